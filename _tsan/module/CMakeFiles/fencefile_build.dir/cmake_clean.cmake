@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/fencefile_build.dir/tools/fencefile_build.c.o"
+  "CMakeFiles/fencefile_build.dir/tools/fencefile_build.c.o.d"
+  "fencefile_build"
+  "fencefile_build.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang C)
+  include(CMakeFiles/fencefile_build.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
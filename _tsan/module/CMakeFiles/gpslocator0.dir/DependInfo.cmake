@@ -0,0 +1,51 @@
+
+# Consider dependencies only in project.
+set(CMAKE_DEPENDS_IN_PROJECT_ONLY OFF)
+
+# The set of languages for which implicit dependencies are needed:
+set(CMAKE_DEPENDS_LANGUAGES
+  )
+
+# The set of dependency files which are needed:
+set(CMAKE_DEPENDS_DEPENDENCY_FILES
+  "/root/repo/module/src/app.c" "module/CMakeFiles/gpslocator0.dir/src/app.c.o" "gcc" "module/CMakeFiles/gpslocator0.dir/src/app.c.o.d"
+  "/root/repo/module/src/devgrid.c" "module/CMakeFiles/gpslocator0.dir/src/devgrid.c.o" "gcc" "module/CMakeFiles/gpslocator0.dir/src/devgrid.c.o.d"
+  "/root/repo/module/src/dispatch.c" "module/CMakeFiles/gpslocator0.dir/src/dispatch.c.o" "gcc" "module/CMakeFiles/gpslocator0.dir/src/dispatch.c.o.d"
+  "/root/repo/module/src/distmatrix.c" "module/CMakeFiles/gpslocator0.dir/src/distmatrix.c.o" "gcc" "module/CMakeFiles/gpslocator0.dir/src/distmatrix.c.o.d"
+  "/root/repo/module/src/fencefile.c" "module/CMakeFiles/gpslocator0.dir/src/fencefile.c.o" "gcc" "module/CMakeFiles/gpslocator0.dir/src/fencefile.c.o.d"
+  "/root/repo/module/src/fixmemo.c" "module/CMakeFiles/gpslocator0.dir/src/fixmemo.c.o" "gcc" "module/CMakeFiles/gpslocator0.dir/src/fixmemo.c.o.d"
+  "/root/repo/module/src/fleet.c" "module/CMakeFiles/gpslocator0.dir/src/fleet.c.o" "gcc" "module/CMakeFiles/gpslocator0.dir/src/fleet.c.o.d"
+  "/root/repo/module/src/geofence.c" "module/CMakeFiles/gpslocator0.dir/src/geofence.c.o" "gcc" "module/CMakeFiles/gpslocator0.dir/src/geofence.c.o.d"
+  "/root/repo/module/src/geoid.c" "module/CMakeFiles/gpslocator0.dir/src/geoid.c.o" "gcc" "module/CMakeFiles/gpslocator0.dir/src/geoid.c.o.d"
+  "/root/repo/module/src/kdtree.c" "module/CMakeFiles/gpslocator0.dir/src/kdtree.c.o" "gcc" "module/CMakeFiles/gpslocator0.dir/src/kdtree.c.o.d"
+  "/root/repo/module/src/lazyfence.c" "module/CMakeFiles/gpslocator0.dir/src/lazyfence.c.o" "gcc" "module/CMakeFiles/gpslocator0.dir/src/lazyfence.c.o.d"
+  "/root/repo/module/src/membership.c" "module/CMakeFiles/gpslocator0.dir/src/membership.c.o" "gcc" "module/CMakeFiles/gpslocator0.dir/src/membership.c.o.d"
+  "/root/repo/module/src/navigation.c" "module/CMakeFiles/gpslocator0.dir/src/navigation.c.o" "gcc" "module/CMakeFiles/gpslocator0.dir/src/navigation.c.o.d"
+  "/root/repo/module/src/occupancy.c" "module/CMakeFiles/gpslocator0.dir/src/occupancy.c.o" "gcc" "module/CMakeFiles/gpslocator0.dir/src/occupancy.c.o.d"
+  "/root/repo/module/src/parallel.c" "module/CMakeFiles/gpslocator0.dir/src/parallel.c.o" "gcc" "module/CMakeFiles/gpslocator0.dir/src/parallel.c.o.d"
+  "/root/repo/module/src/polyfence.c" "module/CMakeFiles/gpslocator0.dir/src/polyfence.c.o" "gcc" "module/CMakeFiles/gpslocator0.dir/src/polyfence.c.o.d"
+  "/root/repo/module/src/position.c" "module/CMakeFiles/gpslocator0.dir/src/position.c.o" "gcc" "module/CMakeFiles/gpslocator0.dir/src/position.c.o.d"
+  "/root/repo/module/src/rangeset.c" "module/CMakeFiles/gpslocator0.dir/src/rangeset.c.o" "gcc" "module/CMakeFiles/gpslocator0.dir/src/rangeset.c.o.d"
+  "/root/repo/module/src/registry.c" "module/CMakeFiles/gpslocator0.dir/src/registry.c.o" "gcc" "module/CMakeFiles/gpslocator0.dir/src/registry.c.o.d"
+  "/root/repo/module/src/rtree.c" "module/CMakeFiles/gpslocator0.dir/src/rtree.c.o" "gcc" "module/CMakeFiles/gpslocator0.dir/src/rtree.c.o.d"
+  "/root/repo/module/src/target.c" "module/CMakeFiles/gpslocator0.dir/src/target.c.o" "gcc" "module/CMakeFiles/gpslocator0.dir/src/target.c.o.d"
+  "/root/repo/module/src/targetset.c" "module/CMakeFiles/gpslocator0.dir/src/targetset.c.o" "gcc" "module/CMakeFiles/gpslocator0.dir/src/targetset.c.o.d"
+  "/root/repo/module/src/tcpingest.c" "module/CMakeFiles/gpslocator0.dir/src/tcpingest.c.o" "gcc" "module/CMakeFiles/gpslocator0.dir/src/tcpingest.c.o.d"
+  "/root/repo/module/src/udpingest.c" "module/CMakeFiles/gpslocator0.dir/src/udpingest.c.o" "gcc" "module/CMakeFiles/gpslocator0.dir/src/udpingest.c.o.d"
+  "/root/repo/module/src/userif.c" "module/CMakeFiles/gpslocator0.dir/src/userif.c.o" "gcc" "module/CMakeFiles/gpslocator0.dir/src/userif.c.o.d"
+  "/root/repo/_tsan/module/target_table.c" "module/CMakeFiles/gpslocator0.dir/target_table.c.o" "gcc" "module/CMakeFiles/gpslocator0.dir/target_table.c.o.d"
+  )
+
+# Pairs of files generated by the same build rule.
+set(CMAKE_MULTIPLE_OUTPUT_PAIRS
+  "/root/repo/_tsan/module/libgpslocator0.so" "/root/repo/_tsan/module/libgpslocator0.so.0.0.0"
+  "/root/repo/_tsan/module/libgpslocator0.so.0" "/root/repo/_tsan/module/libgpslocator0.so.0.0.0"
+  )
+
+
+# Targets to which this target links.
+set(CMAKE_TARGET_LINKED_INFO_FILES
+  )
+
+# Fortran module output directory.
+set(CMAKE_Fortran_TARGET_MODULE_DIR "")
@@ -0,0 +1,64 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/gpslocator0.dir/src/app.c.o"
+  "CMakeFiles/gpslocator0.dir/src/app.c.o.d"
+  "CMakeFiles/gpslocator0.dir/src/devgrid.c.o"
+  "CMakeFiles/gpslocator0.dir/src/devgrid.c.o.d"
+  "CMakeFiles/gpslocator0.dir/src/dispatch.c.o"
+  "CMakeFiles/gpslocator0.dir/src/dispatch.c.o.d"
+  "CMakeFiles/gpslocator0.dir/src/distmatrix.c.o"
+  "CMakeFiles/gpslocator0.dir/src/distmatrix.c.o.d"
+  "CMakeFiles/gpslocator0.dir/src/fencefile.c.o"
+  "CMakeFiles/gpslocator0.dir/src/fencefile.c.o.d"
+  "CMakeFiles/gpslocator0.dir/src/fixmemo.c.o"
+  "CMakeFiles/gpslocator0.dir/src/fixmemo.c.o.d"
+  "CMakeFiles/gpslocator0.dir/src/fleet.c.o"
+  "CMakeFiles/gpslocator0.dir/src/fleet.c.o.d"
+  "CMakeFiles/gpslocator0.dir/src/geofence.c.o"
+  "CMakeFiles/gpslocator0.dir/src/geofence.c.o.d"
+  "CMakeFiles/gpslocator0.dir/src/geoid.c.o"
+  "CMakeFiles/gpslocator0.dir/src/geoid.c.o.d"
+  "CMakeFiles/gpslocator0.dir/src/kdtree.c.o"
+  "CMakeFiles/gpslocator0.dir/src/kdtree.c.o.d"
+  "CMakeFiles/gpslocator0.dir/src/lazyfence.c.o"
+  "CMakeFiles/gpslocator0.dir/src/lazyfence.c.o.d"
+  "CMakeFiles/gpslocator0.dir/src/membership.c.o"
+  "CMakeFiles/gpslocator0.dir/src/membership.c.o.d"
+  "CMakeFiles/gpslocator0.dir/src/navigation.c.o"
+  "CMakeFiles/gpslocator0.dir/src/navigation.c.o.d"
+  "CMakeFiles/gpslocator0.dir/src/occupancy.c.o"
+  "CMakeFiles/gpslocator0.dir/src/occupancy.c.o.d"
+  "CMakeFiles/gpslocator0.dir/src/parallel.c.o"
+  "CMakeFiles/gpslocator0.dir/src/parallel.c.o.d"
+  "CMakeFiles/gpslocator0.dir/src/polyfence.c.o"
+  "CMakeFiles/gpslocator0.dir/src/polyfence.c.o.d"
+  "CMakeFiles/gpslocator0.dir/src/position.c.o"
+  "CMakeFiles/gpslocator0.dir/src/position.c.o.d"
+  "CMakeFiles/gpslocator0.dir/src/rangeset.c.o"
+  "CMakeFiles/gpslocator0.dir/src/rangeset.c.o.d"
+  "CMakeFiles/gpslocator0.dir/src/registry.c.o"
+  "CMakeFiles/gpslocator0.dir/src/registry.c.o.d"
+  "CMakeFiles/gpslocator0.dir/src/rtree.c.o"
+  "CMakeFiles/gpslocator0.dir/src/rtree.c.o.d"
+  "CMakeFiles/gpslocator0.dir/src/target.c.o"
+  "CMakeFiles/gpslocator0.dir/src/target.c.o.d"
+  "CMakeFiles/gpslocator0.dir/src/targetset.c.o"
+  "CMakeFiles/gpslocator0.dir/src/targetset.c.o.d"
+  "CMakeFiles/gpslocator0.dir/src/tcpingest.c.o"
+  "CMakeFiles/gpslocator0.dir/src/tcpingest.c.o.d"
+  "CMakeFiles/gpslocator0.dir/src/udpingest.c.o"
+  "CMakeFiles/gpslocator0.dir/src/udpingest.c.o.d"
+  "CMakeFiles/gpslocator0.dir/src/userif.c.o"
+  "CMakeFiles/gpslocator0.dir/src/userif.c.o.d"
+  "CMakeFiles/gpslocator0.dir/target_table.c.o"
+  "CMakeFiles/gpslocator0.dir/target_table.c.o.d"
+  "libgpslocator0.pdb"
+  "libgpslocator0.so"
+  "libgpslocator0.so.0"
+  "libgpslocator0.so.0.0.0"
+  "target_table.c"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang C)
+  include(CMakeFiles/gpslocator0.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,19 @@
+/* Generated by target_table_gen. Do not edit. */
+
+#include <stdint.h>
+#include "target.h"
+
+const uint32_t target_table_count_ = 1u;
+
+const target_entry_st target_table_[1] = {
+    {
+        .llh = {.latitude = 39.4731325f, .longitude = -0.3677324f, .altitude = 8.0f, .is_valid = pos_3d},
+        .ecef = {4930045.59f, -31642.1629f, 4033037.9f},
+        .rotation = {{0.00641809708f, 0.999979404f, 0.0f},
+                     {-0.635703222f, 0.00408008903f, 0.771922772f},
+                     {0.771906874f, -0.00495427529f, 0.635716315f}},
+        .range = 100.0f,
+        .range_sq = 10000.0f,
+        .separation = 49.5f,
+    },
+};
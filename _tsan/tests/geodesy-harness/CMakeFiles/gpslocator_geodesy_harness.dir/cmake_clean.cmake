@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/gpslocator_geodesy_harness.dir/src/geodesy_harness.cpp.o"
+  "CMakeFiles/gpslocator_geodesy_harness.dir/src/geodesy_harness.cpp.o.d"
+  "gpslocator_geodesy_harness"
+  "gpslocator_geodesy_harness.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/gpslocator_geodesy_harness.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
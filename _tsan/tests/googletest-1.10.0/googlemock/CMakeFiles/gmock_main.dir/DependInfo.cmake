@@ -0,0 +1,21 @@
+
+# Consider dependencies only in project.
+set(CMAKE_DEPENDS_IN_PROJECT_ONLY OFF)
+
+# The set of languages for which implicit dependencies are needed:
+set(CMAKE_DEPENDS_LANGUAGES
+  )
+
+# The set of dependency files which are needed:
+set(CMAKE_DEPENDS_DEPENDENCY_FILES
+  "/root/repo/tests/googletest-1.10.0/googlemock/src/gmock_main.cc" "tests/googletest-1.10.0/googlemock/CMakeFiles/gmock_main.dir/src/gmock_main.cc.o" "gcc" "tests/googletest-1.10.0/googlemock/CMakeFiles/gmock_main.dir/src/gmock_main.cc.o.d"
+  )
+
+# Targets to which this target links.
+set(CMAKE_TARGET_LINKED_INFO_FILES
+  "/root/repo/_tsan/tests/googletest-1.10.0/googlemock/CMakeFiles/gmock.dir/DependInfo.cmake"
+  "/root/repo/_tsan/tests/googletest-1.10.0/googletest/CMakeFiles/gtest.dir/DependInfo.cmake"
+  )
+
+# Fortran module output directory.
+set(CMAKE_Fortran_TARGET_MODULE_DIR "")
@@ -0,0 +1,50 @@
+
+# Consider dependencies only in project.
+set(CMAKE_DEPENDS_IN_PROJECT_ONLY OFF)
+
+# The set of languages for which implicit dependencies are needed:
+set(CMAKE_DEPENDS_LANGUAGES
+  )
+
+# The set of dependency files which are needed:
+set(CMAKE_DEPENDS_DEPENDENCY_FILES
+  "/root/repo/tests/unitary-tests/module/app_tests.cpp" "tests/unitary-tests/CMakeFiles/gpslocator_tests.dir/module/app_tests.cpp.o" "gcc" "tests/unitary-tests/CMakeFiles/gpslocator_tests.dir/module/app_tests.cpp.o.d"
+  "/root/repo/tests/unitary-tests/module/devgrid_tests.cpp" "tests/unitary-tests/CMakeFiles/gpslocator_tests.dir/module/devgrid_tests.cpp.o" "gcc" "tests/unitary-tests/CMakeFiles/gpslocator_tests.dir/module/devgrid_tests.cpp.o.d"
+  "/root/repo/tests/unitary-tests/module/dispatch_tests.cpp" "tests/unitary-tests/CMakeFiles/gpslocator_tests.dir/module/dispatch_tests.cpp.o" "gcc" "tests/unitary-tests/CMakeFiles/gpslocator_tests.dir/module/dispatch_tests.cpp.o.d"
+  "/root/repo/tests/unitary-tests/module/distmatrix_tests.cpp" "tests/unitary-tests/CMakeFiles/gpslocator_tests.dir/module/distmatrix_tests.cpp.o" "gcc" "tests/unitary-tests/CMakeFiles/gpslocator_tests.dir/module/distmatrix_tests.cpp.o.d"
+  "/root/repo/tests/unitary-tests/module/fencefile_tests.cpp" "tests/unitary-tests/CMakeFiles/gpslocator_tests.dir/module/fencefile_tests.cpp.o" "gcc" "tests/unitary-tests/CMakeFiles/gpslocator_tests.dir/module/fencefile_tests.cpp.o.d"
+  "/root/repo/tests/unitary-tests/module/fixmemo_tests.cpp" "tests/unitary-tests/CMakeFiles/gpslocator_tests.dir/module/fixmemo_tests.cpp.o" "gcc" "tests/unitary-tests/CMakeFiles/gpslocator_tests.dir/module/fixmemo_tests.cpp.o.d"
+  "/root/repo/tests/unitary-tests/module/fleet_tests.cpp" "tests/unitary-tests/CMakeFiles/gpslocator_tests.dir/module/fleet_tests.cpp.o" "gcc" "tests/unitary-tests/CMakeFiles/gpslocator_tests.dir/module/fleet_tests.cpp.o.d"
+  "/root/repo/tests/unitary-tests/module/geodesy_tests.cpp" "tests/unitary-tests/CMakeFiles/gpslocator_tests.dir/module/geodesy_tests.cpp.o" "gcc" "tests/unitary-tests/CMakeFiles/gpslocator_tests.dir/module/geodesy_tests.cpp.o.d"
+  "/root/repo/tests/unitary-tests/module/geofence_tests.cpp" "tests/unitary-tests/CMakeFiles/gpslocator_tests.dir/module/geofence_tests.cpp.o" "gcc" "tests/unitary-tests/CMakeFiles/gpslocator_tests.dir/module/geofence_tests.cpp.o.d"
+  "/root/repo/tests/unitary-tests/module/geoid_tests.cpp" "tests/unitary-tests/CMakeFiles/gpslocator_tests.dir/module/geoid_tests.cpp.o" "gcc" "tests/unitary-tests/CMakeFiles/gpslocator_tests.dir/module/geoid_tests.cpp.o.d"
+  "/root/repo/tests/unitary-tests/module/kdtree_tests.cpp" "tests/unitary-tests/CMakeFiles/gpslocator_tests.dir/module/kdtree_tests.cpp.o" "gcc" "tests/unitary-tests/CMakeFiles/gpslocator_tests.dir/module/kdtree_tests.cpp.o.d"
+  "/root/repo/tests/unitary-tests/module/lazyfence_tests.cpp" "tests/unitary-tests/CMakeFiles/gpslocator_tests.dir/module/lazyfence_tests.cpp.o" "gcc" "tests/unitary-tests/CMakeFiles/gpslocator_tests.dir/module/lazyfence_tests.cpp.o.d"
+  "/root/repo/tests/unitary-tests/module/membership_tests.cpp" "tests/unitary-tests/CMakeFiles/gpslocator_tests.dir/module/membership_tests.cpp.o" "gcc" "tests/unitary-tests/CMakeFiles/gpslocator_tests.dir/module/membership_tests.cpp.o.d"
+  "/root/repo/tests/unitary-tests/module/navigation_tests.cpp" "tests/unitary-tests/CMakeFiles/gpslocator_tests.dir/module/navigation_tests.cpp.o" "gcc" "tests/unitary-tests/CMakeFiles/gpslocator_tests.dir/module/navigation_tests.cpp.o.d"
+  "/root/repo/tests/unitary-tests/module/occupancy_tests.cpp" "tests/unitary-tests/CMakeFiles/gpslocator_tests.dir/module/occupancy_tests.cpp.o" "gcc" "tests/unitary-tests/CMakeFiles/gpslocator_tests.dir/module/occupancy_tests.cpp.o.d"
+  "/root/repo/tests/unitary-tests/module/parallel_tests.cpp" "tests/unitary-tests/CMakeFiles/gpslocator_tests.dir/module/parallel_tests.cpp.o" "gcc" "tests/unitary-tests/CMakeFiles/gpslocator_tests.dir/module/parallel_tests.cpp.o.d"
+  "/root/repo/tests/unitary-tests/module/polyfence_tests.cpp" "tests/unitary-tests/CMakeFiles/gpslocator_tests.dir/module/polyfence_tests.cpp.o" "gcc" "tests/unitary-tests/CMakeFiles/gpslocator_tests.dir/module/polyfence_tests.cpp.o.d"
+  "/root/repo/tests/unitary-tests/module/position_tests.cpp" "tests/unitary-tests/CMakeFiles/gpslocator_tests.dir/module/position_tests.cpp.o" "gcc" "tests/unitary-tests/CMakeFiles/gpslocator_tests.dir/module/position_tests.cpp.o.d"
+  "/root/repo/tests/unitary-tests/module/rangeset_tests.cpp" "tests/unitary-tests/CMakeFiles/gpslocator_tests.dir/module/rangeset_tests.cpp.o" "gcc" "tests/unitary-tests/CMakeFiles/gpslocator_tests.dir/module/rangeset_tests.cpp.o.d"
+  "/root/repo/tests/unitary-tests/module/registry_tests.cpp" "tests/unitary-tests/CMakeFiles/gpslocator_tests.dir/module/registry_tests.cpp.o" "gcc" "tests/unitary-tests/CMakeFiles/gpslocator_tests.dir/module/registry_tests.cpp.o.d"
+  "/root/repo/tests/unitary-tests/module/rtree_tests.cpp" "tests/unitary-tests/CMakeFiles/gpslocator_tests.dir/module/rtree_tests.cpp.o" "gcc" "tests/unitary-tests/CMakeFiles/gpslocator_tests.dir/module/rtree_tests.cpp.o.d"
+  "/root/repo/tests/unitary-tests/module/target_tests.cpp" "tests/unitary-tests/CMakeFiles/gpslocator_tests.dir/module/target_tests.cpp.o" "gcc" "tests/unitary-tests/CMakeFiles/gpslocator_tests.dir/module/target_tests.cpp.o.d"
+  "/root/repo/tests/unitary-tests/module/targetset_tests.cpp" "tests/unitary-tests/CMakeFiles/gpslocator_tests.dir/module/targetset_tests.cpp.o" "gcc" "tests/unitary-tests/CMakeFiles/gpslocator_tests.dir/module/targetset_tests.cpp.o.d"
+  "/root/repo/tests/unitary-tests/module/tcpingest_tests.cpp" "tests/unitary-tests/CMakeFiles/gpslocator_tests.dir/module/tcpingest_tests.cpp.o" "gcc" "tests/unitary-tests/CMakeFiles/gpslocator_tests.dir/module/tcpingest_tests.cpp.o.d"
+  "/root/repo/tests/unitary-tests/module/udpingest_tests.cpp" "tests/unitary-tests/CMakeFiles/gpslocator_tests.dir/module/udpingest_tests.cpp.o" "gcc" "tests/unitary-tests/CMakeFiles/gpslocator_tests.dir/module/udpingest_tests.cpp.o.d"
+  "/root/repo/tests/unitary-tests/module/userif_tests.cpp" "tests/unitary-tests/CMakeFiles/gpslocator_tests.dir/module/userif_tests.cpp.o" "gcc" "tests/unitary-tests/CMakeFiles/gpslocator_tests.dir/module/userif_tests.cpp.o.d"
+  "/root/repo/tests/unitary-tests/src/NmeaUtils.cpp" "tests/unitary-tests/CMakeFiles/gpslocator_tests.dir/src/NmeaUtils.cpp.o" "gcc" "tests/unitary-tests/CMakeFiles/gpslocator_tests.dir/src/NmeaUtils.cpp.o.d"
+  "/root/repo/tests/unitary-tests/src/tests.cpp" "tests/unitary-tests/CMakeFiles/gpslocator_tests.dir/src/tests.cpp.o" "gcc" "tests/unitary-tests/CMakeFiles/gpslocator_tests.dir/src/tests.cpp.o.d"
+  "/root/repo/tests/unitary-tests/src/unitary_test_system_model_memory.cpp" "tests/unitary-tests/CMakeFiles/gpslocator_tests.dir/src/unitary_test_system_model_memory.cpp.o" "gcc" "tests/unitary-tests/CMakeFiles/gpslocator_tests.dir/src/unitary_test_system_model_memory.cpp.o.d"
+  )
+
+# Targets to which this target links.
+set(CMAKE_TARGET_LINKED_INFO_FILES
+  "/root/repo/_tsan/module/CMakeFiles/gpslocator0.dir/DependInfo.cmake"
+  "/root/repo/_tsan/tests/googletest-1.10.0/googletest/CMakeFiles/gtest.dir/DependInfo.cmake"
+  "/root/repo/_tsan/tests/googletest-1.10.0/googletest/CMakeFiles/gtest_main.dir/DependInfo.cmake"
+  )
+
+# Fortran module output directory.
+set(CMAKE_Fortran_TARGET_MODULE_DIR "")
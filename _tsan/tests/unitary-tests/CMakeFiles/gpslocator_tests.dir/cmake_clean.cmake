@@ -0,0 +1,67 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/gpslocator_tests.dir/module/app_tests.cpp.o"
+  "CMakeFiles/gpslocator_tests.dir/module/app_tests.cpp.o.d"
+  "CMakeFiles/gpslocator_tests.dir/module/devgrid_tests.cpp.o"
+  "CMakeFiles/gpslocator_tests.dir/module/devgrid_tests.cpp.o.d"
+  "CMakeFiles/gpslocator_tests.dir/module/dispatch_tests.cpp.o"
+  "CMakeFiles/gpslocator_tests.dir/module/dispatch_tests.cpp.o.d"
+  "CMakeFiles/gpslocator_tests.dir/module/distmatrix_tests.cpp.o"
+  "CMakeFiles/gpslocator_tests.dir/module/distmatrix_tests.cpp.o.d"
+  "CMakeFiles/gpslocator_tests.dir/module/fencefile_tests.cpp.o"
+  "CMakeFiles/gpslocator_tests.dir/module/fencefile_tests.cpp.o.d"
+  "CMakeFiles/gpslocator_tests.dir/module/fixmemo_tests.cpp.o"
+  "CMakeFiles/gpslocator_tests.dir/module/fixmemo_tests.cpp.o.d"
+  "CMakeFiles/gpslocator_tests.dir/module/fleet_tests.cpp.o"
+  "CMakeFiles/gpslocator_tests.dir/module/fleet_tests.cpp.o.d"
+  "CMakeFiles/gpslocator_tests.dir/module/geodesy_tests.cpp.o"
+  "CMakeFiles/gpslocator_tests.dir/module/geodesy_tests.cpp.o.d"
+  "CMakeFiles/gpslocator_tests.dir/module/geofence_tests.cpp.o"
+  "CMakeFiles/gpslocator_tests.dir/module/geofence_tests.cpp.o.d"
+  "CMakeFiles/gpslocator_tests.dir/module/geoid_tests.cpp.o"
+  "CMakeFiles/gpslocator_tests.dir/module/geoid_tests.cpp.o.d"
+  "CMakeFiles/gpslocator_tests.dir/module/kdtree_tests.cpp.o"
+  "CMakeFiles/gpslocator_tests.dir/module/kdtree_tests.cpp.o.d"
+  "CMakeFiles/gpslocator_tests.dir/module/lazyfence_tests.cpp.o"
+  "CMakeFiles/gpslocator_tests.dir/module/lazyfence_tests.cpp.o.d"
+  "CMakeFiles/gpslocator_tests.dir/module/membership_tests.cpp.o"
+  "CMakeFiles/gpslocator_tests.dir/module/membership_tests.cpp.o.d"
+  "CMakeFiles/gpslocator_tests.dir/module/navigation_tests.cpp.o"
+  "CMakeFiles/gpslocator_tests.dir/module/navigation_tests.cpp.o.d"
+  "CMakeFiles/gpslocator_tests.dir/module/occupancy_tests.cpp.o"
+  "CMakeFiles/gpslocator_tests.dir/module/occupancy_tests.cpp.o.d"
+  "CMakeFiles/gpslocator_tests.dir/module/parallel_tests.cpp.o"
+  "CMakeFiles/gpslocator_tests.dir/module/parallel_tests.cpp.o.d"
+  "CMakeFiles/gpslocator_tests.dir/module/polyfence_tests.cpp.o"
+  "CMakeFiles/gpslocator_tests.dir/module/polyfence_tests.cpp.o.d"
+  "CMakeFiles/gpslocator_tests.dir/module/position_tests.cpp.o"
+  "CMakeFiles/gpslocator_tests.dir/module/position_tests.cpp.o.d"
+  "CMakeFiles/gpslocator_tests.dir/module/rangeset_tests.cpp.o"
+  "CMakeFiles/gpslocator_tests.dir/module/rangeset_tests.cpp.o.d"
+  "CMakeFiles/gpslocator_tests.dir/module/registry_tests.cpp.o"
+  "CMakeFiles/gpslocator_tests.dir/module/registry_tests.cpp.o.d"
+  "CMakeFiles/gpslocator_tests.dir/module/rtree_tests.cpp.o"
+  "CMakeFiles/gpslocator_tests.dir/module/rtree_tests.cpp.o.d"
+  "CMakeFiles/gpslocator_tests.dir/module/target_tests.cpp.o"
+  "CMakeFiles/gpslocator_tests.dir/module/target_tests.cpp.o.d"
+  "CMakeFiles/gpslocator_tests.dir/module/targetset_tests.cpp.o"
+  "CMakeFiles/gpslocator_tests.dir/module/targetset_tests.cpp.o.d"
+  "CMakeFiles/gpslocator_tests.dir/module/tcpingest_tests.cpp.o"
+  "CMakeFiles/gpslocator_tests.dir/module/tcpingest_tests.cpp.o.d"
+  "CMakeFiles/gpslocator_tests.dir/module/udpingest_tests.cpp.o"
+  "CMakeFiles/gpslocator_tests.dir/module/udpingest_tests.cpp.o.d"
+  "CMakeFiles/gpslocator_tests.dir/module/userif_tests.cpp.o"
+  "CMakeFiles/gpslocator_tests.dir/module/userif_tests.cpp.o.d"
+  "CMakeFiles/gpslocator_tests.dir/src/NmeaUtils.cpp.o"
+  "CMakeFiles/gpslocator_tests.dir/src/NmeaUtils.cpp.o.d"
+  "CMakeFiles/gpslocator_tests.dir/src/tests.cpp.o"
+  "CMakeFiles/gpslocator_tests.dir/src/tests.cpp.o.d"
+  "CMakeFiles/gpslocator_tests.dir/src/unitary_test_system_model_memory.cpp.o"
+  "CMakeFiles/gpslocator_tests.dir/src/unitary_test_system_model_memory.cpp.o.d"
+  "gpslocator_tests"
+  "gpslocator_tests.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/gpslocator_tests.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
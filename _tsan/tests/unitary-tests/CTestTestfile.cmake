@@ -0,0 +1,8 @@
+# CMake generated Testfile for 
+# Source directory: /root/repo/tests/unitary-tests
+# Build directory: /root/repo/_tsan/tests/unitary-tests
+# 
+# This file includes the relevant testing commands required for 
+# testing this directory and lists subdirectories to be tested as well.
+add_test(Suite-gpslocator_tests "gpslocator_tests" "--gtest_repeat=2")
+set_tests_properties(Suite-gpslocator_tests PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/tests/unitary-tests/CMakeLists.txt;50;add_test;/root/repo/tests/unitary-tests/CMakeLists.txt;0;")
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/target_table_gen.dir/tools/target_table_gen.cpp.o"
+  "CMakeFiles/target_table_gen.dir/tools/target_table_gen.cpp.o.d"
+  "target_table_gen"
+  "target_table_gen.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/target_table_gen.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,8 @@
+# CMake generated Testfile for 
+# Source directory: /root/repo/tests/geodesy-harness
+# Build directory: /root/repo/_ubsan/tests/geodesy-harness
+# 
+# This file includes the relevant testing commands required for 
+# testing this directory and lists subdirectories to be tested as well.
+add_test(Harness-gpslocator_geodesy_harness "gpslocator_geodesy_harness" "--quick" "--output" "/root/repo/_ubsan/tests/geodesy-harness/geodesy_harness.csv")
+set_tests_properties(Harness-gpslocator_geodesy_harness PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/tests/geodesy-harness/CMakeLists.txt;30;add_test;/root/repo/tests/geodesy-harness/CMakeLists.txt;0;")
@@ -0,0 +1,7 @@
+# CMake generated Testfile for 
+# Source directory: /root/repo/tests/googletest-1.10.0
+# Build directory: /root/repo/_ubsan/tests/googletest-1.10.0
+# 
+# This file includes the relevant testing commands required for 
+# testing this directory and lists subdirectories to be tested as well.
+subdirs("googlemock")
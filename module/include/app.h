@@ -13,6 +13,18 @@
  * [27/02/2021]     [miguelgarcia]
  * Initial version
  *
+ * [18/10/2026]     [miguelgarcia]
+ * Lazy evaluation of the fences
+ *
+ * [18/10/2026]     [miguelgarcia]
+ * Hot-swappable target set
+ *
+ * [18/10/2026]     [miguelgarcia]
+ * Fence occupancy index
+ *
+ * [18/10/2026]     [miguelgarcia]
+ * Stationary device memo
+ *
  */
 
 #ifndef INCLUDE_APP_H_
@@ -22,6 +34,24 @@
 extern "C" {
 #endif
 
+#include <stdint.h>
+#include "geofence.h"
+#include "geoid.h"
+#include "occupancy.h"
+#include "targetset.h"
+
+/** Counters of the GPSlocator */
+typedef struct {
+
+    /** Number of valid positions */
+    uint32_t fixes;
+    /** Number of positions that reused the fences of the stationary memo */
+    uint32_t memo_hits;
+    /** Number of positions checked with the stationary memo and evaluated */
+    uint32_t memo_misses;
+
+} app_stats_st;
+
 /**
 * @brief Initialize the state of the GPSlocator
 */
@@ -33,6 +63,58 @@ void app_init(void);
  */
 void app_step(char d);
 
+/**
+ * @brief Set the geoid grid used to get the ellipsoidal height of the device when the GPS module does not report the
+ * geoidal separation.
+ * @param [in] geoid  Geoid grid, or NULL to use the MSL altitude as ellipsoidal height
+ */
+void app_set_geoid(const geoid_st* geoid);
+
+/**
+ * @brief Set the fences checked on every new position. By default the fences are the targets of the target table.
+ * @param [in] fences  Set of fences, or NULL to use the targets of the target table
+ */
+void app_set_geofences(geofence_set_st* fences);
+
+/**
+ * @brief Enable the lazy evaluation of the fences (see lazyfence.h): a new position reuses the fences of the last
+ * evaluated one while the device cannot have crossed a fence boundary. It is disabled by default.
+ * @param [in] enable     Positive value to enable it, Zero to evaluate every position
+ * @param [in] max_speed  Max plausible speed of the device in m/s, zero for no bound
+ */
+void app_set_lazy_evaluation(uint8_t enable, float max_speed);
+
+/**
+ * @brief Set a target set checked instead of the fences on every new position (see targetset.h). Its snapshots can be
+ * replaced from other threads while the device is evaluated.
+ * @param [in] t  Target set, or NULL to check the fences again
+ * @return Zero on success, Otherwise a negative value if no reader of the target set is available
+ */
+int app_set_target_set(targetset_st* t);
+
+/**
+ * @brief Set an occupancy index updated with the enter and exit transitions of the device (see occupancy.h). The device
+ * enters the fences that contain it now, and leaves the fences of the previous occupancy index.
+ * @param [in] o       Occupancy index, or NULL to stop updating it
+ * @param [in] device  Device index in the occupancy index
+ * @return Zero on success, Otherwise a negative value
+ */
+int app_set_occupancy(occupancy_st* o, uint32_t device);
+
+/**
+ * @brief Enable the stationary device memo (see fixmemo.h): a new position within epsilon of the last evaluated one
+ * reuses its fences. It is disabled by default.
+ * @param [in] enable   Positive value to enable it, Zero to evaluate every position
+ * @param [in] epsilon  Max distance to the last evaluated position in meters, zero for identical positions only
+ */
+void app_set_stationary_memo(uint8_t enable, float epsilon);
+
+/**
+ * @brief Get the counters of the GPSlocator since its initialization
+ * @param [out] stats  Counters
+ */
+void app_get_stats(app_stats_st* stats);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,154 @@
+/**
+ * @file devgrid.h
+ *
+ * Device spatial hash
+ *
+ * Spatial hash of the current ECEF positions of a fleet of devices, for the proximity queries between devices ("which
+ * devices are within R meters of this one"). The space is split in ECEF cubes of a fixed size, and each cube with
+ * devices is a cell of a hash table (open addressing) with the list of its devices. A new fix of a device updates its
+ * position in place, and only moves the device to another cell when it crosses a cell boundary: the device is removed
+ * from the list of the old cell (the last device of the list takes its place) and appended to the list of the new one.
+ *
+ * A query around a position reads the cells of the cube of side 2R around it, so its cost depends on the devices near
+ * the position and not on the size of the fleet. The best cell size is about the usual query radius: every query reads
+ * 27 cells. A query with a radius too large for the cells reads every cell instead.
+ *
+ * The devices are identified by an index lower than the max number of devices of the hash.
+ *
+ * @license
+ * All rights reserved. Read LICENSE.txt file for the license terms.
+ *
+ * Changelog:
+ *
+ * [18/10/2026]     [miguelgarcia]
+ * Initial version
+ *
+ */
+
+#ifndef INCLUDE_DEVGRID_H_
+#define INCLUDE_DEVGRID_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+/** Min cell size in meters, so the cell coordinates of any ECEF position fit in the cell keys */
+#define DEVGRID_MIN_CELL    8.0f
+
+/** Device of the hash */
+typedef struct {
+
+    /** ECEF position (x, y, z) */
+    float ecef[3];
+    /** Position of the device in the list of its cell */
+    uint32_t pos;
+    /** Key of the cell of the device, zero if the device is not in the hash */
+    uint64_t key;
+
+} devgrid_device_st;
+
+/** Cell of the hash */
+typedef struct {
+
+    /** Key of the cell, zero if the hash slot is empty */
+    uint64_t key;
+    /** Devices of the cell */
+    uint32_t* devices;
+    /** Number of devices of the cell */
+    uint32_t count;
+    /** Allocated devices */
+    uint32_t capacity;
+
+} devgrid_cell_st;
+
+/** Device spatial hash */
+typedef struct {
+
+    /** Cell size in meters */
+    float cell;
+    /** Devices, by index */
+    devgrid_device_st* devices;
+    /** Max number of devices */
+    uint32_t max_devices;
+    /** Number of devices in the hash */
+    uint32_t count;
+
+    /** Hash table of the cells with devices */
+    devgrid_cell_st* cells;
+    /** Size of the hash table minus one, the size is a power of two */
+    uint32_t mask;
+    /** Number of cells with devices */
+    uint32_t ncells;
+
+    /** Number of updates */
+    uint32_t updates;
+    /** Number of updates that moved a device to another cell */
+    uint32_t moves;
+
+} devgrid_st;
+
+/**
+ * @brief Initialize an empty hash
+ * @param [out] g            Hash
+ * @param [in]  max_devices  Max number of devices
+ * @param [in]  cell         Cell size in meters, at least DEVGRID_MIN_CELL
+ * @return Zero on success, Otherwise a negative value
+ */
+int devgrid_init(devgrid_st* g, uint32_t max_devices, float cell);
+
+/**
+ * @brief Release a hash
+ * @param [in] g  Hash
+ */
+void devgrid_free(devgrid_st* g);
+
+/**
+ * @brief Set the position of a device, and add it to the hash if it is not in it
+ * @param [in] g       Hash
+ * @param [in] device  Device index
+ * @param [in] x       ECEF X
+ * @param [in] y       ECEF Y
+ * @param [in] z       ECEF Z
+ * @return Zero on success, Otherwise a negative value
+ */
+int devgrid_update(devgrid_st* g, uint32_t device, float x, float y, float z);
+
+/**
+ * @brief Remove a device from the hash, for a device without position
+ * @param [in] g       Hash
+ * @param [in] device  Device index
+ */
+void devgrid_remove(devgrid_st* g, uint32_t device);
+
+/**
+ * @brief Find the devices within a distance of an ECEF position
+ * @param [in]  g        Hash
+ * @param [in]  x        ECEF X
+ * @param [in]  y        ECEF Y
+ * @param [in]  z        ECEF Z
+ * @param [in]  radius   Distance in meters
+ * @param [out] devices  Indexes of the devices found
+ * @param [in]  max      Size of the device buffer
+ * @return Number of devices found. If it is larger than max, only max devices are written
+ */
+uint32_t devgrid_query(const devgrid_st* g, float x, float y, float z, float radius, uint32_t* devices, uint32_t max);
+
+/**
+ * @brief Find the other devices within a distance of a device
+ * @param [in]  g        Hash
+ * @param [in]  device   Device index
+ * @param [in]  radius   Distance in meters
+ * @param [out] devices  Indexes of the devices found, without the given one
+ * @param [in]  max      Size of the device buffer
+ * @return Number of devices found, zero if the device is not in the hash. If it is larger than max, only max devices
+ * are written
+ */
+uint32_t devgrid_neighbours(const devgrid_st* g, uint32_t device, float radius, uint32_t* devices, uint32_t max);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* INCLUDE_DEVGRID_H_ */
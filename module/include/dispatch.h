@@ -0,0 +1,211 @@
+/**
+ * @file dispatch.h
+ *
+ * Runtime CPU feature dispatch
+ *
+ * The hot kernels of the library (NMEA checksum, NMEA field scanning, the distance kernel of the distance matrix, the
+ * range test of the target sets, the point-in-polygon crossing test and the box test of the R-tree) have a scalar
+ * version and SIMD versions for SSE2, AVX2 and AVX-512. The CPU features are detected once when the library is
+ * loaded, and the best version supported by the CPU is bound to a table of function pointers, so the same binary runs
+ * on any x86 processor. On other architectures only the scalar versions are built.
+ *
+ * The environment variable GPSLOCATOR_CPU (scalar, sse2, avx2 or avx512) forces a lower level, e.g. to compare the
+ * results of two versions. A level higher than the supported one is ignored.
+ *
+ * @license
+ * All rights reserved. Read LICENSE.txt file for the license terms.
+ *
+ * Changelog:
+ *
+ * [18/10/2026]     [miguelgarcia]
+ * Initial version
+ *
+ * [18/10/2026]     [miguelgarcia]
+ * Point-in-polygon crossings kernel
+ *
+ * [18/10/2026]     [miguelgarcia]
+ * R-tree box test kernel
+ *
+ * [18/10/2026]     [miguelgarcia]
+ * Range mask kernel
+ *
+ */
+
+#ifndef INCLUDE_DISPATCH_H_
+#define INCLUDE_DISPATCH_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+/** Environment variable to force a dispatch level */
+#define DISPATCH_ENV    "GPSLOCATOR_CPU"
+
+/** Dispatch levels, from the lowest to the highest */
+typedef enum {
+
+    dispatch_scalar = 0,
+    dispatch_sse2 = 1,
+    dispatch_avx2 = 2,
+    dispatch_avx512 = 3,
+
+    dispatch_levels
+
+} dispatch_level;
+
+/**
+ * XOR of a buffer of bytes (NMEA checksum)
+ * @param [in] data  Buffer
+ * @param [in] len   Buffer length
+ * @return XOR of the bytes
+ */
+typedef uint8_t (*dispatch_xor_fn)(const char* data, uint32_t len);
+
+/**
+ * Find the separators of a buffer (NMEA field scanning)
+ * @param [in]  data  Buffer
+ * @param [in]  len   Buffer length
+ * @param [in]  sep   Separator
+ * @param [out] offs  Offsets of the separators, in order
+ * @param [in]  max   Max number of offsets
+ * @return Number of offsets written
+ */
+typedef uint32_t (*dispatch_scan_fn)(const char* data, uint32_t len, char sep, uint16_t* offs, uint32_t max);
+
+/**
+ * Squared distances (or distances) from one point to n points of a set. The set arrays and the output must be
+ * aligned to 64 bytes and padded to 16 elements.
+ *
+ * @param [in]  bx         Set X
+ * @param [in]  by         Set Y
+ * @param [in]  bz         Set Z
+ * @param [in]  xi         Point X
+ * @param [in]  yi         Point Y
+ * @param [in]  zi         Point Z
+ * @param [in]  n          Number of set points
+ * @param [in]  take_sqrt  Positive to output distances, zero to output squared distances
+ * @param [out] out        Output
+ */
+typedef void (*dispatch_row_dist_fn)(const float* bx, const float* by, const float* bz,
+                                     float xi, float yi, float zi, uint32_t n, uint8_t take_sqrt, float* out);
+
+/**
+ * Bitmask of the points of a set within their own radius of a point. The set arrays must be aligned to 64 bytes and
+ * padded to 16 elements, with a negative squared radius in the padding.
+ *
+ * @param [in]  bx    Set X
+ * @param [in]  by    Set Y
+ * @param [in]  bz    Set Z
+ * @param [in]  r2    Squared radius of each set point
+ * @param [in]  n     Number of set points
+ * @param [in]  x     Point X
+ * @param [in]  y     Point Y
+ * @param [in]  z     Point Z
+ * @param [out] mask  Bit j is set if the point is within the radius of set point j. Room for n bits rounded up to 64,
+ *                    all the words are written. It can be NULL if n is zero
+ * @return Number of bits set
+ */
+typedef uint32_t (*dispatch_range_mask_fn)(const float* bx, const float* by, const float* bz, const float* r2,
+                                           uint32_t n, float x, float y, float z, uint64_t* mask);
+
+/**
+ * Number of polygon edges crossed by a ray from a point towards +X (crossing number test). The edge arrays must be
+ * aligned to 64 bytes and padded to 16 elements with degenerate edges (y0 == y1).
+ *
+ * @param [in] x0  Edge start X
+ * @param [in] y0  Edge start Y
+ * @param [in] x1  Edge end X
+ * @param [in] y1  Edge end Y
+ * @param [in] n   Number of edges
+ * @param [in] px  Point X
+ * @param [in] py  Point Y
+ * @return Number of crossed edges. The point is inside the polygon if it is odd
+ */
+typedef uint32_t (*dispatch_crossings_fn)(const float* x0, const float* y0, const float* x1, const float* y1,
+                                          uint32_t n, float px, float py);
+
+/**
+ * Test which of 16 boxes contain a point. The bounds are 6 rows of 16 floats (min X, min Y, min Z, max X, max Y,
+ * max Z), aligned to 64 bytes.
+ *
+ * @param [in] bounds  Bounds of the boxes
+ * @param [in] x       Point X
+ * @param [in] y       Point Y
+ * @param [in] z       Point Z
+ * @return Bitmask of the boxes that contain the point (inclusive bounds)
+ */
+typedef uint32_t (*dispatch_box_mask_fn)(const float* bounds, float x, float y, float z);
+
+/** Kernels of a dispatch level */
+typedef struct {
+
+    /** Level of the kernels */
+    dispatch_level level;
+
+    /** NMEA checksum */
+    dispatch_xor_fn nmea_xor;
+    /** NMEA field scanning */
+    dispatch_scan_fn nmea_scan;
+    /** Distance matrix row */
+    dispatch_row_dist_fn row_dist;
+    /** Target set range mask */
+    dispatch_range_mask_fn range_mask;
+    /** Point-in-polygon crossings */
+    dispatch_crossings_fn crossings;
+    /** R-tree box test */
+    dispatch_box_mask_fn box_mask;
+
+} dispatch_kernels_st;
+
+/**
+ * @brief Detect the CPU features and bind the best kernels, honouring the GPSLOCATOR_CPU environment variable. It is
+ * called when the library is loaded.
+ */
+void dispatch_init(void);
+
+/**
+ * @brief Get the highest level supported by the CPU
+ * @return Supported level
+ */
+dispatch_level dispatch_get_supported(void);
+
+/**
+ * @brief Get the level of the bound kernels
+ * @return Bound level
+ */
+dispatch_level dispatch_get_level(void);
+
+/**
+ * @brief Bind the kernels of a level. It must not be called while other threads use the library.
+ * @param [in] level  Level
+ * @return Zero on success, Otherwise a negative value if the CPU does not support the level
+ */
+int dispatch_set_level(dispatch_level level);
+
+/**
+ * @brief Get the bound kernels
+ * @return Bound kernels
+ */
+const dispatch_kernels_st* dispatch_get_kernels(void);
+
+/**
+ * @brief Get the kernels of a level, without binding them
+ * @param [in] level  Level
+ * @return Kernels of the level, or NULL if the CPU does not support it
+ */
+const dispatch_kernels_st* dispatch_get_variant(dispatch_level level);
+
+/**
+ * @brief Get the name of a level, as used by the GPSLOCATOR_CPU environment variable
+ * @param [in] level  Level
+ * @return Level name
+ */
+const char* dispatch_level_name(dispatch_level level);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* INCLUDE_DISPATCH_H_ */
@@ -0,0 +1,114 @@
+/**
+ * @file distmatrix.h
+ *
+ * Pairwise distance matrix
+ *
+ * Distances between a set of N positions and a set of M positions (or all the pairs of one set). Each position is
+ * converted to ECEF once, and the N x M distances are computed in cache-sized tiles, with SIMD inside each tile and
+ * the tiles distributed between worker threads. The ECEF chord is the same distance given by
+ * position_geodetic_to_enu() plus position_xyz_distance().
+ *
+ * @license
+ * All rights reserved. Read LICENSE.txt file for the license terms.
+ *
+ * Changelog:
+ *
+ * [18/10/2026]     [miguelgarcia]
+ * Initial version
+ *
+ */
+
+#ifndef INCLUDE_DISTMATRIX_H_
+#define INCLUDE_DISTMATRIX_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include "position.h"
+
+/** Rows of a tile */
+#define DISTMATRIX_TILE_ROWS    64
+/** Columns of a tile. 3 x 1024 floats of the column set fit in L1 cache */
+#define DISTMATRIX_TILE_COLS    1024
+
+/** Set of positions in ECEF, stored as structure-of-arrays */
+typedef struct {
+
+    /** ECEF X. Aligned to 64 bytes, padded to 16 elements */
+    float* x;
+    /** ECEF Y */
+    float* y;
+    /** ECEF Z */
+    float* z;
+    /** Number of positions */
+    uint32_t n;
+
+} distmatrix_set_st;
+
+/** Pair of positions within the distance threshold */
+typedef struct {
+
+    /** Index in the row set */
+    uint32_t i;
+    /** Index in the column set */
+    uint32_t j;
+    /** Distance in meters */
+    float dist;
+
+} distmatrix_pair_st;
+
+/**
+ * Callback with a batch of pairs. The calls are serialized, but they come from the worker threads.
+ * @param [in] pairs  Pairs of the batch
+ * @param [in] n      Number of pairs
+ * @param [in] ctx    User context
+ */
+typedef void (*distmatrix_pairs_cb)(const distmatrix_pair_st* pairs, uint32_t n, void* ctx);
+
+/**
+ * @brief Build a set of positions. Every position is converted to ECEF.
+ * @param [out] s       Set
+ * @param [in]  points  Geodetic positions
+ * @param [in]  n       Number of positions
+ * @return Zero on success, Otherwise a negative value
+ */
+int distmatrix_set_init(distmatrix_set_st* s, const position_st* points, uint32_t n);
+
+/**
+ * @brief Release a set of positions
+ * @param [in] s  Set
+ */
+void distmatrix_set_free(distmatrix_set_st* s);
+
+/**
+ * @brief Compute the full distance matrix between two sets
+ * @param [in]  rows     Row set (N positions)
+ * @param [in]  cols     Column set (M positions). It can be the row set
+ * @param [out] dist     N x M distances in meters, row-major
+ * @param [in]  threads  Number of worker threads, zero to use all the processors
+ * @return Zero on success, Otherwise a negative value
+ */
+int distmatrix_compute(const distmatrix_set_st* rows, const distmatrix_set_st* cols, float* dist, uint32_t threads);
+
+/**
+ * @brief Find the pairs of two sets within a distance, without building the matrix. If both sets are the same set,
+ * only the pairs with i < j are reported.
+ *
+ * @param [in] rows      Row set
+ * @param [in] cols      Column set. It can be the row set
+ * @param [in] max_dist  Max distance in meters (inclusive)
+ * @param [in] cb        Callback with batches of pairs
+ * @param [in] ctx       User context passed to the callback
+ * @param [in] threads   Number of worker threads, zero to use all the processors
+ * @return Zero on success, Otherwise a negative value
+ */
+int distmatrix_stream(const distmatrix_set_st* rows, const distmatrix_set_st* cols, float max_dist,
+                      distmatrix_pairs_cb cb, void* ctx, uint32_t threads);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* INCLUDE_DISTMATRIX_H_ */
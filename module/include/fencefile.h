@@ -0,0 +1,260 @@
+/**
+ * @file fencefile.h
+ *
+ * Memory-mapped geofence index file
+ *
+ * On-disk form of a geofence set that is queried in place: the file is mapped read-only and every query reads the
+ * mapped records, so opening it does not parse or build anything and startup only costs the page faults of the pages
+ * a query touches.
+ *
+ * The file is a header, a section table and FENCEFILE_SECTIONS sections, each one aligned to FENCEFILE_ALIGN bytes:
+ *
+ * - circles: a fencefile_circle_st per circular fence, with its ECEF center and squared radius.
+ * - polygons: a fencefile_polygon_st per polygon fence, with its local frame (origin and rotation) and bounds.
+ * - edges: the band edges of every polygon, four arrays (x0, y0, x1, y1) of nedges floats per polygon.
+ * - bands: the first edge and the number of edges of every band, two arrays of nbands per polygon.
+ * - vertices: the projected vertices of every polygon, two arrays (east, north) of nvertices per polygon.
+ * - nodes: the nodes of an R-tree of every fence (see rtree.h), in the layout of rtree_node_st.
+ * - items: the fence of each R-tree box, in leaf order: a circle, or the number of circles plus a polygon.
+ *
+ * Every reference is an offset or an index relative to its section, never a pointer, so the file can be mapped at
+ * any address. The numbers are stored in the byte order of the host that wrote the file, and the header has a marker
+ * to reject files of the other order. The header and the section table have a CRC-32, and so does every section. The
+ * structure (sizes, alignment, section bounds) is always checked on open; the checksums and every reference of the
+ * records are only checked by fencefile_verify(), or on open with FENCEFILE_VERIFY, as they read the whole file.
+ *
+ * @license
+ * All rights reserved. Read LICENSE.txt file for the license terms.
+ *
+ * Changelog:
+ *
+ * [18/10/2026]     [miguelgarcia]
+ * Initial version
+ *
+ * [18/10/2026]     [miguelgarcia]
+ * The set is written without changes
+ *
+ */
+
+#ifndef INCLUDE_FENCEFILE_H_
+#define INCLUDE_FENCEFILE_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stddef.h>
+#include <stdint.h>
+#include "geofence.h"
+#include "rtree.h"
+
+/** Magic number at the start of a file */
+#define FENCEFILE_MAGIC         "GPSFENCE"
+/** Version of the format. Files of another version are rejected */
+#define FENCEFILE_VERSION       1
+/** Byte order marker, as written by the host */
+#define FENCEFILE_ENDIAN        0x01020304u
+/** Alignment of the sections in bytes */
+#define FENCEFILE_ALIGN         64
+
+/** Open flag: check the checksums and every reference of the records (see fencefile_verify()) */
+#define FENCEFILE_VERIFY        0x1u
+
+/** Sections of a file */
+typedef enum {
+
+    fencefile_section_circles = 0,
+    fencefile_section_polygons = 1,
+    fencefile_section_edges = 2,
+    fencefile_section_bands = 3,
+    fencefile_section_vertices = 4,
+    fencefile_section_nodes = 5,
+    fencefile_section_items = 6,
+
+    FENCEFILE_SECTIONS = 7
+
+} fencefile_section;
+
+/** Entry of the section table */
+typedef struct {
+
+    /** Offset from the start of the file in bytes, a multiple of FENCEFILE_ALIGN */
+    uint64_t offset;
+    /** Size in bytes */
+    uint64_t size;
+    /** CRC-32 of the section */
+    uint32_t checksum;
+    /** Reserved, zero */
+    uint32_t reserved[3];
+
+} fencefile_section_st;
+
+/** Header of a file */
+typedef struct {
+
+    /** FENCEFILE_MAGIC, without the null character */
+    char magic[8];
+    /** FENCEFILE_VERSION */
+    uint32_t version;
+    /** FENCEFILE_ENDIAN */
+    uint32_t endian;
+    /** Size of the file in bytes */
+    uint64_t size;
+    /** Number of circular fences */
+    uint32_t ncircles;
+    /** Number of polygon fences */
+    uint32_t npolygons;
+    /** Number of nodes of the R-tree. The root is the last one */
+    uint32_t nnodes;
+    /** Number of leaves of the R-tree, the first nodes */
+    uint32_t nleaves;
+    /** Number of levels of the R-tree */
+    uint32_t depth;
+    /** CRC-32 of the header and the section table, computed with this field set to zero */
+    uint32_t checksum;
+    /** Reserved, zero */
+    uint32_t reserved[4];
+    /** Section table */
+    fencefile_section_st sections[FENCEFILE_SECTIONS];
+
+} fencefile_header_st;
+
+/** Circular fence record */
+typedef struct {
+
+    /** User ID */
+    uint32_t id;
+    /** Center. Latitude and Longitude in decimal degrees, ellipsoidal height in meters */
+    float center[3];
+    /** Center in ECEF (x, y, z) */
+    float ecef[3];
+    /** Radius in meters */
+    float radius;
+    /** Squared radius in square meters */
+    float radius_sq;
+    /** Reserved, zero */
+    uint32_t reserved[3];
+
+} fencefile_circle_st;
+
+/** Polygon fence record (see polyfence_st) */
+typedef struct {
+
+    /** User ID */
+    uint32_t id;
+    /** Number of vertices */
+    uint32_t nvertices;
+    /** Origin of the local frame in ECEF (x, y, z) */
+    float origin[3];
+    /** Rotation from ECEF to the local frame, rows East, North and Up */
+    float rotation[3][3];
+    /** Vertical bounds of the positions inside the fence */
+    float min_up;
+    float max_up;
+    /** Bounding box of the projected polygon (east, north) in meters */
+    float min[2];
+    float max[2];
+    /** Bands per meter of north coordinate */
+    float band_scale;
+    /** Number of bands */
+    uint32_t nbands;
+    /** Size of each edge array */
+    uint32_t nedges;
+    /** Reserved, zero */
+    uint32_t reserved;
+    /** First float of the edge arrays in the edges section */
+    uint64_t edges;
+    /** First element of the band arrays in the bands section */
+    uint64_t bands;
+    /** First float of the vertex arrays in the vertices section */
+    uint64_t vertices;
+
+} fencefile_polygon_st;
+
+/** Opened file */
+typedef struct {
+
+    /** Contents of the file */
+    const uint8_t* data;
+    /** Size of the file in bytes */
+    size_t size;
+    /** Positive value if the contents are mapped by fencefile_open() */
+    uint8_t mapped;
+
+    /** Header, at the start of the contents */
+    const fencefile_header_st* header;
+    /** Records */
+    const fencefile_circle_st* circles;
+    const fencefile_polygon_st* polygons;
+    const float* edges;
+    const uint32_t* bands;
+    const float* vertices;
+    /** R-tree over the mapped nodes and items. It must not be released */
+    rtree_st rtree;
+
+} fencefile_st;
+
+/**
+ * @brief Write a geofence set to a file. The file is written to a temporary path and renamed, so a reader never maps
+ * a partial file. The file has its own R-tree over the fences of the set, with no tombstones, so the set is not
+ * changed whatever its index.
+ *
+ * @param [in] s     Set of fences
+ * @param [in] path  File path
+ * @return Zero on success, Otherwise a negative value
+ */
+int fencefile_write(const geofence_set_st* s, const char* path);
+
+/**
+ * @brief Map a file and check its structure
+ * @param [out] f      Opened file
+ * @param [in]  path   File path
+ * @param [in]  flags  FENCEFILE_VERIFY to check the whole file, or zero
+ * @return Zero on success, Otherwise a negative value
+ */
+int fencefile_open(fencefile_st* f, const char* path, uint32_t flags);
+
+/**
+ * @brief Use the contents of a file already in memory, and check their structure. The contents must be aligned to
+ * FENCEFILE_ALIGN bytes and stay valid until the file is closed.
+ *
+ * @param [out] f      Opened file
+ * @param [in]  data   Contents of the file
+ * @param [in]  size   Size of the contents in bytes
+ * @param [in]  flags  FENCEFILE_VERIFY to check the whole file, or zero
+ * @return Zero on success, Otherwise a negative value
+ */
+int fencefile_open_memory(fencefile_st* f, const void* data, size_t size, uint32_t flags);
+
+/**
+ * @brief Close a file, and unmap it if it was mapped
+ * @param [in] f  Opened file
+ */
+void fencefile_close(fencefile_st* f);
+
+/**
+ * @brief Check the checksums of a file, and that every reference of its records is in bounds, so a query cannot read
+ * out of the file. Files from an untrusted source must be verified before they are queried.
+ *
+ * @param [in] f  Opened file
+ * @return Zero if the file is valid, Otherwise a negative value
+ */
+int fencefile_verify(const fencefile_st* f);
+
+/**
+ * @brief Find the fences of a file that contain an ECEF position
+ * @param [in]  f    Opened file
+ * @param [in]  x    ECEF X
+ * @param [in]  y    ECEF Y
+ * @param [in]  z    ECEF Z
+ * @param [out] ids  IDs of the fences that contain the position
+ * @param [in]  max  Size of the IDs buffer
+ * @return Number of fences that contain the position. If it is larger than max, only max IDs are written
+ */
+uint32_t fencefile_evaluate(const fencefile_st* f, float x, float y, float z, uint32_t* ids, uint32_t max);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* INCLUDE_FENCEFILE_H_ */
@@ -0,0 +1,113 @@
+/**
+ * @file fixmemo.h
+ *
+ * Stationary device memo
+ *
+ * Memo of the last evaluated position of a device and the fences that contain it. A parked device reports the same
+ * position, or almost the same, for hours: while a new position is within a distance (epsilon) of the memo position,
+ * and the set of fences is the same one with the same version, the fences of the memo are reused without converting
+ * the position or testing any fence. The distance is an upper bound computed from the differences of latitude,
+ * longitude and height, so it is a handful of operations. An epsilon of zero only reuses identical positions.
+ *
+ * A fence boundary within epsilon of the memo position is not detected until the device moves farther than epsilon,
+ * so epsilon must be kept below the position noise that is acceptable on the fence boundaries. The memo counts its
+ * hits and misses to tune it.
+ *
+ * @license
+ * All rights reserved. Read LICENSE.txt file for the license terms.
+ *
+ * Changelog:
+ *
+ * [18/10/2026]     [miguelgarcia]
+ * Initial version
+ *
+ */
+
+#ifndef INCLUDE_FIXMEMO_H_
+#define INCLUDE_FIXMEMO_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include "position.h"
+
+/** Max number of fence IDs of a memo. A position in more fences is not kept */
+#define FIXMEMO_MAX_IDS     64
+
+/** Memo of a device */
+typedef struct {
+
+    /** Max distance to the memo position in meters */
+    float epsilon;
+
+    /** Positive value if there is a memo position */
+    uint8_t valid;
+    /** Memo position. Ellipsoidal height */
+    position_st llh;
+    /** Cosine of the latitude of the memo position */
+    float cos_lat;
+    /** Set of fences of the memo */
+    const void* set;
+    /** Version of the set of fences of the memo */
+    uint64_t version;
+
+    /** Fences that contain the memo position */
+    uint32_t ids[FIXMEMO_MAX_IDS];
+    /** Number of fences that contain the memo position */
+    uint32_t n;
+
+    /** Number of positions that reused the memo */
+    uint32_t hits;
+    /** Number of positions that did not reuse the memo */
+    uint32_t misses;
+
+} fixmemo_st;
+
+/**
+ * @brief Initialize an empty memo
+ * @param [out] m        Memo
+ * @param [in]  epsilon  Max distance to the memo position in meters
+ */
+void fixmemo_init(fixmemo_st* m, float epsilon);
+
+/**
+ * @brief Forget the memo position, so the next position is evaluated. The hits and misses are kept
+ * @param [in] m  Memo
+ */
+void fixmemo_reset(fixmemo_st* m);
+
+/**
+ * @brief Get the fences of a position from the memo, if the position is within epsilon of the memo position and the
+ * set of fences did not change.
+ *
+ * @param [in]  m        Memo
+ * @param [in]  set      Set of fences
+ * @param [in]  version  Version of the set of fences
+ * @param [in]  llh      Position. Latitude and Longitude in decimal degrees, ellipsoidal height in meters
+ * @param [out] ids      IDs of the fences that contain the position
+ * @param [in]  max      Size of the IDs buffer
+ * @param [out] n        Number of fences that contain the position. If it is larger than max, only max IDs are written
+ * @return Positive value if the memo is reused, Otherwise Zero and the position must be evaluated.
+ */
+uint8_t fixmemo_lookup(fixmemo_st* m, const void* set, uint64_t version, const position_st* llh, uint32_t* ids,
+                       uint32_t max, uint32_t* n);
+
+/**
+ * @brief Keep an evaluated position as the memo position
+ * @param [in] m        Memo
+ * @param [in] set      Set of fences
+ * @param [in] version  Version of the set of fences
+ * @param [in] llh      Position. Latitude and Longitude in decimal degrees, ellipsoidal height in meters
+ * @param [in] ids      IDs of the fences that contain the position
+ * @param [in] n        Number of fences that contain the position
+ */
+void fixmemo_store(fixmemo_st* m, const void* set, uint64_t version, const position_st* llh, const uint32_t* ids,
+                   uint32_t n);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* INCLUDE_FIXMEMO_H_ */
@@ -0,0 +1,224 @@
+/**
+ * @file fleet.h
+ *
+ * Fleet engine
+ *
+ * Tracks the NMEA streams of many GPS modules in one process. Each device has its own state (NMEA parser context, last
+ * position and the fences that contain it), identified by a user device ID. The devices are split in shards by a hash
+ * of their ID, and each shard is owned by one worker thread of a fixed pool: the worker is the only thread that parses
+ * and evaluates the devices of its shard, and every queue and lock belongs to a shard, so the shards never contend
+ * with each other.
+ *
+ * Any thread submits the bytes received from a device with fleet_submit(). The bytes are appended to the queue of the
+ * shard of the device, and the worker takes the whole queue at once and feeds the bytes to the parsers, in the order
+ * they were submitted, so the bytes of a device are always parsed in order. A submitter waits while the queue of the
+ * shard is full. Every new valid position is checked against the current snapshot of a target set (see targetset.h),
+ * that can be replaced while the workers run.
+ *
+ * The ellipsoidal height of a position is the MSL altitude plus the geoidal separation reported by the GPS module. If
+ * the module does not report it, the separation is taken from the geoid grid of the engine (see fleet_set_geoid()),
+ * with a cache of the last grid cell of each device, or the MSL altitude is kept if there is no grid.
+ *
+ * @license
+ * All rights reserved. Read LICENSE.txt file for the license terms.
+ *
+ * Changelog:
+ *
+ * [18/10/2026]     [miguelgarcia]
+ * Initial version
+ *
+ * [18/10/2026]     [miguelgarcia]
+ * Device registry
+ *
+ * [18/10/2026]     [miguelgarcia]
+ * Geoid grid for the devices without a reported geoidal separation
+ *
+ */
+
+#ifndef INCLUDE_FLEET_H_
+#define INCLUDE_FLEET_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <pthread.h>
+#include <stdint.h>
+#include "geoid.h"
+#include "navigation.h"
+#include "position.h"
+#include "registry.h"
+#include "targetset.h"
+
+/** Max number of worker threads */
+#define FLEET_MAX_WORKERS   32
+/** Max number of fence IDs kept for a device */
+#define FLEET_MAX_FENCES    16
+/** Size of the queue of a shard in bytes. A submitter waits while the queue is full */
+#define FLEET_QUEUE_BYTES   (1 << 18)
+
+/** State of a device, as seen by the user */
+typedef struct {
+
+    /** Last position, invalid if the device has no fix. Ellipsoidal height */
+    position_st llh;
+    /** Fences that contain the last position */
+    uint32_t fences[FLEET_MAX_FENCES];
+    /** Number of fences that contain the last position. If it is larger than FLEET_MAX_FENCES, only
+     * FLEET_MAX_FENCES IDs are kept */
+    uint32_t nfences;
+    /** Number of GGA sentences parsed */
+    uint32_t positions;
+
+} fleet_status_st;
+
+/** Device of a shard */
+typedef struct {
+
+    /** User device ID */
+    uint32_t id;
+    /** NMEA parser context */
+    navigation_st nav;
+    /** Last position and fences */
+    fleet_status_st status;
+    /** Last geoid grid cell used by the device */
+    geoid_cache_st geoid_cache;
+
+} fleet_device_st;
+
+/**
+ * Callback with each new position of a device. It is called from the worker thread of the device, and it must not
+ * call the functions of the fleet engine.
+ * @param [in] device  User device ID
+ * @param [in] status  State of the device with the new position
+ * @param [in] ctx     User context
+ */
+typedef void (*fleet_position_cb)(uint32_t device, const fleet_status_st* status, void* ctx);
+
+struct fleet;
+
+/** Shard of the devices, owned by a worker thread */
+typedef struct {
+
+    /** Fleet engine */
+    struct fleet* fleet;
+    /** Worker thread */
+    pthread_t thread;
+    /** Reader of the target set */
+    int reader;
+
+    /** Lock of the queue */
+    pthread_mutex_t lock;
+    /** Signaled when the queue has data or the worker must stop */
+    pthread_cond_t ready;
+    /** Signaled when the worker takes the queue or finishes it */
+    pthread_cond_t done;
+    /** Queue of submissions: device ID, length and bytes of each one */
+    char* queue;
+    /** Bytes in the queue */
+    uint32_t queued;
+    /** Positive value while the worker parses the submissions it took */
+    uint8_t busy;
+    /** Positive value if the worker must stop when the queue is empty */
+    uint8_t stop;
+    /** Submissions being parsed by the worker */
+    char* work;
+
+    /** Lock of the devices array and of the state updates. Taken by the worker when it adds a device or updates its
+     * state, and by fleet_get_status() and fleet_count(). The lookups of the registry take no lock */
+    pthread_mutex_t devices_lock;
+    /** Devices of the shard, by registry index */
+    fleet_device_st* devices;
+    /** Number of devices */
+    uint32_t ndevices;
+    /** Allocated devices */
+    uint32_t capacity;
+    /** Registry of the device indexes by ID */
+    registry_st registry;
+
+} fleet_shard_st;
+
+/** Fleet engine */
+typedef struct fleet {
+
+    /** Target set checked on every new position, NULL for none */
+    targetset_st* targets;
+    /** Callback with each new position, NULL for none */
+    fleet_position_cb cb;
+    /** User context of the callback */
+    void* ctx;
+    /** Geoid grid for the devices that do not report the geoidal separation, NULL for none */
+    const geoid_st* geoid;
+
+    /** Shards, one per worker */
+    fleet_shard_st shards[FLEET_MAX_WORKERS];
+    /** Number of workers */
+    uint32_t workers;
+
+} fleet_st;
+
+/**
+ * @brief Initialize a fleet engine without devices and start its workers
+ * @param [out] f        Fleet engine
+ * @param [in]  workers  Number of worker threads, zero to use parallel_default_threads(). FLEET_MAX_WORKERS at most
+ * @param [in]  targets  Target set checked on every new position, or NULL
+ * @param [in]  cb       Callback with each new position, or NULL
+ * @param [in]  ctx      User context passed to the callback
+ * @return Zero on success, Otherwise a negative value
+ */
+int fleet_init(fleet_st* f, uint32_t workers, targetset_st* targets, fleet_position_cb cb, void* ctx);
+
+/**
+ * @brief Parse the submitted bytes, stop the workers and release the fleet engine
+ * @param [in] f  Fleet engine
+ */
+void fleet_free(fleet_st* f);
+
+/**
+ * @brief Set the geoid grid used to get the ellipsoidal height of the devices whose GPS module does not report the
+ * geoidal separation. It must be called before the first submission.
+ *
+ * @param [in] f      Fleet engine
+ * @param [in] geoid  Geoid grid, or NULL to use the MSL altitude as ellipsoidal height. It must outlive the engine
+ */
+void fleet_set_geoid(fleet_st* f, const geoid_st* geoid);
+
+/**
+ * @brief Submit bytes received from a device. It can be called from any thread. The device is added to the engine
+ * with its first submission.
+ *
+ * @param [in] f       Fleet engine
+ * @param [in] device  User device ID
+ * @param [in] data    NMEA bytes
+ * @param [in] len     Number of bytes
+ * @return Zero on success, Otherwise a negative value
+ */
+int fleet_submit(fleet_st* f, uint32_t device, const char* data, uint32_t len);
+
+/**
+ * @brief Wait until every byte submitted before the call is parsed
+ * @param [in] f  Fleet engine
+ */
+void fleet_flush(fleet_st* f);
+
+/**
+ * @brief Get the state of a device
+ * @param [in]  f       Fleet engine
+ * @param [in]  device  User device ID
+ * @param [out] status  State of the device
+ * @return Zero on success, Otherwise a negative value if the device has no parsed submissions
+ */
+int fleet_get_status(fleet_st* f, uint32_t device, fleet_status_st* status);
+
+/**
+ * @brief Return the number of devices with parsed submissions
+ * @param [in] f  Fleet engine
+ * @return Number of devices
+ */
+uint32_t fleet_count(fleet_st* f);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* INCLUDE_FLEET_H_ */
@@ -0,0 +1,375 @@
+/**
+ * @file geodesy.hpp
+ *
+ * Header-only geodesy kernels parameterised on the scalar type and on the reference ellipsoid
+ *
+ * This is the C++ template counterpart of position.c. The same conversions are provided for any scalar type (float
+ * on the device, double or long double on servers) and any reference ellipsoid (WGS-84, GRS-80, PZ-90). All the
+ * ellipsoid derived constants are constexpr, so they are folded at compile time.
+ *
+ * A custom scalar type (e.g. fixed-point) can be used by providing sqrt(), sin(), cos(), cbrt() and atan2() overloads
+ * reachable by argument dependent lookup, or by specialising geodesy::scalar_traits.
+ *
+ * @license
+ * All rights reserved. Read LICENSE.txt file for the license terms.
+ *
+ * Changelog:
+ *
+ * [18/10/2026]     [miguelgarcia]
+ * Initial version
+ *
+ */
+
+#ifndef INCLUDE_GEODESY_HPP_
+#define INCLUDE_GEODESY_HPP_
+
+#include <cmath>
+#include <cstddef>
+
+namespace geodesy {
+
+/* -- Reference ellipsoids -- */
+
+/** WGS-84 ellipsoid (GPS) */
+struct wgs84 {
+    static constexpr double semimajor_axis() { return 6378137.0; }
+    static constexpr double inverse_flattening() { return 298.257223563; }
+};
+
+/** GRS-80 ellipsoid (ETRS89, NAD83) */
+struct grs80 {
+    static constexpr double semimajor_axis() { return 6378137.0; }
+    static constexpr double inverse_flattening() { return 298.257222101; }
+};
+
+/** PZ-90.11 ellipsoid (GLONASS) */
+struct pz90 {
+    static constexpr double semimajor_axis() { return 6378136.0; }
+    static constexpr double inverse_flattening() { return 298.25784; }
+};
+
+/**
+ * Constants derived from a reference ellipsoid E. E must provide semimajor_axis() and inverse_flattening().
+ */
+template <typename E>
+struct ellipsoid {
+    /** Semimajor axis (m) */
+    static constexpr double a() { return E::semimajor_axis(); }
+    /** Flattening */
+    static constexpr double f() { return 1.0 / E::inverse_flattening(); }
+    /** Semiminor axis (m) */
+    static constexpr double b() { return a() * (1.0 - f()); }
+    /** Square of the first eccentricity */
+    static constexpr double e2() { return f() * (2.0 - f()); }
+    /** Square of the second eccentricity */
+    static constexpr double ep2() { return e2() / (1.0 - e2()); }
+};
+
+/* -- Scalar traits -- */
+
+/**
+ * Math operations used by the kernels. The default implementation uses the std overloads or the ones found by
+ * argument dependent lookup for user types.
+ */
+template <typename T>
+struct scalar_traits {
+    static constexpr T from_double(double v) { return static_cast<T>(v); }
+    static T sqrt(T v) { using std::sqrt; return sqrt(v); }
+    static T sin(T v) { using std::sin; return sin(v); }
+    static T cos(T v) { using std::cos; return cos(v); }
+    static T cbrt(T v) { using std::cbrt; return cbrt(v); }
+    static T atan2(T y, T x) { using std::atan2; return atan2(y, x); }
+};
+
+/**
+ * @brief  Decimal degrees to radians converter
+ * @param degrees  Decimal degrees
+ * @return  Equivalent in radians
+ */
+template <typename T>
+inline T degrees_to_radians(T degrees)
+{
+    constexpr T k = scalar_traits<T>::from_double(3.14159265358979323846 / 180.0);
+    return k * degrees;
+}
+
+/**
+ * @brief  Radians to decimal degrees converter
+ * @param radians  Radians
+ * @return  Equivalent in decimal degrees
+ */
+template <typename T>
+inline T radians_to_degrees(T radians)
+{
+    constexpr T k = scalar_traits<T>::from_double(180.0 / 3.14159265358979323846);
+    return k * radians;
+}
+
+/**
+ * @brief Converts a Geodetic point (lat, lon, h) to the Earth-Centered Earth-Fixed (ECEF) coordinates (x, y, z).
+ * @param [in]  lat  Latitude in decimal degrees
+ * @param [in]  lon  Longitude in decimal degrees
+ * @param [in]  h    Ellipsoidal height
+ * @param [out] x    ECEF X
+ * @param [out] y    ECEF Y
+ * @param [out] z    ECEF Z
+ */
+template <typename T, typename E = wgs84>
+inline void geodetic_to_ecef(T lat, T lon, T h, T& x, T& y, T& z)
+{
+    typedef scalar_traits<T> st;
+    constexpr T a = st::from_double(ellipsoid<E>::a());
+    constexpr T e2 = st::from_double(ellipsoid<E>::e2());
+    constexpr T one_minus_e2 = st::from_double(1.0 - ellipsoid<E>::e2());
+    constexpr T one = st::from_double(1.0);
+
+    T lambda = degrees_to_radians(lat);
+    T phi = degrees_to_radians(lon);
+    T sin_lambda = st::sin(lambda);
+    T cos_lambda = st::cos(lambda);
+    T sin_phi = st::sin(phi);
+    T cos_phi = st::cos(phi);
+    T N = a / st::sqrt(one - e2 * sin_lambda * sin_lambda);
+
+    x = (h + N) * cos_lambda * cos_phi;
+    y = (h + N) * cos_lambda * sin_phi;
+    z = (h + one_minus_e2 * N) * sin_lambda;
+}
+
+/**
+ * Local Tangent Plane centered at a Geodetic point. The origin in ECEF and the rotation terms are computed once, so
+ * many points can be projected to the same plane without repeating the trigonometry.
+ */
+template <typename T, typename E = wgs84>
+struct enu_frame {
+
+    /** Origin in ECEF */
+    T x0, y0, z0;
+    /** Rotation terms of the origin */
+    T sin_lat, cos_lat, sin_lon, cos_lon;
+
+    /**
+     * @brief Build the frame centered at the Geodetic point (lat0, lon0, h0)
+     * @param [in]  lat0    Geodetic initial latitude
+     * @param [in]  lon0    Geodetic initial longitude
+     * @param [in]  h0      Geodetic initial altitude
+     * @return The local frame
+     */
+    static enu_frame from_geodetic(T lat0, T lon0, T h0)
+    {
+        typedef scalar_traits<T> st;
+        enu_frame f;
+        T lambda = degrees_to_radians(lat0);
+        T phi = degrees_to_radians(lon0);
+        f.sin_lat = st::sin(lambda);
+        f.cos_lat = st::cos(lambda);
+        f.sin_lon = st::sin(phi);
+        f.cos_lon = st::cos(phi);
+        geodetic_to_ecef<T, E>(lat0, lon0, h0, f.x0, f.y0, f.z0);
+        return f;
+    }
+
+    /**
+     * @brief Converts ECEF coordinates (x, y, z) to East-North-Up coordinates in this frame
+     * @param [in]  x       ECEF X
+     * @param [in]  y       ECEF Y
+     * @param [in]  z       ECEF Z
+     * @param [out] xEast   ENU East coordinate
+     * @param [out] yNorth  ENU North coordinate
+     * @param [out] zUp     ENU UP coordinate
+     */
+    void ecef_to_enu(T x, T y, T z, T& xEast, T& yNorth, T& zUp) const
+    {
+        T xd = x - x0;
+        T yd = y - y0;
+        T zd = z - z0;
+
+        xEast = -sin_lon * xd + cos_lon * yd;
+        yNorth = -cos_lon * sin_lat * xd - sin_lat * sin_lon * yd + cos_lat * zd;
+        zUp = cos_lat * cos_lon * xd + cos_lat * sin_lon * yd + sin_lat * zd;
+    }
+
+    /**
+     * @brief Converts East-North-Up coordinates in this frame to ECEF coordinates (x, y, z)
+     * @param [in]  xEast   ENU East coordinate
+     * @param [in]  yNorth  ENU North coordinate
+     * @param [in]  zUp     ENU UP coordinate
+     * @param [out] x       ECEF X
+     * @param [out] y       ECEF Y
+     * @param [out] z       ECEF Z
+     */
+    void enu_to_ecef(T xEast, T yNorth, T zUp, T& x, T& y, T& z) const
+    {
+        /* The rotation is orthonormal, so its inverse is the transpose */
+        x = x0 - sin_lon * xEast - cos_lon * sin_lat * yNorth + cos_lat * cos_lon * zUp;
+        y = y0 + cos_lon * xEast - sin_lat * sin_lon * yNorth + cos_lat * sin_lon * zUp;
+        z = z0 + cos_lat * yNorth + sin_lat * zUp;
+    }
+};
+
+/**
+ * @brief Converts the ECEF coordinates (x, y, z) to East-North-Up coordinates in a Local Tangent Plane that is
+ * centered at the Geodetic point (lat0, lon0, h0).
+ *
+ * @param [in]  x       ECEF X
+ * @param [in]  y       ECEF Y
+ * @param [in]  z       ECEF Z
+ * @param [in]  lat0    Geodetic initial latitude
+ * @param [in]  lon0    Geodetic initial longitude
+ * @param [in]  h0      Geodetic initial altitude
+ * @param [out] xEast   ENU East coordinate
+ * @param [out] yNorth  ENU North coordinate
+ * @param [out] zUp     ENU UP coordinate
+ */
+template <typename T, typename E = wgs84>
+inline void ecef_to_enu(T x, T y, T z, T lat0, T lon0, T h0, T& xEast, T& yNorth, T& zUp)
+{
+    enu_frame<T, E>::from_geodetic(lat0, lon0, h0).ecef_to_enu(x, y, z, xEast, yNorth, zUp);
+}
+
+/**
+ * @brief Converts the Geodetic coordinates (lat, lon, h) to East-North-Up coordinates in a Local Tangent Plane
+ * that is centered at the Geodetic point (lat0, lon0, h0).
+ *
+ * @param [in]  lat     Latitude in decimal degrees
+ * @param [in]  lon     Longitude in decimal degrees
+ * @param [in]  h       Geodetic Altitude
+ * @param [in]  lat0    Geodetic initial latitude
+ * @param [in]  lon0    Geodetic initial longitude
+ * @param [in]  h0      Geodetic initial altitude
+ * @param [out] xEast   ENU East coordinate
+ * @param [out] yNorth  ENU North coordinate
+ * @param [out] zUp     ENU UP coordinate
+ */
+template <typename T, typename E = wgs84>
+inline void geodetic_to_enu(T lat, T lon, T h, T lat0, T lon0, T h0, T& xEast, T& yNorth, T& zUp)
+{
+    T x, y, z;
+    geodetic_to_ecef<T, E>(lat, lon, h, x, y, z);
+    ecef_to_enu<T, E>(x, y, z, lat0, lon0, h0, xEast, yNorth, zUp);
+}
+
+/**
+ * @brief Converts the ECEF coordinates (x, y, z) to a Geodetic point (lat, lon, h).
+ *
+ * Closed-form solution of H. Vermeille, "An analytical method to transform geocentric into geodetic coordinates",
+ * J. Geodesy (2011). It is exact (no iterations) for every point outside the evolute of the ellipsoid, i.e. for every
+ * point farther than ~43 km from the Earth center.
+ *
+ * @param [in]  x    ECEF X
+ * @param [in]  y    ECEF Y
+ * @param [in]  z    ECEF Z
+ * @param [out] lat  Latitude in decimal degrees
+ * @param [out] lon  Longitude in decimal degrees
+ * @param [out] h    Ellipsoidal height
+ */
+template <typename T, typename E = wgs84>
+inline void ecef_to_geodetic(T x, T y, T z, T& lat, T& lon, T& h)
+{
+    typedef scalar_traits<T> st;
+    constexpr T inv_a2 = st::from_double(1.0 / (ellipsoid<E>::a() * ellipsoid<E>::a()));
+    constexpr T e2 = st::from_double(ellipsoid<E>::e2());
+    constexpr T e4 = st::from_double(ellipsoid<E>::e2() * ellipsoid<E>::e2());
+    constexpr T one_minus_e2 = st::from_double(1.0 - ellipsoid<E>::e2());
+    constexpr T zero = st::from_double(0.0);
+    constexpr T one = st::from_double(1.0);
+    constexpr T two = st::from_double(2.0);
+    constexpr T four = st::from_double(4.0);
+    constexpr T sixth = st::from_double(1.0 / 6.0);
+
+    T w2 = x * x + y * y;
+    T w = st::sqrt(w2);
+    T z2 = z * z;
+
+    T p = w2 * inv_a2;
+    T q = one_minus_e2 * z2 * inv_a2;
+    T r = (p + q - e4) * sixth;
+    T s = e4 * p * q / (four * r * r * r);
+    T t = st::cbrt(one + s + st::sqrt(s * (two + s)));
+    T u = r * (one + t + one / t);
+    T v = st::sqrt(u * u + e4 * q);
+    T uv = u + v;
+    T wk = e2 * (uv - q) / (two * v);
+    T k = st::sqrt(uv + wk * wk) - wk;
+    T D = k * w / (k + e2);
+    T Dz = st::sqrt(D * D + z2);
+
+    lat = radians_to_degrees(two * st::atan2(z, D + Dz));
+    lon = (w2 > zero) ? radians_to_degrees(st::atan2(y, x)) : zero;
+    h = (k + e2 - one) / k * Dz;
+}
+
+/**
+ * @brief Converts the East-North-Up coordinates of a Local Tangent Plane centered at the Geodetic point
+ * (lat0, lon0, h0) to a Geodetic point (lat, lon, h).
+ *
+ * @param [in]  xEast   ENU East coordinate
+ * @param [in]  yNorth  ENU North coordinate
+ * @param [in]  zUp     ENU UP coordinate
+ * @param [in]  lat0    Geodetic initial latitude
+ * @param [in]  lon0    Geodetic initial longitude
+ * @param [in]  h0      Geodetic initial altitude
+ * @param [out] lat     Latitude in decimal degrees
+ * @param [out] lon     Longitude in decimal degrees
+ * @param [out] h       Ellipsoidal height
+ */
+template <typename T, typename E = wgs84>
+inline void enu_to_geodetic(T xEast, T yNorth, T zUp, T lat0, T lon0, T h0, T& lat, T& lon, T& h)
+{
+    T x, y, z;
+    enu_frame<T, E>::from_geodetic(lat0, lon0, h0).enu_to_ecef(xEast, yNorth, zUp, x, y, z);
+    ecef_to_geodetic<T, E>(x, y, z, lat, lon, h);
+}
+
+/**
+ * @brief  Calculate the distance between two 3D-points
+ * @return  The distance between the two coordinates in meters
+ */
+template <typename T>
+inline T xyz_distance(T x0, T y0, T z0, T x1, T y1, T z1)
+{
+    T dx = (x1 - x0);
+    T dy = (y1 - y0);
+    T dz = (z1 - z0);
+    return scalar_traits<T>::sqrt((dx * dx) + (dy * dy) + (dz * dz));
+}
+
+/**
+ * @brief Converts n Geodetic points to ECEF. Input and output arrays are structure-of-arrays.
+ * @param [in]  lat  Latitudes in decimal degrees
+ * @param [in]  lon  Longitudes in decimal degrees
+ * @param [in]  h    Ellipsoidal heights
+ * @param [out] x    ECEF X
+ * @param [out] y    ECEF Y
+ * @param [out] z    ECEF Z
+ * @param [in]  n    Number of points
+ */
+template <typename T, typename E = wgs84>
+inline void geodetic_to_ecef(const T* lat, const T* lon, const T* h, T* x, T* y, T* z, std::size_t n)
+{
+    for (std::size_t i = 0; i < n; i++) {
+        geodetic_to_ecef<T, E>(lat[i], lon[i], h[i], x[i], y[i], z[i]);
+    }
+}
+
+/**
+ * @brief Converts n ECEF points to Geodetic. Input and output arrays are structure-of-arrays.
+ * @param [in]  x    ECEF X
+ * @param [in]  y    ECEF Y
+ * @param [in]  z    ECEF Z
+ * @param [out] lat  Latitudes in decimal degrees
+ * @param [out] lon  Longitudes in decimal degrees
+ * @param [out] h    Ellipsoidal heights
+ * @param [in]  n    Number of points
+ */
+template <typename T, typename E = wgs84>
+inline void ecef_to_geodetic(const T* x, const T* y, const T* z, T* lat, T* lon, T* h, std::size_t n)
+{
+    for (std::size_t i = 0; i < n; i++) {
+        ecef_to_geodetic<T, E>(x[i], y[i], z[i], lat[i], lon[i], h[i]);
+    }
+}
+
+} /* namespace geodesy */
+
+#endif /* INCLUDE_GEODESY_HPP_ */
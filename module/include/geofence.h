@@ -0,0 +1,368 @@
+/**
+ * @file geofence.h
+ *
+ * Geofence set
+ *
+ * Set of circular fences (a center and a radius) and polygon fences, each one with a user ID. The evaluation of a
+ * device position returns the IDs of all the fences that contain it.
+ *
+ * The fences are indexed in a multi-resolution grid of ECEF cubes. The cells of level k are cubes of
+ * GEOFENCE_GRID_MIN_CELL * 2^k meters, and each fence is registered in the cells its padded bounding box overlaps at
+ * the finest level with cells at least as wide as that box (up to 8 cells). A device position is in a single cell of
+ * each level, so an evaluation probes one cell per level with fences, and only the fences of those cells go through
+ * the exact distance test.
+ *
+ * The polygon fences are indexed in an R-tree of their ECEF bounding boxes (see rtree.h). The circular fences can be
+ * indexed in the same R-tree instead of the grid (geofence_index_rtree), which takes less memory when the fences are
+ * sparse or their sizes vary a lot. The boxes returned by the R-tree are the candidates of the exact test.
+ *
+ * Small sets of circular fences (up to a few thousand) can skip the indexes and be scanned with the SIMD range kernel
+ * instead (geofence_index_scan, see rangeset.h), which has the same cost for any position.
+ *
+ * Fences can be added, removed and resized after the indexes are built, without building them again. A fence keeps
+ * its slot in the set until the next build: a removed fence is left as a tombstone that never matches, and the grid
+ * cells have room to grow, so a circular fence is inserted in (or removed from) the few cells it overlaps. The fences
+ * added to the R-tree and the scan indexes, and every polygon fence added, are checked one by one until the next build.
+ * When the tombstones and the fences checked one by one are more than GEOFENCE_DELTA_MIN plus 1/GEOFENCE_DELTA_RATIO
+ * of the set, the set is marked to be built again (compacted): the tombstones are dropped and the indexes are built
+ * from scratch by the next geofence_build() or evaluation. The writer can call geofence_build() itself after the edits,
+ * so an evaluation does not pay for it. The removals and resizes find the fences with a hash table of IDs, built on the
+ * first one after each build.
+ *
+ * @license
+ * All rights reserved. Read LICENSE.txt file for the license terms.
+ *
+ * Changelog:
+ *
+ * [18/10/2026]     [miguelgarcia]
+ * Initial version
+ *
+ * [18/10/2026]     [miguelgarcia]
+ * Multi-resolution grid index
+ *
+ * [18/10/2026]     [miguelgarcia]
+ * Polygon fences and R-tree index
+ *
+ * [18/10/2026]     [miguelgarcia]
+ * Brute-force scan of the circular fences
+ *
+ * [18/10/2026]     [miguelgarcia]
+ * Distance to the nearest fence boundary
+ *
+ * [18/10/2026]     [miguelgarcia]
+ * Incremental edits
+ *
+ * [18/10/2026]     [miguelgarcia]
+ * Grid level of the padded fence box
+ *
+ * [18/10/2026]     [miguelgarcia]
+ * Box padding shared with the fence files
+ *
+ */
+
+#ifndef INCLUDE_GEOFENCE_H_
+#define INCLUDE_GEOFENCE_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include "polyfence.h"
+#include "position.h"
+#include "rangeset.h"
+#include "rtree.h"
+#include "target.h"
+
+/** Number of levels of the grid index */
+#define GEOFENCE_GRID_LEVELS    18
+/** Cell size of the finest level of the grid index in meters. Each level doubles the cell size */
+#define GEOFENCE_GRID_MIN_CELL  64.0f
+/** Padding of the fence boxes in meters, so the rounding of the exact test cannot accept a position out of the index */
+#define GEOFENCE_BOX_PAD        1.0f
+
+/** Max number of cells searched per axis, on each side of the cell of a position, by geofence_margin() */
+#define GEOFENCE_MARGIN_RINGS   2
+
+/** Min number of tombstones and fences out of the indexes that mark the set to be built again */
+#define GEOFENCE_DELTA_MIN      64
+/** Max fraction of tombstones and fences out of the indexes, one in GEOFENCE_DELTA_RATIO, over GEOFENCE_DELTA_MIN */
+#define GEOFENCE_DELTA_RATIO    16
+
+/** Slot of a polygon fence in the hash table of IDs */
+#define GEOFENCE_REF_POLYGON    0x80000000u
+/** Empty entry of the hash table of IDs */
+#define GEOFENCE_REF_EMPTY      0xFFFFFFFFu
+
+/** Index of the circular fences */
+typedef enum {
+
+    /** Multi-resolution grid */
+    geofence_index_grid = 0,
+    /** R-tree, shared with the polygon fences */
+    geofence_index_rtree = 1,
+    /** No index, every fence is tested with the SIMD range kernel */
+    geofence_index_scan = 2
+
+} geofence_index;
+
+/** Edit of a set (see geofence_apply()) */
+typedef enum {
+
+    /** Add a circular fence */
+    geofence_op_add = 0,
+    /** Add a polygon fence */
+    geofence_op_add_polygon = 1,
+    /** Remove a fence */
+    geofence_op_remove = 2,
+    /** Change the radius of a circular fence */
+    geofence_op_radius = 3
+
+} geofence_op;
+
+/** Fence */
+typedef struct {
+
+    /** User ID */
+    uint32_t id;
+    /** Center. Latitude and Longitude in decimal degrees, ellipsoidal height in meters */
+    position_st center;
+    /** Center in ECEF (x, y, z) */
+    float ecef[3];
+    /** Radius in meters */
+    float radius;
+    /** Squared radius in square meters */
+    float radius_sq;
+
+} geofence_st;
+
+/** Cell of the grid index */
+typedef struct {
+
+    /** Level and cell coordinates, zero if the hash slot is empty */
+    uint64_t key;
+    /** First fence of the cell in the items of the grid */
+    uint32_t start;
+    /** Number of fences of the cell */
+    uint32_t count;
+    /** Items reserved for the cell */
+    uint32_t capacity;
+    /** Reserved, zero */
+    uint32_t reserved;
+
+} geofence_cell_st;
+
+/** Multi-resolution grid index */
+typedef struct {
+
+    /** Hash table of the cells with fences (open addressing) */
+    geofence_cell_st* cells;
+    /** Size of the hash table minus one, the size is a power of two */
+    uint32_t mask;
+    /** Number of cells of the hash table */
+    uint32_t ncells;
+    /** Fence indexes of the cells */
+    uint32_t* items;
+    /** Items used by the cells, or left behind by the cells that grew */
+    uint32_t nitems;
+    /** Allocated items */
+    uint32_t item_capacity;
+    /** Items left behind by the cells that grew */
+    uint32_t garbage;
+    /** Bitmask of the levels with fences */
+    uint32_t levels;
+
+} geofence_grid_st;
+
+/** Entry of the hash table of IDs */
+typedef struct {
+
+    /** User ID */
+    uint32_t id;
+    /** Slot of the fence: the index of a circular fence, or GEOFENCE_REF_POLYGON plus the index of a polygon fence.
+     * GEOFENCE_REF_EMPTY if the entry is empty */
+    uint32_t ref;
+
+} geofence_ref_st;
+
+/** Edit of a set */
+typedef struct {
+
+    /** Operation */
+    geofence_op op;
+    /** User ID of the fence */
+    uint32_t id;
+    /** Center of the circular fence to add. Latitude and Longitude in decimal degrees, ellipsoidal height in meters */
+    position_st center;
+    /** Radius of the circular fence to add, or new radius, in meters */
+    float radius;
+    /** Vertices of the polygon fence to add (see polyfence_init()) */
+    const position_st* vertices;
+    /** Number of vertices of the polygon fence to add */
+    uint32_t nvertices;
+
+} geofence_edit_st;
+
+/** Set of fences */
+typedef struct {
+
+    /** Fences */
+    geofence_st* fences;
+    /** Number of fences */
+    uint32_t count;
+    /** Allocated fences */
+    uint32_t capacity;
+    /** Polygon fences */
+    polyfence_st* polygons;
+    /** Number of polygon fences */
+    uint32_t npolygons;
+    /** Allocated polygon fences */
+    uint32_t polygon_capacity;
+
+    /** Index of the circular fences */
+    geofence_index index;
+    /** Grid index of the circular fences */
+    geofence_grid_st grid;
+    /** R-tree of the polygon fences, then the circular fences with the R-tree index */
+    rtree_st rtree;
+    /** Circular fences with the scan index */
+    rangeset_st scan;
+    /** Number of circular fences in the indexes, the next ones are checked one by one */
+    uint32_t indexed;
+    /** Number of polygon fences in the R-tree, the next ones are checked one by one */
+    uint32_t indexed_polygons;
+    /** Number of tombstones (removed fences) */
+    uint32_t removed;
+    /** Hash table of IDs (open addressing), NULL until a fence is removed or resized */
+    geofence_ref_st* refs;
+    /** Size of the hash table of IDs minus one, the size is a power of two */
+    uint32_t refs_mask;
+    /** Number of entries of the hash table of IDs */
+    uint32_t nrefs;
+    /** Number of edits of the set, it changes whenever a fence is added, removed or resized */
+    uint32_t version;
+    /** Positive value if the indexes must be built again */
+    uint8_t dirty;
+
+} geofence_set_st;
+
+/**
+ * @brief Initialize an empty set
+ * @param [out] s         Set
+ * @param [in]  capacity  Expected number of fences, the set grows if needed
+ * @return Zero on success, Otherwise a negative value
+ */
+int geofence_set_init(geofence_set_st* s, uint32_t capacity);
+
+/**
+ * @brief Release a set
+ * @param [in] s  Set
+ */
+void geofence_set_free(geofence_set_st* s);
+
+/**
+ * @brief Add a fence to the set
+ * @param [in] s       Set
+ * @param [in] id      User ID of the fence
+ * @param [in] center  Center. Latitude and Longitude in decimal degrees, ellipsoidal height in meters
+ * @param [in] radius  Radius in meters
+ * @return Zero on success, Otherwise a negative value
+ */
+int geofence_add(geofence_set_st* s, uint32_t id, const position_st* center, float radius);
+
+/**
+ * @brief Add a polygon fence to the set
+ * @param [in] s         Set
+ * @param [in] id        User ID of the fence
+ * @param [in] vertices  Vertices of the ring (see polyfence_init())
+ * @param [in] n         Number of vertices
+ * @return Zero on success, Otherwise a negative value
+ */
+int geofence_add_polygon(geofence_set_st* s, uint32_t id, const position_st* vertices, uint32_t n);
+
+/**
+ * @brief Remove a fence from the set. If several fences have the ID, only one of them is removed
+ * @param [in] s   Set
+ * @param [in] id  User ID of the fence
+ * @return Zero on success, Otherwise a negative value if no fence has the ID
+ */
+int geofence_remove(geofence_set_st* s, uint32_t id);
+
+/**
+ * @brief Change the radius of a circular fence. If several fences have the ID, only one of them is changed
+ * @param [in] s       Set
+ * @param [in] id      User ID of the fence
+ * @param [in] radius  Radius in meters
+ * @return Zero on success, Otherwise a negative value if no circular fence has the ID or the radius is not valid
+ */
+int geofence_set_radius(geofence_set_st* s, uint32_t id, float radius);
+
+/**
+ * @brief Apply a batch of edits to the set, in order. A batch larger than the fences that can be out of the indexes
+ * marks the set to be built again first, so the indexes are built once instead of updated for every edit.
+ *
+ * @param [in] s      Set
+ * @param [in] edits  Edits
+ * @param [in] n      Number of edits
+ * @return Number of edits applied. The edits stop at the first one that fails
+ */
+uint32_t geofence_apply(geofence_set_st* s, const geofence_edit_st* edits, uint32_t n);
+
+/**
+ * @brief Select the index of the circular fences. The default is the grid.
+ * @param [in] s      Set
+ * @param [in] index  Index
+ */
+void geofence_set_index(geofence_set_st* s, geofence_index index);
+
+/**
+ * @brief Add every target of the target table to the set. The ID of each fence is the index of the target.
+ * @param [in] s  Set
+ * @return Zero on success, Otherwise a negative value
+ */
+int geofence_add_targets(geofence_set_st* s);
+
+/**
+ * @brief Build the indexes of the set, and drop the tombstones. They are built by geofence_evaluate() if the set is
+ * marked to be built again, so it only needs to be called to evaluate the set from several threads, or to compact it
+ * out of the evaluations.
+ *
+ * @param [in] s  Set
+ * @return Zero on success, Otherwise a negative value
+ */
+int geofence_build(geofence_set_st* s);
+
+/**
+ * @brief Find the fences that contain an ECEF position. The indexes are built first if the set is marked to be built
+ * again, so the set must not be evaluated from several threads while it is edited.
+ *
+ * @param [in]  s    Set
+ * @param [in]  x    ECEF X
+ * @param [in]  y    ECEF Y
+ * @param [in]  z    ECEF Z
+ * @param [out] ids  IDs of the fences that contain the position
+ * @param [in]  max  Size of the IDs buffer
+ * @return Number of fences that contain the position. If it is larger than max, only max IDs are written
+ */
+uint32_t geofence_evaluate(geofence_set_st* s, float x, float y, float z, uint32_t* ids, uint32_t max);
+
+/**
+ * @brief Get the distance from an ECEF position to the nearest fence boundary, or a lower bound of it: the fences that
+ * contain a position closer than this to the given one are the fences that contain the given one. The search is
+ * limited to the given distance. With the grid index, the search of each level stops GEOFENCE_MARGIN_RINGS cells away
+ * from the position, so the distance is at most that far if the level has fences.
+ *
+ * @param [in] s      Set
+ * @param [in] x      ECEF X
+ * @param [in] y      ECEF Y
+ * @param [in] z      ECEF Z
+ * @param [in] limit  Max distance searched in meters
+ * @return Distance in meters, at most the limit
+ */
+float geofence_margin(geofence_set_st* s, float x, float y, float z, float limit);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* INCLUDE_GEOFENCE_H_ */
@@ -0,0 +1,150 @@
+/**
+ * @file geoid.h
+ *
+ * Geoid undulation grid
+ *
+ * Geoid undulation (separation between the WGS-84 ellipsoid and the mean sea level) read from a compact binary grid,
+ * e.g. EGM96 or EGM2008 resampled to a regular latitude/longitude grid. The grid file is mapped in memory, so opening
+ * it does not parse anything, and each lookup is a bilinear interpolation of the four corners of a grid cell.
+ *
+ * Grid file format (little-endian):
+ *
+ *     offset  size  field
+ *     0       8     magic "GPSLGEOI"
+ *     8       4     uint32 version (GEOID_GRID_VERSION)
+ *     12      4     uint32 header size in bytes (GEOID_GRID_HEADER_SZ)
+ *     16      4     float  latitude of the first row (south edge) in decimal degrees
+ *     20      4     float  longitude of the first column (west edge) in decimal degrees
+ *     24      4     float  latitude spacing in decimal degrees
+ *     28      4     float  longitude spacing in decimal degrees
+ *     32      4     uint32 number of rows (latitudes)
+ *     36      4     uint32 number of columns (longitudes)
+ *     40      4     float  scale of the samples
+ *     44      4     float  offset of the samples
+ *     48      16    reserved, zero
+ *     64      ...   int16 samples, row-major from south to north. undulation = offset + scale * sample
+ *
+ * When the columns cover the 360 degrees of longitude the grid wraps around the antimeridian. The samples are read in
+ * the host byte order, so the grid is expected to run on little-endian hosts.
+ *
+ * @license
+ * All rights reserved. Read LICENSE.txt file for the license terms.
+ *
+ * Changelog:
+ *
+ * [18/10/2026]     [miguelgarcia]
+ * Initial version
+ *
+ */
+
+#ifndef INCLUDE_GEOID_H_
+#define INCLUDE_GEOID_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stddef.h>
+#include <stdint.h>
+
+/** Grid file magic */
+#define GEOID_GRID_MAGIC        "GPSLGEOI"
+/** Grid file format version */
+#define GEOID_GRID_VERSION      1
+/** Grid file header size */
+#define GEOID_GRID_HEADER_SZ    64
+
+/** Geoid undulation grid */
+typedef struct {
+
+    /** Grid samples */
+    const int16_t* samples;
+    /** Latitude of the first row in decimal degrees */
+    float lat0;
+    /** Longitude of the first column in decimal degrees */
+    float lon0;
+    /** Inverse of the latitude spacing */
+    float inv_dlat;
+    /** Inverse of the longitude spacing */
+    float inv_dlon;
+    /** Number of rows */
+    uint32_t rows;
+    /** Number of columns */
+    uint32_t cols;
+    /** Columns per 360 degrees if the grid wraps around the antimeridian, Otherwise Zero */
+    uint32_t wrap_cols;
+    /** Scale of the samples */
+    float scale;
+    /** Offset of the samples */
+    float offset;
+
+    /** Mapped file, NULL if the grid was initialized from memory */
+    void* map;
+    /** Size of the mapped file */
+    size_t map_sz;
+
+} geoid_st;
+
+/** Last grid cell used by a device, so consecutive fixes in the same cell do not read the grid again */
+typedef struct {
+
+    /** Cell row, negative if the cache is empty */
+    int32_t row;
+    /** Cell column */
+    int32_t col;
+    /** Undulation at the cell corners (south-west, south-east, north-west, north-east) */
+    float v[4];
+
+    /** Number of lookups served by the cached cell */
+    uint32_t hits;
+    /** Number of lookups that loaded a new cell */
+    uint32_t misses;
+
+} geoid_cache_st;
+
+/**
+ * @brief Initialize a grid from a memory buffer with the grid file contents (e.g. a grid stored in flash). The buffer
+ * must be kept while the grid is used.
+ *
+ * @param [out] g     Grid
+ * @param [in]  data  Grid file contents, aligned to 2 bytes
+ * @param [in]  sz    Size of the contents in bytes
+ * @return Zero if the grid is valid, Otherwise a negative value
+ */
+int geoid_init(geoid_st* g, const void* data, size_t sz);
+
+/**
+ * @brief Map a grid file in memory
+ * @param [out] g     Grid
+ * @param [in]  path  Grid file path
+ * @return Zero if the grid is valid, Otherwise a negative value
+ */
+int geoid_open(geoid_st* g, const char* path);
+
+/**
+ * @brief Release a grid mapped with geoid_open()
+ * @param [in] g  Grid
+ */
+void geoid_close(geoid_st* g);
+
+/**
+ * @brief Reset a device cache
+ * @param [out] c  Cache
+ */
+void geoid_cache_reset(geoid_cache_st* c);
+
+/**
+ * @brief Get the geoid undulation at a position
+ * @param [in]     g    Grid
+ * @param [in,out] c    Device cache, can be NULL
+ * @param [in]     lat  Latitude in decimal degrees
+ * @param [in]     lon  Longitude in decimal degrees
+ * @return Geoid undulation in meters (ellipsoidal height = MSL altitude + undulation)
+ */
+float geoid_get_undulation(const geoid_st* g, geoid_cache_st* c, float lat, float lon);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* INCLUDE_GEOID_H_ */
@@ -0,0 +1,134 @@
+/**
+ * @file kdtree.h
+ *
+ * ECEF k-d tree for nearest-target queries
+ *
+ * Static k-d tree over the ECEF coordinates of a set of targets. The tree is implicit: the nodes are stored in one
+ * array, the root of the range [lo, hi) is the median element lo + (hi - lo) / 2 and its subtrees are the ranges on
+ * each side, so there are no pointers and every subtree is contiguous in memory. Each node splits on the axis with the
+ * largest extent of its range.
+ *
+ * The distances are the ECEF chord, the same distance given by position_geodetic_to_enu() plus
+ * position_xyz_distance().
+ *
+ * @license
+ * All rights reserved. Read LICENSE.txt file for the license terms.
+ *
+ * Changelog:
+ *
+ * [18/10/2026]     [miguelgarcia]
+ * Initial version
+ *
+ */
+
+#ifndef INCLUDE_KDTREE_H_
+#define INCLUDE_KDTREE_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include "position.h"
+
+/** Node of the tree */
+typedef struct {
+
+    /** ECEF (x, y, z) */
+    float p[3];
+    /** Target ID */
+    uint32_t id;
+
+} kdtree_node_st;
+
+/** Tree */
+typedef struct {
+
+    /** Nodes, in implicit tree order */
+    kdtree_node_st* nodes;
+    /** Split axis of each node (0 = X, 1 = Y, 2 = Z) */
+    uint8_t* axes;
+    /** Number of nodes */
+    uint32_t n;
+
+} kdtree_st;
+
+/** Query result */
+typedef struct {
+
+    /** Target ID */
+    uint32_t id;
+    /** Distance in meters */
+    float dist;
+
+} kdtree_result_st;
+
+/**
+ * @brief Build a tree from geodetic positions. The ID of each target is its index in the positions.
+ * @param [out] t        Tree
+ * @param [in]  points   Geodetic positions. Latitude and Longitude in decimal degrees, ellipsoidal height in meters
+ * @param [in]  n        Number of positions
+ * @param [in]  threads  Number of worker threads, zero to use all the processors
+ * @return Zero on success, Otherwise a negative value
+ */
+int kdtree_build(kdtree_st* t, const position_st* points, uint32_t n, uint32_t threads);
+
+/**
+ * @brief Build a tree from the targets of the target table. The ID of each target is its index in the table.
+ * @param [out] t        Tree
+ * @param [in]  threads  Number of worker threads, zero to use all the processors
+ * @return Zero on success, Otherwise a negative value
+ */
+int kdtree_build_targets(kdtree_st* t, uint32_t threads);
+
+/**
+ * @brief Release a tree
+ * @param [in] t  Tree
+ */
+void kdtree_free(kdtree_st* t);
+
+/**
+ * @brief Find the k nearest targets to an ECEF position
+ * @param [in]  t    Tree
+ * @param [in]  x    ECEF X
+ * @param [in]  y    ECEF Y
+ * @param [in]  z    ECEF Z
+ * @param [in]  k    Number of targets
+ * @param [out] out  Nearest targets, sorted by distance. Room for k results
+ * @return Number of results, k or the number of targets if it is lower
+ */
+uint32_t kdtree_knn(const kdtree_st* t, float x, float y, float z, uint32_t k, kdtree_result_st* out);
+
+/**
+ * @brief Find the targets within a distance of an ECEF position
+ * @param [in]  t       Tree
+ * @param [in]  x       ECEF X
+ * @param [in]  y       ECEF Y
+ * @param [in]  z       ECEF Z
+ * @param [in]  radius  Max distance in meters (inclusive)
+ * @param [out] out     Targets within the distance, not sorted
+ * @param [in]  max     Size of the output buffer
+ * @return Number of targets within the distance. If it is larger than max, only max results are written
+ */
+uint32_t kdtree_radius(const kdtree_st* t, float x, float y, float z, float radius, kdtree_result_st* out,
+                       uint32_t max);
+
+/**
+ * @brief Find the k nearest targets to many ECEF positions, using several threads
+ * @param [in]  t        Tree
+ * @param [in]  queries  ECEF positions (x, y, z) * nq
+ * @param [in]  nq       Number of positions
+ * @param [in]  k        Number of targets per position
+ * @param [out] out      Nearest targets of each position, sorted by distance. Room for nq * k results
+ * @param [out] counts   Number of results of each position, can be NULL
+ * @param [in]  threads  Number of worker threads, zero to use all the processors
+ * @return Zero on success, Otherwise a negative value
+ */
+int kdtree_knn_batch(const kdtree_st* t, const float* queries, uint32_t nq, uint32_t k, kdtree_result_st* out,
+                     uint32_t* counts, uint32_t threads);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* INCLUDE_KDTREE_H_ */
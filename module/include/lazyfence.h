@@ -0,0 +1,134 @@
+/**
+ * @file lazyfence.h
+ *
+ * Lazy geofence evaluation
+ *
+ * Optional evaluator that skips the evaluation of a geofence set while a device cannot have crossed any fence
+ * boundary. A full evaluation converts the position to ECEF, finds the fences that contain it and the distance to the
+ * nearest fence boundary (the margin, see geofence_margin()), and keeps them with the position. The next positions
+ * reuse the kept fences while the displacement from the kept position is shorter than the margin.
+ *
+ * The displacement is bounded from the latitude, longitude and height deltas, without trigonometry (see
+ * position_displacement_bound()). The cosine of the kept latitude is computed once per full evaluation.
+ *
+ * Each device also has a max plausible speed. While the time since the full evaluation is too short to reach the
+ * margin at that speed, the position is not checked at all: a jump faster than the max speed is taken as a GPS outlier
+ * and ignored until the time would allow it.
+ *
+ * The evaluator also keeps the set and its version, so another set or an edit of the set (see geofence_remove())
+ * forces a full evaluation.
+ *
+ * @license
+ * All rights reserved. Read LICENSE.txt file for the license terms.
+ *
+ * Changelog:
+ *
+ * [18/10/2026]     [miguelgarcia]
+ * Initial version
+ *
+ * [18/10/2026]     [miguelgarcia]
+ * Edits of the set
+ *
+ * [18/10/2026]     [miguelgarcia]
+ * Displacement bound from position.h
+ *
+ * [18/10/2026]     [miguelgarcia]
+ * Set of the last full evaluation
+ *
+ */
+
+#ifndef INCLUDE_LAZYFENCE_H_
+#define INCLUDE_LAZYFENCE_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include "geofence.h"
+#include "position.h"
+
+/** Max number of fence IDs kept by an evaluator. A device in more fences is evaluated on every position */
+#define LAZYFENCE_MAX_IDS       32
+/** Max distance searched for the nearest fence boundary, in meters */
+#define LAZYFENCE_MAX_MARGIN    5000.0f
+/** Distance subtracted from the margin, for the float rounding of the ECEF positions, in meters */
+#define LAZYFENCE_PAD           4.0f
+/** Max ellipsoidal height of a device, in meters. The displacement bound is not valid above it */
+#define LAZYFENCE_MAX_HEIGHT    POSITION_MAX_HEIGHT
+
+/** Evaluator of a device */
+typedef struct {
+
+    /** Max plausible speed of the device in m/s, zero for no bound */
+    float max_speed;
+
+    /** Position of the last full evaluation. Ellipsoidal height */
+    position_st anchor;
+    /** Cosine of the latitude of the anchor */
+    float cos_lat;
+    /** Time of the last full evaluation in seconds */
+    double time;
+    /** Distance the device can move from the anchor without crossing a fence boundary, negative if unknown */
+    float margin;
+    /** Set of the last full evaluation */
+    const geofence_set_st* set;
+    /** Version of the set in the last full evaluation */
+    uint32_t version;
+
+    /** Fences that contain the anchor */
+    uint32_t ids[LAZYFENCE_MAX_IDS];
+    /** Number of fences that contain the anchor */
+    uint32_t n;
+    /** Number of IDs kept */
+    uint32_t kept;
+
+    /** Number of full evaluations */
+    uint32_t evaluations;
+    /** Number of skipped evaluations */
+    uint32_t skipped;
+
+} lazyfence_st;
+
+/**
+ * @brief Initialize an evaluator
+ * @param [out] l          Evaluator
+ * @param [in]  max_speed  Max plausible speed of the device in m/s, zero for no bound
+ */
+void lazyfence_init(lazyfence_st* l, float max_speed);
+
+/**
+ * @brief Forget the last full evaluation, so the next position is evaluated. Another set is detected by the evaluator,
+ * so it is only needed when the fences of the set change without a new version.
+ * @param [in] l  Evaluator
+ */
+void lazyfence_reset(lazyfence_st* l);
+
+/**
+ * @brief Get an upper bound of the distance from the anchor of an evaluator to a position
+ * @param [in] l    Evaluator, with an anchor
+ * @param [in] llh  Position. Latitude and Longitude in decimal degrees, ellipsoidal height in meters
+ * @return Distance in meters
+ */
+float lazyfence_displacement(const lazyfence_st* l, const position_st* llh);
+
+/**
+ * @brief Find the fences that contain a device position, from the last full evaluation if the device cannot have
+ * crossed a fence boundary since then.
+ *
+ * @param [in]  l     Evaluator
+ * @param [in]  s     Set of fences
+ * @param [in]  llh   Position. Latitude and Longitude in decimal degrees, ellipsoidal height in meters
+ * @param [in]  time  Time of the position in seconds. A time before the last full evaluation does not use the speed
+ * @param [out] ids   IDs of the fences that contain the position
+ * @param [in]  max   Size of the IDs buffer
+ * @return Number of fences that contain the position. If it is larger than max, only max IDs are written
+ */
+uint32_t lazyfence_evaluate(lazyfence_st* l, geofence_set_st* s, const position_st* llh, double time,
+                            uint32_t* ids, uint32_t max);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* INCLUDE_LAZYFENCE_H_ */
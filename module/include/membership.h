@@ -0,0 +1,164 @@
+/**
+ * @file membership.h
+ *
+ * Device fence membership
+ *
+ * Membership state of a fleet of devices in a set of fences, stored as one bitset per device: bit i of a device is set
+ * if the device is inside fence i. The bitsets of all the devices are a single array of 64-bit words, so the state
+ * takes one bit per device and fence. A new evaluation of a device gives its new bitmask (the one of
+ * rangeset_evaluate(), for instance): it is compared with the stored one a word at a time with XOR, and only the bits
+ * that changed become events. A device that did not cross any fence boundary costs a load, a XOR and a branch per word.
+ *
+ * The enter and exit events are not reported one by one: they are appended to a batch, and the batch is passed to the
+ * callback of the state when it is full and when it is flushed.
+ *
+ * The devices are identified by an index lower than the max number of devices, and the fences by their bit index.
+ *
+ * @license
+ * All rights reserved. Read LICENSE.txt file for the license terms.
+ *
+ * Changelog:
+ *
+ * [18/10/2026]     [miguelgarcia]
+ * Initial version
+ *
+ */
+
+#ifndef INCLUDE_MEMBERSHIP_H_
+#define INCLUDE_MEMBERSHIP_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+/** Number of events of a batch */
+#define MEMBERSHIP_BATCH    256
+
+/** Type of event */
+typedef enum {
+
+    /** The device entered the fence */
+    membership_enter = 0,
+    /** The device left the fence */
+    membership_exit = 1
+
+} membership_transition;
+
+/** Enter or exit event */
+typedef struct {
+
+    /** Device index */
+    uint32_t device;
+    /** Fence index */
+    uint32_t fence;
+    /** Type of event */
+    membership_transition type;
+
+} membership_event_st;
+
+/**
+ * Callback with a batch of events, in the order they happened
+ * @param [in] events  Events of the batch
+ * @param [in] n       Number of events
+ * @param [in] ctx     User context
+ */
+typedef void (*membership_events_cb)(const membership_event_st* events, uint32_t n, void* ctx);
+
+/** Membership state */
+typedef struct {
+
+    /** Bitsets of the devices, words per device * max devices */
+    uint64_t* bits;
+    /** Max number of devices */
+    uint32_t max_devices;
+    /** Number of fences */
+    uint32_t nfences;
+    /** 64-bit words of a bitset */
+    uint32_t words;
+
+    /** Callback with the batches of events */
+    membership_events_cb cb;
+    /** User context of the callback */
+    void* ctx;
+    /** Events not reported yet */
+    membership_event_st batch[MEMBERSHIP_BATCH];
+    /** Number of events not reported yet */
+    uint32_t nbatch;
+
+    /** Number of events */
+    uint64_t events;
+
+} membership_st;
+
+/**
+ * @brief Initialize a state with every device outside every fence
+ * @param [out] m            State
+ * @param [in]  max_devices  Max number of devices
+ * @param [in]  nfences      Number of fences
+ * @param [in]  cb           Callback with the batches of events
+ * @param [in]  ctx          User context passed to the callback
+ * @return Zero on success, Otherwise a negative value
+ */
+int membership_init(membership_st* m, uint32_t max_devices, uint32_t nfences, membership_events_cb cb, void* ctx);
+
+/**
+ * @brief Release a state. The events not reported yet are lost
+ * @param [in] m  State
+ */
+void membership_free(membership_st* m);
+
+/**
+ * @brief Change the number of fences. The devices keep the state of the fences that remain
+ * @param [in] m        State
+ * @param [in] nfences  Number of fences
+ * @return Zero on success, Otherwise a negative value
+ */
+int membership_resize(membership_st* m, uint32_t nfences);
+
+/**
+ * @brief Set the fences that contain a device, and add the events of the fences it entered or left to the batch
+ * @param [in] m       State
+ * @param [in] device  Device index
+ * @param [in] mask    Bit i is set if the device is inside fence i. Room for the words of a bitset
+ * @return Number of events of the device
+ */
+uint32_t membership_update(membership_st* m, uint32_t device, const uint64_t* mask);
+
+/**
+ * @brief Take a device out of every fence, for a device without position. The exit events are added to the batch
+ * @param [in] m       State
+ * @param [in] device  Device index
+ * @return Number of events of the device
+ */
+uint32_t membership_clear(membership_st* m, uint32_t device);
+
+/**
+ * @brief Report the events of the batch to the callback, if there are any
+ * @param [in] m  State
+ */
+void membership_flush(membership_st* m);
+
+/**
+ * @brief Check if a device is inside a fence
+ * @param [in] m       State
+ * @param [in] device  Device index
+ * @param [in] fence   Fence index
+ * @return Positive value if the device is inside the fence, Otherwise Zero.
+ */
+uint8_t membership_contains(const membership_st* m, uint32_t device, uint32_t fence);
+
+/**
+ * @brief Return the number of fences that contain a device
+ * @param [in] m       State
+ * @param [in] device  Device index
+ * @return Number of fences
+ */
+uint32_t membership_count(const membership_st* m, uint32_t device);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* INCLUDE_MEMBERSHIP_H_ */
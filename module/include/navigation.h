@@ -11,6 +11,15 @@
  * [28/02/2021]     [miguelgarcia]
  * Initial version
  *
+ * [18/10/2026]     [miguelgarcia]
+ * UTC time of the last GGA sentence
+ *
+ * [18/10/2026]     [miguelgarcia]
+ * Reentrant parser context
+ *
+ * [18/10/2026]     [miguelgarcia]
+ * Geoidal separation reported flag
+ *
  */
 
 #ifndef INCLUDE_NAVIGATION_H_
@@ -20,8 +29,12 @@
 extern "C" {
 #endif
 
+#include <stdint.h>
 #include "position.h"
 
+/** Max size of MTK3339 NMEA sentence */
+#define NAVIGATION_BUF_SZ   255
+
 /**
  * An interface to the MTK3339 GPS module.
  */
@@ -62,9 +75,75 @@ typedef struct {
     float altitude;
     /** geoidal separation */
     float geoidal;
+    /** Positive value if the sentence has the geoidal separation field, Otherwise Zero */
+    uint8_t geoidal_valid;
 
 } GgaType;
 
+/**
+ * Parser context of a GPS module. The navigation_* functions without context use a global one, the
+ * navigation_ctx_* functions take the context of each module, so the modules can be parsed from several threads.
+ */
+typedef struct {
+
+    /** Time, position and fix related data of the last GGA sentence */
+    GgaType gga;
+    /** LLH : Latitude, Longitude in Decimal Degrees, Altitude in meters */
+    position_st llh;
+
+    /** Data Buffer */
+    char buf[NAVIGATION_BUF_SZ];
+    /** Buffer position */
+    int buf_pos;
+    /** Parser state: zero while waiting for the start character '$', positive while reading the sentence body */
+    uint8_t state;
+
+} navigation_st;
+
+/**
+ * @brief Initialize a parser context, without position and waiting for a new sentence
+ * @param [out] nav  Parser context
+ */
+void navigation_init(navigation_st* nav);
+
+/**
+ * @brief Reset the last read data from the GPS module of a parser context
+ * @param [in] nav  Parser context
+ */
+void navigation_ctx_reset(navigation_st* nav);
+
+/**
+ * @brief Get current LLH position of a parser context. Latitude and Longitude in decimal degrees and MSL Altitude in
+ * meters.
+ * @param [in] nav  Parser context
+ * @return Current LLH position
+ */
+position_st navigation_ctx_get_llh(const navigation_st* nav);
+
+/**
+ * @brief Get the geoidal separation reported by the GPS module in the last GGA sentence of a parser context
+ * @param [in]  nav         Parser context
+ * @param [out] separation  Geoidal separation in meters, zero if it is not reported
+ * @return Positive value if the position is valid and the sentence has the separation field, Otherwise Zero. A
+ * reported separation can be zero.
+ */
+uint8_t navigation_ctx_get_geoid_separation(const navigation_st* nav, float* separation);
+
+/**
+ * @brief Get the UTC time of the last GGA sentence of a parser context
+ * @param [in] nav  Parser context
+ * @return Seconds since midnight
+ */
+double navigation_ctx_get_time(const navigation_st* nav);
+
+/**
+ * Add new NMEA char to the NMEA parser of a parser context
+ * @param [in] nav  Parser context
+ * @param [in] d    Input char
+ * @return Positive value if the context has a new position value, Otherwise Zero.
+ */
+uint8_t navigation_ctx_add_nmea_char(navigation_st* nav, char d);
+
 
 /**
  * @brief Reset the last read data from the GPS module.
@@ -79,6 +158,23 @@ void navigation_reset(void);
 position_st navigation_get_llh(void);
 
 
+/**
+ * @brief Get the geoidal separation reported by the GPS module in the last GGA sentence. Ellipsoidal height is MSL
+ * Altitude plus the separation.
+ * @param [out] separation  Geoidal separation in meters, zero if it is not reported
+ * @return Positive value if the position is valid and the sentence has the separation field, Otherwise Zero. A
+ * reported separation can be zero.
+ */
+uint8_t navigation_get_geoid_separation(float* separation);
+
+
+/**
+ * @brief Get the UTC time of the last GGA sentence
+ * @return Seconds since midnight
+ */
+double navigation_get_time(void);
+
+
 /**
  * Add new NMEA char to the NMEA parser
  * @param [in] d  Input char
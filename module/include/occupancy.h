@@ -0,0 +1,153 @@
+/**
+ * @file occupancy.h
+ *
+ * Fence occupancy index
+ *
+ * Reverse index of the devices inside each fence, updated only on the enter and exit transitions of the devices. Each
+ * fence has a compact membership set of device indexes: a hash table with open addressing and linear probing, at most
+ * half full, so adding, removing and checking a device take constant time, and the count of devices is kept with it.
+ * A removed device shifts back the next devices of its probe sequence, so the table has no deleted entries, and it
+ * shrinks when it is less than 1/8 full, so the memory is bounded by the devices inside the fences (8 to 32 bytes per
+ * device in a fence) plus a fixed cost per fence. The fences are found by their user ID in another hash table.
+ *
+ * The devices are identified by an index chosen by the caller, any value but OCCUPANCY_EMPTY. The transitions of a
+ * device come from two consecutive evaluations of its position: occupancy_update() compares the fences of both and
+ * applies the difference.
+ *
+ * @license
+ * All rights reserved. Read LICENSE.txt file for the license terms.
+ *
+ * Changelog:
+ *
+ * [18/10/2026]     [miguelgarcia]
+ * Initial version
+ *
+ */
+
+#ifndef INCLUDE_OCCUPANCY_H_
+#define INCLUDE_OCCUPANCY_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+/** Device index of an empty entry of a membership set. It is not a valid device index */
+#define OCCUPANCY_EMPTY     0xFFFFFFFFu
+
+/** Devices inside a fence */
+typedef struct {
+
+    /** User ID of the fence */
+    uint32_t id;
+    /** Number of devices inside the fence */
+    uint32_t count;
+    /** Size of the hash table minus one, the size is a power of two */
+    uint32_t mask;
+    /** Hash table of the device indexes, NULL if the fence has no devices */
+    uint32_t* devices;
+
+} occupancy_fence_st;
+
+/** Occupancy index */
+typedef struct {
+
+    /** Fences with devices, or that had devices */
+    occupancy_fence_st* fences;
+    /** Number of fences */
+    uint32_t nfences;
+    /** Allocated fences */
+    uint32_t capacity;
+    /** Hash table of the fence indexes by user ID, OCCUPANCY_EMPTY if the entry is empty */
+    uint32_t* index;
+    /** Size of the hash table of the fences minus one, the size is a power of two */
+    uint32_t index_mask;
+
+} occupancy_st;
+
+/**
+ * @brief Initialize an empty occupancy index
+ * @param [out] o  Occupancy index
+ * @return Zero on success, Otherwise a negative value
+ */
+int occupancy_init(occupancy_st* o);
+
+/**
+ * @brief Release an occupancy index
+ * @param [in] o  Occupancy index
+ */
+void occupancy_free(occupancy_st* o);
+
+/**
+ * @brief Register that a device entered a fence
+ * @param [in] o       Occupancy index
+ * @param [in] fence   User ID of the fence
+ * @param [in] device  Device index, not OCCUPANCY_EMPTY
+ * @return Zero on success, Otherwise a negative value
+ */
+int occupancy_enter(occupancy_st* o, uint32_t fence, uint32_t device);
+
+/**
+ * @brief Register that a device left a fence
+ * @param [in] o       Occupancy index
+ * @param [in] fence   User ID of the fence
+ * @param [in] device  Device index
+ * @return Zero on success, Otherwise a negative value if the device was not inside the fence
+ */
+int occupancy_exit(occupancy_st* o, uint32_t fence, uint32_t device);
+
+/**
+ * @brief Apply the transitions of a device between two evaluations: it leaves the fences of the previous evaluation
+ * that are not in the new one, and enters the fences of the new evaluation that were not in the previous one.
+ *
+ * @param [in] o         Occupancy index
+ * @param [in] device    Device index
+ * @param [in] previous  IDs of the fences of the previous evaluation
+ * @param [in] nprevious Number of fences of the previous evaluation
+ * @param [in] current   IDs of the fences of the new evaluation
+ * @param [in] ncurrent  Number of fences of the new evaluation
+ * @return Zero on success, Otherwise a negative value
+ */
+int occupancy_update(occupancy_st* o, uint32_t device, const uint32_t* previous, uint32_t nprevious,
+                     const uint32_t* current, uint32_t ncurrent);
+
+/**
+ * @brief Remove every device from a fence, for a fence removed from the set
+ * @param [in] o      Occupancy index
+ * @param [in] fence  User ID of the fence
+ */
+void occupancy_clear(occupancy_st* o, uint32_t fence);
+
+/**
+ * @brief Return the number of devices inside a fence
+ * @param [in] o      Occupancy index
+ * @param [in] fence  User ID of the fence
+ * @return Number of devices
+ */
+uint32_t occupancy_count(const occupancy_st* o, uint32_t fence);
+
+/**
+ * @brief Check if a device is inside a fence
+ * @param [in] o       Occupancy index
+ * @param [in] fence   User ID of the fence
+ * @param [in] device  Device index
+ * @return Positive value if the device is inside the fence, Otherwise Zero.
+ */
+uint8_t occupancy_contains(const occupancy_st* o, uint32_t fence, uint32_t device);
+
+/**
+ * @brief Get the devices inside a fence, in no particular order
+ * @param [in]  o        Occupancy index
+ * @param [in]  fence    User ID of the fence
+ * @param [out] devices  Device indexes
+ * @param [in]  max      Size of the device buffer
+ * @return Number of devices inside the fence. If it is larger than max, only max devices are written
+ */
+uint32_t occupancy_members(const occupancy_st* o, uint32_t fence, uint32_t* devices, uint32_t max);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* INCLUDE_OCCUPANCY_H_ */
@@ -0,0 +1,61 @@
+/**
+ * @file parallel.h
+ *
+ * Parallel task runner
+ *
+ * Runs a number of independent tasks on a pool of worker threads. The workers take the tasks in order from a shared
+ * counter, so tasks of different cost are balanced between the workers.
+ *
+ * @license
+ * All rights reserved. Read LICENSE.txt file for the license terms.
+ *
+ * Changelog:
+ *
+ * [18/10/2026]     [miguelgarcia]
+ * Initial version
+ *
+ */
+
+#ifndef INCLUDE_PARALLEL_H_
+#define INCLUDE_PARALLEL_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+/** Max number of worker threads */
+#define PARALLEL_MAX_THREADS    256
+
+/**
+ * Task function
+ * @param [in] task    Task index
+ * @param [in] worker  Index of the worker running the task, lower than the number of workers
+ * @param [in] ctx     User context
+ */
+typedef void (*parallel_task_fn)(uint32_t task, uint32_t worker, void* ctx);
+
+/**
+ * @brief Return the number of worker threads used when zero threads are requested
+ * @return Number of online processors
+ */
+uint32_t parallel_default_threads(void);
+
+/**
+ * @brief Run the tasks [0, tasks) on a pool of worker threads and wait until all of them are done. The calling thread
+ * is one of the workers.
+ *
+ * @param [in] tasks    Number of tasks
+ * @param [in] threads  Number of worker threads, zero to use parallel_default_threads()
+ * @param [in] fn       Task function
+ * @param [in] ctx      User context passed to the task function
+ * @return Number of workers used. If some worker threads cannot be created, the tasks are run by the others
+ */
+int parallel_for(uint32_t tasks, uint32_t threads, parallel_task_fn fn, void* ctx);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* INCLUDE_PARALLEL_H_ */
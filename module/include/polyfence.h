@@ -0,0 +1,162 @@
+/**
+ * @file polyfence.h
+ *
+ * Polygon geofences
+ *
+ * A polygon fence is a closed ring of geodetic vertices. The vertices are projected once, when the fence is built, to
+ * the East-North plane of a local frame centered at the polygon, and a device position is projected to the same plane
+ * with a precomputed rotation, so the containment test is a 2D point-in-polygon test. The altitude of the device is
+ * only bounded: a position more than POLYFENCE_MAX_DEPTH below the lowest vertex or POLYFENCE_MAX_HEIGHT above the
+ * local plane is never inside, so every fence has a finite ECEF bounding box. The projection is meant for polygons up
+ * to a few hundred kilometers.
+ *
+ * The bounding box of the projected polygon rejects most positions before the exact test. The exact test counts the
+ * edges crossed by a ray from the position (crossing number), with the SIMD kernel of the dispatch module. The edges
+ * are bucketed in horizontal bands of the bounding box, and a position only tests the edges of its band, so a large
+ * polygon does not scan every vertex.
+ *
+ * @license
+ * All rights reserved. Read LICENSE.txt file for the license terms.
+ *
+ * Changelog:
+ *
+ * [18/10/2026]     [miguelgarcia]
+ * Initial version
+ *
+ * [18/10/2026]     [miguelgarcia]
+ * Vertical bounds and ECEF bounding box
+ *
+ * [18/10/2026]     [miguelgarcia]
+ * Distance to the boundary
+ *
+ */
+
+#ifndef INCLUDE_POLYFENCE_H_
+#define INCLUDE_POLYFENCE_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include "position.h"
+
+/** Polygons with more edges than this are bucketed in bands */
+#define POLYFENCE_BAND_MIN_EDGES    32
+/** Expected number of edges per band */
+#define POLYFENCE_BAND_EDGES        8
+/** Max number of bands of a polygon */
+#define POLYFENCE_MAX_BANDS         4096
+/** Max depth of a position inside a fence, below the lowest vertex, in meters */
+#define POLYFENCE_MAX_DEPTH         1000.0f
+/** Max height of a position inside a fence, above the local plane, in meters */
+#define POLYFENCE_MAX_HEIGHT        20000.0f
+
+/** Polygon fence */
+typedef struct {
+
+    /** User ID */
+    uint32_t id;
+    /** Number of vertices */
+    uint32_t nvertices;
+
+    /** Origin of the local frame in ECEF (x, y, z) */
+    float origin[3];
+    /** Rotation from ECEF to the local frame, rows East, North and Up */
+    float rotation[3][3];
+    /** Min Up coordinate of a position inside the fence */
+    float min_up;
+    /** Max Up coordinate of a position inside the fence */
+    float max_up;
+
+    /** Bounding box of the projected polygon (east, north) in meters */
+    float min[2];
+    float max[2];
+
+    /** Edges of every band (start and end points), aligned and padded with degenerate edges */
+    float* x0;
+    float* y0;
+    float* x1;
+    float* y1;
+    /** Size of the edge arrays, with the padding */
+    uint32_t nedges;
+    /** First edge of each band */
+    uint32_t* band_start;
+    /** Number of edges of each band */
+    uint32_t* band_count;
+    /** Number of bands */
+    uint32_t nbands;
+    /** Bands per meter of north coordinate */
+    float band_scale;
+
+    /** Projected vertices (east, north), every edge including the horizontal ones */
+    float* vx;
+    float* vy;
+
+} polyfence_st;
+
+/**
+ * @brief Build a polygon fence
+ * @param [out] p         Fence
+ * @param [in]  id        User ID
+ * @param [in]  vertices  Vertices of the ring, in either order. Latitude and Longitude in decimal degrees, the altitude
+ *                        is not used. The ring is closed implicitly, the last vertex can repeat the first one
+ * @param [in]  n         Number of vertices
+ * @return Zero on success, Otherwise a negative value
+ */
+int polyfence_init(polyfence_st* p, uint32_t id, const position_st* vertices, uint32_t n);
+
+/**
+ * @brief Release a polygon fence
+ * @param [in] p  Fence
+ */
+void polyfence_free(polyfence_st* p);
+
+/**
+ * @brief Project an ECEF position to the local plane of a fence
+ * @param [in]  p      Fence
+ * @param [in]  x      ECEF X
+ * @param [in]  y      ECEF Y
+ * @param [in]  z      ECEF Z
+ * @param [out] east   East coordinate in meters
+ * @param [out] north  North coordinate in meters
+ * @return Up coordinate in meters
+ */
+float polyfence_project(const polyfence_st* p, float x, float y, float z, float* east, float* north);
+
+/**
+ * @brief Get the ECEF bounding box of the positions inside a fence
+ * @param [in]  p    Fence
+ * @param [out] min  Min ECEF (x, y, z)
+ * @param [out] max  Max ECEF (x, y, z)
+ */
+void polyfence_get_bounds(const polyfence_st* p, float min[3], float max[3]);
+
+/**
+ * @brief Check if an ECEF position is inside a fence
+ * @param [in] p  Fence
+ * @param [in] x  ECEF X
+ * @param [in] y  ECEF Y
+ * @param [in] z  ECEF Z
+ * @return Positive value if it is inside, Otherwise Zero
+ */
+uint8_t polyfence_contains(const polyfence_st* p, float x, float y, float z);
+
+/**
+ * @brief Get the distance from an ECEF position to the boundary of a fence, in the local frame: the boundary of the
+ * polygon extruded between the vertical bounds. The projection does not stretch distances, so a position closer than
+ * this to the given one is inside the fence if and only if the given one is.
+ *
+ * @param [in] p  Fence
+ * @param [in] x  ECEF X
+ * @param [in] y  ECEF Y
+ * @param [in] z  ECEF Z
+ * @return Distance in meters
+ */
+float polyfence_distance(const polyfence_st* p, float x, float y, float z);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* INCLUDE_POLYFENCE_H_ */
@@ -12,6 +12,9 @@
  * [27/02/2021]     [miguelgarcia]
  * Initial version
  *
+ * [18/10/2026]     [miguelgarcia]
+ * Displacement bound
+ *
  */
 
 #ifndef INCLUDE_POSITION_H_
@@ -21,6 +24,11 @@
 extern "C" {
 #endif
 
+#include <stdint.h>
+
+/** Max ellipsoidal height covered by position_displacement_bound(), in meters */
+#define POSITION_MAX_HEIGHT     20000.0f
+
 typedef enum {
 
     pos_invalid = 0,
@@ -90,6 +98,71 @@ void position_geodetic_to_enu(float lat, float lon, float h,
                               float lat0, float lon0, float h0,
                               float* xEast, float* yNorth, float* zUp);
 
+/**
+ * @brief Converts the East-North-Up coordinates of a Local Tangent Plane centered at the (WGS-84) Geodetic point
+ * (lat0, lon0, h0) to the Earth-Centered Earth-Fixed (ECEF) coordinates (x, y, z).
+ *
+ * @param [in]  xEast   ENU East coordinate
+ * @param [in]  yNorth  ENU North coordinate
+ * @param [in]  zUp     ENU UP coordinate
+ * @param [in]  lat0    Geodetic initial latitude
+ * @param [in]  lon0    Geodetic initial longitude
+ * @param [in]  h0      Geodetic initial altitude
+ * @param [out] x       ECEF X
+ * @param [out] y       ECEF Y
+ * @param [out] z       ECEF Z
+ */
+void position_enu_to_ecef(float xEast, float yNorth, float zUp,
+                          float lat0, float lon0, float h0,
+                          float* x, float* y, float* z);
+
+/**
+ * @brief Converts the Earth-Centered Earth-Fixed (ECEF) coordinates (x, y, z) to the WGS-84 Geodetic point
+ * (lat, lon, h). Closed-form (non-iterative) solution, valid for any point farther than ~43 km from the Earth center.
+ *
+ * @param [in]  x    ECEF X
+ * @param [in]  y    ECEF Y
+ * @param [in]  z    ECEF Z
+ * @param [out] lat  Latitude in decimal degrees
+ * @param [out] lon  Longitude in decimal degrees
+ * @param [out] h    Geodetic Altitude
+ */
+void position_ecef_to_geodetic(float x, float y, float z,
+                               float* lat, float* lon, float* h);
+
+/**
+ * @brief Converts an array of Earth-Centered Earth-Fixed (ECEF) coordinates to WGS-84 Geodetic points.
+ * Input and output arrays are structure-of-arrays of n elements.
+ *
+ * @param [in]  x    ECEF X array
+ * @param [in]  y    ECEF Y array
+ * @param [in]  z    ECEF Z array
+ * @param [out] lat  Latitude array in decimal degrees
+ * @param [out] lon  Longitude array in decimal degrees
+ * @param [out] h    Geodetic Altitude array
+ * @param [in]  n    Number of points
+ */
+void position_ecef_to_geodetic_array(const float* x, const float* y, const float* z,
+                                     float* lat, float* lon, float* h, uint32_t n);
+
+/**
+ * @brief Converts the East-North-Up coordinates of a Local Tangent Plane centered at the (WGS-84) Geodetic point
+ * (lat0, lon0, h0) to the WGS-84 Geodetic point (lat, lon, h).
+ *
+ * @param [in]  xEast   ENU East coordinate
+ * @param [in]  yNorth  ENU North coordinate
+ * @param [in]  zUp     ENU UP coordinate
+ * @param [in]  lat0    Geodetic initial latitude
+ * @param [in]  lon0    Geodetic initial longitude
+ * @param [in]  h0      Geodetic initial altitude
+ * @param [out] lat     Latitude in decimal degrees
+ * @param [out] lon     Longitude in decimal degrees
+ * @param [out] h       Geodetic Altitude
+ */
+void position_enu_to_geodetic(float xEast, float yNorth, float zUp,
+                              float lat0, float lon0, float h0,
+                              float* lat, float* lon, float* h);
+
 /**
  * @brief  Calculate the distance between two 3D-points
  * @param [in] x0   X0 coordinate in meters
@@ -103,6 +176,25 @@ void position_geodetic_to_enu(float lat, float lon, float h,
 float position_xyz_distance(float x0, float y0, float z0,
                             float x1, float y1, float z1);
 
+/**
+ * @brief Cosine of a latitude, computed once for each reference position of position_displacement_bound()
+ * @param [in] lat  Latitude in decimal degrees
+ * @return Cosine of the latitude
+ */
+float position_cos_latitude(float lat);
+
+/**
+ * @brief Get an upper bound of the distance between a reference position and another one, without trigonometry: the
+ * length of the path along the parallel of the reference position, then along the meridian of the other one, then up
+ * or down, with the largest radius of curvature of the WGS-84 ellipsoid at POSITION_MAX_HEIGHT.
+ *
+ * @param [in] ref      Reference position. Latitude and Longitude in decimal degrees, ellipsoidal height in meters
+ * @param [in] cos_lat  Cosine of the reference latitude (see position_cos_latitude())
+ * @param [in] llh      Position. Latitude and Longitude in decimal degrees, ellipsoidal height in meters
+ * @return Distance in meters. It is not a bound above POSITION_MAX_HEIGHT
+ */
+float position_displacement_bound(const position_st* ref, float cos_lat, const position_st* llh);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,102 @@
+/**
+ * @file rangeset.h
+ *
+ * Brute-force target set
+ *
+ * Set of targets (an ECEF center and a range) stored as a structure of arrays: X, Y, Z and squared range, aligned to
+ * 64 bytes and padded to 16 elements. A device position is tested against every target with the SIMD range kernel of
+ * the dispatch module, which outputs a bitmask of the targets in range without branches. With a few hundred to a few
+ * thousand targets the whole set stays in cache, and the cost of an evaluation does not depend on the position.
+ *
+ * @license
+ * All rights reserved. Read LICENSE.txt file for the license terms.
+ *
+ * Changelog:
+ *
+ * [18/10/2026]     [miguelgarcia]
+ * Initial version
+ *
+ */
+
+#ifndef INCLUDE_RANGESET_H_
+#define INCLUDE_RANGESET_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+/** Number of 64-bit words of the bitmask of a set of n targets */
+#define RANGESET_WORDS(n)   (((n) + 63) / 64)
+
+/** Set of targets */
+typedef struct {
+
+    /** ECEF X of the centers */
+    float* x;
+    /** ECEF Y of the centers */
+    float* y;
+    /** ECEF Z of the centers */
+    float* z;
+    /** Squared ranges in square meters, negative in the padding */
+    float* range_sq;
+    /** User ID of each target */
+    uint32_t* ids;
+    /** Number of targets */
+    uint32_t n;
+
+} rangeset_st;
+
+/**
+ * @brief Build a set
+ * @param [out] s       Set
+ * @param [in]  ids     User ID of each target, or NULL to use the index of the target
+ * @param [in]  ecef    ECEF centers (x, y, z) * n
+ * @param [in]  ranges  Range of each target in meters
+ * @param [in]  n       Number of targets
+ * @return Zero on success, Otherwise a negative value
+ */
+int rangeset_build(rangeset_st* s, const uint32_t* ids, const float* ecef, const float* ranges, uint32_t n);
+
+/**
+ * @brief Build a set with the targets of the target table. The ID of each target is its index in the table.
+ * @param [out] s  Set
+ * @return Zero on success, Otherwise a negative value
+ */
+int rangeset_build_targets(rangeset_st* s);
+
+/**
+ * @brief Release a set
+ * @param [in] s  Set
+ */
+void rangeset_free(rangeset_st* s);
+
+/**
+ * @brief Get the targets in range of an ECEF position, as a bitmask
+ * @param [in]  s     Set
+ * @param [in]  x     ECEF X
+ * @param [in]  y     ECEF Y
+ * @param [in]  z     ECEF Z
+ * @param [out] mask  Bit i is set if target i is in range. Room for RANGESET_WORDS(n) words
+ * @return Number of targets in range
+ */
+uint32_t rangeset_evaluate(const rangeset_st* s, float x, float y, float z, uint64_t* mask);
+
+/**
+ * @brief Get the IDs of the targets in range of an ECEF position
+ * @param [in]  s    Set
+ * @param [in]  x    ECEF X
+ * @param [in]  y    ECEF Y
+ * @param [in]  z    ECEF Z
+ * @param [out] ids  IDs of the targets in range, in target order
+ * @param [in]  max  Size of the IDs buffer
+ * @return Number of targets in range. If it is larger than max, only max IDs are written
+ */
+uint32_t rangeset_find(const rangeset_st* s, float x, float y, float z, uint32_t* ids, uint32_t max);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* INCLUDE_RANGESET_H_ */
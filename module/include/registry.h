@@ -0,0 +1,151 @@
+/**
+ * @file registry.h
+ *
+ * Device registry
+ *
+ * Map of 64-bit device keys to indexes of a dense state array owned by the caller. The map is a Robin Hood hash table
+ * with open addressing: each slot holds the key inline with its index and its probe distance, so a lookup reads a few
+ * consecutive slots of one or two cache lines, and it stops as soon as it finds a slot closer to its home than the key
+ * would be. A removed key shifts back the next slots of its probe sequence, so the table has no deleted slots. The
+ * indexes of the removed keys are reused by the next keys, so the state array stays dense.
+ *
+ * The table grows without stopping the lookups: when it is 3/4 full, a table of twice the size is allocated and the
+ * new keys go there, and each insertion moves REGISTRY_MIGRATE_STEP slots of the old table to the new one. A lookup
+ * checks the new table, then the old one until all its slots are moved.
+ *
+ * The writers (insert and remove) are serialized by a lock. The lookups take no lock: they can run from any thread
+ * at the same time as a writer. A writer increments a sequence counter before and after each change (seqlock), and a
+ * lookup that overlaps a change is repeated. The replaced tables are kept until registry_reclaim() or
+ * registry_free(), so a lookup never reads released memory.
+ *
+ * @license
+ * All rights reserved. Read LICENSE.txt file for the license terms.
+ *
+ * Changelog:
+ *
+ * [18/10/2026]     [miguelgarcia]
+ * Initial version
+ *
+ */
+
+#ifndef INCLUDE_REGISTRY_H_
+#define INCLUDE_REGISTRY_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <pthread.h>
+#include <stdint.h>
+
+/** Index of a key that is not in the registry */
+#define REGISTRY_NONE           0xFFFFFFFFu
+/** Slots of the old table moved to the new one by each insertion while the table grows */
+#define REGISTRY_MIGRATE_STEP   64
+
+/** Slot of a table */
+typedef struct {
+
+    /** Device key */
+    uint64_t key;
+    /** Index of the key, REGISTRY_NONE if the key was removed from an old table */
+    uint32_t index;
+    /** Probe distance plus one, zero if the slot is empty */
+    uint32_t dist;
+
+} registry_slot_st;
+
+/** Hash table */
+typedef struct registry_table {
+
+    /** Slots */
+    registry_slot_st* slots;
+    /** Number of slots minus one, the size is a power of two */
+    uint32_t mask;
+    /** Number of keys */
+    uint32_t count;
+    /** Next replaced table */
+    struct registry_table* next;
+
+} registry_table_st;
+
+/** Device registry */
+typedef struct {
+
+    /** Table of the new keys */
+    registry_table_st* table;
+    /** Table being moved to the new one, NULL if the table is not growing */
+    registry_table_st* old;
+    /** Next slot of the old table to move */
+    uint32_t migrated;
+    /** Sequence counter, odd while a writer changes the tables */
+    uint32_t seq;
+    /** Lock of the writers */
+    pthread_mutex_t lock;
+
+    /** Number of keys */
+    uint32_t count;
+    /** Number of indexes given, the size of the state array */
+    uint32_t indexes;
+    /** Indexes of the removed keys, to reuse */
+    uint32_t* reuse;
+    /** Number of indexes to reuse */
+    uint32_t nreuse;
+    /** Allocated indexes to reuse */
+    uint32_t reuse_capacity;
+
+    /** Replaced tables, not released yet */
+    registry_table_st* retired;
+
+} registry_st;
+
+/**
+ * @brief Initialize an empty registry
+ * @param [out] r         Registry
+ * @param [in]  capacity  Expected number of keys, it can grow later
+ * @return Zero on success, Otherwise a negative value
+ */
+int registry_init(registry_st* r, uint32_t capacity);
+
+/**
+ * @brief Release a registry. No lookup can use it anymore
+ * @param [in] r  Registry
+ */
+void registry_free(registry_st* r);
+
+/**
+ * @brief Add a key to the registry, if it is not in it
+ * @param [in] r    Registry
+ * @param [in] key  Device key
+ * @return Index of the key, lower than the number of indexes given. REGISTRY_NONE if there is no memory
+ */
+uint32_t registry_insert(registry_st* r, uint64_t key);
+
+/**
+ * @brief Remove a key from the registry. Its index is given to a next key
+ * @param [in] r    Registry
+ * @param [in] key  Device key
+ * @return Index of the key, or REGISTRY_NONE if it is not in the registry
+ */
+uint32_t registry_remove(registry_st* r, uint64_t key);
+
+/**
+ * @brief Find the index of a key. It takes no lock, and it can be called at the same time as a writer
+ * @param [in] r    Registry
+ * @param [in] key  Device key
+ * @return Index of the key, or REGISTRY_NONE if it is not in the registry
+ */
+uint32_t registry_find(const registry_st* r, uint64_t key);
+
+/**
+ * @brief Release the replaced tables. It must not be called while a lookup runs
+ * @param [in] r  Registry
+ * @return Number of released tables
+ */
+uint32_t registry_reclaim(registry_st* r);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* INCLUDE_REGISTRY_H_ */
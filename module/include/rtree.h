@@ -0,0 +1,151 @@
+/**
+ * @file rtree.h
+ *
+ * Bulk-loaded R-tree of bounding boxes
+ *
+ * Static R-tree over ECEF axis-aligned boxes, bulk-loaded with Sort-Tile-Recursive (STR): the boxes are sorted by the
+ * X of their centers and cut in slabs, each slab is sorted by Y and cut in runs, each run is sorted by Z and packed in
+ * full nodes, and the same is repeated with the nodes of each level up to the root. Every node is full except the last
+ * one of each level, and sibling nodes hardly overlap.
+ *
+ * The nodes are stored in one flat array, without pointers: the leaves first, then every level up to the root, which
+ * is the last node. The children of a node are contiguous, so a node only stores its first child and the number of
+ * children. Each node holds the boxes of its RTREE_FANOUT children as a structure of arrays, one cache line per
+ * coordinate, so the children of a node are tested at once by the SIMD box kernel of the dispatch module.
+ *
+ * A point query returns the IDs of the boxes that contain the point, the candidates of an exact containment test. A
+ * box query returns the IDs of the boxes that overlap a box, the candidates of a search within a distance.
+ *
+ * @license
+ * All rights reserved. Read LICENSE.txt file for the license terms.
+ *
+ * Changelog:
+ *
+ * [18/10/2026]     [miguelgarcia]
+ * Initial version
+ *
+ * [18/10/2026]     [miguelgarcia]
+ * Box queries
+ *
+ */
+
+#ifndef INCLUDE_RTREE_H_
+#define INCLUDE_RTREE_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+/** Max number of children of a node: one cache line of floats, the width of the box kernel */
+#define RTREE_FANOUT    16
+/** Max height of a tree, enough for 2^32 boxes */
+#define RTREE_MAX_DEPTH 9
+
+/**
+ * Box visitor
+ * @param [in] id   ID of a box that contains the position, or that overlaps the box of the query
+ * @param [in] ctx  User context
+ */
+typedef void (*rtree_visit_cb)(uint32_t id, void* ctx);
+
+/** Axis-aligned box */
+typedef struct {
+
+    /** Min ECEF (x, y, z) */
+    float min[3];
+    /** Max ECEF (x, y, z) */
+    float max[3];
+
+} rtree_box_st;
+
+/** Node of the tree */
+typedef struct {
+
+    /** Min (x, y, z) of the boxes of the children */
+    float min[3][RTREE_FANOUT];
+    /** Max (x, y, z) of the boxes of the children */
+    float max[3][RTREE_FANOUT];
+    /** First child: a node, or an item if the node is a leaf */
+    uint32_t first;
+    /** Number of children */
+    uint32_t count;
+    /** Padding to a multiple of the cache line */
+    uint32_t reserved[14];
+
+} rtree_node_st;
+
+/** Tree */
+typedef struct {
+
+    /** Nodes: the leaves, then every level up to the root */
+    rtree_node_st* nodes;
+    /** Number of nodes. The root is the last one */
+    uint32_t nnodes;
+    /** Number of leaves */
+    uint32_t nleaves;
+    /** Box IDs, in leaf order */
+    uint32_t* items;
+    /** Number of boxes */
+    uint32_t n;
+    /** Number of levels */
+    uint32_t depth;
+
+} rtree_st;
+
+/**
+ * @brief Build a tree. The ID of each box is its index in the boxes.
+ * @param [out] t        Tree
+ * @param [in]  boxes    Boxes
+ * @param [in]  n        Number of boxes
+ * @param [in]  threads  Number of worker threads, zero to use all the processors
+ * @return Zero on success, Otherwise a negative value
+ */
+int rtree_build(rtree_st* t, const rtree_box_st* boxes, uint32_t n, uint32_t threads);
+
+/**
+ * @brief Release a tree
+ * @param [in] t  Tree
+ */
+void rtree_free(rtree_st* t);
+
+/**
+ * @brief Find the boxes that contain an ECEF position
+ * @param [in]  t    Tree
+ * @param [in]  x    ECEF X
+ * @param [in]  y    ECEF Y
+ * @param [in]  z    ECEF Z
+ * @param [out] ids  IDs of the boxes that contain the position, not sorted
+ * @param [in]  max  Size of the IDs buffer
+ * @return Number of boxes that contain the position. If it is larger than max, only max IDs are written
+ */
+uint32_t rtree_query(const rtree_st* t, float x, float y, float z, uint32_t* ids, uint32_t max);
+
+/**
+ * @brief Call a function with every box that contains an ECEF position
+ * @param [in] t    Tree
+ * @param [in] x    ECEF X
+ * @param [in] y    ECEF Y
+ * @param [in] z    ECEF Z
+ * @param [in] cb   Function called with the ID of each box
+ * @param [in] ctx  User context passed to the function
+ * @return Number of boxes that contain the position
+ */
+uint32_t rtree_visit(const rtree_st* t, float x, float y, float z, rtree_visit_cb cb, void* ctx);
+
+/**
+ * @brief Call a function with every box that overlaps a box
+ * @param [in] t    Tree
+ * @param [in] box  Box of the query
+ * @param [in] cb   Function called with the ID of each box
+ * @param [in] ctx  User context passed to the function
+ * @return Number of boxes that overlap the box of the query
+ */
+uint32_t rtree_visit_box(const rtree_st* t, const rtree_box_st* box, rtree_visit_cb cb, void* ctx);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* INCLUDE_RTREE_H_ */
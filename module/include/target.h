@@ -13,6 +13,9 @@
  * [27/02/2021]     [miguelgarcia]
  * Initial version
  *
+ * [18/10/2026]     [miguelgarcia]
+ * Geoidal separation of the targets
+ *
  */
 
 #ifndef INCLUDE_TARGET_H_
@@ -22,8 +25,30 @@
 extern "C" {
 #endif
 
+#include <stdint.h>
 #include "position.h"
 
+/**
+ * Target with its local frame precomputed. The target table is generated at build time from a CSV list of targets
+ * (see module/targets.csv), so it lives in flash and the device does not do any target-side math at runtime.
+ */
+typedef struct {
+
+    /** Geodetic position. Latitude and Longitude in decimal degrees, MSL Altitude in meters */
+    position_st llh;
+    /** Origin of the local frame in ECEF (x, y, z), at the ellipsoidal height of the target */
+    float ecef[3];
+    /** ECEF to ENU rotation matrix. Rows are the East, North and Up axes */
+    float rotation[3][3];
+    /** Range distance in meters */
+    float range;
+    /** Squared range distance in square meters */
+    float range_sq;
+    /** Geoidal separation at the target in meters. Ellipsoidal height is MSL Altitude plus the separation */
+    float separation;
+
+} target_entry_st;
+
 /**
  * @brief Return the target position
  * @return Target position
@@ -36,6 +61,46 @@ position_st target_get_position(void);
  */
 uint32_t target_get_range(void);
 
+/**
+ * @brief Return the number of targets of the target table
+ * @return Number of targets
+ */
+uint32_t target_get_count(void);
+
+/**
+ * @brief Return a target of the target table
+ * @param [in] idx  Target index, lower than target_get_count()
+ * @return Target entry, or NULL if the index is out of the table
+ */
+const target_entry_st* target_get_entry(uint32_t idx);
+
+/**
+ * @brief Converts the Earth-Centered Earth-Fixed (ECEF) coordinates (x, y, z) to East-North-Up coordinates in the
+ * Local Tangent Plane of the target.
+ *
+ * @param [in]  t       Target entry
+ * @param [in]  x       ECEF X
+ * @param [in]  y       ECEF Y
+ * @param [in]  z       ECEF Z
+ * @param [out] xEast   ENU East coordinate
+ * @param [out] yNorth  ENU North coordinate
+ * @param [out] zUp     ENU UP coordinate
+ */
+void target_ecef_to_enu(const target_entry_st* t, float x, float y, float z,
+                        float* xEast, float* yNorth, float* zUp);
+
+/**
+ * @brief Check if an ECEF position is within the range of the target. The rotation to ENU keeps the distances, so the
+ * check is done directly in ECEF against the squared range.
+ *
+ * @param [in] t  Target entry
+ * @param [in] x  ECEF X
+ * @param [in] y  ECEF Y
+ * @param [in] z  ECEF Z
+ * @return Positive value if the position is on range, Otherwise Zero.
+ */
+uint8_t target_is_on_range(const target_entry_st* t, float x, float y, float z);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,177 @@
+/**
+ * @file targetset.h
+ *
+ * Hot-swappable target set
+ *
+ * A target set holds the current snapshot of the fences checked by the devices. A snapshot is an immutable geofence
+ * set with its indexes built and a version number. The readers (the threads that evaluate device positions) reach the
+ * current snapshot through an atomic pointer, and an administrator can publish a new snapshot at any time: the
+ * evaluations in progress finish with the snapshot they started with, and the next ones use the new one. The readers
+ * never take a lock nor wait for the writers.
+ *
+ * The old snapshots are released with epoch-based reclamation. The target set has a global epoch, and each reader has
+ * a slot where it writes the epoch when it starts a read section and clears it when the section ends. Publishing a
+ * snapshot swaps the pointer and then advances the epoch, so the readers that may still use the old snapshot are the
+ * ones with an epoch not newer than the epoch of the swap. The old snapshot is kept in a retired list until no reader
+ * slot has such an epoch, and then it is released. The retired list is checked on every publish, and by
+ * targetset_reclaim().
+ *
+ * Every access to the pointer, the epoch and the reader slots is sequentially consistent, so a reader that writes its
+ * slot after the writer checked it reads the new pointer. The writers are serialized by a mutex.
+ *
+ * @license
+ * All rights reserved. Read LICENSE.txt file for the license terms.
+ *
+ * Changelog:
+ *
+ * [18/10/2026]     [miguelgarcia]
+ * Initial version
+ *
+ */
+
+#ifndef INCLUDE_TARGETSET_H_
+#define INCLUDE_TARGETSET_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <pthread.h>
+#include <stdint.h>
+#include "geofence.h"
+
+/** Max number of readers of a target set */
+#define TARGETSET_MAX_READERS   64
+
+/** Snapshot of the fences */
+typedef struct targetset_snapshot {
+
+    /** Fences, with the indexes built. They must not be modified */
+    geofence_set_st fences;
+    /** Version, starting at 1 for the first published snapshot */
+    uint64_t version;
+    /** Epoch when the snapshot was replaced */
+    uint64_t retired;
+    /** Next snapshot of the retired list */
+    struct targetset_snapshot* next;
+
+} targetset_snapshot_st;
+
+/** Reader slot, one cache line so the readers do not share lines */
+typedef struct {
+
+    /** Epoch of the read section in progress, zero outside the read sections */
+    uint64_t epoch;
+    /** Positive value if the slot is registered */
+    uint32_t used;
+    /** Padding up to the cache line */
+    uint8_t reserved[52];
+
+} targetset_reader_st;
+
+/** Target set */
+typedef struct {
+
+    /** Current snapshot, NULL before the first publish */
+    targetset_snapshot_st* current;
+    /** Global epoch, starting at 1 */
+    uint64_t epoch;
+    /** Version of the last published snapshot */
+    uint64_t version;
+    /** Replaced snapshots not released yet */
+    targetset_snapshot_st* retired;
+    /** Lock of the writers */
+    pthread_mutex_t lock;
+    /** Reader slots */
+    targetset_reader_st readers[TARGETSET_MAX_READERS];
+
+} targetset_st;
+
+/**
+ * @brief Initialize a target set without snapshot
+ * @param [out] t  Target set
+ * @return Zero on success, Otherwise a negative value
+ */
+int targetset_init(targetset_st* t);
+
+/**
+ * @brief Release a target set and all its snapshots. No reader can use it anymore
+ * @param [in] t  Target set
+ */
+void targetset_free(targetset_st* t);
+
+/**
+ * @brief Register a reader of a target set. Each thread that reads the set needs its own reader
+ * @param [in] t  Target set
+ * @return Reader index, Otherwise a negative value if all the slots are registered
+ */
+int targetset_reader_register(targetset_st* t);
+
+/**
+ * @brief Unregister a reader of a target set. The reader must be outside the read sections
+ * @param [in] t       Target set
+ * @param [in] reader  Reader index
+ */
+void targetset_reader_unregister(targetset_st* t, int reader);
+
+/**
+ * @brief Start a read section and get the current snapshot. The snapshot is valid until targetset_read_end(). The read
+ * sections of a reader cannot be nested.
+ *
+ * @param [in] t       Target set
+ * @param [in] reader  Reader index
+ * @return Current snapshot, or NULL if nothing was published
+ */
+targetset_snapshot_st* targetset_read_begin(targetset_st* t, int reader);
+
+/**
+ * @brief End a read section. The snapshot of the section must not be used anymore
+ * @param [in] t       Target set
+ * @param [in] reader  Reader index
+ */
+void targetset_read_end(targetset_st* t, int reader);
+
+/**
+ * @brief Find the fences of the current snapshot that contain an ECEF position, in a read section
+ * @param [in]  t        Target set
+ * @param [in]  reader   Reader index
+ * @param [in]  x        ECEF X
+ * @param [in]  y        ECEF Y
+ * @param [in]  z        ECEF Z
+ * @param [out] ids      IDs of the fences that contain the position
+ * @param [in]  max      Size of the IDs buffer
+ * @param [out] version  Version of the snapshot, zero if nothing was published. It can be NULL
+ * @return Number of fences that contain the position. If it is larger than max, only max IDs are written
+ */
+uint32_t targetset_evaluate(targetset_st* t, int reader, float x, float y, float z, uint32_t* ids, uint32_t max,
+                            uint64_t* version);
+
+/**
+ * @brief Publish a new snapshot. The indexes of the fences are built, and the fences are moved into the snapshot: the
+ * set given is left empty, as if it was released. The replaced snapshot is released once no reader uses it.
+ *
+ * @param [in] t       Target set
+ * @param [in] fences  Fences of the snapshot
+ * @return Zero on success, Otherwise a negative value and the fences are not moved
+ */
+int targetset_publish(targetset_st* t, geofence_set_st* fences);
+
+/**
+ * @brief Publish a snapshot with the targets of the target table (see geofence_add_targets())
+ * @param [in] t  Target set
+ * @return Zero on success, Otherwise a negative value
+ */
+int targetset_publish_targets(targetset_st* t);
+
+/**
+ * @brief Release the replaced snapshots that no reader uses
+ * @param [in] t  Target set
+ * @return Number of replaced snapshots not released yet
+ */
+uint32_t targetset_reclaim(targetset_st* t);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* INCLUDE_TARGETSET_H_ */
@@ -0,0 +1,191 @@
+/**
+ * @file tcpingest.h
+ *
+ * TCP ingestion server
+ *
+ * Receives the NMEA streams of many GPS modules over TCP and feeds them to a fleet engine (see fleet.h). Each accepted
+ * connection is a device: its device ID is given by a user callback from the peer address, or it is a sequential
+ * number if there is no callback.
+ *
+ * The sockets are non-blocking and served by a few event-loop threads, each one with its own epoll set. The listening
+ * socket is in every set in exclusive mode, so a new connection wakes up one loop, and the connection stays in that
+ * loop until it is closed. The connections are edge-triggered: on each readiness event the loop reads the socket
+ * until it is drained, in chunks of TCPINGEST_READ_BYTES, and submits each chunk as a whole to the fleet engine. The
+ * fleet engine keeps the parser state of the device between chunks, so the sentences can be split at any byte.
+ *
+ * There is no backpressure per connection: fleet_submit() waits while the queue of the shard of the device is full,
+ * and it waits on the loop thread, so a slow shard stalls every connection of the loop until its worker takes the
+ * queue. Meanwhile the sockets of the loop are not read, and the peers are held back by the TCP flow control once the
+ * socket buffers are full. Each wait lasts until the worker of the shard finishes the batch it took, up to
+ * FLEET_QUEUE_BYTES.
+ *
+ * A peer that closes its side of the connection (even if it only shuts down its writes) is closed at once. A peer
+ * that sends nothing for the idle timeout, a slow peer or a half-open one whose host is gone without closing the
+ * connection, is closed by the loop: each loop keeps its connections in the order of their last data, so the
+ * expired ones are found without a scan of all of them.
+ *
+ * The number of concurrent connections is limited by the open file limit of the process (RLIMIT_NOFILE) and by the
+ * listen backlog of the system (somaxconn); each connection takes a few tens of bytes besides its socket. When the
+ * process is out of descriptors, a loop frees a spare descriptor it keeps for this case, accepts and closes each
+ * pending connection with it, and opens it again: the peers are refused at once instead of waiting, and the listening
+ * socket does not stay ready. If the spare descriptor is lost to another thread, the loop stops watching the listening
+ * socket until one of its connections is closed, or for TCPINGEST_PAUSE_MS.
+ *
+ * @license
+ * All rights reserved. Read LICENSE.txt file for the license terms.
+ *
+ * Changelog:
+ *
+ * [18/10/2026]     [miguelgarcia]
+ * Initial version
+ *
+ * [18/10/2026]     [miguelgarcia]
+ * Refuse the connections when the process is out of descriptors
+ *
+ * [18/10/2026]     [miguelgarcia]
+ * Stall of a loop by a full shard queue
+ *
+ */
+
+#ifndef INCLUDE_TCPINGEST_H_
+#define INCLUDE_TCPINGEST_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <pthread.h>
+#include <stdint.h>
+#include <sys/socket.h>
+#include "fleet.h"
+
+/** Max number of event-loop threads */
+#define TCPINGEST_MAX_LOOPS     16
+/** Size of the read buffer of a loop. Each read is submitted as a whole to the fleet engine */
+#define TCPINGEST_READ_BYTES    (1 << 16)
+/** Max number of events taken by a loop at once */
+#define TCPINGEST_MAX_EVENTS    256
+/** Time a loop stops watching the listening socket when it cannot refuse the connections, in milliseconds */
+#define TCPINGEST_PAUSE_MS      100
+
+/**
+ * Callback that gives the device ID of a new connection. It is called from the event-loop thread that accepts the
+ * connection.
+ * @param [in] peer      Address of the peer
+ * @param [in] peer_len  Length of the address
+ * @param [in] ctx       User context
+ * @return Device ID of the connection
+ */
+typedef uint32_t (*tcpingest_connect_cb)(const struct sockaddr* peer, socklen_t peer_len, void* ctx);
+
+/** Counters of the server */
+typedef struct {
+
+    /** Accepted connections */
+    uint64_t accepted;
+    /** Closed connections, including the expired ones */
+    uint64_t closed;
+    /** Connections closed by the idle timeout */
+    uint64_t timeouts;
+    /** Connections refused because the process is out of descriptors */
+    uint64_t refused;
+    /** Received bytes */
+    uint64_t bytes;
+
+} tcpingest_stats_st;
+
+struct tcpingest;
+struct tcpingest_conn;
+
+/** Event loop */
+typedef struct {
+
+    /** Server */
+    struct tcpingest* server;
+    /** Event-loop thread */
+    pthread_t thread;
+    /** epoll set */
+    int epoll;
+    /** Event to stop the loop */
+    int wake;
+    /** Read buffer */
+    char* buf;
+    /** Spare descriptor, freed to refuse the connections when the process is out of descriptors */
+    int spare;
+    /** Positive value while the loop does not watch the listening socket */
+    uint8_t paused;
+    /** Time to watch the listening socket again in milliseconds */
+    uint64_t resume_at;
+    /** Connection with the oldest data */
+    struct tcpingest_conn* oldest;
+    /** Connection with the newest data */
+    struct tcpingest_conn* newest;
+    /** Counters of the loop */
+    tcpingest_stats_st stats;
+
+} tcpingest_loop_st;
+
+/** TCP ingestion server */
+typedef struct tcpingest {
+
+    /** Fleet engine fed by the server */
+    fleet_st* fleet;
+    /** Listening socket */
+    int listen;
+    /** Listening port */
+    uint16_t port;
+    /** Idle timeout in milliseconds, zero for none */
+    uint32_t idle_ms;
+    /** Callback with each new connection, NULL for sequential device IDs */
+    tcpingest_connect_cb cb;
+    /** User context of the callback */
+    void* ctx;
+    /** Last sequential device ID */
+    uint32_t last_device;
+
+    /** Event loops */
+    tcpingest_loop_st loops[TCPINGEST_MAX_LOOPS];
+    /** Number of event loops */
+    uint32_t nloops;
+
+} tcpingest_st;
+
+/**
+ * @brief Start a TCP ingestion server listening on all the addresses
+ * @param [out] t        Server
+ * @param [in]  fleet    Fleet engine fed by the server. It must outlive the server
+ * @param [in]  port     Listening port, zero for a port given by the system (see tcpingest_port())
+ * @param [in]  loops    Number of event-loop threads, zero for one. TCPINGEST_MAX_LOOPS at most
+ * @param [in]  idle_ms  Idle timeout of a connection in milliseconds, zero for none
+ * @param [in]  cb       Callback that gives the device ID of a new connection, or NULL for sequential IDs from one
+ * @param [in]  ctx      User context passed to the callback
+ * @return Zero on success, Otherwise a negative value
+ */
+int tcpingest_init(tcpingest_st* t, fleet_st* fleet, uint16_t port, uint32_t loops, uint32_t idle_ms,
+        tcpingest_connect_cb cb, void* ctx);
+
+/**
+ * @brief Stop the server and close all its connections. The bytes already received are submitted to the fleet engine
+ * @param [in] t  Server
+ */
+void tcpingest_free(tcpingest_st* t);
+
+/**
+ * @brief Return the listening port of the server
+ * @param [in] t  Server
+ * @return Port
+ */
+uint16_t tcpingest_port(const tcpingest_st* t);
+
+/**
+ * @brief Get the counters of the server. It can be called from any thread
+ * @param [in]  t      Server
+ * @param [out] stats  Counters
+ */
+void tcpingest_get_stats(tcpingest_st* t, tcpingest_stats_st* stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* INCLUDE_TCPINGEST_H_ */
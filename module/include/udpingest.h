@@ -0,0 +1,161 @@
+/**
+ * @file udpingest.h
+ *
+ * UDP ingestion listener
+ *
+ * Receives NMEA sentences broadcast over UDP, one or a few per datagram, and feeds them to a fleet engine (see
+ * fleet.h). Each source address (IPv4 address and port) is a device: its device ID is given by a user callback from
+ * the source address, or it is a sequential number if there is no callback. The fleet engine keeps the parser context
+ * of each device, so a sentence can be split across datagrams of the same source.
+ *
+ * The listener opens several sockets bound to the same port with SO_REUSEPORT, and each socket is served by its own
+ * worker thread. The system spreads the datagrams over the sockets by a hash of their addresses, so the datagrams of a
+ * source always go to the same worker, in order. A worker takes up to UDPINGEST_BATCH datagrams with each recvmmsg()
+ * call, and finds the device of each one in its own registry of sources (see registry.h), that no other thread uses.
+ *
+ * @license
+ * All rights reserved. Read LICENSE.txt file for the license terms.
+ *
+ * Changelog:
+ *
+ * [18/10/2026]     [miguelgarcia]
+ * Initial version
+ *
+ */
+
+#ifndef INCLUDE_UDPINGEST_H_
+#define INCLUDE_UDPINGEST_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <pthread.h>
+#include <stdint.h>
+#include <sys/socket.h>
+#include "fleet.h"
+#include "registry.h"
+
+/** Max number of worker threads, one socket each */
+#define UDPINGEST_MAX_WORKERS   16
+/** Max number of datagrams taken by each recvmmsg() call */
+#define UDPINGEST_BATCH         64
+/** Max size of a datagram. The bytes of a larger datagram are dropped */
+#define UDPINGEST_DGRAM_BYTES   2048
+/** Receive buffer requested for each socket, limited by the system (rmem_max) */
+#define UDPINGEST_RCVBUF        (1 << 22)
+
+/**
+ * Callback that gives the device ID of a new source. It is called from the worker thread that receives the first
+ * datagram of the source.
+ * @param [in] source      Address of the source
+ * @param [in] source_len  Length of the address
+ * @param [in] ctx         User context
+ * @return Device ID of the source
+ */
+typedef uint32_t (*udpingest_source_cb)(const struct sockaddr* source, socklen_t source_len, void* ctx);
+
+/** Counters of the listener */
+typedef struct {
+
+    /** Received datagrams */
+    uint64_t datagrams;
+    /** recvmmsg() calls that returned datagrams */
+    uint64_t batches;
+    /** Datagrams larger than UDPINGEST_DGRAM_BYTES */
+    uint64_t truncated;
+    /** Received bytes */
+    uint64_t bytes;
+    /** Different sources */
+    uint64_t sources;
+
+} udpingest_stats_st;
+
+struct udpingest;
+struct udpingest_batch;
+
+/** Worker with its socket */
+typedef struct {
+
+    /** Listener */
+    struct udpingest* listener;
+    /** Worker thread */
+    pthread_t thread;
+    /** Socket */
+    int fd;
+    /** Event to stop the worker */
+    int wake;
+    /** Buffers and headers of a batch of datagrams */
+    struct udpingest_batch* batch;
+
+    /** Registry of the sources of the worker, by address */
+    registry_st sources;
+    /** Device IDs, by registry index */
+    uint32_t* devices;
+    /** Allocated device IDs */
+    uint32_t capacity;
+    /** Counters of the worker */
+    udpingest_stats_st stats;
+
+} udpingest_worker_st;
+
+/** UDP ingestion listener */
+typedef struct udpingest {
+
+    /** Fleet engine fed by the listener */
+    fleet_st* fleet;
+    /** Listening port */
+    uint16_t port;
+    /** Callback with each new source, NULL for sequential device IDs */
+    udpingest_source_cb cb;
+    /** User context of the callback */
+    void* ctx;
+    /** Last sequential device ID */
+    uint32_t last_device;
+
+    /** Workers */
+    udpingest_worker_st workers[UDPINGEST_MAX_WORKERS];
+    /** Number of workers */
+    uint32_t nworkers;
+
+} udpingest_st;
+
+/**
+ * @brief Start a UDP ingestion listener on all the addresses
+ * @param [out] u        Listener
+ * @param [in]  fleet    Fleet engine fed by the listener. It must outlive the listener
+ * @param [in]  port     Listening port, zero for a port given by the system (see udpingest_port())
+ * @param [in]  workers  Number of sockets and worker threads, zero to use parallel_default_threads().
+ *                       UDPINGEST_MAX_WORKERS at most
+ * @param [in]  cb       Callback that gives the device ID of a new source, or NULL for sequential IDs from one
+ * @param [in]  ctx      User context passed to the callback
+ * @return Zero on success, Otherwise a negative value
+ */
+int udpingest_init(udpingest_st* u, fleet_st* fleet, uint16_t port, uint32_t workers, udpingest_source_cb cb,
+        void* ctx);
+
+/**
+ * @brief Stop the listener and close its sockets. The datagrams already received are submitted to the fleet engine
+ * @param [in] u  Listener
+ */
+void udpingest_free(udpingest_st* u);
+
+/**
+ * @brief Return the listening port of the listener
+ * @param [in] u  Listener
+ * @return Port
+ */
+uint16_t udpingest_port(const udpingest_st* u);
+
+/**
+ * @brief Get the counters of the listener. It can be called from any thread
+ * @param [in]  u      Listener
+ * @param [out] stats  Counters
+ */
+void udpingest_get_stats(udpingest_st* u, udpingest_stats_st* stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* INCLUDE_UDPINGEST_H_ */
@@ -13,6 +13,9 @@
  * [01/03/2021]     [miguelgarcia]
  * Initial version
  *
+ * [18/10/2026]     [miguelgarcia]
+ * Per-fence state
+ *
  */
 
 #ifndef INCLUDE_USERIF_H_
@@ -25,6 +28,9 @@ extern "C" {
 #include <stdint.h>
 #include "position.h"
 
+/** Max number of reached fences kept by the user interface */
+#define USERIF_MAX_FENCES   64
+
 /**
  * @brief Update the USER INTERFACE with the status of the Target. When the target is reached, the argument must be
  * positive. If the device is out of range of the target, the argument must be zero.
@@ -41,6 +47,29 @@ void userif_set_target_reached(uint8_t reached);
  */
 uint8_t userif_get_target_reached(void);
 
+/**
+ * @brief Update the USER INTERFACE with the fences that contain the device. Only the first USERIF_MAX_FENCES are kept.
+ *
+ * @param [in] ids  IDs of the reached fences
+ * @param [in] n    Number of reached fences
+ */
+void userif_set_fences_reached(const uint32_t* ids, uint32_t n);
+
+/**
+ * @brief Return the fences that contain the device
+ * @param [out] ids  IDs of the reached fences
+ * @param [in]  max  Size of the IDs buffer
+ * @return Number of reached fences. If it is larger than max, only max IDs are written
+ */
+uint32_t userif_get_fences_reached(uint32_t* ids, uint32_t max);
+
+/**
+ * @brief Return the state of a fence
+ * @param [in] id  Fence ID
+ * @return Positive value if the fence contains the device, Otherwise Zero.
+ */
+uint8_t userif_is_fence_reached(uint32_t id);
+
 /**
  * @brief Update the USER INTERFACE with the status of the GPS. If the position is not valid (FIX==0), or it is
  * valid (FIX>0)
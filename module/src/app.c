@@ -13,16 +13,75 @@
  * [27/02/2021]     [miguelgarcia]
  * Initial version
  *
+ * [18/10/2026]     [miguelgarcia]
+ * Multi-target geofence set
+ *
+ * [18/10/2026]     [miguelgarcia]
+ * Target table fences scanned with the SIMD range kernel
+ *
+ * [18/10/2026]     [miguelgarcia]
+ * Lazy evaluation of the fences
+ *
+ * [18/10/2026]     [miguelgarcia]
+ * Hot-swappable target set
+ *
+ * [18/10/2026]     [miguelgarcia]
+ * Fence occupancy index
+ *
+ * [18/10/2026]     [miguelgarcia]
+ * Stationary device memo
+ *
  */
 
 /* -- Includes -- */
 #include <stdint.h>
+#include "fixmemo.h"
+#include "geofence.h"
+#include "lazyfence.h"
 #include "navigation.h"
+#include "occupancy.h"
 #include "position.h"
 #include "target.h"
+#include "targetset.h"
 #include "userif.h"
 #include "app.h"
 
+/* -- Local variables -- */
+
+/** Geoid grid, NULL if not available */
+static const geoid_st* geoid_ = NULL;
+/** Last geoid grid cell used by the device */
+static geoid_cache_st geoid_cache_;
+
+/** Fences of the targets of the target table. The table is small, so it is scanned without index */
+static geofence_set_st targets_;
+/** Fences checked on every new position */
+static geofence_set_st* fences_ = NULL;
+/** Positive value if the fences are evaluated lazily */
+static uint8_t lazy_ = 0;
+/** Lazy evaluator of the device */
+static lazyfence_st lazy_state_;
+/** Target set checked instead of the fences, NULL if not used */
+static targetset_st* targetset_ = NULL;
+/** Reader of the target set */
+static int reader_ = -1;
+/** Version of the last snapshot of the target set used */
+static uint64_t version_ = 0;
+/** Occupancy index updated with the transitions of the device, NULL if not used */
+static occupancy_st* occupancy_ = NULL;
+/** Device index in the occupancy index */
+static uint32_t device_ = 0;
+/** Positive value if the stationary memo is used */
+static uint8_t memo_enabled_ = 0;
+/** Stationary memo of the device */
+static fixmemo_st memo_;
+/** Number of valid positions */
+static uint32_t fixes_ = 0;
+
+/* -- Local functions -- */
+static uint32_t evaluate(geofence_set_st* fences, uint64_t version, position_st* llh, float separation,
+                         uint32_t* reached);
+
 
 /**
 * @brief Initialize the state of the GPSlocator
@@ -33,6 +92,144 @@ void app_init (
 {
     /* Initialize the Navigation component */
     navigation_reset();
+    geoid_cache_reset(&geoid_cache_);
+
+    /* Fences of the target table */
+    if (targets_.fences == NULL && geofence_set_init(&targets_, target_get_count()) == 0) {
+        geofence_add_targets(&targets_);
+        geofence_set_index(&targets_, geofence_index_scan);
+    }
+    if (fences_ == NULL) {
+        fences_ = &targets_;
+    }
+    lazyfence_reset(&lazy_state_);
+    fixmemo_init(&memo_, memo_.epsilon);
+    fixes_ = 0;
+}
+
+/**
+ * @brief Set the geoid grid used to get the ellipsoidal height of the device when the GPS module does not report the
+ * geoidal separation.
+ * @param [in] geoid  Geoid grid, or NULL to use the MSL altitude as ellipsoidal height
+ */
+void app_set_geoid (
+        const geoid_st* geoid
+)
+{
+    geoid_ = geoid;
+    geoid_cache_reset(&geoid_cache_);
+}
+
+/**
+ * @brief Set the fences checked on every new position. By default the fences are the targets of the target table.
+ * @param [in] fences  Set of fences, or NULL to use the targets of the target table
+ */
+void app_set_geofences (
+        geofence_set_st* fences
+)
+{
+    fences_ = (fences != NULL) ? fences : &targets_;
+    lazyfence_reset(&lazy_state_);
+    fixmemo_reset(&memo_);
+}
+
+/**
+ * @brief Enable the lazy evaluation of the fences (see lazyfence.h): a new position reuses the fences of the last
+ * evaluated one while the device cannot have crossed a fence boundary. It is disabled by default.
+ * @param [in] enable     Positive value to enable it, Zero to evaluate every position
+ * @param [in] max_speed  Max plausible speed of the device in m/s, zero for no bound
+ */
+void app_set_lazy_evaluation (
+        uint8_t enable,
+        float max_speed
+)
+{
+    lazy_ = enable;
+    lazyfence_init(&lazy_state_, max_speed);
+}
+
+/**
+ * @brief Set a target set checked instead of the fences on every new position (see targetset.h). Its snapshots can be
+ * replaced from other threads while the device is evaluated.
+ * @param [in] t  Target set, or NULL to check the fences again
+ * @return Zero on success, Otherwise a negative value if no reader of the target set is available
+ */
+int app_set_target_set (
+        targetset_st* t
+)
+{
+    if (targetset_ != NULL) {
+        targetset_reader_unregister(targetset_, reader_);
+    }
+    targetset_ = NULL;
+    reader_ = -1;
+    version_ = 0;
+    lazyfence_reset(&lazy_state_);
+    fixmemo_reset(&memo_);
+
+    if (t != NULL) {
+        reader_ = targetset_reader_register(t);
+        if (reader_ < 0) {
+            return -1;
+        }
+        targetset_ = t;
+    }
+    return 0;
+}
+
+/**
+ * @brief Set an occupancy index updated with the enter and exit transitions of the device (see occupancy.h). The device
+ * enters the fences that contain it now, and leaves the fences of the previous occupancy index.
+ * @param [in] o       Occupancy index, or NULL to stop updating it
+ * @param [in] device  Device index in the occupancy index
+ * @return Zero on success, Otherwise a negative value
+ */
+int app_set_occupancy (
+        occupancy_st* o,
+        uint32_t device
+)
+{
+    uint32_t reached[USERIF_MAX_FENCES];
+    uint32_t n = userif_get_fences_reached(reached, USERIF_MAX_FENCES);
+
+    n = (n < USERIF_MAX_FENCES) ? n : USERIF_MAX_FENCES;
+    if (occupancy_ != NULL) {
+        occupancy_update(occupancy_, device_, reached, n, NULL, 0);
+    }
+    occupancy_ = o;
+    device_ = device;
+    if (o != NULL) {
+        return occupancy_update(o, device, NULL, 0, reached, n);
+    }
+    return 0;
+}
+
+/**
+ * @brief Enable the stationary device memo (see fixmemo.h): a new position within epsilon of the last evaluated one
+ * reuses its fences. It is disabled by default.
+ * @param [in] enable   Positive value to enable it, Zero to evaluate every position
+ * @param [in] epsilon  Max distance to the last evaluated position in meters, zero for identical positions only
+ */
+void app_set_stationary_memo (
+        uint8_t enable,
+        float epsilon
+)
+{
+    memo_enabled_ = enable;
+    fixmemo_init(&memo_, epsilon);
+}
+
+/**
+ * @brief Get the counters of the GPSlocator since its initialization
+ * @param [out] stats  Counters
+ */
+void app_get_stats (
+        app_stats_st* stats
+)
+{
+    stats->fixes = fixes_;
+    stats->memo_hits = memo_.hits;
+    stats->memo_misses = memo_.misses;
 }
 
 /**
@@ -43,40 +240,106 @@ void app_step (
         char d
 )
 {
-    /* Target */
-    position_st target_llh;
     /* Device */
     position_st llh;
-    float enu[3];
 
     /* Update the navigation component */
     if ( navigation_add_nmea_char(d) ) {
 
-        uint8_t on_range = 0;
+        uint32_t reached[USERIF_MAX_FENCES];
+        uint32_t n = 0;
 
         /* New GGA data is available */
         llh = navigation_get_llh();
-        target_llh = target_get_position();
 
         /* LLH is valid if GPS fix is active */
         if (llh.is_valid) {
-            float dist;
-
-            /* Compute local ENU position with target as origin */
-            position_geodetic_to_enu (
-                    llh.latitude, llh.longitude, llh.altitude,
-                    target_llh.latitude, target_llh.longitude, target_llh.altitude,
-                    &enu[0], &enu[1], &enu[2]
-            );
-
-            /* Get distance to target */
-            dist = position_xyz_distance(0.0f,0.0f,0.0f,enu[0],enu[1],enu[2]);
-            on_range = (dist <= target_get_range())? 1 : 0;
+            float separation;
+            uint8_t reported = navigation_get_geoid_separation(&separation);
+
+            fixes_++;
+
+            /* Geoidal separation from the grid if the GPS module does not report it. A reported zero is kept */
+            if (!reported && geoid_ != NULL) {
+                separation = geoid_get_undulation(geoid_, &geoid_cache_, llh.latitude, llh.longitude);
+            }
+
+            if (targetset_ != NULL) {
+                /* The snapshot is not released while it is evaluated, even if a new one is published */
+                targetset_snapshot_st* snapshot = targetset_read_begin(targetset_, reader_);
+
+                if (snapshot != NULL) {
+                    /* The kept fences of the lazy evaluator are the ones of the previous snapshot */
+                    if (snapshot->version != version_) {
+                        version_ = snapshot->version;
+                        lazyfence_reset(&lazy_state_);
+                    }
+                    n = evaluate(&snapshot->fences, snapshot->version, &llh, separation, reached);
+                }
+                targetset_read_end(targetset_, reader_);
+            } else if (fences_ != NULL) {
+                n = evaluate(fences_, fences_->version, &llh, separation, reached);
+            }
+        }
+
+        /* Enter and exit transitions of the device, from the fences of the previous position */
+        if (occupancy_ != NULL) {
+            uint32_t previous[USERIF_MAX_FENCES];
+            uint32_t nprevious = userif_get_fences_reached(previous, USERIF_MAX_FENCES);
+
+            nprevious = (nprevious < USERIF_MAX_FENCES) ? nprevious : USERIF_MAX_FENCES;
+            occupancy_update(occupancy_, device_, previous, nprevious, reached,
+                             (n < USERIF_MAX_FENCES) ? n : USERIF_MAX_FENCES);
         }
 
         /* Update user interface */
         userif_set_gps_status(llh.is_valid);
-        userif_set_target_reached(on_range);
+        userif_set_target_reached((n > 0) ? 1 : 0);
+        userif_set_fences_reached(reached, n);
 
     }
-}
\ No newline at end of file
+}
+
+/**
+ * @brief Find the fences that contain the device
+ * @param fences      Set of fences
+ * @param version     Version of the set of fences
+ * @param llh         Device position, with the MSL altitude
+ * @param separation  Geoidal separation in meters
+ * @param reached     IDs of the fences that contain the device, USERIF_MAX_FENCES at most
+ * @return Number of fences that contain the device
+ */
+static uint32_t evaluate (
+        geofence_set_st* fences,
+        uint64_t version,
+        position_st* llh,
+        float separation,
+        uint32_t* reached
+)
+{
+    float xyz[3];
+    uint32_t n;
+
+    llh->altitude += separation;
+
+    /* A parked device reuses the fences of its last evaluated position */
+    if (memo_enabled_ && fixmemo_lookup(&memo_, fences, version, llh, reached, USERIF_MAX_FENCES, &n)) {
+        return n;
+    }
+
+    if (lazy_) {
+        /* The evaluator only converts the position to ECEF when the device may have crossed a fence */
+        n = lazyfence_evaluate(&lazy_state_, fences, llh, navigation_get_time(), reached, USERIF_MAX_FENCES);
+    } else {
+        /* Device ECEF position. The fence centers are precomputed in ECEF */
+        position_geodetic_to_ecef(llh->latitude, llh->longitude, llh->altitude, &xyz[0], &xyz[1], &xyz[2]);
+
+        /* Fences that contain the device */
+        n = geofence_evaluate(fences, xyz[0], xyz[1], xyz[2], reached, USERIF_MAX_FENCES);
+    }
+
+    if (memo_enabled_) {
+        fixmemo_store(&memo_, fences, version, llh, reached, n);
+    }
+    return n;
+}
@@ -0,0 +1,539 @@
+/**
+ * @file devgrid.c
+ *
+ * Device spatial hash
+ *
+ * @license
+ * All rights reserved. Read LICENSE.txt file for the license terms.
+ *
+ * Changelog:
+ *
+ * [18/10/2026]     [miguelgarcia]
+ * Initial version
+ *
+ */
+
+/* -- Includes -- */
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include "devgrid.h"
+
+/* -- Definitions -- */
+
+/** Bits of each cell coordinate in a cell key */
+#define KEY_AXIS_BITS   21
+/** Bias of the cell coordinates, so they are stored unsigned */
+#define KEY_AXIS_BIAS   (1 << (KEY_AXIS_BITS - 1))
+/** Bit set in every cell key, so a zero key is an empty hash slot */
+#define KEY_USED        (1ULL << 63)
+/** Initial size of the hash table */
+#define MIN_CELLS       64
+
+/* -- Local types -- */
+
+/** State of a query */
+typedef struct {
+    const devgrid_st* g;
+    float x, y, z;
+    float radius_sq;
+    /** Device not returned, or max_devices */
+    uint32_t skip;
+    uint32_t* devices;
+    uint32_t max;
+    /** Number of devices found */
+    uint32_t n;
+} query_st;
+
+/* -- Local functions -- */
+static int32_t cell_coord(const devgrid_st* g, float v);
+static uint64_t cell_key(int32_t ix, int32_t iy, int32_t iz);
+static uint32_t key_hash(uint64_t key);
+static int32_t find_cell(const devgrid_st* g, uint64_t key);
+static devgrid_cell_st* add_cell(devgrid_st* g, uint64_t key);
+static void remove_cell(devgrid_st* g, uint32_t slot);
+static int rehash(devgrid_st* g, uint32_t size);
+static int cell_push(devgrid_st* g, uint64_t key, uint32_t device);
+static void cell_pop(devgrid_st* g, uint32_t device);
+static void query_cell(query_st* q, const devgrid_cell_st* c);
+static uint32_t query(query_st* q);
+
+
+/**
+ * @brief Initialize an empty hash
+ * @param [out] g            Hash
+ * @param [in]  max_devices  Max number of devices
+ * @param [in]  cell         Cell size in meters, at least DEVGRID_MIN_CELL
+ * @return Zero on success, Otherwise a negative value
+ */
+int devgrid_init (
+        devgrid_st* g,
+        uint32_t max_devices,
+        float cell
+)
+{
+    memset(g, 0, sizeof(devgrid_st));
+    if (!(cell >= DEVGRID_MIN_CELL)) {
+        return -1;
+    }
+    g->cell = cell;
+    g->max_devices = max_devices;
+    g->devices = (devgrid_device_st*)calloc((max_devices > 0) ? max_devices : 1, sizeof(devgrid_device_st));
+    if (g->devices == NULL || rehash(g, MIN_CELLS) != 0) {
+        devgrid_free(g);
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * @brief Release a hash
+ * @param [in] g  Hash
+ */
+void devgrid_free (
+        devgrid_st* g
+)
+{
+    for (uint32_t i = 0; g->cells != NULL && i <= g->mask; i++) {
+        free(g->cells[i].devices);
+    }
+    free(g->cells);
+    free(g->devices);
+    memset(g, 0, sizeof(devgrid_st));
+}
+
+/**
+ * @brief Set the position of a device, and add it to the hash if it is not in it
+ * @param [in] g       Hash
+ * @param [in] device  Device index
+ * @param [in] x       ECEF X
+ * @param [in] y       ECEF Y
+ * @param [in] z       ECEF Z
+ * @return Zero on success, Otherwise a negative value
+ */
+int devgrid_update (
+        devgrid_st* g,
+        uint32_t device,
+        float x,
+        float y,
+        float z
+)
+{
+    devgrid_device_st* d;
+    uint64_t key;
+
+    if (device >= g->max_devices) {
+        return -1;
+    }
+    d = &g->devices[device];
+    key = cell_key(cell_coord(g, x), cell_coord(g, y), cell_coord(g, z));
+    g->updates++;
+
+    /* The device only moves to another cell when it crosses a cell boundary */
+    if (d->key != key) {
+        if (d->key != 0) {
+            cell_pop(g, device);
+            g->moves++;
+        } else {
+            g->count++;
+        }
+        if (cell_push(g, key, device) != 0) {
+            g->count--;
+            return -1;
+        }
+    }
+    d->ecef[0] = x;
+    d->ecef[1] = y;
+    d->ecef[2] = z;
+    return 0;
+}
+
+/**
+ * @brief Remove a device from the hash, for a device without position
+ * @param [in] g       Hash
+ * @param [in] device  Device index
+ */
+void devgrid_remove (
+        devgrid_st* g,
+        uint32_t device
+)
+{
+    if (device < g->max_devices && g->devices[device].key != 0) {
+        cell_pop(g, device);
+        g->count--;
+    }
+}
+
+/**
+ * @brief Find the devices within a distance of an ECEF position
+ * @param [in]  g        Hash
+ * @param [in]  x        ECEF X
+ * @param [in]  y        ECEF Y
+ * @param [in]  z        ECEF Z
+ * @param [in]  radius   Distance in meters
+ * @param [out] devices  Indexes of the devices found
+ * @param [in]  max      Size of the device buffer
+ * @return Number of devices found. If it is larger than max, only max devices are written
+ */
+uint32_t devgrid_query (
+        const devgrid_st* g,
+        float x,
+        float y,
+        float z,
+        float radius,
+        uint32_t* devices,
+        uint32_t max
+)
+{
+    query_st q = {g, x, y, z, radius * radius, g->max_devices, devices, max, 0};
+
+    if (!(radius >= 0.0f)) {
+        return 0;
+    }
+    return query(&q);
+}
+
+/**
+ * @brief Find the other devices within a distance of a device
+ * @param [in]  g        Hash
+ * @param [in]  device   Device index
+ * @param [in]  radius   Distance in meters
+ * @param [out] devices  Indexes of the devices found, without the given one
+ * @param [in]  max      Size of the device buffer
+ * @return Number of devices found, zero if the device is not in the hash. If it is larger than max, only max devices
+ * are written
+ */
+uint32_t devgrid_neighbours (
+        const devgrid_st* g,
+        uint32_t device,
+        float radius,
+        uint32_t* devices,
+        uint32_t max
+)
+{
+    const devgrid_device_st* d;
+    query_st q;
+
+    if (device >= g->max_devices || g->devices[device].key == 0 || !(radius >= 0.0f)) {
+        return 0;
+    }
+    d = &g->devices[device];
+    q.g = g;
+    q.x = d->ecef[0];
+    q.y = d->ecef[1];
+    q.z = d->ecef[2];
+    q.radius_sq = radius * radius;
+    q.skip = device;
+    q.devices = devices;
+    q.max = max;
+    q.n = 0;
+    return query(&q);
+}
+
+/**
+ * @brief Cell coordinate of an ECEF coordinate, clamped to the range of the cell keys
+ * @param g  Hash
+ * @param v  ECEF coordinate
+ * @return  Cell coordinate
+ */
+static int32_t cell_coord (
+        const devgrid_st* g,
+        float v
+)
+{
+    float c = floorf(v / g->cell);
+
+    if (c < (float)-KEY_AXIS_BIAS) {
+        return -KEY_AXIS_BIAS;
+    }
+    if (c > (float)(KEY_AXIS_BIAS - 1)) {
+        return KEY_AXIS_BIAS - 1;
+    }
+    return (int32_t)c;
+}
+
+/**
+ * @brief Key of a cell
+ * @param ix  Cell X
+ * @param iy  Cell Y
+ * @param iz  Cell Z
+ * @return  Key
+ */
+static uint64_t cell_key (
+        int32_t ix,
+        int32_t iy,
+        int32_t iz
+)
+{
+    return KEY_USED
+         | ((uint64_t)(uint32_t)(ix + KEY_AXIS_BIAS) << (2 * KEY_AXIS_BITS))
+         | ((uint64_t)(uint32_t)(iy + KEY_AXIS_BIAS) << KEY_AXIS_BITS)
+         | (uint64_t)(uint32_t)(iz + KEY_AXIS_BIAS);
+}
+
+/**
+ * @brief Hash of a cell key
+ * @param key  Key
+ * @return  Hash
+ */
+static uint32_t key_hash (
+        uint64_t key
+)
+{
+    key ^= key >> 31;
+    key *= 0x7fb5d329728ea185ULL;
+    key ^= key >> 27;
+    return (uint32_t)key;
+}
+
+/**
+ * @brief Find a cell in the hash table
+ * @param g    Hash
+ * @param key  Key
+ * @return Slot of the cell, Otherwise a negative value if it has no devices
+ */
+static int32_t find_cell (
+        const devgrid_st* g,
+        uint64_t key
+)
+{
+    uint32_t slot = key_hash(key) & g->mask;
+
+    while (g->cells[slot].key != 0) {
+        if (g->cells[slot].key == key) {
+            return (int32_t)slot;
+        }
+        slot = (slot + 1) & g->mask;
+    }
+    return -1;
+}
+
+/**
+ * @brief Add an empty cell to the hash table
+ * @param g    Hash
+ * @param key  Key, not in the table
+ * @return The cell, or NULL if there is no memory
+ */
+static devgrid_cell_st* add_cell (
+        devgrid_st* g,
+        uint64_t key
+)
+{
+    uint32_t slot;
+
+    /* Hash table at most half full */
+    if ((g->ncells + 1) * 2 > g->mask + 1 && rehash(g, (g->mask + 1) * 2) != 0) {
+        return NULL;
+    }
+
+    slot = key_hash(key) & g->mask;
+    while (g->cells[slot].key != 0) {
+        slot = (slot + 1) & g->mask;
+    }
+    memset(&g->cells[slot], 0, sizeof(devgrid_cell_st));
+    g->cells[slot].key = key;
+    g->ncells++;
+    return &g->cells[slot];
+}
+
+/**
+ * @brief Remove an empty cell from the hash table. The next cells of the probe sequence are shifted back, so the table
+ * has no deleted slots
+ *
+ * @param g     Hash
+ * @param slot  Slot of the cell
+ */
+static void remove_cell (
+        devgrid_st* g,
+        uint32_t slot
+)
+{
+    uint32_t hole = slot;
+
+    free(g->cells[slot].devices);
+    for (uint32_t i = (slot + 1) & g->mask; g->cells[i].key != 0; i = (i + 1) & g->mask) {
+        uint32_t home = key_hash(g->cells[i].key) & g->mask;
+
+        /* The cell can fill the hole if its home slot is not between the hole and the cell */
+        if (((i - home) & g->mask) >= ((i - hole) & g->mask)) {
+            g->cells[hole] = g->cells[i];
+            hole = i;
+        }
+    }
+    memset(&g->cells[hole], 0, sizeof(devgrid_cell_st));
+    g->ncells--;
+}
+
+/**
+ * @brief Move the cells to a new hash table
+ * @param g     Hash
+ * @param size  Size of the new hash table, a power of two
+ * @return Zero on success, Otherwise a negative value
+ */
+static int rehash (
+        devgrid_st* g,
+        uint32_t size
+)
+{
+    devgrid_cell_st* cells = (devgrid_cell_st*)calloc(size, sizeof(devgrid_cell_st));
+
+    if (cells == NULL) {
+        return -1;
+    }
+
+    for (uint32_t i = 0; g->cells != NULL && i <= g->mask; i++) {
+        if (g->cells[i].key != 0) {
+            uint32_t slot = key_hash(g->cells[i].key) & (size - 1);
+            while (cells[slot].key != 0) {
+                slot = (slot + 1) & (size - 1);
+            }
+            cells[slot] = g->cells[i];
+        }
+    }
+    free(g->cells);
+    g->cells = cells;
+    g->mask = size - 1;
+    return 0;
+}
+
+/**
+ * @brief Append a device to the list of a cell, and add the cell if it has no devices
+ * @param g       Hash
+ * @param key     Key of the cell
+ * @param device  Device index, not in any cell
+ * @return Zero on success, Otherwise a negative value
+ */
+static int cell_push (
+        devgrid_st* g,
+        uint64_t key,
+        uint32_t device
+)
+{
+    int32_t slot = find_cell(g, key);
+    devgrid_cell_st* c = (slot >= 0) ? &g->cells[slot] : add_cell(g, key);
+
+    if (c == NULL) {
+        return -1;
+    }
+    if (c->count == c->capacity) {
+        uint32_t capacity = (c->capacity == 0) ? 4 : c->capacity * 2;
+        uint32_t* devices = (uint32_t*)realloc(c->devices, capacity * sizeof(uint32_t));
+        if (devices == NULL) {
+            if (c->count == 0) {
+                remove_cell(g, (uint32_t)find_cell(g, key));
+            }
+            return -1;
+        }
+        c->devices = devices;
+        c->capacity = capacity;
+    }
+
+    g->devices[device].key = key;
+    g->devices[device].pos = c->count;
+    c->devices[c->count++] = device;
+    return 0;
+}
+
+/**
+ * @brief Remove a device from the list of its cell. The last device of the list takes its place, and the cell is
+ * removed if it has no devices left
+ *
+ * @param g       Hash
+ * @param device  Device index, in a cell
+ */
+static void cell_pop (
+        devgrid_st* g,
+        uint32_t device
+)
+{
+    devgrid_device_st* d = &g->devices[device];
+    int32_t slot = find_cell(g, d->key);
+    devgrid_cell_st* c;
+    uint32_t last;
+
+    d->key = 0;
+    if (slot < 0) {
+        return;
+    }
+    c = &g->cells[slot];
+    last = c->devices[--c->count];
+    c->devices[d->pos] = last;
+    g->devices[last].pos = d->pos;
+    if (c->count == 0) {
+        remove_cell(g, (uint32_t)slot);
+    }
+}
+
+/**
+ * @brief Check the devices of a cell
+ * @param q  Query
+ * @param c  Cell
+ */
+static void query_cell (
+        query_st* q,
+        const devgrid_cell_st* c
+)
+{
+    for (uint32_t k = 0; k < c->count; k++) {
+        uint32_t device = c->devices[k];
+        const float* p = q->g->devices[device].ecef;
+        float dx = q->x - p[0];
+        float dy = q->y - p[1];
+        float dz = q->z - p[2];
+
+        if (device != q->skip && dx * dx + dy * dy + dz * dz <= q->radius_sq) {
+            if (q->n < q->max) {
+                q->devices[q->n] = device;
+            }
+            q->n++;
+        }
+    }
+}
+
+/**
+ * @brief Find the devices of a query. It reads the cells of the cube around the position, or every cell if the cube
+ * has more cells than the hash table
+ *
+ * @param q  Query
+ * @return Number of devices found
+ */
+static uint32_t query (
+        query_st* q
+)
+{
+    const devgrid_st* g = q->g;
+    float rings = ceilf(sqrtf(q->radius_sq) / g->cell);
+    int32_t cx, cy, cz, k;
+
+    if ((double)(2.0f * rings + 1.0f) * (2.0f * rings + 1.0f) * (2.0f * rings + 1.0f) > (double)g->ncells) {
+        for (uint32_t i = 0; i <= g->mask; i++) {
+            if (g->cells[i].key != 0) {
+                query_cell(q, &g->cells[i]);
+            }
+        }
+        return q->n;
+    }
+
+    k = (int32_t)rings;
+    cx = cell_coord(g, q->x);
+    cy = cell_coord(g, q->y);
+    cz = cell_coord(g, q->z);
+    for (int32_t ix = cx - k; ix <= cx + k; ix++) {
+        for (int32_t iy = cy - k; iy <= cy + k; iy++) {
+            for (int32_t iz = cz - k; iz <= cz + k; iz++) {
+                int32_t slot;
+
+                /* Cells out of the range of the keys have no devices */
+                if (ix < -KEY_AXIS_BIAS || ix >= KEY_AXIS_BIAS || iy < -KEY_AXIS_BIAS || iy >= KEY_AXIS_BIAS ||
+                    iz < -KEY_AXIS_BIAS || iz >= KEY_AXIS_BIAS) {
+                    continue;
+                }
+                slot = find_cell(g, cell_key(ix, iy, iz));
+                if (slot >= 0) {
+                    query_cell(q, &g->cells[slot]);
+                }
+            }
+        }
+    }
+    return q->n;
+}
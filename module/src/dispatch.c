@@ -0,0 +1,883 @@
+/**
+ * @file dispatch.c
+ *
+ * Runtime CPU feature dispatch
+ *
+ * @license
+ * All rights reserved. Read LICENSE.txt file for the license terms.
+ *
+ * Changelog:
+ *
+ * [18/10/2026]     [miguelgarcia]
+ * Initial version
+ *
+ * [18/10/2026]     [miguelgarcia]
+ * Point-in-polygon crossings kernel
+ *
+ * [18/10/2026]     [miguelgarcia]
+ * R-tree box test kernel
+ *
+ * [18/10/2026]     [miguelgarcia]
+ * Range mask kernel
+ *
+ * [18/10/2026]     [miguelgarcia]
+ * Empty sets in the range mask kernels
+ *
+ */
+
+/* -- Includes -- */
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include "dispatch.h"
+
+/* The SIMD versions are built with per-function target attributes, so the library does not need -mavx2 flags */
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define DISPATCH_X86    1
+#include <immintrin.h>
+#define TARGET_SSE2     __attribute__((target("sse2")))
+#define TARGET_AVX2     __attribute__((target("avx2,fma")))
+#define TARGET_AVX512   __attribute__((target("avx512f,avx512bw")))
+#endif
+
+/* -- Local functions -- */
+static uint8_t xor_scalar(const char* data, uint32_t len);
+static uint32_t scan_scalar(const char* data, uint32_t len, char sep, uint16_t* offs, uint32_t max);
+static void row_dist_scalar(const float* bx, const float* by, const float* bz,
+                            float xi, float yi, float zi, uint32_t n, uint8_t take_sqrt, float* out);
+static uint32_t range_mask_scalar(const float* bx, const float* by, const float* bz, const float* r2, uint32_t n,
+                                  float x, float y, float z, uint64_t* mask);
+static uint32_t crossings_scalar(const float* x0, const float* y0, const float* x1, const float* y1,
+                                 uint32_t n, float px, float py);
+static uint32_t box_mask_scalar(const float* bounds, float x, float y, float z);
+#ifdef DISPATCH_X86
+static uint8_t xor_sse2(const char* data, uint32_t len);
+static uint32_t scan_sse2(const char* data, uint32_t len, char sep, uint16_t* offs, uint32_t max);
+static void row_dist_sse2(const float* bx, const float* by, const float* bz,
+                          float xi, float yi, float zi, uint32_t n, uint8_t take_sqrt, float* out);
+static uint32_t range_mask_sse2(const float* bx, const float* by, const float* bz, const float* r2, uint32_t n,
+                                float x, float y, float z, uint64_t* mask);
+static uint32_t crossings_sse2(const float* x0, const float* y0, const float* x1, const float* y1,
+                               uint32_t n, float px, float py);
+static uint32_t box_mask_sse2(const float* bounds, float x, float y, float z);
+static uint8_t xor_avx2(const char* data, uint32_t len);
+static uint32_t scan_avx2(const char* data, uint32_t len, char sep, uint16_t* offs, uint32_t max);
+static void row_dist_avx2(const float* bx, const float* by, const float* bz,
+                          float xi, float yi, float zi, uint32_t n, uint8_t take_sqrt, float* out);
+static uint32_t range_mask_avx2(const float* bx, const float* by, const float* bz, const float* r2, uint32_t n,
+                                float x, float y, float z, uint64_t* mask);
+static uint32_t crossings_avx2(const float* x0, const float* y0, const float* x1, const float* y1,
+                               uint32_t n, float px, float py);
+static uint32_t box_mask_avx2(const float* bounds, float x, float y, float z);
+static uint8_t xor_avx512(const char* data, uint32_t len);
+static uint32_t scan_avx512(const char* data, uint32_t len, char sep, uint16_t* offs, uint32_t max);
+static void row_dist_avx512(const float* bx, const float* by, const float* bz,
+                            float xi, float yi, float zi, uint32_t n, uint8_t take_sqrt, float* out);
+static uint32_t range_mask_avx512(const float* bx, const float* by, const float* bz, const float* r2, uint32_t n,
+                                  float x, float y, float z, uint64_t* mask);
+static uint32_t crossings_avx512(const float* x0, const float* y0, const float* x1, const float* y1,
+                                 uint32_t n, float px, float py);
+static uint32_t box_mask_avx512(const float* bounds, float x, float y, float z);
+#endif
+static dispatch_level detect_level(void);
+static void dispatch_load(void) __attribute__((constructor));
+
+/* -- Local variables -- */
+
+/** Kernels of every level */
+static const dispatch_kernels_st variants_[dispatch_levels] = {
+    {dispatch_scalar, xor_scalar, scan_scalar, row_dist_scalar, range_mask_scalar, crossings_scalar, box_mask_scalar},
+#ifdef DISPATCH_X86
+    {dispatch_sse2, xor_sse2, scan_sse2, row_dist_sse2, range_mask_sse2, crossings_sse2, box_mask_sse2},
+    {dispatch_avx2, xor_avx2, scan_avx2, row_dist_avx2, range_mask_avx2, crossings_avx2, box_mask_avx2},
+    {dispatch_avx512, xor_avx512, scan_avx512, row_dist_avx512, range_mask_avx512, crossings_avx512, box_mask_avx512},
+#endif
+};
+
+/** Level names */
+static const char* names_[dispatch_levels] = {"scalar", "sse2", "avx2", "avx512"};
+
+/** Highest level supported by the CPU */
+static dispatch_level supported_ = dispatch_scalar;
+
+/** Bound kernels. The scalar ones are valid before dispatch_init() */
+static dispatch_kernels_st kernels_ = {dispatch_scalar, xor_scalar, scan_scalar, row_dist_scalar, range_mask_scalar,
+                                       crossings_scalar, box_mask_scalar};
+
+
+/**
+ * @brief Detect the CPU features and bind the best kernels, honouring the GPSLOCATOR_CPU environment variable. It is
+ * called when the library is loaded.
+ */
+void dispatch_init (
+
+)
+{
+    dispatch_level level;
+    const char* env;
+
+    supported_ = detect_level();
+    level = supported_;
+
+    env = getenv(DISPATCH_ENV);
+    if (env != NULL) {
+        for (int l = 0; l < dispatch_levels; l++) {
+            if (strcmp(env, names_[l]) == 0 && (dispatch_level)l < level) {
+                level = (dispatch_level)l;
+            }
+        }
+    }
+
+    kernels_ = variants_[level];
+}
+
+/**
+ * @brief Get the highest level supported by the CPU
+ * @return Supported level
+ */
+dispatch_level dispatch_get_supported (
+
+)
+{
+    return supported_;
+}
+
+/**
+ * @brief Get the level of the bound kernels
+ * @return Bound level
+ */
+dispatch_level dispatch_get_level (
+
+)
+{
+    return kernels_.level;
+}
+
+/**
+ * @brief Bind the kernels of a level. It must not be called while other threads use the library.
+ * @param [in] level  Level
+ * @return Zero on success, Otherwise a negative value if the CPU does not support the level
+ */
+int dispatch_set_level (
+        dispatch_level level
+)
+{
+    const dispatch_kernels_st* k = dispatch_get_variant(level);
+
+    if (k == NULL) {
+        return -1;
+    }
+    kernels_ = *k;
+    return 0;
+}
+
+/**
+ * @brief Get the bound kernels
+ * @return Bound kernels
+ */
+const dispatch_kernels_st* dispatch_get_kernels (
+
+)
+{
+    return &kernels_;
+}
+
+/**
+ * @brief Get the kernels of a level, without binding them
+ * @param [in] level  Level
+ * @return Kernels of the level, or NULL if the CPU does not support it
+ */
+const dispatch_kernels_st* dispatch_get_variant (
+        dispatch_level level
+)
+{
+    if ((int)level < 0 || level > supported_) {
+        return NULL;
+    }
+    return &variants_[level];
+}
+
+/**
+ * @brief Get the name of a level, as used by the GPSLOCATOR_CPU environment variable
+ * @param [in] level  Level
+ * @return Level name
+ */
+const char* dispatch_level_name (
+        dispatch_level level
+)
+{
+    if ((int)level < 0 || level >= dispatch_levels) {
+        return "unknown";
+    }
+    return names_[level];
+}
+
+/**
+ * @brief Bind the kernels when the library is loaded
+ */
+static void dispatch_load (
+
+)
+{
+    dispatch_init();
+}
+
+/**
+ * @brief Detect the highest level supported by the CPU and the operating system
+ * @return Supported level
+ */
+static dispatch_level detect_level (
+
+)
+{
+#ifdef DISPATCH_X86
+    __builtin_cpu_init();
+
+    if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw")) {
+        return dispatch_avx512;
+    }
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) {
+        return dispatch_avx2;
+    }
+    if (__builtin_cpu_supports("sse2")) {
+        return dispatch_sse2;
+    }
+#endif
+    return dispatch_scalar;
+}
+
+
+/* -- Scalar kernels -- */
+
+static uint8_t xor_scalar (
+        const char* data,
+        uint32_t len
+)
+{
+    uint8_t sum = 0;
+
+    for (uint32_t i = 0; i < len; i++) {
+        sum ^= (uint8_t)data[i];
+    }
+    return sum;
+}
+
+static uint32_t scan_scalar (
+        const char* data,
+        uint32_t len,
+        char sep,
+        uint16_t* offs,
+        uint32_t max
+)
+{
+    uint32_t n = 0;
+
+    for (uint32_t i = 0; i < len && n < max; i++) {
+        if (data[i] == sep) {
+            offs[n++] = (uint16_t)i;
+        }
+    }
+    return n;
+}
+
+static void row_dist_scalar (
+        const float* bx,
+        const float* by,
+        const float* bz,
+        float xi,
+        float yi,
+        float zi,
+        uint32_t n,
+        uint8_t take_sqrt,
+        float* out
+)
+{
+    for (uint32_t j = 0; j < n; j++) {
+        float dx = bx[j] - xi;
+        float dy = by[j] - yi;
+        float dz = bz[j] - zi;
+        float d2 = dx * dx + dy * dy + dz * dz;
+        out[j] = take_sqrt ? sqrtf(d2) : d2;
+    }
+}
+
+static uint32_t range_mask_scalar (
+        const float* bx,
+        const float* by,
+        const float* bz,
+        const float* r2,
+        uint32_t n,
+        float x,
+        float y,
+        float z,
+        uint64_t* mask
+)
+{
+    uint32_t count = 0;
+
+    /* An empty set has no mask */
+    if (n == 0) {
+        return 0;
+    }
+    memset(mask, 0, ((n + 63) / 64) * sizeof(uint64_t));
+    for (uint32_t j = 0; j < n; j++) {
+        float dx = bx[j] - x;
+        float dy = by[j] - y;
+        float dz = bz[j] - z;
+        uint64_t in = (dx * dx + dy * dy + dz * dz <= r2[j]);
+        mask[j / 64] |= in << (j % 64);
+        count += (uint32_t)in;
+    }
+    return count;
+}
+
+/*
+ * An edge is crossed when it straddles the horizontal line of the point and the point is on its left. The side is the
+ * sign of the cross product, compared with the direction of the edge, so there is no division.
+ */
+static uint32_t crossings_scalar (
+        const float* x0,
+        const float* y0,
+        const float* x1,
+        const float* y1,
+        uint32_t n,
+        float px,
+        float py
+)
+{
+    uint32_t count = 0;
+
+    for (uint32_t j = 0; j < n; j++) {
+        uint8_t straddle = (y0[j] > py) != (y1[j] > py);
+        uint8_t up = y1[j] > y0[j];
+        float c = (py - y0[j]) * (x1[j] - x0[j]) - (px - x0[j]) * (y1[j] - y0[j]);
+        count += straddle & ((c > 0.0f) == up);
+    }
+    return count;
+}
+
+static uint32_t box_mask_scalar (
+        const float* bounds,
+        float x,
+        float y,
+        float z
+)
+{
+    uint32_t mask = 0;
+
+    for (uint32_t k = 0; k < 16; k++) {
+        uint32_t in = (x >= bounds[k]) & (y >= bounds[16 + k]) & (z >= bounds[32 + k]) &
+                      (x <= bounds[48 + k]) & (y <= bounds[64 + k]) & (z <= bounds[80 + k]);
+        mask |= in << k;
+    }
+    return mask;
+}
+
+#ifdef DISPATCH_X86
+
+/**
+ * @brief Append the offsets of the bits set in a mask of matches
+ * @param mask  Matches of a block
+ * @param base  Offset of the block
+ * @param offs  Offsets
+ * @param n     Number of offsets written
+ * @param max   Max number of offsets
+ * @return  Number of offsets written
+ */
+static inline uint32_t append_matches (
+        uint64_t mask,
+        uint32_t base,
+        uint16_t* offs,
+        uint32_t n,
+        uint32_t max
+)
+{
+    while (mask != 0 && n < max) {
+        offs[n++] = (uint16_t)(base + (uint32_t)__builtin_ctzll(mask));
+        mask &= mask - 1;
+    }
+    return n;
+}
+
+
+/* -- SSE2 kernels -- */
+
+TARGET_SSE2 static uint8_t xor_sse2 (
+        const char* data,
+        uint32_t len
+)
+{
+    __m128i acc = _mm_setzero_si128();
+    uint8_t lanes[16];
+    uint8_t sum = 0;
+    uint32_t i = 0;
+
+    for (; i + 16 <= len; i += 16) {
+        acc = _mm_xor_si128(acc, _mm_loadu_si128((const __m128i*)&data[i]));
+    }
+    _mm_storeu_si128((__m128i*)lanes, acc);
+    for (uint32_t l = 0; l < 16; l++) {
+        sum ^= lanes[l];
+    }
+    return sum ^ xor_scalar(&data[i], len - i);
+}
+
+TARGET_SSE2 static uint32_t scan_sse2 (
+        const char* data,
+        uint32_t len,
+        char sep,
+        uint16_t* offs,
+        uint32_t max
+)
+{
+    __m128i vsep = _mm_set1_epi8(sep);
+    uint32_t n = 0;
+    uint32_t i = 0;
+
+    for (; i + 16 <= len && n < max; i += 16) {
+        __m128i eq = _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)&data[i]), vsep);
+        n = append_matches((uint32_t)_mm_movemask_epi8(eq), i, offs, n, max);
+    }
+    for (; i < len && n < max; i++) {
+        if (data[i] == sep) {
+            offs[n++] = (uint16_t)i;
+        }
+    }
+    return n;
+}
+
+TARGET_SSE2 static void row_dist_sse2 (
+        const float* bx,
+        const float* by,
+        const float* bz,
+        float xi,
+        float yi,
+        float zi,
+        uint32_t n,
+        uint8_t take_sqrt,
+        float* out
+)
+{
+    __m128 vx = _mm_set1_ps(xi);
+    __m128 vy = _mm_set1_ps(yi);
+    __m128 vz = _mm_set1_ps(zi);
+
+    for (uint32_t j = 0; j < n; j += 4) {
+        __m128 dx = _mm_sub_ps(_mm_load_ps(&bx[j]), vx);
+        __m128 dy = _mm_sub_ps(_mm_load_ps(&by[j]), vy);
+        __m128 dz = _mm_sub_ps(_mm_load_ps(&bz[j]), vz);
+        __m128 d2 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz));
+        _mm_store_ps(&out[j], take_sqrt ? _mm_sqrt_ps(d2) : d2);
+    }
+}
+
+TARGET_SSE2 static uint32_t range_mask_sse2 (
+        const float* bx,
+        const float* by,
+        const float* bz,
+        const float* r2,
+        uint32_t n,
+        float x,
+        float y,
+        float z,
+        uint64_t* mask
+)
+{
+    __m128 vx = _mm_set1_ps(x);
+    __m128 vy = _mm_set1_ps(y);
+    __m128 vz = _mm_set1_ps(z);
+    uint32_t count = 0;
+
+    /* An empty set has no mask */
+    if (n == 0) {
+        return 0;
+    }
+    memset(mask, 0, ((n + 63) / 64) * sizeof(uint64_t));
+    for (uint32_t j = 0; j < n; j += 4) {
+        __m128 dx = _mm_sub_ps(_mm_load_ps(&bx[j]), vx);
+        __m128 dy = _mm_sub_ps(_mm_load_ps(&by[j]), vy);
+        __m128 dz = _mm_sub_ps(_mm_load_ps(&bz[j]), vz);
+        __m128 d2 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz));
+        uint64_t in = (uint64_t)_mm_movemask_ps(_mm_cmple_ps(d2, _mm_load_ps(&r2[j])));
+        mask[j / 64] |= in << (j % 64);
+        count += (uint32_t)__builtin_popcountll(in);
+    }
+    return count;
+}
+
+TARGET_SSE2 static uint32_t crossings_sse2 (
+        const float* x0,
+        const float* y0,
+        const float* x1,
+        const float* y1,
+        uint32_t n,
+        float px,
+        float py
+)
+{
+    __m128 vx = _mm_set1_ps(px);
+    __m128 vy = _mm_set1_ps(py);
+    __m128 zero = _mm_setzero_ps();
+    uint32_t count = 0;
+
+    for (uint32_t j = 0; j < n; j += 4) {
+        __m128 ax = _mm_load_ps(&x0[j]);
+        __m128 ay = _mm_load_ps(&y0[j]);
+        __m128 bx = _mm_load_ps(&x1[j]);
+        __m128 by = _mm_load_ps(&y1[j]);
+        __m128 straddle = _mm_xor_ps(_mm_cmpgt_ps(ay, vy), _mm_cmpgt_ps(by, vy));
+        __m128 up = _mm_cmpgt_ps(by, ay);
+        __m128 c = _mm_sub_ps(_mm_mul_ps(_mm_sub_ps(vy, ay), _mm_sub_ps(bx, ax)),
+                              _mm_mul_ps(_mm_sub_ps(vx, ax), _mm_sub_ps(by, ay)));
+        __m128 hit = _mm_andnot_ps(_mm_xor_ps(_mm_cmpgt_ps(c, zero), up), straddle);
+        count += (uint32_t)__builtin_popcount((unsigned)_mm_movemask_ps(hit));
+    }
+    return count;
+}
+
+TARGET_SSE2 static uint32_t box_mask_sse2 (
+        const float* bounds,
+        float x,
+        float y,
+        float z
+)
+{
+    __m128 vx = _mm_set1_ps(x);
+    __m128 vy = _mm_set1_ps(y);
+    __m128 vz = _mm_set1_ps(z);
+    uint32_t mask = 0;
+
+    for (uint32_t k = 0; k < 16; k += 4) {
+        __m128 in = _mm_and_ps(_mm_and_ps(_mm_cmpge_ps(vx, _mm_load_ps(&bounds[k])),
+                                          _mm_cmpge_ps(vy, _mm_load_ps(&bounds[16 + k]))),
+                               _mm_cmpge_ps(vz, _mm_load_ps(&bounds[32 + k])));
+        in = _mm_and_ps(in, _mm_and_ps(_mm_and_ps(_mm_cmple_ps(vx, _mm_load_ps(&bounds[48 + k])),
+                                                  _mm_cmple_ps(vy, _mm_load_ps(&bounds[64 + k]))),
+                                       _mm_cmple_ps(vz, _mm_load_ps(&bounds[80 + k]))));
+        mask |= (uint32_t)_mm_movemask_ps(in) << k;
+    }
+    return mask;
+}
+
+
+/* -- AVX2 kernels -- */
+
+TARGET_AVX2 static uint8_t xor_avx2 (
+        const char* data,
+        uint32_t len
+)
+{
+    __m256i acc = _mm256_setzero_si256();
+    uint8_t lanes[32];
+    uint8_t sum = 0;
+    uint32_t i = 0;
+
+    for (; i + 32 <= len; i += 32) {
+        acc = _mm256_xor_si256(acc, _mm256_loadu_si256((const __m256i*)&data[i]));
+    }
+    _mm256_storeu_si256((__m256i*)lanes, acc);
+    for (uint32_t l = 0; l < 32; l++) {
+        sum ^= lanes[l];
+    }
+    return sum ^ xor_scalar(&data[i], len - i);
+}
+
+TARGET_AVX2 static uint32_t scan_avx2 (
+        const char* data,
+        uint32_t len,
+        char sep,
+        uint16_t* offs,
+        uint32_t max
+)
+{
+    __m256i vsep = _mm256_set1_epi8(sep);
+    uint32_t n = 0;
+    uint32_t i = 0;
+
+    for (; i + 32 <= len && n < max; i += 32) {
+        __m256i eq = _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i*)&data[i]), vsep);
+        n = append_matches((uint32_t)_mm256_movemask_epi8(eq), i, offs, n, max);
+    }
+    for (; i < len && n < max; i++) {
+        if (data[i] == sep) {
+            offs[n++] = (uint16_t)i;
+        }
+    }
+    return n;
+}
+
+TARGET_AVX2 static void row_dist_avx2 (
+        const float* bx,
+        const float* by,
+        const float* bz,
+        float xi,
+        float yi,
+        float zi,
+        uint32_t n,
+        uint8_t take_sqrt,
+        float* out
+)
+{
+    __m256 vx = _mm256_set1_ps(xi);
+    __m256 vy = _mm256_set1_ps(yi);
+    __m256 vz = _mm256_set1_ps(zi);
+
+    for (uint32_t j = 0; j < n; j += 8) {
+        __m256 dx = _mm256_sub_ps(_mm256_load_ps(&bx[j]), vx);
+        __m256 dy = _mm256_sub_ps(_mm256_load_ps(&by[j]), vy);
+        __m256 dz = _mm256_sub_ps(_mm256_load_ps(&bz[j]), vz);
+        __m256 d2 = _mm256_fmadd_ps(dz, dz, _mm256_fmadd_ps(dy, dy, _mm256_mul_ps(dx, dx)));
+        _mm256_store_ps(&out[j], take_sqrt ? _mm256_sqrt_ps(d2) : d2);
+    }
+}
+
+TARGET_AVX2 static uint32_t range_mask_avx2 (
+        const float* bx,
+        const float* by,
+        const float* bz,
+        const float* r2,
+        uint32_t n,
+        float x,
+        float y,
+        float z,
+        uint64_t* mask
+)
+{
+    __m256 vx = _mm256_set1_ps(x);
+    __m256 vy = _mm256_set1_ps(y);
+    __m256 vz = _mm256_set1_ps(z);
+    uint32_t count = 0;
+
+    /* An empty set has no mask */
+    if (n == 0) {
+        return 0;
+    }
+    memset(mask, 0, ((n + 63) / 64) * sizeof(uint64_t));
+    for (uint32_t j = 0; j < n; j += 8) {
+        __m256 dx = _mm256_sub_ps(_mm256_load_ps(&bx[j]), vx);
+        __m256 dy = _mm256_sub_ps(_mm256_load_ps(&by[j]), vy);
+        __m256 dz = _mm256_sub_ps(_mm256_load_ps(&bz[j]), vz);
+        __m256 d2 = _mm256_fmadd_ps(dz, dz, _mm256_fmadd_ps(dy, dy, _mm256_mul_ps(dx, dx)));
+        uint64_t in = (uint64_t)_mm256_movemask_ps(_mm256_cmp_ps(d2, _mm256_load_ps(&r2[j]), _CMP_LE_OQ));
+        mask[j / 64] |= in << (j % 64);
+        count += (uint32_t)__builtin_popcountll(in);
+    }
+    return count;
+}
+
+TARGET_AVX2 static uint32_t crossings_avx2 (
+        const float* x0,
+        const float* y0,
+        const float* x1,
+        const float* y1,
+        uint32_t n,
+        float px,
+        float py
+)
+{
+    __m256 vx = _mm256_set1_ps(px);
+    __m256 vy = _mm256_set1_ps(py);
+    __m256 zero = _mm256_setzero_ps();
+    uint32_t count = 0;
+
+    for (uint32_t j = 0; j < n; j += 8) {
+        __m256 ax = _mm256_load_ps(&x0[j]);
+        __m256 ay = _mm256_load_ps(&y0[j]);
+        __m256 bx = _mm256_load_ps(&x1[j]);
+        __m256 by = _mm256_load_ps(&y1[j]);
+        __m256 straddle = _mm256_xor_ps(_mm256_cmp_ps(ay, vy, _CMP_GT_OQ), _mm256_cmp_ps(by, vy, _CMP_GT_OQ));
+        __m256 up = _mm256_cmp_ps(by, ay, _CMP_GT_OQ);
+        __m256 c = _mm256_sub_ps(_mm256_mul_ps(_mm256_sub_ps(vy, ay), _mm256_sub_ps(bx, ax)),
+                                 _mm256_mul_ps(_mm256_sub_ps(vx, ax), _mm256_sub_ps(by, ay)));
+        __m256 hit = _mm256_andnot_ps(_mm256_xor_ps(_mm256_cmp_ps(c, zero, _CMP_GT_OQ), up), straddle);
+        count += (uint32_t)__builtin_popcount((unsigned)_mm256_movemask_ps(hit));
+    }
+    return count;
+}
+
+TARGET_AVX2 static uint32_t box_mask_avx2 (
+        const float* bounds,
+        float x,
+        float y,
+        float z
+)
+{
+    __m256 vx = _mm256_set1_ps(x);
+    __m256 vy = _mm256_set1_ps(y);
+    __m256 vz = _mm256_set1_ps(z);
+    uint32_t mask = 0;
+
+    for (uint32_t k = 0; k < 16; k += 8) {
+        __m256 lo = _mm256_and_ps(_mm256_cmp_ps(vx, _mm256_load_ps(&bounds[k]), _CMP_GE_OQ),
+                                  _mm256_cmp_ps(vy, _mm256_load_ps(&bounds[16 + k]), _CMP_GE_OQ));
+        __m256 hi = _mm256_and_ps(_mm256_cmp_ps(vx, _mm256_load_ps(&bounds[48 + k]), _CMP_LE_OQ),
+                                  _mm256_cmp_ps(vy, _mm256_load_ps(&bounds[64 + k]), _CMP_LE_OQ));
+        __m256 in = _mm256_and_ps(_mm256_and_ps(lo, hi),
+                                  _mm256_and_ps(_mm256_cmp_ps(vz, _mm256_load_ps(&bounds[32 + k]), _CMP_GE_OQ),
+                                                _mm256_cmp_ps(vz, _mm256_load_ps(&bounds[80 + k]), _CMP_LE_OQ)));
+        mask |= (uint32_t)_mm256_movemask_ps(in) << k;
+    }
+    return mask;
+}
+
+
+/* -- AVX-512 kernels -- */
+
+TARGET_AVX512 static uint8_t xor_avx512 (
+        const char* data,
+        uint32_t len
+)
+{
+    __m512i acc = _mm512_setzero_si512();
+    uint8_t lanes[64];
+    uint8_t sum = 0;
+    uint32_t i = 0;
+
+    for (; i + 64 <= len; i += 64) {
+        acc = _mm512_xor_si512(acc, _mm512_loadu_si512((const void*)&data[i]));
+    }
+    _mm512_storeu_si512((void*)lanes, acc);
+    for (uint32_t l = 0; l < 64; l++) {
+        sum ^= lanes[l];
+    }
+    return sum ^ xor_scalar(&data[i], len - i);
+}
+
+TARGET_AVX512 static uint32_t scan_avx512 (
+        const char* data,
+        uint32_t len,
+        char sep,
+        uint16_t* offs,
+        uint32_t max
+)
+{
+    __m512i vsep = _mm512_set1_epi8(sep);
+    uint32_t n = 0;
+    uint32_t i = 0;
+
+    for (; i + 64 <= len && n < max; i += 64) {
+        __mmask64 eq = _mm512_cmpeq_epi8_mask(_mm512_loadu_si512((const void*)&data[i]), vsep);
+        n = append_matches((uint64_t)eq, i, offs, n, max);
+    }
+    /* Tail with a masked load, so no byte past the buffer is read */
+    if (i < len && n < max) {
+        __mmask64 tail = (__mmask64)((~0ULL) >> (64 - (len - i)));
+        __m512i v = _mm512_maskz_loadu_epi8(tail, (const void*)&data[i]);
+        __mmask64 eq = _mm512_mask_cmpeq_epi8_mask(tail, v, vsep);
+        n = append_matches((uint64_t)eq, i, offs, n, max);
+    }
+    return n;
+}
+
+TARGET_AVX512 static void row_dist_avx512 (
+        const float* bx,
+        const float* by,
+        const float* bz,
+        float xi,
+        float yi,
+        float zi,
+        uint32_t n,
+        uint8_t take_sqrt,
+        float* out
+)
+{
+    __m512 vx = _mm512_set1_ps(xi);
+    __m512 vy = _mm512_set1_ps(yi);
+    __m512 vz = _mm512_set1_ps(zi);
+
+    for (uint32_t j = 0; j < n; j += 16) {
+        __m512 dx = _mm512_sub_ps(_mm512_load_ps(&bx[j]), vx);
+        __m512 dy = _mm512_sub_ps(_mm512_load_ps(&by[j]), vy);
+        __m512 dz = _mm512_sub_ps(_mm512_load_ps(&bz[j]), vz);
+        __m512 d2 = _mm512_fmadd_ps(dz, dz, _mm512_fmadd_ps(dy, dy, _mm512_mul_ps(dx, dx)));
+        _mm512_store_ps(&out[j], take_sqrt ? _mm512_sqrt_ps(d2) : d2);
+    }
+}
+
+TARGET_AVX512 static uint32_t range_mask_avx512 (
+        const float* bx,
+        const float* by,
+        const float* bz,
+        const float* r2,
+        uint32_t n,
+        float x,
+        float y,
+        float z,
+        uint64_t* mask
+)
+{
+    __m512 vx = _mm512_set1_ps(x);
+    __m512 vy = _mm512_set1_ps(y);
+    __m512 vz = _mm512_set1_ps(z);
+    uint32_t count = 0;
+
+    /* An empty set has no mask */
+    if (n == 0) {
+        return 0;
+    }
+    memset(mask, 0, ((n + 63) / 64) * sizeof(uint64_t));
+    for (uint32_t j = 0; j < n; j += 16) {
+        __m512 dx = _mm512_sub_ps(_mm512_load_ps(&bx[j]), vx);
+        __m512 dy = _mm512_sub_ps(_mm512_load_ps(&by[j]), vy);
+        __m512 dz = _mm512_sub_ps(_mm512_load_ps(&bz[j]), vz);
+        __m512 d2 = _mm512_fmadd_ps(dz, dz, _mm512_fmadd_ps(dy, dy, _mm512_mul_ps(dx, dx)));
+        uint64_t in = (uint64_t)_mm512_cmp_ps_mask(d2, _mm512_load_ps(&r2[j]), _CMP_LE_OQ);
+        mask[j / 64] |= in << (j % 64);
+        count += (uint32_t)__builtin_popcountll(in);
+    }
+    return count;
+}
+
+TARGET_AVX512 static uint32_t crossings_avx512 (
+        const float* x0,
+        const float* y0,
+        const float* x1,
+        const float* y1,
+        uint32_t n,
+        float px,
+        float py
+)
+{
+    __m512 vx = _mm512_set1_ps(px);
+    __m512 vy = _mm512_set1_ps(py);
+    __m512 zero = _mm512_setzero_ps();
+    uint32_t count = 0;
+
+    for (uint32_t j = 0; j < n; j += 16) {
+        __m512 ax = _mm512_load_ps(&x0[j]);
+        __m512 ay = _mm512_load_ps(&y0[j]);
+        __m512 bx = _mm512_load_ps(&x1[j]);
+        __m512 by = _mm512_load_ps(&y1[j]);
+        __mmask16 straddle = _mm512_cmp_ps_mask(ay, vy, _CMP_GT_OQ) ^ _mm512_cmp_ps_mask(by, vy, _CMP_GT_OQ);
+        __mmask16 up = _mm512_cmp_ps_mask(by, ay, _CMP_GT_OQ);
+        __m512 c = _mm512_sub_ps(_mm512_mul_ps(_mm512_sub_ps(vy, ay), _mm512_sub_ps(bx, ax)),
+                                 _mm512_mul_ps(_mm512_sub_ps(vx, ax), _mm512_sub_ps(by, ay)));
+        __mmask16 cpos = _mm512_cmp_ps_mask(c, zero, _CMP_GT_OQ);
+        count += (uint32_t)__builtin_popcount((unsigned)(straddle & (__mmask16)~(cpos ^ up)));
+    }
+    return count;
+}
+
+TARGET_AVX512 static uint32_t box_mask_avx512 (
+        const float* bounds,
+        float x,
+        float y,
+        float z
+)
+{
+    __m512 vx = _mm512_set1_ps(x);
+    __m512 vy = _mm512_set1_ps(y);
+    __m512 vz = _mm512_set1_ps(z);
+    __mmask16 in;
+
+    /* Each comparison is masked by the previous ones */
+    in = _mm512_cmp_ps_mask(vx, _mm512_load_ps(&bounds[0]), _CMP_GE_OQ);
+    in = _mm512_mask_cmp_ps_mask(in, vy, _mm512_load_ps(&bounds[16]), _CMP_GE_OQ);
+    in = _mm512_mask_cmp_ps_mask(in, vz, _mm512_load_ps(&bounds[32]), _CMP_GE_OQ);
+    in = _mm512_mask_cmp_ps_mask(in, vx, _mm512_load_ps(&bounds[48]), _CMP_LE_OQ);
+    in = _mm512_mask_cmp_ps_mask(in, vy, _mm512_load_ps(&bounds[64]), _CMP_LE_OQ);
+    in = _mm512_mask_cmp_ps_mask(in, vz, _mm512_load_ps(&bounds[80]), _CMP_LE_OQ);
+    return (uint32_t)in;
+}
+
+#endif /* DISPATCH_X86 */
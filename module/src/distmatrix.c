@@ -0,0 +1,378 @@
+/**
+ * @file distmatrix.c
+ *
+ * Pairwise distance matrix
+ *
+ * @license
+ * All rights reserved. Read LICENSE.txt file for the license terms.
+ *
+ * Changelog:
+ *
+ * [18/10/2026]     [miguelgarcia]
+ * Initial version
+ *
+ * [18/10/2026]     [miguelgarcia]
+ * Argument checks of the matrix
+ *
+ */
+
+/* -- Includes -- */
+#include <math.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include "dispatch.h"
+#include "parallel.h"
+#include "distmatrix.h"
+
+/* -- Definitions -- */
+
+/** Alignment of the set arrays */
+#define SET_ALIGN       64
+/** Padding of the set arrays in elements, so the SIMD kernel can read whole vectors */
+#define SET_PAD         16
+/** Pairs buffered by each worker before calling the user callback */
+#define PAIR_BATCH      256
+
+/* -- Local types -- */
+
+/** Per-worker state */
+typedef struct {
+    /** Squared distances of a tile row */
+    float* d2;
+    /** Buffered pairs */
+    distmatrix_pair_st pairs[PAIR_BATCH];
+    /** Number of buffered pairs */
+    uint32_t npairs;
+} worker_st;
+
+/** State of a distmatrix_compute() or distmatrix_stream() call */
+typedef struct {
+    const distmatrix_set_st* rows;
+    const distmatrix_set_st* cols;
+    /** Number of column tiles */
+    uint32_t col_tiles;
+
+    /** Output matrix, NULL in stream mode */
+    float* dist;
+
+    /** Stream mode: squared threshold, callback, and whether rows and cols are the same set */
+    float max_d2;
+    distmatrix_pairs_cb cb;
+    void* ctx;
+    uint8_t self;
+    pthread_mutex_t cb_lock;
+
+    worker_st* workers;
+} job_st;
+
+/* -- Local functions -- */
+static float* alloc_array(uint32_t n);
+static int run_job(job_st* job, uint32_t threads);
+static void matrix_tile(uint32_t task, uint32_t worker, void* arg);
+static void stream_tile(uint32_t task, uint32_t worker, void* arg);
+static void flush_pairs(job_st* job, worker_st* w);
+
+
+/**
+ * @brief Build a set of positions. Every position is converted to ECEF.
+ * @param [out] s       Set
+ * @param [in]  points  Geodetic positions
+ * @param [in]  n       Number of positions
+ * @return Zero on success, Otherwise a negative value
+ */
+int distmatrix_set_init (
+        distmatrix_set_st* s,
+        const position_st* points,
+        uint32_t n
+)
+{
+    memset(s, 0, sizeof(distmatrix_set_st));
+
+    s->x = alloc_array(n);
+    s->y = alloc_array(n);
+    s->z = alloc_array(n);
+    if (s->x == NULL || s->y == NULL || s->z == NULL) {
+        distmatrix_set_free(s);
+        return -1;
+    }
+
+    for (uint32_t i = 0; i < n; i++) {
+        position_geodetic_to_ecef(points[i].latitude, points[i].longitude, points[i].altitude,
+                                  &s->x[i], &s->y[i], &s->z[i]);
+    }
+    s->n = n;
+
+    return 0;
+}
+
+/**
+ * @brief Release a set of positions
+ * @param [in] s  Set
+ */
+void distmatrix_set_free (
+        distmatrix_set_st* s
+)
+{
+    free(s->x);
+    free(s->y);
+    free(s->z);
+    memset(s, 0, sizeof(distmatrix_set_st));
+}
+
+/**
+ * @brief Compute the full distance matrix between two sets
+ * @param [in]  rows     Row set (N positions)
+ * @param [in]  cols     Column set (M positions). It can be the row set
+ * @param [out] dist     N x M distances in meters, row-major
+ * @param [in]  threads  Number of worker threads, zero to use all the processors
+ * @return Zero on success, Otherwise a negative value
+ */
+int distmatrix_compute (
+        const distmatrix_set_st* rows,
+        const distmatrix_set_st* cols,
+        float* dist,
+        uint32_t threads
+)
+{
+    job_st job;
+
+    /* A NULL output would run the job in stream mode */
+    if (rows == NULL || cols == NULL || dist == NULL) {
+        return -1;
+    }
+
+    memset(&job, 0, sizeof(job_st));
+    job.rows = rows;
+    job.cols = cols;
+    job.dist = dist;
+
+    return run_job(&job, threads);
+}
+
+/**
+ * @brief Find the pairs of two sets within a distance, without building the matrix. If both sets are the same set,
+ * only the pairs with i < j are reported.
+ *
+ * @param [in] rows      Row set
+ * @param [in] cols      Column set. It can be the row set
+ * @param [in] max_dist  Max distance in meters (inclusive)
+ * @param [in] cb        Callback with batches of pairs
+ * @param [in] ctx       User context passed to the callback
+ * @param [in] threads   Number of worker threads, zero to use all the processors
+ * @return Zero on success, Otherwise a negative value
+ */
+int distmatrix_stream (
+        const distmatrix_set_st* rows,
+        const distmatrix_set_st* cols,
+        float max_dist,
+        distmatrix_pairs_cb cb,
+        void* ctx,
+        uint32_t threads
+)
+{
+    job_st job;
+    int res;
+
+    if (rows == NULL || cols == NULL || cb == NULL || max_dist < 0.0f) {
+        return -1;
+    }
+
+    memset(&job, 0, sizeof(job_st));
+    job.rows = rows;
+    job.cols = cols;
+    job.max_d2 = max_dist * max_dist;
+    job.cb = cb;
+    job.ctx = ctx;
+    job.self = (rows == cols) ? 1 : 0;
+    pthread_mutex_init(&job.cb_lock, NULL);
+
+    res = run_job(&job, threads);
+
+    pthread_mutex_destroy(&job.cb_lock);
+    return res;
+}
+
+/**
+ * @brief Split the job in tiles and run them on the worker threads
+ * @param job      Job
+ * @param threads  Number of worker threads, zero to use all the processors
+ * @return Zero on success, Otherwise a negative value
+ */
+static int run_job (
+        job_st* job,
+        uint32_t threads
+)
+{
+    uint32_t row_tiles = (job->rows->n + DISTMATRIX_TILE_ROWS - 1) / DISTMATRIX_TILE_ROWS;
+    uint32_t tiles;
+    uint32_t nworkers;
+    int res = 0;
+
+    job->col_tiles = (job->cols->n + DISTMATRIX_TILE_COLS - 1) / DISTMATRIX_TILE_COLS;
+    tiles = row_tiles * job->col_tiles;
+    if (tiles == 0) {
+        return 0;
+    }
+
+    nworkers = (threads == 0) ? parallel_default_threads() : threads;
+    if (nworkers > PARALLEL_MAX_THREADS) {
+        nworkers = PARALLEL_MAX_THREADS;
+    }
+    if (nworkers > tiles) {
+        nworkers = tiles;
+    }
+
+    job->workers = (worker_st*)calloc(nworkers, sizeof(worker_st));
+    if (job->workers == NULL) {
+        return -1;
+    }
+    for (uint32_t w = 0; w < nworkers; w++) {
+        job->workers[w].d2 = alloc_array(DISTMATRIX_TILE_COLS);
+        if (job->workers[w].d2 == NULL) {
+            res = -1;
+        }
+    }
+
+    if (res == 0) {
+        parallel_for(tiles, nworkers, (job->dist != NULL) ? matrix_tile : stream_tile, job);
+
+        /* Pairs left in the worker buffers */
+        if (job->dist == NULL) {
+            for (uint32_t w = 0; w < nworkers; w++) {
+                flush_pairs(job, &job->workers[w]);
+            }
+        }
+    }
+
+    for (uint32_t w = 0; w < nworkers; w++) {
+        free(job->workers[w].d2);
+    }
+    free(job->workers);
+    return res;
+}
+
+/**
+ * @brief Compute the distances of a tile into the output matrix
+ * @param task    Tile index
+ * @param worker  Worker index
+ * @param arg     Job
+ */
+static void matrix_tile (
+        uint32_t task,
+        uint32_t worker,
+        void* arg
+)
+{
+    job_st* job = (job_st*)arg;
+    worker_st* w = &job->workers[worker];
+    const distmatrix_set_st* a = job->rows;
+    const distmatrix_set_st* b = job->cols;
+
+    uint32_t i0 = (task / job->col_tiles) * DISTMATRIX_TILE_ROWS;
+    uint32_t j0 = (task % job->col_tiles) * DISTMATRIX_TILE_COLS;
+    uint32_t i1 = (i0 + DISTMATRIX_TILE_ROWS < a->n) ? i0 + DISTMATRIX_TILE_ROWS : a->n;
+    uint32_t nj = (j0 + DISTMATRIX_TILE_COLS < b->n) ? DISTMATRIX_TILE_COLS : b->n - j0;
+    dispatch_row_dist_fn row_dist = dispatch_get_kernels()->row_dist;
+
+    for (uint32_t i = i0; i < i1; i++) {
+        row_dist(&b->x[j0], &b->y[j0], &b->z[j0], a->x[i], a->y[i], a->z[i], nj, 1, w->d2);
+        memcpy(&job->dist[(size_t)i * b->n + j0], w->d2, nj * sizeof(float));
+    }
+}
+
+/**
+ * @brief Find the pairs of a tile within the threshold
+ * @param task    Tile index
+ * @param worker  Worker index
+ * @param arg     Job
+ */
+static void stream_tile (
+        uint32_t task,
+        uint32_t worker,
+        void* arg
+)
+{
+    job_st* job = (job_st*)arg;
+    worker_st* w = &job->workers[worker];
+    const distmatrix_set_st* a = job->rows;
+    const distmatrix_set_st* b = job->cols;
+
+    uint32_t i0 = (task / job->col_tiles) * DISTMATRIX_TILE_ROWS;
+    uint32_t j0 = (task % job->col_tiles) * DISTMATRIX_TILE_COLS;
+    uint32_t i1 = (i0 + DISTMATRIX_TILE_ROWS < a->n) ? i0 + DISTMATRIX_TILE_ROWS : a->n;
+    uint32_t nj = (j0 + DISTMATRIX_TILE_COLS < b->n) ? DISTMATRIX_TILE_COLS : b->n - j0;
+    dispatch_row_dist_fn row_dist = dispatch_get_kernels()->row_dist;
+
+    /* Same set: the tile is below the diagonal */
+    if (job->self && j0 + nj <= i0 + 1) {
+        return;
+    }
+
+    for (uint32_t i = i0; i < i1; i++) {
+        uint32_t jstart = 0;
+
+        if (job->self) {
+            if (j0 + nj <= i + 1) {
+                continue;
+            }
+            jstart = (i + 1 > j0) ? i + 1 - j0 : 0;
+        }
+
+        row_dist(&b->x[j0], &b->y[j0], &b->z[j0], a->x[i], a->y[i], a->z[i], nj, 0, w->d2);
+
+        for (uint32_t j = jstart; j < nj; j++) {
+            if (w->d2[j] <= job->max_d2) {
+                distmatrix_pair_st* p = &w->pairs[w->npairs++];
+                p->i = i;
+                p->j = j0 + j;
+                p->dist = sqrtf(w->d2[j]);
+                if (w->npairs == PAIR_BATCH) {
+                    flush_pairs(job, w);
+                }
+            }
+        }
+    }
+}
+
+/**
+ * @brief Deliver the pairs buffered by a worker to the user callback
+ * @param job  Job
+ * @param w    Worker
+ */
+static void flush_pairs (
+        job_st* job,
+        worker_st* w
+)
+{
+    if (w->npairs == 0) {
+        return;
+    }
+
+    pthread_mutex_lock(&job->cb_lock);
+    job->cb(w->pairs, w->npairs, job->ctx);
+    pthread_mutex_unlock(&job->cb_lock);
+    w->npairs = 0;
+}
+
+/**
+ * @brief Allocate an aligned and padded array of floats
+ * @param n  Number of elements
+ * @return  The array, or NULL
+ */
+static float* alloc_array (
+        uint32_t n
+)
+{
+    void* p = NULL;
+    size_t sz = (((size_t)n + SET_PAD - 1) / SET_PAD) * SET_PAD * sizeof(float);
+
+    if (sz == 0) {
+        sz = SET_PAD * sizeof(float);
+    }
+    if (posix_memalign(&p, SET_ALIGN, sz) != 0) {
+        return NULL;
+    }
+    memset(p, 0, sz);
+    return (float*)p;
+}
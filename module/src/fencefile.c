@@ -0,0 +1,798 @@
+/**
+ * @file fencefile.c
+ *
+ * Memory-mapped geofence index file
+ *
+ * @license
+ * All rights reserved. Read LICENSE.txt file for the license terms.
+ *
+ * Changelog:
+ *
+ * [18/10/2026]     [miguelgarcia]
+ * Initial version
+ *
+ * [18/10/2026]     [miguelgarcia]
+ * Sets with incremental edits are built again before they are written
+ *
+ * [18/10/2026]     [miguelgarcia]
+ * The file is written from a private R-tree, so the set is not changed
+ *
+ */
+
+/* -- Includes -- */
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "fencefile.h"
+#include "polyfence.h"
+
+/* -- Definitions -- */
+
+/** Alignment of the edge arrays of a polygon, in floats, for the aligned loads of the crossings kernel */
+#define EDGE_ALIGN_FLOATS   16
+/** CRC-32 polynomial (IEEE 802.3, reflected) */
+#define CRC_POLY            0xEDB88320u
+
+/* -- Local types -- */
+
+/** State of a file being written */
+typedef struct {
+    FILE* file;
+    /** Bytes written */
+    uint64_t offset;
+    /** Running CRC of the current section */
+    uint32_t crc;
+    uint32_t table[256];
+    /** Positive value if a write failed */
+    uint8_t error;
+} writer_st;
+
+/** State of an evaluation */
+typedef struct {
+    const fencefile_st* f;
+    float x, y, z;
+    uint32_t* ids;
+    uint32_t max;
+    /** Number of fences that contain the position */
+    uint32_t n;
+} match_st;
+
+/* -- Local functions -- */
+static int index_build(const geofence_set_st* s, rtree_st* t, uint32_t* ncircles, uint32_t* npolygons);
+static void put(writer_st* w, const void* data, size_t size);
+static void begin_section(writer_st* w, fencefile_header_st* h, fencefile_section s);
+static void end_section(writer_st* w, fencefile_header_st* h, fencefile_section s);
+static int check_structure(const fencefile_st* f);
+static int verify_polygons(const fencefile_st* f);
+static int verify_tree(const fencefile_st* f);
+static void load_polygon(const fencefile_st* f, uint32_t i, polyfence_st* p);
+static void match(uint32_t id, void* ctx);
+static void crc_table(uint32_t table[256]);
+static uint32_t crc_update(const uint32_t table[256], uint32_t crc, const void* data, size_t size);
+
+
+/**
+ * @brief Write a geofence set to a file. The file is written to a temporary path and renamed, so a reader never maps
+ * a partial file. The file has its own R-tree over the fences of the set, with no tombstones, so the set is not
+ * changed whatever its index.
+ *
+ * @param [in] s     Set of fences
+ * @param [in] path  File path
+ * @return Zero on success, Otherwise a negative value
+ */
+int fencefile_write (
+        const geofence_set_st* s,
+        const char* path
+)
+{
+    fencefile_header_st h;
+    writer_st w;
+    rtree_st tree;
+    const rtree_st* t = &tree;
+    uint32_t ncircles;
+    uint32_t npolygons;
+    uint64_t edges = 0;
+    uint64_t bands = 0;
+    uint64_t vertices = 0;
+    size_t len;
+    char* tmp;
+
+    if (s == NULL || path == NULL) {
+        return -1;
+    }
+
+    len = strlen(path) + 5;
+    tmp = (char*)malloc(len);
+    if (tmp == NULL) {
+        return -1;
+    }
+    snprintf(tmp, len, "%s.tmp", path);
+
+    if (index_build(s, &tree, &ncircles, &npolygons) != 0) {
+        free(tmp);
+        return -1;
+    }
+
+    memset(&w, 0, sizeof(writer_st));
+    crc_table(w.table);
+    w.file = fopen(tmp, "wb");
+    if (w.file == NULL) {
+        rtree_free(&tree);
+        free(tmp);
+        return -1;
+    }
+
+    memset(&h, 0, sizeof(fencefile_header_st));
+    memcpy(h.magic, FENCEFILE_MAGIC, sizeof(h.magic));
+    h.version = FENCEFILE_VERSION;
+    h.endian = FENCEFILE_ENDIAN;
+    h.ncircles = ncircles;
+    h.npolygons = npolygons;
+    h.nnodes = t->nnodes;
+    h.nleaves = t->nleaves;
+    h.depth = t->depth;
+
+    /* The header is written again at the end, with the section table */
+    put(&w, &h, sizeof(fencefile_header_st));
+
+    /* The tombstones are left out, in the same order as the boxes of the tree */
+    begin_section(&w, &h, fencefile_section_circles);
+    for (uint32_t i = 0; i < s->count; i++) {
+        const geofence_st* g = &s->fences[i];
+        fencefile_circle_st c;
+
+        if (g->radius < 0.0f) {
+            continue;
+        }
+        memset(&c, 0, sizeof(fencefile_circle_st));
+        c.id = g->id;
+        c.center[0] = g->center.latitude;
+        c.center[1] = g->center.longitude;
+        c.center[2] = g->center.altitude;
+        memcpy(c.ecef, g->ecef, sizeof(c.ecef));
+        c.radius = g->radius;
+        c.radius_sq = g->radius_sq;
+        put(&w, &c, sizeof(fencefile_circle_st));
+    }
+    end_section(&w, &h, fencefile_section_circles);
+
+    begin_section(&w, &h, fencefile_section_polygons);
+    for (uint32_t i = 0; i < s->npolygons; i++) {
+        const polyfence_st* p = &s->polygons[i];
+        fencefile_polygon_st r;
+
+        if (p->nvertices == 0) {
+            continue;
+        }
+        memset(&r, 0, sizeof(fencefile_polygon_st));
+        r.id = p->id;
+        r.nvertices = p->nvertices;
+        memcpy(r.origin, p->origin, sizeof(r.origin));
+        memcpy(r.rotation, p->rotation, sizeof(r.rotation));
+        r.min_up = p->min_up;
+        r.max_up = p->max_up;
+        memcpy(r.min, p->min, sizeof(r.min));
+        memcpy(r.max, p->max, sizeof(r.max));
+        r.band_scale = p->band_scale;
+        r.nbands = p->nbands;
+        r.nedges = p->nedges;
+        r.edges = edges;
+        r.bands = bands;
+        r.vertices = vertices;
+        put(&w, &r, sizeof(fencefile_polygon_st));
+
+        edges += 4 * (uint64_t)p->nedges;
+        bands += 2 * (uint64_t)p->nbands;
+        vertices += 2 * (uint64_t)p->nvertices;
+    }
+    end_section(&w, &h, fencefile_section_polygons);
+
+    /* The edge arrays are padded to whole vectors, so every array stays aligned */
+    begin_section(&w, &h, fencefile_section_edges);
+    for (uint32_t i = 0; i < s->npolygons; i++) {
+        const polyfence_st* p = &s->polygons[i];
+        put(&w, p->x0, p->nedges * sizeof(float));
+        put(&w, p->y0, p->nedges * sizeof(float));
+        put(&w, p->x1, p->nedges * sizeof(float));
+        put(&w, p->y1, p->nedges * sizeof(float));
+    }
+    end_section(&w, &h, fencefile_section_edges);
+
+    begin_section(&w, &h, fencefile_section_bands);
+    for (uint32_t i = 0; i < s->npolygons; i++) {
+        const polyfence_st* p = &s->polygons[i];
+        put(&w, p->band_start, p->nbands * sizeof(uint32_t));
+        put(&w, p->band_count, p->nbands * sizeof(uint32_t));
+    }
+    end_section(&w, &h, fencefile_section_bands);
+
+    begin_section(&w, &h, fencefile_section_vertices);
+    for (uint32_t i = 0; i < s->npolygons; i++) {
+        const polyfence_st* p = &s->polygons[i];
+        put(&w, p->vx, p->nvertices * sizeof(float));
+        put(&w, p->vy, p->nvertices * sizeof(float));
+    }
+    end_section(&w, &h, fencefile_section_vertices);
+
+    begin_section(&w, &h, fencefile_section_nodes);
+    put(&w, t->nodes, t->nnodes * sizeof(rtree_node_st));
+    end_section(&w, &h, fencefile_section_nodes);
+
+    begin_section(&w, &h, fencefile_section_items);
+    put(&w, t->items, t->n * sizeof(uint32_t));
+    end_section(&w, &h, fencefile_section_items);
+
+    h.size = w.offset;
+    h.checksum = crc_update(w.table, 0xFFFFFFFFu, &h, sizeof(fencefile_header_st)) ^ 0xFFFFFFFFu;
+    if (fseek(w.file, 0, SEEK_SET) != 0) {
+        w.error = 1;
+    }
+    put(&w, &h, sizeof(fencefile_header_st));
+
+    rtree_free(&tree);
+    if (fclose(w.file) != 0 || w.error || rename(tmp, path) != 0) {
+        remove(tmp);
+        free(tmp);
+        return -1;
+    }
+    free(tmp);
+    return 0;
+}
+
+/**
+ * @brief Map a file and check its structure
+ * @param [out] f      Opened file
+ * @param [in]  path   File path
+ * @param [in]  flags  FENCEFILE_VERIFY to check the whole file, or zero
+ * @return Zero on success, Otherwise a negative value
+ */
+int fencefile_open (
+        fencefile_st* f,
+        const char* path,
+        uint32_t flags
+)
+{
+    struct stat st;
+    void* map;
+    int fd;
+
+    memset(f, 0, sizeof(fencefile_st));
+    fd = (path != NULL) ? open(path, O_RDONLY) : -1;
+    if (fd < 0) {
+        return -1;
+    }
+    if (fstat(fd, &st) != 0 || st.st_size < (off_t)sizeof(fencefile_header_st)) {
+        close(fd);
+        return -1;
+    }
+
+    /* The mapping keeps the file open */
+    map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        return -1;
+    }
+
+    if (fencefile_open_memory(f, map, (size_t)st.st_size, flags) != 0) {
+        munmap(map, (size_t)st.st_size);
+        return -1;
+    }
+    f->mapped = 1;
+    return 0;
+}
+
+/**
+ * @brief Use the contents of a file already in memory, and check their structure. The contents must be aligned to
+ * FENCEFILE_ALIGN bytes and stay valid until the file is closed.
+ *
+ * @param [out] f      Opened file
+ * @param [in]  data   Contents of the file
+ * @param [in]  size   Size of the contents in bytes
+ * @param [in]  flags  FENCEFILE_VERIFY to check the whole file, or zero
+ * @return Zero on success, Otherwise a negative value
+ */
+int fencefile_open_memory (
+        fencefile_st* f,
+        const void* data,
+        size_t size,
+        uint32_t flags
+)
+{
+    const fencefile_header_st* h = (const fencefile_header_st*)data;
+
+    memset(f, 0, sizeof(fencefile_st));
+    if (data == NULL || size < sizeof(fencefile_header_st) || (uintptr_t)data % FENCEFILE_ALIGN != 0) {
+        return -1;
+    }
+
+    f->data = (const uint8_t*)data;
+    f->size = size;
+    f->header = h;
+    if (check_structure(f) != 0) {
+        memset(f, 0, sizeof(fencefile_st));
+        return -1;
+    }
+
+    f->circles = (const fencefile_circle_st*)(f->data + h->sections[fencefile_section_circles].offset);
+    f->polygons = (const fencefile_polygon_st*)(f->data + h->sections[fencefile_section_polygons].offset);
+    f->edges = (const float*)(f->data + h->sections[fencefile_section_edges].offset);
+    f->bands = (const uint32_t*)(f->data + h->sections[fencefile_section_bands].offset);
+    f->vertices = (const float*)(f->data + h->sections[fencefile_section_vertices].offset);
+
+    /* The tree is only read */
+    f->rtree.nodes = (rtree_node_st*)(f->data + h->sections[fencefile_section_nodes].offset);
+    f->rtree.items = (uint32_t*)(f->data + h->sections[fencefile_section_items].offset);
+    f->rtree.nnodes = h->nnodes;
+    f->rtree.nleaves = h->nleaves;
+    f->rtree.depth = h->depth;
+    f->rtree.n = (h->nnodes > 0) ? h->ncircles + h->npolygons : 0;
+
+    if ((flags & FENCEFILE_VERIFY) && fencefile_verify(f) != 0) {
+        memset(f, 0, sizeof(fencefile_st));
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * @brief Close a file, and unmap it if it was mapped
+ * @param [in] f  Opened file
+ */
+void fencefile_close (
+        fencefile_st* f
+)
+{
+    if (f->mapped) {
+        munmap((void*)f->data, f->size);
+    }
+    memset(f, 0, sizeof(fencefile_st));
+}
+
+/**
+ * @brief Check the checksums of a file, and that every reference of its records is in bounds, so a query cannot read
+ * out of the file. Files from an untrusted source must be verified before they are queried.
+ *
+ * @param [in] f  Opened file
+ * @return Zero if the file is valid, Otherwise a negative value
+ */
+int fencefile_verify (
+        const fencefile_st* f
+)
+{
+    uint32_t table[256];
+
+    if (f->header == NULL) {
+        return -1;
+    }
+
+    crc_table(table);
+    for (int i = 0; i < FENCEFILE_SECTIONS; i++) {
+        const fencefile_section_st* s = &f->header->sections[i];
+        if ((crc_update(table, 0xFFFFFFFFu, f->data + s->offset, s->size) ^ 0xFFFFFFFFu) != s->checksum) {
+            return -1;
+        }
+    }
+
+    return (verify_polygons(f) == 0 && verify_tree(f) == 0) ? 0 : -1;
+}
+
+/**
+ * @brief Find the fences of a file that contain an ECEF position
+ * @param [in]  f    Opened file
+ * @param [in]  x    ECEF X
+ * @param [in]  y    ECEF Y
+ * @param [in]  z    ECEF Z
+ * @param [out] ids  IDs of the fences that contain the position
+ * @param [in]  max  Size of the IDs buffer
+ * @return Number of fences that contain the position. If it is larger than max, only max IDs are written
+ */
+uint32_t fencefile_evaluate (
+        const fencefile_st* f,
+        float x,
+        float y,
+        float z,
+        uint32_t* ids,
+        uint32_t max
+)
+{
+    match_st m = {f, x, y, z, ids, max, 0};
+
+    rtree_visit(&f->rtree, x, y, z, match, &m);
+    return m.n;
+}
+
+/**
+ * @brief Build the R-tree of a file over the fences of a set, with no tombstones. The boxes are numbered as the
+ * records of the file: circles first, then polygons
+ *
+ * @param s          Set
+ * @param t          Tree, empty if the set has no fences. It must be released with rtree_free()
+ * @param ncircles   Number of circular fences in the tree
+ * @param npolygons  Number of polygon fences in the tree
+ * @return Zero on success, Otherwise a negative value
+ */
+static int index_build (
+        const geofence_set_st* s,
+        rtree_st* t,
+        uint32_t* ncircles,
+        uint32_t* npolygons
+)
+{
+    rtree_box_st* boxes;
+    uint32_t n = 0;
+    int ret;
+
+    memset(t, 0, sizeof(rtree_st));
+    *ncircles = 0;
+    *npolygons = 0;
+    if (s->count + s->npolygons == 0) {
+        return 0;
+    }
+    boxes = (rtree_box_st*)malloc((s->count + s->npolygons) * sizeof(rtree_box_st));
+    if (boxes == NULL) {
+        return -1;
+    }
+
+    for (uint32_t i = 0; i < s->count; i++) {
+        const geofence_st* f = &s->fences[i];
+        if (f->radius < 0.0f) {
+            continue;
+        }
+        for (int a = 0; a < 3; a++) {
+            boxes[n].min[a] = f->ecef[a] - f->radius - GEOFENCE_BOX_PAD;
+            boxes[n].max[a] = f->ecef[a] + f->radius + GEOFENCE_BOX_PAD;
+        }
+        n++;
+    }
+    *ncircles = n;
+    for (uint32_t i = 0; i < s->npolygons; i++) {
+        rtree_box_st* b = &boxes[n];
+        if (s->polygons[i].nvertices == 0) {
+            continue;
+        }
+        polyfence_get_bounds(&s->polygons[i], b->min, b->max);
+        for (int a = 0; a < 3; a++) {
+            b->min[a] -= GEOFENCE_BOX_PAD;
+            b->max[a] += GEOFENCE_BOX_PAD;
+        }
+        n++;
+    }
+    *npolygons = n - *ncircles;
+
+    ret = (n > 0) ? rtree_build(t, boxes, n, 0) : 0;
+    free(boxes);
+    return ret;
+}
+
+/**
+ * @brief Write data to a file
+ * @param w     Writer
+ * @param data  Data
+ * @param size  Size in bytes
+ */
+static void put (
+        writer_st* w,
+        const void* data,
+        size_t size
+)
+{
+    if (size == 0) {
+        return;
+    }
+    if (fwrite(data, 1, size, w->file) != size) {
+        w->error = 1;
+    }
+    w->crc = crc_update(w->table, w->crc, data, size);
+    w->offset += size;
+}
+
+/**
+ * @brief Start a section at the next aligned offset
+ * @param w  Writer
+ * @param h  Header
+ * @param s  Section
+ */
+static void begin_section (
+        writer_st* w,
+        fencefile_header_st* h,
+        fencefile_section s
+)
+{
+    static const uint8_t zeros[FENCEFILE_ALIGN] = {0};
+
+    put(w, zeros, (size_t)((FENCEFILE_ALIGN - w->offset % FENCEFILE_ALIGN) % FENCEFILE_ALIGN));
+    h->sections[s].offset = w->offset;
+    w->crc = 0xFFFFFFFFu;
+}
+
+/**
+ * @brief End a section
+ * @param w  Writer
+ * @param h  Header
+ * @param s  Section
+ */
+static void end_section (
+        writer_st* w,
+        fencefile_header_st* h,
+        fencefile_section s
+)
+{
+    h->sections[s].size = w->offset - h->sections[s].offset;
+    h->sections[s].checksum = w->crc ^ 0xFFFFFFFFu;
+}
+
+/**
+ * @brief Check the header and the section table of a file: the format, the checksum, and that every section is aligned,
+ * in the file, and has the size of its records
+ *
+ * @param f  File, with the contents and the header set
+ * @return Zero if they are valid, Otherwise a negative value
+ */
+static int check_structure (
+        const fencefile_st* f
+)
+{
+    const fencefile_header_st* h = f->header;
+    fencefile_header_st copy;
+    uint32_t table[256];
+    uint64_t expected[FENCEFILE_SECTIONS];
+
+    if (memcmp(h->magic, FENCEFILE_MAGIC, sizeof(h->magic)) != 0 || h->version != FENCEFILE_VERSION ||
+        h->endian != FENCEFILE_ENDIAN || h->size != f->size) {
+        return -1;
+    }
+
+    crc_table(table);
+    memcpy(&copy, h, sizeof(fencefile_header_st));
+    copy.checksum = 0;
+    if ((crc_update(table, 0xFFFFFFFFu, &copy, sizeof(fencefile_header_st)) ^ 0xFFFFFFFFu) != h->checksum) {
+        return -1;
+    }
+
+    /* Sizes of the record sections, the others are arrays of 4-byte values */
+    expected[fencefile_section_circles] = (uint64_t)h->ncircles * sizeof(fencefile_circle_st);
+    expected[fencefile_section_polygons] = (uint64_t)h->npolygons * sizeof(fencefile_polygon_st);
+    expected[fencefile_section_nodes] = (uint64_t)h->nnodes * sizeof(rtree_node_st);
+    expected[fencefile_section_items] = (h->nnodes > 0) ? ((uint64_t)h->ncircles + h->npolygons) * sizeof(uint32_t) : 0;
+
+    for (int i = 0; i < FENCEFILE_SECTIONS; i++) {
+        const fencefile_section_st* s = &h->sections[i];
+        uint8_t record = (i == fencefile_section_circles || i == fencefile_section_polygons ||
+                          i == fencefile_section_nodes || i == fencefile_section_items);
+
+        if (s->offset % FENCEFILE_ALIGN != 0 || s->offset < sizeof(fencefile_header_st) || s->offset > f->size ||
+            s->size > f->size - s->offset || s->size % sizeof(uint32_t) != 0 || (record && s->size != expected[i])) {
+            return -1;
+        }
+    }
+
+    if (h->nleaves > h->nnodes || (h->nnodes > 0 && h->nleaves == 0) || h->depth > RTREE_MAX_DEPTH ||
+        (h->nnodes == 0 && h->ncircles + h->npolygons > 0)) {
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * @brief Check the references of the polygon records
+ * @param f  File
+ * @return Zero if they are valid, Otherwise a negative value
+ */
+static int verify_polygons (
+        const fencefile_st* f
+)
+{
+    const fencefile_header_st* h = f->header;
+    uint64_t nedges = h->sections[fencefile_section_edges].size / sizeof(float);
+    uint64_t nbands = h->sections[fencefile_section_bands].size / sizeof(uint32_t);
+    uint64_t nvertices = h->sections[fencefile_section_vertices].size / sizeof(float);
+
+    for (uint32_t i = 0; i < h->npolygons; i++) {
+        const fencefile_polygon_st* r = &f->polygons[i];
+        const uint32_t* start;
+        const uint32_t* count;
+
+        if (r->nvertices < 3 || r->nbands == 0 || r->nedges % EDGE_ALIGN_FLOATS != 0 ||
+            r->edges % EDGE_ALIGN_FLOATS != 0 || r->edges > nedges || 4 * (uint64_t)r->nedges > nedges - r->edges ||
+            r->bands > nbands || 2 * (uint64_t)r->nbands > nbands - r->bands ||
+            r->vertices > nvertices || 2 * (uint64_t)r->nvertices > nvertices - r->vertices) {
+            return -1;
+        }
+
+        /* The kernel reads whole vectors from the start of each band */
+        start = &f->bands[r->bands];
+        count = start + r->nbands;
+        for (uint32_t b = 0; b < r->nbands; b++) {
+            uint64_t padded = ((uint64_t)count[b] + EDGE_ALIGN_FLOATS - 1) / EDGE_ALIGN_FLOATS * EDGE_ALIGN_FLOATS;
+            if (start[b] % EDGE_ALIGN_FLOATS != 0 || start[b] + padded > r->nedges) {
+                return -1;
+            }
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief Check the R-tree: the children of every node are nodes of the level below it, stored before it, or items of
+ * the file for a leaf, and the unused children never contain a position. The traversal then always ends and stays in
+ * its stack.
+ *
+ * @param f  File
+ * @return Zero if it is valid, Otherwise a negative value
+ */
+static int verify_tree (
+        const fencefile_st* f
+)
+{
+    const rtree_st* t = &f->rtree;
+    uint8_t* level;
+    int ret = 0;
+
+    for (uint32_t i = 0; i < t->n; i++) {
+        if (t->items[i] >= t->n) {
+            return -1;
+        }
+    }
+    if (t->nnodes == 0) {
+        return 0;
+    }
+
+    level = (uint8_t*)malloc(t->nnodes);
+    if (level == NULL) {
+        return -1;
+    }
+
+    for (uint32_t i = 0; i < t->nnodes && ret == 0; i++) {
+        const rtree_node_st* node = &t->nodes[i];
+
+        if (node->count == 0 || node->count > RTREE_FANOUT) {
+            ret = -1;
+            break;
+        }
+        for (uint32_t k = node->count; k < RTREE_FANOUT; k++) {
+            if (node->min[0][k] <= node->max[0][k]) {
+                ret = -1;
+            }
+        }
+
+        if (i < t->nleaves) {
+            level[i] = 1;
+            if ((uint64_t)node->first + node->count > t->n) {
+                ret = -1;
+            }
+        } else if ((uint64_t)node->first + node->count > i) {
+            ret = -1;
+        } else {
+            level[i] = (uint8_t)(level[node->first] + 1);
+            for (uint32_t k = 1; k < node->count; k++) {
+                if (level[node->first + k] != level[node->first]) {
+                    ret = -1;
+                }
+            }
+        }
+    }
+    if (ret == 0 && level[t->nnodes - 1] != t->depth) {
+        ret = -1;
+    }
+
+    free(level);
+    return ret;
+}
+
+/**
+ * @brief Build a polygon fence over the mapped arrays of a polygon record. It must not be released.
+ * @param f  File
+ * @param i  Polygon
+ * @param p  Fence
+ */
+static void load_polygon (
+        const fencefile_st* f,
+        uint32_t i,
+        polyfence_st* p
+)
+{
+    const fencefile_polygon_st* r = &f->polygons[i];
+
+    p->id = r->id;
+    p->nvertices = r->nvertices;
+    memcpy(p->origin, r->origin, sizeof(p->origin));
+    memcpy(p->rotation, r->rotation, sizeof(p->rotation));
+    p->min_up = r->min_up;
+    p->max_up = r->max_up;
+    memcpy(p->min, r->min, sizeof(p->min));
+    memcpy(p->max, r->max, sizeof(p->max));
+    p->nedges = r->nedges;
+    p->x0 = (float*)&f->edges[r->edges];
+    p->y0 = p->x0 + r->nedges;
+    p->x1 = p->y0 + r->nedges;
+    p->y1 = p->x1 + r->nedges;
+    p->band_start = (uint32_t*)&f->bands[r->bands];
+    p->band_count = p->band_start + r->nbands;
+    p->nbands = r->nbands;
+    p->band_scale = r->band_scale;
+    p->vx = (float*)&f->vertices[r->vertices];
+    p->vy = p->vx + r->nvertices;
+}
+
+/**
+ * @brief Exact test of a candidate of the R-tree
+ * @param id   Box ID: a circle, or the number of circles plus a polygon
+ * @param ctx  Evaluation
+ */
+static void match (
+        uint32_t id,
+        void* ctx
+)
+{
+    match_st* m = (match_st*)ctx;
+    const fencefile_header_st* h = m->f->header;
+    uint32_t found;
+    uint8_t in;
+
+    if (id < h->ncircles) {
+        const fencefile_circle_st* c = &m->f->circles[id];
+        float dx = m->x - c->ecef[0];
+        float dy = m->y - c->ecef[1];
+        float dz = m->z - c->ecef[2];
+
+        in = (dx * dx + dy * dy + dz * dz <= c->radius_sq);
+        found = c->id;
+    } else {
+        polyfence_st p;
+
+        load_polygon(m->f, id - h->ncircles, &p);
+        in = polyfence_contains(&p, m->x, m->y, m->z);
+        found = p.id;
+    }
+
+    if (in) {
+        if (m->n < m->max) {
+            m->ids[m->n] = found;
+        }
+        m->n++;
+    }
+}
+
+/**
+ * @brief Build the CRC-32 table
+ * @param table  Table
+ */
+static void crc_table (
+        uint32_t table[256]
+)
+{
+    for (uint32_t i = 0; i < 256; i++) {
+        uint32_t c = i;
+        for (int k = 0; k < 8; k++) {
+            c = (c & 1) ? CRC_POLY ^ (c >> 1) : c >> 1;
+        }
+        table[i] = c;
+    }
+}
+
+/**
+ * @brief Update a CRC-32 with data. The CRC starts at 0xFFFFFFFF, and the checksum is the final CRC inverted.
+ * @param table  CRC-32 table
+ * @param crc    CRC
+ * @param data   Data
+ * @param size   Size in bytes
+ * @return Updated CRC
+ */
+static uint32_t crc_update (
+        const uint32_t table[256],
+        uint32_t crc,
+        const void* data,
+        size_t size
+)
+{
+    const uint8_t* p = (const uint8_t*)data;
+
+    for (size_t i = 0; i < size; i++) {
+        crc = table[(crc ^ p[i]) & 0xFF] ^ (crc >> 8);
+    }
+    return crc;
+}
@@ -0,0 +1,116 @@
+/**
+ * @file fixmemo.c
+ *
+ * Stationary device memo
+ *
+ * @license
+ * All rights reserved. Read LICENSE.txt file for the license terms.
+ *
+ * Changelog:
+ *
+ * [18/10/2026]     [miguelgarcia]
+ * Initial version
+ *
+ * [18/10/2026]     [miguelgarcia]
+ * Displacement bound from position.h
+ *
+ */
+
+/* -- Includes -- */
+#include <string.h>
+#include "fixmemo.h"
+
+
+/**
+ * @brief Initialize an empty memo
+ * @param [out] m        Memo
+ * @param [in]  epsilon  Max distance to the memo position in meters
+ */
+void fixmemo_init (
+        fixmemo_st* m,
+        float epsilon
+)
+{
+    memset(m, 0, sizeof(fixmemo_st));
+    m->epsilon = (epsilon > 0.0f) ? epsilon : 0.0f;
+}
+
+/**
+ * @brief Forget the memo position, so the next position is evaluated. The hits and misses are kept
+ * @param [in] m  Memo
+ */
+void fixmemo_reset (
+        fixmemo_st* m
+)
+{
+    m->valid = 0;
+    m->set = NULL;
+}
+
+/**
+ * @brief Get the fences of a position from the memo, if the position is within epsilon of the memo position and the
+ * set of fences did not change.
+ *
+ * @param [in]  m        Memo
+ * @param [in]  set      Set of fences
+ * @param [in]  version  Version of the set of fences
+ * @param [in]  llh      Position. Latitude and Longitude in decimal degrees, ellipsoidal height in meters
+ * @param [out] ids      IDs of the fences that contain the position
+ * @param [in]  max      Size of the IDs buffer
+ * @param [out] n        Number of fences that contain the position. If it is larger than max, only max IDs are written
+ * @return Positive value if the memo is reused, Otherwise Zero and the position must be evaluated.
+ */
+uint8_t fixmemo_lookup (
+        fixmemo_st* m,
+        const void* set,
+        uint64_t version,
+        const position_st* llh,
+        uint32_t* ids,
+        uint32_t max,
+        uint32_t* n
+)
+{
+    if (m->valid && m->set == set && m->version == version) {
+        if (position_displacement_bound(&m->llh, m->cos_lat, llh) <= m->epsilon) {
+            memcpy(ids, m->ids, ((m->n < max) ? m->n : max) * sizeof(uint32_t));
+            *n = m->n;
+            m->hits++;
+            return 1;
+        }
+    }
+    m->misses++;
+    return 0;
+}
+
+/**
+ * @brief Keep an evaluated position as the memo position
+ * @param [in] m        Memo
+ * @param [in] set      Set of fences
+ * @param [in] version  Version of the set of fences
+ * @param [in] llh      Position. Latitude and Longitude in decimal degrees, ellipsoidal height in meters
+ * @param [in] ids      IDs of the fences that contain the position
+ * @param [in] n        Number of fences that contain the position
+ */
+void fixmemo_store (
+        fixmemo_st* m,
+        const void* set,
+        uint64_t version,
+        const position_st* llh,
+        const uint32_t* ids,
+        uint32_t n
+)
+{
+    /* The IDs of a position in too many fences do not fit */
+    if (n > FIXMEMO_MAX_IDS) {
+        fixmemo_reset(m);
+        return;
+    }
+
+    memcpy(m->ids, ids, n * sizeof(uint32_t));
+    m->n = n;
+    m->llh = *llh;
+    m->cos_lat = position_cos_latitude(llh->latitude);
+    m->set = set;
+    m->version = version;
+    m->valid = 1;
+}
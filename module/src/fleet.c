@@ -0,0 +1,486 @@
+/**
+ * @file fleet.c
+ *
+ * Fleet engine
+ *
+ * @license
+ * All rights reserved. Read LICENSE.txt file for the license terms.
+ *
+ * Changelog:
+ *
+ * [18/10/2026]     [miguelgarcia]
+ * Initial version
+ *
+ * [18/10/2026]     [miguelgarcia]
+ * Device registry
+ *
+ * [18/10/2026]     [miguelgarcia]
+ * Geoid grid for the devices without a reported geoidal separation
+ *
+ * [18/10/2026]     [miguelgarcia]
+ * Device lookups without the lock of the devices
+ *
+ */
+
+/* -- Includes -- */
+#include <stdlib.h>
+#include <string.h>
+#include "fleet.h"
+#include "parallel.h"
+
+/* -- Definitions -- */
+
+/** Size of the header of a submission in the queue: device ID and length */
+#define HEADER_SZ       (2 * sizeof(uint32_t))
+
+/* -- Local functions -- */
+static uint32_t id_hash(uint32_t id);
+static fleet_shard_st* shard_of(fleet_st* f, uint32_t device);
+static fleet_device_st* find_device(const fleet_shard_st* s, uint32_t id);
+static fleet_device_st* add_device(fleet_shard_st* s, uint32_t id);
+static void parse(fleet_shard_st* s, const char* work, uint32_t len);
+static void new_position(fleet_shard_st* s, fleet_device_st* d);
+static void* worker_run(void* arg);
+static void shard_free(fleet_shard_st* s);
+
+
+/**
+ * @brief Initialize a fleet engine without devices and start its workers
+ * @param [out] f        Fleet engine
+ * @param [in]  workers  Number of worker threads, zero to use parallel_default_threads(). FLEET_MAX_WORKERS at most
+ * @param [in]  targets  Target set checked on every new position, or NULL
+ * @param [in]  cb       Callback with each new position, or NULL
+ * @param [in]  ctx      User context passed to the callback
+ * @return Zero on success, Otherwise a negative value
+ */
+int fleet_init (
+        fleet_st* f,
+        uint32_t workers,
+        targetset_st* targets,
+        fleet_position_cb cb,
+        void* ctx
+)
+{
+    memset(f, 0, sizeof(fleet_st));
+    f->targets = targets;
+    f->cb = cb;
+    f->ctx = ctx;
+
+    if (workers == 0) {
+        workers = parallel_default_threads();
+    }
+    if (workers > FLEET_MAX_WORKERS) {
+        workers = FLEET_MAX_WORKERS;
+    }
+
+    for (uint32_t i = 0; i < workers; i++) {
+        fleet_shard_st* s = &f->shards[i];
+
+        s->fleet = f;
+        s->reader = -1;
+        s->queue = (char*)malloc(FLEET_QUEUE_BYTES);
+        s->work = (char*)malloc(FLEET_QUEUE_BYTES);
+        if (s->queue == NULL || s->work == NULL || registry_init(&s->registry, 0) != 0 ||
+            (targets != NULL && (s->reader = targetset_reader_register(targets)) < 0)) {
+            free(s->queue);
+            free(s->work);
+            registry_free(&s->registry);
+            fleet_free(f);
+            return -1;
+        }
+        pthread_mutex_init(&s->lock, NULL);
+        pthread_mutex_init(&s->devices_lock, NULL);
+        pthread_cond_init(&s->ready, NULL);
+        pthread_cond_init(&s->done, NULL);
+
+        if (pthread_create(&s->thread, NULL, worker_run, s) != 0) {
+            shard_free(s);
+            fleet_free(f);
+            return -1;
+        }
+        f->workers++;
+    }
+    return 0;
+}
+
+/**
+ * @brief Parse the submitted bytes, stop the workers and release the fleet engine
+ * @param [in] f  Fleet engine
+ */
+void fleet_free (
+        fleet_st* f
+)
+{
+    for (uint32_t i = 0; i < f->workers; i++) {
+        fleet_shard_st* s = &f->shards[i];
+
+        pthread_mutex_lock(&s->lock);
+        s->stop = 1;
+        pthread_cond_signal(&s->ready);
+        pthread_mutex_unlock(&s->lock);
+        pthread_join(s->thread, NULL);
+        shard_free(s);
+    }
+    memset(f, 0, sizeof(fleet_st));
+}
+
+/**
+ * @brief Set the geoid grid used to get the ellipsoidal height of the devices whose GPS module does not report the
+ * geoidal separation. It must be called before the first submission.
+ *
+ * @param [in] f      Fleet engine
+ * @param [in] geoid  Geoid grid, or NULL to use the MSL altitude as ellipsoidal height. It must outlive the engine
+ */
+void fleet_set_geoid (
+        fleet_st* f,
+        const geoid_st* geoid
+)
+{
+    f->geoid = geoid;
+}
+
+/**
+ * @brief Submit bytes received from a device. It can be called from any thread. The device is added to the engine
+ * with its first submission.
+ *
+ * @param [in] f       Fleet engine
+ * @param [in] device  User device ID
+ * @param [in] data    NMEA bytes
+ * @param [in] len     Number of bytes
+ * @return Zero on success, Otherwise a negative value
+ */
+int fleet_submit (
+        fleet_st* f,
+        uint32_t device,
+        const char* data,
+        uint32_t len
+)
+{
+    fleet_shard_st* s;
+
+    if (f->workers == 0 || (data == NULL && len > 0)) {
+        return -1;
+    }
+    s = shard_of(f, device);
+
+    pthread_mutex_lock(&s->lock);
+    do {
+        /* Submissions larger than the queue are split */
+        uint32_t chunk = (len < FLEET_QUEUE_BYTES - HEADER_SZ) ? len : (uint32_t)(FLEET_QUEUE_BYTES - HEADER_SZ);
+
+        while (s->queued + HEADER_SZ + chunk > FLEET_QUEUE_BYTES) {
+            pthread_cond_wait(&s->done, &s->lock);
+        }
+        memcpy(&s->queue[s->queued], &device, sizeof(uint32_t));
+        memcpy(&s->queue[s->queued + sizeof(uint32_t)], &chunk, sizeof(uint32_t));
+        memcpy(&s->queue[s->queued + HEADER_SZ], data, chunk);
+        s->queued += (uint32_t)HEADER_SZ + chunk;
+        pthread_cond_signal(&s->ready);
+
+        data += chunk;
+        len -= chunk;
+    } while (len > 0);
+    pthread_mutex_unlock(&s->lock);
+    return 0;
+}
+
+/**
+ * @brief Wait until every byte submitted before the call is parsed
+ * @param [in] f  Fleet engine
+ */
+void fleet_flush (
+        fleet_st* f
+)
+{
+    for (uint32_t i = 0; i < f->workers; i++) {
+        fleet_shard_st* s = &f->shards[i];
+
+        pthread_mutex_lock(&s->lock);
+        while (s->queued > 0 || s->busy) {
+            pthread_cond_wait(&s->done, &s->lock);
+        }
+        pthread_mutex_unlock(&s->lock);
+    }
+}
+
+/**
+ * @brief Get the state of a device
+ * @param [in]  f       Fleet engine
+ * @param [in]  device  User device ID
+ * @param [out] status  State of the device
+ * @return Zero on success, Otherwise a negative value if the device has no parsed submissions
+ */
+int fleet_get_status (
+        fleet_st* f,
+        uint32_t device,
+        fleet_status_st* status
+)
+{
+    fleet_shard_st* s;
+    uint32_t index;
+
+    if (f->workers == 0) {
+        return -1;
+    }
+    s = shard_of(f, device);
+
+    /* The lookup takes no lock. A device is added under the lock, so the lock waits until its state is set */
+    index = registry_find(&s->registry, device);
+    if (index == REGISTRY_NONE) {
+        return -1;
+    }
+    pthread_mutex_lock(&s->devices_lock);
+    *status = s->devices[index].status;
+    pthread_mutex_unlock(&s->devices_lock);
+    return 0;
+}
+
+/**
+ * @brief Return the number of devices with parsed submissions
+ * @param [in] f  Fleet engine
+ * @return Number of devices
+ */
+uint32_t fleet_count (
+        fleet_st* f
+)
+{
+    uint32_t n = 0;
+
+    for (uint32_t i = 0; i < f->workers; i++) {
+        pthread_mutex_lock(&f->shards[i].devices_lock);
+        n += f->shards[i].ndevices;
+        pthread_mutex_unlock(&f->shards[i].devices_lock);
+    }
+    return n;
+}
+
+/**
+ * @brief Hash of a device ID
+ * @param id  Device ID
+ * @return Hash
+ */
+static uint32_t id_hash (
+        uint32_t id
+)
+{
+    id ^= id >> 16;
+    id *= 0x7feb352dU;
+    id ^= id >> 15;
+    id *= 0x846ca68bU;
+    id ^= id >> 16;
+    return id;
+}
+
+/**
+ * @brief Shard of a device
+ * @param f       Fleet engine
+ * @param device  Device ID
+ * @return Shard
+ */
+static fleet_shard_st* shard_of (
+        fleet_st* f,
+        uint32_t device
+)
+{
+    return &f->shards[(uint32_t)(((uint64_t)id_hash(device) * f->workers) >> 32)];
+}
+
+/**
+ * @brief Find a device of a shard
+ * @param s   Shard
+ * @param id  Device ID
+ * @return The device, or NULL if it is not in the shard
+ */
+static fleet_device_st* find_device (
+        const fleet_shard_st* s,
+        uint32_t id
+)
+{
+    uint32_t index = registry_find(&s->registry, id);
+
+    return (index != REGISTRY_NONE) ? &s->devices[index] : NULL;
+}
+
+/**
+ * @brief Add a device to a shard
+ * @param s   Shard
+ * @param id  Device ID, not in the shard
+ * @return The device, or NULL if there is no memory
+ */
+static fleet_device_st* add_device (
+        fleet_shard_st* s,
+        uint32_t id
+)
+{
+    fleet_device_st* d = NULL;
+    uint32_t index;
+
+    /* The devices can move, and the new index is visible to the lookups once it is inserted */
+    pthread_mutex_lock(&s->devices_lock);
+
+    /* The devices are never removed, so the registry gives the indexes in order */
+    if (s->ndevices == s->capacity) {
+        uint32_t capacity = (s->capacity == 0) ? 16 : s->capacity * 2;
+        fleet_device_st* devices = (fleet_device_st*)realloc(s->devices, capacity * sizeof(fleet_device_st));
+        if (devices == NULL) {
+            pthread_mutex_unlock(&s->devices_lock);
+            return NULL;
+        }
+        s->devices = devices;
+        s->capacity = capacity;
+    }
+    index = registry_insert(&s->registry, id);
+    if (index != REGISTRY_NONE) {
+        d = &s->devices[index];
+        memset(d, 0, sizeof(fleet_device_st));
+        d->id = id;
+        navigation_init(&d->nav);
+        geoid_cache_reset(&d->geoid_cache);
+        s->ndevices++;
+    }
+    pthread_mutex_unlock(&s->devices_lock);
+    return d;
+}
+
+/**
+ * @brief Feed the submissions taken from the queue to the parsers of their devices
+ * @param s     Shard
+ * @param work  Submissions
+ * @param len   Bytes of the submissions
+ */
+static void parse (
+        fleet_shard_st* s,
+        const char* work,
+        uint32_t len
+)
+{
+    uint32_t pos = 0;
+
+    /* The worker is the only writer of its devices: it reads them without the lock */
+    while (pos + HEADER_SZ <= len) {
+        uint32_t id, n;
+        fleet_device_st* d;
+
+        memcpy(&id, &work[pos], sizeof(uint32_t));
+        memcpy(&n, &work[pos + sizeof(uint32_t)], sizeof(uint32_t));
+        pos += (uint32_t)HEADER_SZ;
+
+        d = find_device(s, id);
+        if (d == NULL) {
+            d = add_device(s, id);
+        }
+        for (uint32_t k = 0; d != NULL && k < n; k++) {
+            if (navigation_ctx_add_nmea_char(&d->nav, work[pos + k])) {
+                new_position(s, d);
+            }
+        }
+        pos += n;
+    }
+}
+
+/**
+ * @brief Evaluate the new position of a device and report it
+ * @param s  Shard
+ * @param d  Device
+ */
+static void new_position (
+        fleet_shard_st* s,
+        fleet_device_st* d
+)
+{
+    fleet_st* f = s->fleet;
+    fleet_status_st status = d->status;
+    fleet_status_st* st = &status;
+
+    st->llh = navigation_ctx_get_llh(&d->nav);
+    st->nfences = 0;
+    st->positions++;
+
+    if (st->llh.is_valid) {
+        float x, y, z, separation;
+
+        /* Geoidal separation from the grid if the GPS module does not report it. A reported zero is kept */
+        if (navigation_ctx_get_geoid_separation(&d->nav, &separation)) {
+            st->llh.altitude += separation;
+        } else if (f->geoid != NULL) {
+            st->llh.altitude += geoid_get_undulation(f->geoid, &d->geoid_cache, st->llh.latitude, st->llh.longitude);
+        }
+        if (f->targets != NULL) {
+            position_geodetic_to_ecef(st->llh.latitude, st->llh.longitude, st->llh.altitude, &x, &y, &z);
+            st->nfences = targetset_evaluate(f->targets, s->reader, x, y, z, st->fences, FLEET_MAX_FENCES, NULL);
+        }
+    }
+
+    /* Only the state update is under the lock, for fleet_get_status() */
+    pthread_mutex_lock(&s->devices_lock);
+    d->status = status;
+    pthread_mutex_unlock(&s->devices_lock);
+
+    if (f->cb != NULL) {
+        f->cb(d->id, st, f->ctx);
+    }
+}
+
+/**
+ * @brief Worker loop. Takes the whole queue of its shard and parses it, until it must stop and the queue is empty
+ * @param arg  Shard
+ * @return NULL
+ */
+static void* worker_run (
+        void* arg
+)
+{
+    fleet_shard_st* s = (fleet_shard_st*)arg;
+
+    pthread_mutex_lock(&s->lock);
+    for (;;) {
+        char* work;
+        uint32_t len;
+
+        while (s->queued == 0 && !s->stop) {
+            pthread_cond_wait(&s->ready, &s->lock);
+        }
+        if (s->queued == 0) {
+            break;
+        }
+
+        /* The submitters fill the other buffer while this one is parsed */
+        work = s->queue;
+        len = s->queued;
+        s->queue = s->work;
+        s->work = work;
+        s->queued = 0;
+        s->busy = 1;
+        pthread_cond_broadcast(&s->done);
+        pthread_mutex_unlock(&s->lock);
+
+        parse(s, work, len);
+
+        pthread_mutex_lock(&s->lock);
+        s->busy = 0;
+        pthread_cond_broadcast(&s->done);
+    }
+    pthread_mutex_unlock(&s->lock);
+    return NULL;
+}
+
+/**
+ * @brief Release a shard whose worker is stopped
+ * @param s  Shard
+ */
+static void shard_free (
+        fleet_shard_st* s
+)
+{
+    if (s->reader >= 0) {
+        targetset_reader_unregister(s->fleet->targets, s->reader);
+    }
+    pthread_mutex_destroy(&s->lock);
+    pthread_mutex_destroy(&s->devices_lock);
+    pthread_cond_destroy(&s->ready);
+    pthread_cond_destroy(&s->done);
+    free(s->queue);
+    free(s->work);
+    free(s->devices);
+    registry_free(&s->registry);
+}
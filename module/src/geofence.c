@@ -0,0 +1,1513 @@
+/**
+ * @file geofence.c
+ *
+ * Geofence set
+ *
+ * @license
+ * All rights reserved. Read LICENSE.txt file for the license terms.
+ *
+ * Changelog:
+ *
+ * [18/10/2026]     [miguelgarcia]
+ * Initial version
+ *
+ * [18/10/2026]     [miguelgarcia]
+ * Multi-resolution grid index
+ *
+ * [18/10/2026]     [miguelgarcia]
+ * Polygon fences and R-tree index
+ *
+ * [18/10/2026]     [miguelgarcia]
+ * Brute-force scan of the circular fences
+ *
+ * [18/10/2026]     [miguelgarcia]
+ * Distance to the nearest fence boundary
+ *
+ * [18/10/2026]     [miguelgarcia]
+ * Incremental edits
+ *
+ * [18/10/2026]     [miguelgarcia]
+ * Resize without a version change on failure
+ *
+ * [18/10/2026]     [miguelgarcia]
+ * Grid level of the padded fence box
+ *
+ * [18/10/2026]     [miguelgarcia]
+ * Box padding shared with the fence files
+ *
+ */
+
+/* -- Includes -- */
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include "geofence.h"
+
+/* -- Definitions -- */
+
+/** Initial capacity of a set */
+#define GEOFENCE_MIN_CAPACITY   16
+
+/** Bits of each cell coordinate in a cell key */
+#define KEY_AXIS_BITS   19
+/** Bias of the cell coordinates, so they are stored unsigned */
+#define KEY_AXIS_BIAS   (1 << (KEY_AXIS_BITS - 1))
+/** Bit set in every cell key, so a zero key is an empty hash slot */
+#define KEY_USED        (1ULL << 63)
+
+/* -- Local types -- */
+
+/** Registration of a fence in a cell, used while the grid is built */
+typedef struct {
+    uint64_t key;
+    uint32_t fence;
+} entry_st;
+
+/** State of an evaluation */
+typedef struct {
+    const geofence_set_st* s;
+    float x, y, z;
+    uint32_t* ids;
+    uint32_t max;
+    /** Number of fences that contain the position */
+    uint32_t n;
+} match_st;
+
+/** State of a search of the nearest fence boundary */
+typedef struct {
+    const geofence_set_st* s;
+    float x, y, z;
+    /** Distance to the nearest boundary found */
+    float margin;
+} margin_st;
+
+/* -- Local functions -- */
+static int reserve(geofence_set_st* s, uint32_t capacity);
+static uint32_t delta_limit(const geofence_set_st* s);
+static void check_delta(geofence_set_st* s);
+static void compact(geofence_set_st* s);
+static void set_radius(geofence_st* f, float radius);
+static int grid_build(geofence_set_st* s);
+static int grid_insert(geofence_set_st* s, uint32_t fence);
+static void grid_remove(geofence_set_st* s, uint32_t fence);
+static int grid_push(geofence_grid_st* g, uint64_t key, uint32_t item);
+static int grid_rehash(geofence_grid_st* g, uint32_t size);
+static void fence_cells(const geofence_st* f, uint32_t* level, int32_t* lo, int32_t* hi);
+static int tree_build(geofence_set_st* s);
+static int scan_build(geofence_set_st* s);
+static uint32_t tree_circles(const geofence_set_st* s);
+static void grid_free(geofence_grid_st* g);
+static uint32_t grid_level(float radius);
+static int32_t cell_coord(float v);
+static uint64_t cell_key(uint32_t level, int32_t ix, int32_t iy, int32_t iz);
+static uint32_t key_hash(uint64_t key);
+static const geofence_cell_st* grid_find(const geofence_grid_st* g, uint64_t key);
+static int compare_entries(const void* a, const void* b);
+static void match_circle(match_st* m, const geofence_st* f);
+static void tree_candidate(uint32_t id, void* ctx);
+static void grid_margin(margin_st* m, float limit);
+static void margin_circle(margin_st* m, const geofence_st* f);
+static void tree_margin(uint32_t id, void* ctx);
+static int refs_build(geofence_set_st* s);
+static void refs_put(geofence_set_st* s, uint32_t id, uint32_t ref);
+static void refs_add(geofence_set_st* s, uint32_t id, uint32_t ref);
+static int32_t refs_find(geofence_set_st* s, uint32_t id);
+static void refs_delete(geofence_set_st* s, uint32_t slot);
+static void refs_free(geofence_set_st* s);
+
+
+/**
+ * @brief Initialize an empty set
+ * @param [out] s         Set
+ * @param [in]  capacity  Expected number of fences, the set grows if needed
+ * @return Zero on success, Otherwise a negative value
+ */
+int geofence_set_init (
+        geofence_set_st* s,
+        uint32_t capacity
+)
+{
+    memset(s, 0, sizeof(geofence_set_st));
+    /* The first fences are indexed together by the first build */
+    s->dirty = 1;
+    return reserve(s, (capacity < GEOFENCE_MIN_CAPACITY) ? GEOFENCE_MIN_CAPACITY : capacity);
+}
+
+/**
+ * @brief Release a set
+ * @param [in] s  Set
+ */
+void geofence_set_free (
+        geofence_set_st* s
+)
+{
+    for (uint32_t i = 0; i < s->npolygons; i++) {
+        polyfence_free(&s->polygons[i]);
+    }
+    free(s->fences);
+    free(s->polygons);
+    grid_free(&s->grid);
+    rtree_free(&s->rtree);
+    rangeset_free(&s->scan);
+    refs_free(s);
+    memset(s, 0, sizeof(geofence_set_st));
+}
+
+/**
+ * @brief Add a fence to the set
+ * @param [in] s       Set
+ * @param [in] id      User ID of the fence
+ * @param [in] center  Center. Latitude and Longitude in decimal degrees, ellipsoidal height in meters
+ * @param [in] radius  Radius in meters
+ * @return Zero on success, Otherwise a negative value
+ */
+int geofence_add (
+        geofence_set_st* s,
+        uint32_t id,
+        const position_st* center,
+        float radius
+)
+{
+    geofence_st* f;
+
+    if (center == NULL || !(radius >= 0.0f)) {
+        return -1;
+    }
+    if (s->count == s->capacity && reserve(s, s->capacity * 2) != 0) {
+        return -1;
+    }
+
+    f = &s->fences[s->count++];
+    f->id = id;
+    f->center = *center;
+    set_radius(f, radius);
+    position_geodetic_to_ecef(center->latitude, center->longitude, center->altitude,
+                              &f->ecef[0], &f->ecef[1], &f->ecef[2]);
+    refs_add(s, id, s->count - 1);
+    s->version++;
+
+    /* The grid is updated in place. The other indexes check the fence one by one until the next build */
+    if (!s->dirty && s->index == geofence_index_grid) {
+        if (grid_insert(s, s->count - 1) == 0) {
+            s->indexed = s->count;
+        } else {
+            s->dirty = 1;
+        }
+    }
+    check_delta(s);
+    return 0;
+}
+
+/**
+ * @brief Add a polygon fence to the set
+ * @param [in] s         Set
+ * @param [in] id        User ID of the fence
+ * @param [in] vertices  Vertices of the ring (see polyfence_init())
+ * @param [in] n         Number of vertices
+ * @return Zero on success, Otherwise a negative value
+ */
+int geofence_add_polygon (
+        geofence_set_st* s,
+        uint32_t id,
+        const position_st* vertices,
+        uint32_t n
+)
+{
+    if (s->npolygons == s->polygon_capacity) {
+        uint32_t capacity = (s->polygon_capacity == 0) ? GEOFENCE_MIN_CAPACITY : s->polygon_capacity * 2;
+        polyfence_st* polygons = (polyfence_st*)realloc(s->polygons, capacity * sizeof(polyfence_st));
+        if (polygons == NULL) {
+            return -1;
+        }
+        s->polygons = polygons;
+        s->polygon_capacity = capacity;
+    }
+
+    if (polyfence_init(&s->polygons[s->npolygons], id, vertices, n) != 0) {
+        return -1;
+    }
+    s->npolygons++;
+    refs_add(s, id, GEOFENCE_REF_POLYGON | (s->npolygons - 1));
+    s->version++;
+
+    /* Checked one by one until the next build */
+    check_delta(s);
+    return 0;
+}
+
+/**
+ * @brief Remove a fence from the set. If several fences have the ID, only one of them is removed
+ * @param [in] s   Set
+ * @param [in] id  User ID of the fence
+ * @return Zero on success, Otherwise a negative value if no fence has the ID
+ */
+int geofence_remove (
+        geofence_set_st* s,
+        uint32_t id
+)
+{
+    int32_t slot = refs_find(s, id);
+    uint32_t ref;
+
+    if (slot < 0) {
+        return -1;
+    }
+    ref = s->refs[slot].ref;
+    refs_delete(s, (uint32_t)slot);
+
+    /* The slot is left as a tombstone until the next build */
+    if (ref & GEOFENCE_REF_POLYGON) {
+        polyfence_free(&s->polygons[ref & ~GEOFENCE_REF_POLYGON]);
+    } else {
+        if (!s->dirty && ref < s->indexed && s->index == geofence_index_grid) {
+            grid_remove(s, ref);
+        } else if (!s->dirty && ref < s->indexed && s->index == geofence_index_scan) {
+            s->scan.range_sq[ref] = -1.0f;
+        }
+        s->fences[ref].radius = -1.0f;
+        s->fences[ref].radius_sq = -1.0f;
+    }
+    s->removed++;
+    s->version++;
+    check_delta(s);
+    return 0;
+}
+
+/**
+ * @brief Change the radius of a circular fence. If several fences have the ID, only one of them is changed
+ * @param [in] s       Set
+ * @param [in] id      User ID of the fence
+ * @param [in] radius  Radius in meters
+ * @return Zero on success, Otherwise a negative value if no circular fence has the ID or the radius is not valid
+ */
+int geofence_set_radius (
+        geofence_set_st* s,
+        uint32_t id,
+        float radius
+)
+{
+    int32_t slot = (radius >= 0.0f) ? refs_find(s, id) : -1;
+    uint32_t i;
+    uint8_t moved;
+    geofence_st f;
+
+    if (slot < 0 || (s->refs[slot].ref & GEOFENCE_REF_POLYGON)) {
+        return -1;
+    }
+    i = s->refs[slot].ref;
+
+    /* A larger fence out of its R-tree box moves to a new slot, checked one by one. The room is taken before the set
+     * changes, so a failure leaves it as it was */
+    moved = (!s->dirty && i < s->indexed && s->index == geofence_index_rtree && radius > s->fences[i].radius);
+    if (moved && s->count == s->capacity && reserve(s, s->capacity * 2) != 0) {
+        return -1;
+    }
+    s->version++;
+
+    if (s->dirty || i >= s->indexed || (s->index == geofence_index_rtree && !moved)) {
+        /* Out of the indexes, or still inside its R-tree box */
+        set_radius(&s->fences[i], radius);
+        return 0;
+    }
+
+    if (s->index == geofence_index_scan) {
+        set_radius(&s->fences[i], radius);
+        s->scan.range_sq[i] = s->fences[i].radius_sq;
+        return 0;
+    }
+
+    if (s->index == geofence_index_grid) {
+        /* The fence can move to another level */
+        grid_remove(s, i);
+        set_radius(&s->fences[i], radius);
+        if (grid_insert(s, i) != 0) {
+            s->dirty = 1;
+        }
+        return 0;
+    }
+
+    f = s->fences[i];
+    set_radius(&f, radius);
+    s->fences[s->count++] = f;
+    s->fences[i].radius = -1.0f;
+    s->fences[i].radius_sq = -1.0f;
+    s->refs[slot].ref = s->count - 1;
+    s->removed++;
+    check_delta(s);
+    return 0;
+}
+
+/**
+ * @brief Apply a batch of edits to the set, in order. A batch larger than the fences that can be out of the indexes
+ * marks the set to be built again first, so the indexes are built once instead of updated for every edit.
+ *
+ * @param [in] s      Set
+ * @param [in] edits  Edits
+ * @param [in] n      Number of edits
+ * @return Number of edits applied. The edits stop at the first one that fails
+ */
+uint32_t geofence_apply (
+        geofence_set_st* s,
+        const geofence_edit_st* edits,
+        uint32_t n
+)
+{
+    if (n > delta_limit(s)) {
+        s->dirty = 1;
+    }
+
+    for (uint32_t i = 0; i < n; i++) {
+        const geofence_edit_st* e = &edits[i];
+        int ret = -1;
+
+        switch (e->op) {
+        case geofence_op_add:
+            ret = geofence_add(s, e->id, &e->center, e->radius);
+            break;
+        case geofence_op_add_polygon:
+            ret = geofence_add_polygon(s, e->id, e->vertices, e->nvertices);
+            break;
+        case geofence_op_remove:
+            ret = geofence_remove(s, e->id);
+            break;
+        case geofence_op_radius:
+            ret = geofence_set_radius(s, e->id, e->radius);
+            break;
+        }
+        if (ret != 0) {
+            return i;
+        }
+    }
+    return n;
+}
+
+/**
+ * @brief Select the index of the circular fences. The default is the grid.
+ * @param [in] s      Set
+ * @param [in] index  Index
+ */
+void geofence_set_index (
+        geofence_set_st* s,
+        geofence_index index
+)
+{
+    if (s->index != index) {
+        s->index = index;
+        s->version++;
+        s->dirty = 1;
+    }
+}
+
+/**
+ * @brief Add every target of the target table to the set. The ID of each fence is the index of the target.
+ * @param [in] s  Set
+ * @return Zero on success, Otherwise a negative value
+ */
+int geofence_add_targets (
+        geofence_set_st* s
+)
+{
+    for (uint32_t i = 0; i < target_get_count(); i++) {
+        const target_entry_st* t = target_get_entry(i);
+        geofence_st* f;
+
+        if (s->count == s->capacity && reserve(s, s->capacity * 2) != 0) {
+            return -1;
+        }
+
+        /* The target frame is already in ECEF, at the ellipsoidal height of the target */
+        f = &s->fences[s->count++];
+        f->id = i;
+        f->center = t->llh;
+        memcpy(f->ecef, t->ecef, sizeof(f->ecef));
+        f->radius = t->range;
+        f->radius_sq = t->range_sq;
+
+        s->version++;
+        s->dirty = 1;
+    }
+    /* The table of IDs is built again with the new slots */
+    refs_free(s);
+    return 0;
+}
+
+/**
+ * @brief Build the indexes of the set, and drop the tombstones. They are built by geofence_evaluate() if the set is
+ * marked to be built again, so it only needs to be called to evaluate the set from several threads, or to compact it
+ * out of the evaluations.
+ *
+ * @param [in] s  Set
+ * @return Zero on success, Otherwise a negative value
+ */
+int geofence_build (
+        geofence_set_st* s
+)
+{
+    grid_free(&s->grid);
+    rtree_free(&s->rtree);
+    rangeset_free(&s->scan);
+
+    /* The slots of the fences change */
+    refs_free(s);
+    compact(s);
+    s->indexed = s->count;
+    s->indexed_polygons = s->npolygons;
+
+    if ((s->index == geofence_index_grid && grid_build(s) != 0) ||
+        (s->index == geofence_index_scan && scan_build(s) != 0) || tree_build(s) != 0) {
+        grid_free(&s->grid);
+        rtree_free(&s->rtree);
+        rangeset_free(&s->scan);
+        s->dirty = 1;
+        return -1;
+    }
+    s->dirty = 0;
+    return 0;
+}
+
+/**
+ * @brief Find the fences that contain an ECEF position. The indexes are built first if the set is marked to be built
+ * again, so the set must not be evaluated from several threads while it is edited.
+ *
+ * @param [in]  s    Set
+ * @param [in]  x    ECEF X
+ * @param [in]  y    ECEF Y
+ * @param [in]  z    ECEF Z
+ * @param [out] ids  IDs of the fences that contain the position
+ * @param [in]  max  Size of the IDs buffer
+ * @return Number of fences that contain the position. If it is larger than max, only max IDs are written
+ */
+uint32_t geofence_evaluate (
+        geofence_set_st* s,
+        float x,
+        float y,
+        float z,
+        uint32_t* ids,
+        uint32_t max
+)
+{
+    const geofence_grid_st* g = &s->grid;
+    match_st m = {s, x, y, z, ids, max, 0};
+    uint64_t keys[GEOFENCE_GRID_LEVELS];
+    uint32_t nkeys = 0;
+    int32_t ix, iy, iz;
+
+    if (s->dirty) {
+        geofence_build(s);
+    }
+
+    /* Without the indexes (no memory to build them), every fence is a candidate */
+    if (s->dirty) {
+        for (uint32_t i = 0; i < s->count; i++) {
+            match_circle(&m, &s->fences[i]);
+        }
+        for (uint32_t i = 0; i < s->npolygons; i++) {
+            tree_candidate(tree_circles(s) + i, &m);
+        }
+        return m.n;
+    }
+
+    if (s->index == geofence_index_scan) {
+        m.n = rangeset_find(&s->scan, x, y, z, ids, max);
+    }
+
+    /* Polygons, and the circular fences with the R-tree index */
+    rtree_visit(&s->rtree, x, y, z, tree_candidate, &m);
+
+    /* Fences added out of the indexes since the last build */
+    for (uint32_t i = s->indexed; i < s->count; i++) {
+        match_circle(&m, &s->fences[i]);
+    }
+    for (uint32_t i = s->indexed_polygons; i < s->npolygons; i++) {
+        tree_candidate(tree_circles(s) + i, &m);
+    }
+    if (s->index != geofence_index_grid) {
+        return m.n;
+    }
+
+    /* One cell per level with fences. The hash slots of all the levels are prefetched first, so their cache misses
+     * overlap */
+    ix = cell_coord(x);
+    iy = cell_coord(y);
+    iz = cell_coord(z);
+    for (uint32_t levels = g->levels; levels != 0; levels &= levels - 1) {
+        uint32_t level = (uint32_t)__builtin_ctz(levels);
+
+        keys[nkeys] = cell_key(level, ix >> level, iy >> level, iz >> level);
+        __builtin_prefetch(&g->cells[key_hash(keys[nkeys]) & g->mask]);
+        nkeys++;
+    }
+
+    /* A fence is registered in a single level, so it is not found twice */
+    for (uint32_t l = 0; l < nkeys; l++) {
+        const geofence_cell_st* c = grid_find(g, keys[l]);
+        if (c == NULL) {
+            continue;
+        }
+
+        for (uint32_t k = 0; k < c->count; k++) {
+            match_circle(&m, &s->fences[g->items[c->start + k]]);
+        }
+    }
+
+    return m.n;
+}
+
+/**
+ * @brief Get the distance from an ECEF position to the nearest fence boundary, or a lower bound of it: the fences that
+ * contain a position closer than this to the given one are the fences that contain the given one. The search is
+ * limited to the given distance. With the grid index, the search of each level stops GEOFENCE_MARGIN_RINGS cells away
+ * from the position, so the distance is at most that far if the level has fences.
+ *
+ * @param [in] s      Set
+ * @param [in] x      ECEF X
+ * @param [in] y      ECEF Y
+ * @param [in] z      ECEF Z
+ * @param [in] limit  Max distance searched in meters
+ * @return Distance in meters, at most the limit
+ */
+float geofence_margin (
+        geofence_set_st* s,
+        float x,
+        float y,
+        float z,
+        float limit
+)
+{
+    margin_st m = {s, x, y, z, limit};
+    rtree_box_st box = {{x - limit, y - limit, z - limit}, {x + limit, y + limit, z + limit}};
+
+    if (s->dirty) {
+        geofence_build(s);
+    }
+
+    /* Without the indexes, every fence is checked */
+    if (s->dirty) {
+        for (uint32_t i = 0; i < s->count; i++) {
+            margin_circle(&m, &s->fences[i]);
+        }
+        for (uint32_t i = 0; i < s->npolygons; i++) {
+            tree_margin(tree_circles(s) + i, &m);
+        }
+        return m.margin;
+    }
+
+    /* A fence box out of the box of the query is farther than the limit, and so is its boundary */
+    rtree_visit_box(&s->rtree, &box, tree_margin, &m);
+    if (s->index == geofence_index_scan) {
+        for (uint32_t i = 0; i < s->count; i++) {
+            margin_circle(&m, &s->fences[i]);
+        }
+    } else {
+        if (s->index == geofence_index_grid) {
+            grid_margin(&m, limit);
+        }
+        for (uint32_t i = s->indexed; i < s->count; i++) {
+            margin_circle(&m, &s->fences[i]);
+        }
+    }
+    for (uint32_t i = s->indexed_polygons; i < s->npolygons; i++) {
+        tree_margin(tree_circles(s) + i, &m);
+    }
+
+    return m.margin;
+}
+
+/**
+ * @brief Grow the allocated fences of a set
+ * @param s         Set
+ * @param capacity  New capacity
+ * @return Zero on success, Otherwise a negative value
+ */
+static int reserve (
+        geofence_set_st* s,
+        uint32_t capacity
+)
+{
+    geofence_st* fences;
+
+    if (capacity <= s->capacity) {
+        return (capacity == 0) ? -1 : 0;
+    }
+
+    fences = (geofence_st*)realloc(s->fences, capacity * sizeof(geofence_st));
+    if (fences == NULL) {
+        return -1;
+    }
+    s->fences = fences;
+    s->capacity = capacity;
+    return 0;
+}
+
+/**
+ * @brief Max number of tombstones and fences out of the indexes before the set is built again
+ * @param s  Set
+ * @return Number of fences
+ */
+static uint32_t delta_limit (
+        const geofence_set_st* s
+)
+{
+    return GEOFENCE_DELTA_MIN + (s->count + s->npolygons) / GEOFENCE_DELTA_RATIO;
+}
+
+/**
+ * @brief Mark the set to be built again if it has too many tombstones or fences out of the indexes, or the grid has
+ * more items left behind than used. The cost of the build is amortized over the edits since the last one.
+ *
+ * @param s  Set
+ */
+static void check_delta (
+        geofence_set_st* s
+)
+{
+    uint32_t delta = (s->count - s->indexed) + (s->npolygons - s->indexed_polygons) + s->removed;
+
+    if (!s->dirty && (delta > delta_limit(s) ||
+                      (s->grid.garbage > GEOFENCE_DELTA_MIN && s->grid.garbage * 2 > s->grid.nitems))) {
+        s->dirty = 1;
+    }
+}
+
+/**
+ * @brief Drop the tombstones of a set. The fences keep their order
+ * @param s  Set
+ */
+static void compact (
+        geofence_set_st* s
+)
+{
+    uint32_t n = 0;
+
+    if (s->removed == 0) {
+        return;
+    }
+
+    for (uint32_t i = 0; i < s->count; i++) {
+        if (s->fences[i].radius >= 0.0f) {
+            s->fences[n++] = s->fences[i];
+        }
+    }
+    s->count = n;
+
+    /* A removed polygon fence is released, with no vertices */
+    n = 0;
+    for (uint32_t i = 0; i < s->npolygons; i++) {
+        if (s->polygons[i].nvertices != 0) {
+            s->polygons[n++] = s->polygons[i];
+        }
+    }
+    s->npolygons = n;
+    s->removed = 0;
+}
+
+/**
+ * @brief Set the radius of a fence
+ * @param f       Fence
+ * @param radius  Radius in meters
+ */
+static void set_radius (
+        geofence_st* f,
+        float radius
+)
+{
+    f->radius = radius;
+    f->radius_sq = radius * radius;
+}
+
+/**
+ * @brief Build the grid index of the circular fences
+ * @param s  Set
+ * @return Zero on success, Otherwise a negative value
+ */
+static int grid_build (
+        geofence_set_st* s
+)
+{
+    geofence_grid_st* g = &s->grid;
+    entry_st* entries = NULL;
+    uint32_t nentries = 0;
+    uint32_t capacity = 0;
+    uint32_t ncells = 0;
+    uint32_t size;
+
+    grid_free(g);
+
+    /* Cells overlapped by every fence, at the level of its radius */
+    for (uint32_t i = 0; i < s->count; i++) {
+        uint32_t level;
+        int32_t lo[3], hi[3];
+
+        fence_cells(&s->fences[i], &level, lo, hi);
+        for (int32_t ix = lo[0]; ix <= hi[0]; ix++) {
+            for (int32_t iy = lo[1]; iy <= hi[1]; iy++) {
+                for (int32_t iz = lo[2]; iz <= hi[2]; iz++) {
+                    if (nentries == capacity) {
+                        uint32_t c = (capacity == 0) ? s->count * 8 + 8 : capacity * 2;
+                        entry_st* e = (entry_st*)realloc(entries, c * sizeof(entry_st));
+                        if (e == NULL) {
+                            free(entries);
+                            return -1;
+                        }
+                        entries = e;
+                        capacity = c;
+                    }
+                    entries[nentries].key = cell_key(level, ix, iy, iz);
+                    entries[nentries].fence = i;
+                    nentries++;
+                }
+            }
+        }
+        g->levels |= 1u << level;
+    }
+
+    /* Group the registrations by cell */
+    if (nentries > 1) {
+        qsort(entries, nentries, sizeof(entry_st), compare_entries);
+    }
+    for (uint32_t i = 0; i < nentries; i++) {
+        if (i == 0 || entries[i].key != entries[i - 1].key) {
+            ncells++;
+        }
+    }
+
+    /* Hash table at most half full */
+    size = 16;
+    while (size < ncells * 2) {
+        size *= 2;
+    }
+    g->cells = (geofence_cell_st*)calloc(size, sizeof(geofence_cell_st));
+    g->items = (uint32_t*)malloc((nentries + 1) * sizeof(uint32_t));
+    if (g->cells == NULL || g->items == NULL) {
+        free(entries);
+        grid_free(g);
+        return -1;
+    }
+    g->mask = size - 1;
+    g->ncells = ncells;
+    g->nitems = nentries;
+    g->item_capacity = nentries + 1;
+
+    for (uint32_t i = 0; i < nentries; i++) {
+        g->items[i] = entries[i].fence;
+        if (i == 0 || entries[i].key != entries[i - 1].key) {
+            uint32_t slot = key_hash(entries[i].key) & g->mask;
+            while (g->cells[slot].key != 0) {
+                slot = (slot + 1) & g->mask;
+            }
+            g->cells[slot].key = entries[i].key;
+            g->cells[slot].start = i;
+        }
+    }
+    for (uint32_t i = 0; i < nentries; ) {
+        geofence_cell_st* c = (geofence_cell_st*)grid_find(g, entries[i].key);
+        uint32_t j = i;
+        while (j < nentries && entries[j].key == entries[i].key) {
+            j++;
+        }
+        c->count = j - i;
+        c->capacity = j - i;
+        i = j;
+    }
+
+    free(entries);
+    return 0;
+}
+
+/**
+ * @brief Insert a circular fence in the cells of the grid it overlaps
+ * @param s      Set
+ * @param fence  Fence index
+ * @return Zero on success, Otherwise a negative value
+ */
+static int grid_insert (
+        geofence_set_st* s,
+        uint32_t fence
+)
+{
+    uint32_t level;
+    int32_t lo[3], hi[3];
+
+    fence_cells(&s->fences[fence], &level, lo, hi);
+    for (int32_t ix = lo[0]; ix <= hi[0]; ix++) {
+        for (int32_t iy = lo[1]; iy <= hi[1]; iy++) {
+            for (int32_t iz = lo[2]; iz <= hi[2]; iz++) {
+                if (grid_push(&s->grid, cell_key(level, ix, iy, iz), fence) != 0) {
+                    return -1;
+                }
+            }
+        }
+    }
+    s->grid.levels |= 1u << level;
+    return 0;
+}
+
+/**
+ * @brief Remove a circular fence from the cells of the grid it overlaps. The last fence of each cell takes its place
+ * @param s      Set
+ * @param fence  Fence index
+ */
+static void grid_remove (
+        geofence_set_st* s,
+        uint32_t fence
+)
+{
+    geofence_grid_st* g = &s->grid;
+    uint32_t level;
+    int32_t lo[3], hi[3];
+
+    if (g->cells == NULL) {
+        return;
+    }
+
+    fence_cells(&s->fences[fence], &level, lo, hi);
+    for (int32_t ix = lo[0]; ix <= hi[0]; ix++) {
+        for (int32_t iy = lo[1]; iy <= hi[1]; iy++) {
+            for (int32_t iz = lo[2]; iz <= hi[2]; iz++) {
+                geofence_cell_st* c = (geofence_cell_st*)grid_find(g, cell_key(level, ix, iy, iz));
+
+                for (uint32_t k = 0; c != NULL && k < c->count; k++) {
+                    if (g->items[c->start + k] == fence) {
+                        g->items[c->start + k] = g->items[c->start + c->count - 1];
+                        c->count--;
+                        break;
+                    }
+                }
+            }
+        }
+    }
+}
+
+/**
+ * @brief Add an item to a cell of the grid, and the cell if it has no items. A full cell moves its items to the end of
+ * the item array with twice the capacity, unless it is already the last one and grows in place.
+ *
+ * @param g     Grid
+ * @param key   Cell key
+ * @param item  Fence index
+ * @return Zero on success, Otherwise a negative value
+ */
+static int grid_push (
+        geofence_grid_st* g,
+        uint64_t key,
+        uint32_t item
+)
+{
+    geofence_cell_st* c;
+
+    /* Hash table at most half full */
+    if ((g->ncells + 1) * 2 > g->mask + 1 && grid_rehash(g, (g->cells == NULL) ? 16 : (g->mask + 1) * 2) != 0) {
+        return -1;
+    }
+
+    c = (geofence_cell_st*)grid_find(g, key);
+    if (c == NULL) {
+        uint32_t slot = key_hash(key) & g->mask;
+        while (g->cells[slot].key != 0) {
+            slot = (slot + 1) & g->mask;
+        }
+        c = &g->cells[slot];
+        c->key = key;
+        g->ncells++;
+    }
+
+    if (c->count == c->capacity) {
+        uint32_t capacity = (c->capacity < 2) ? 2 : c->capacity * 2;
+        uint8_t last = (c->capacity > 0 && c->start + c->capacity == g->nitems);
+        uint32_t nitems = last ? c->start + capacity : g->nitems + capacity;
+
+        if (nitems > g->item_capacity) {
+            uint32_t size = (g->item_capacity * 2 > nitems) ? g->item_capacity * 2 : nitems;
+            uint32_t* items = (uint32_t*)realloc(g->items, size * sizeof(uint32_t));
+            if (items == NULL) {
+                return -1;
+            }
+            g->items = items;
+            g->item_capacity = size;
+        }
+
+        if (!last) {
+            memcpy(&g->items[g->nitems], &g->items[c->start], c->count * sizeof(uint32_t));
+            g->garbage += c->capacity;
+            c->start = g->nitems;
+        }
+        c->capacity = capacity;
+        g->nitems = nitems;
+    }
+
+    g->items[c->start + c->count++] = item;
+    return 0;
+}
+
+/**
+ * @brief Move the cells of the grid to a new hash table
+ * @param g     Grid
+ * @param size  Size of the new hash table, a power of two
+ * @return Zero on success, Otherwise a negative value
+ */
+static int grid_rehash (
+        geofence_grid_st* g,
+        uint32_t size
+)
+{
+    geofence_cell_st* cells = (geofence_cell_st*)calloc(size, sizeof(geofence_cell_st));
+
+    if (cells == NULL) {
+        return -1;
+    }
+
+    for (uint32_t i = 0; g->cells != NULL && i <= g->mask; i++) {
+        if (g->cells[i].key != 0) {
+            uint32_t slot = key_hash(g->cells[i].key) & (size - 1);
+            while (cells[slot].key != 0) {
+                slot = (slot + 1) & (size - 1);
+            }
+            cells[slot] = g->cells[i];
+        }
+    }
+    free(g->cells);
+    g->cells = cells;
+    g->mask = size - 1;
+    return 0;
+}
+
+/**
+ * @brief Cells of the grid overlapped by a circular fence, at the level of its radius
+ * @param f      Fence
+ * @param level  Level
+ * @param lo     First cell of each axis
+ * @param hi     Last cell of each axis
+ */
+static void fence_cells (
+        const geofence_st* f,
+        uint32_t* level,
+        int32_t* lo,
+        int32_t* hi
+)
+{
+    float r = f->radius + GEOFENCE_BOX_PAD;
+
+    *level = grid_level(f->radius);
+    for (int a = 0; a < 3; a++) {
+        lo[a] = cell_coord(f->ecef[a] - r) >> *level;
+        hi[a] = cell_coord(f->ecef[a] + r) >> *level;
+    }
+}
+
+/**
+ * @brief Build the R-tree of the circular fences, if they use the R-tree index, followed by the polygon fences. The ID
+ * of a box is the index of its circular fence, or the number of circular fences in the tree plus the index of its
+ * polygon.
+ *
+ * @param s  Set
+ * @return Zero on success, Otherwise a negative value
+ */
+static int tree_build (
+        geofence_set_st* s
+)
+{
+    uint32_t ncircles = tree_circles(s);
+    uint32_t n = ncircles + s->npolygons;
+    rtree_box_st* boxes;
+    int ret;
+
+    if (n == 0) {
+        return 0;
+    }
+    boxes = (rtree_box_st*)malloc(n * sizeof(rtree_box_st));
+    if (boxes == NULL) {
+        return -1;
+    }
+
+    for (uint32_t i = 0; i < ncircles; i++) {
+        const geofence_st* f = &s->fences[i];
+        for (int a = 0; a < 3; a++) {
+            boxes[i].min[a] = f->ecef[a] - f->radius - GEOFENCE_BOX_PAD;
+            boxes[i].max[a] = f->ecef[a] + f->radius + GEOFENCE_BOX_PAD;
+        }
+    }
+    for (uint32_t i = 0; i < s->npolygons; i++) {
+        rtree_box_st* b = &boxes[ncircles + i];
+        polyfence_get_bounds(&s->polygons[i], b->min, b->max);
+        for (int a = 0; a < 3; a++) {
+            b->min[a] -= GEOFENCE_BOX_PAD;
+            b->max[a] += GEOFENCE_BOX_PAD;
+        }
+    }
+
+    ret = rtree_build(&s->rtree, boxes, n, 0);
+    free(boxes);
+    return ret;
+}
+
+/**
+ * @brief Build the range set of the circular fences
+ * @param s  Set
+ * @return Zero on success, Otherwise a negative value
+ */
+static int scan_build (
+        geofence_set_st* s
+)
+{
+    uint32_t* ids = (uint32_t*)malloc((s->count + 1) * sizeof(uint32_t));
+    float* ecef = (float*)malloc((s->count + 1) * 3 * sizeof(float));
+    float* radii = (float*)malloc((s->count + 1) * sizeof(float));
+    int ret = -1;
+
+    if (ids != NULL && ecef != NULL && radii != NULL) {
+        for (uint32_t i = 0; i < s->count; i++) {
+            ids[i] = s->fences[i].id;
+            memcpy(&ecef[i * 3], s->fences[i].ecef, sizeof(s->fences[i].ecef));
+            radii[i] = s->fences[i].radius;
+        }
+        ret = rangeset_build(&s->scan, ids, ecef, radii, s->count);
+    }
+
+    free(ids);
+    free(ecef);
+    free(radii);
+    return ret;
+}
+
+/**
+ * @brief Number of circular fences in the R-tree
+ * @param s  Set
+ * @return Number of circular fences
+ */
+static uint32_t tree_circles (
+        const geofence_set_st* s
+)
+{
+    return (s->index == geofence_index_rtree) ? s->indexed : 0;
+}
+
+/**
+ * @brief Release a grid index
+ * @param g  Grid
+ */
+static void grid_free (
+        geofence_grid_st* g
+)
+{
+    free(g->cells);
+    free(g->items);
+    memset(g, 0, sizeof(geofence_grid_st));
+}
+
+/**
+ * @brief Level of a fence: the finest level with cells at least as wide as the padded box of the fence, so the box
+ * overlaps at most 2 cells per axis, 8 cells in all. The top level is taken by larger fences too.
+ *
+ * @param radius  Fence radius
+ * @return  Level
+ */
+static uint32_t grid_level (
+        float radius
+)
+{
+    uint32_t level = 0;
+    float cell = GEOFENCE_GRID_MIN_CELL;
+
+    while (cell < 2.0f * (radius + GEOFENCE_BOX_PAD) && level < GEOFENCE_GRID_LEVELS - 1) {
+        cell *= 2.0f;
+        level++;
+    }
+    return level;
+}
+
+/**
+ * @brief Cell coordinate of an ECEF coordinate at the finest level, clamped to the range of the cell keys. The
+ * coordinate at level k is this one shifted right k bits (floor division by 2^k). The clamp is monotonic, so a fence
+ * is still registered in the clamped cell of any position it contains.
+ *
+ * @param v  ECEF coordinate
+ * @return  Cell coordinate
+ */
+static int32_t cell_coord (
+        float v
+)
+{
+    float c = v * (1.0f / GEOFENCE_GRID_MIN_CELL);
+    int32_t i;
+
+    if (c < (float)-KEY_AXIS_BIAS) {
+        return -KEY_AXIS_BIAS;
+    }
+    if (c > (float)(KEY_AXIS_BIAS - 1)) {
+        return KEY_AXIS_BIAS - 1;
+    }
+
+    /* Floor without the libm call */
+    i = (int32_t)c;
+    return ((float)i > c) ? i - 1 : i;
+}
+
+/**
+ * @brief Key of a cell
+ * @param level  Level
+ * @param ix     Cell X
+ * @param iy     Cell Y
+ * @param iz     Cell Z
+ * @return  Key
+ */
+static uint64_t cell_key (
+        uint32_t level,
+        int32_t ix,
+        int32_t iy,
+        int32_t iz
+)
+{
+    return KEY_USED
+         | ((uint64_t)level << (3 * KEY_AXIS_BITS))
+         | ((uint64_t)(uint32_t)(ix + KEY_AXIS_BIAS) << (2 * KEY_AXIS_BITS))
+         | ((uint64_t)(uint32_t)(iy + KEY_AXIS_BIAS) << KEY_AXIS_BITS)
+         | (uint64_t)(uint32_t)(iz + KEY_AXIS_BIAS);
+}
+
+/**
+ * @brief Hash of a cell key
+ * @param key  Key
+ * @return  Hash
+ */
+static uint32_t key_hash (
+        uint64_t key
+)
+{
+    key ^= key >> 31;
+    key *= 0x7fb5d329728ea185ULL;
+    key ^= key >> 27;
+    return (uint32_t)key;
+}
+
+/**
+ * @brief Find a cell in the hash table
+ * @param g    Grid
+ * @param key  Key
+ * @return  The cell, or NULL if it has no fences
+ */
+static const geofence_cell_st* grid_find (
+        const geofence_grid_st* g,
+        uint64_t key
+)
+{
+    uint32_t slot = key_hash(key) & g->mask;
+
+    while (g->cells[slot].key != 0) {
+        if (g->cells[slot].key == key) {
+            return &g->cells[slot];
+        }
+        slot = (slot + 1) & g->mask;
+    }
+    return NULL;
+}
+
+/**
+ * @brief Compare two registrations by cell key, then by fence
+ */
+static int compare_entries (
+        const void* a,
+        const void* b
+)
+{
+    const entry_st* ea = (const entry_st*)a;
+    const entry_st* eb = (const entry_st*)b;
+
+    if (ea->key != eb->key) {
+        return (ea->key < eb->key) ? -1 : 1;
+    }
+    return (ea->fence < eb->fence) ? -1 : ((ea->fence > eb->fence) ? 1 : 0);
+}
+
+/**
+ * @brief Exact test of a circular fence
+ * @param m  Evaluation
+ * @param f  Fence
+ */
+static inline void match_circle (
+        match_st* m,
+        const geofence_st* f
+)
+{
+    float dx = m->x - f->ecef[0];
+    float dy = m->y - f->ecef[1];
+    float dz = m->z - f->ecef[2];
+
+    if (dx * dx + dy * dy + dz * dz <= f->radius_sq) {
+        if (m->n < m->max) {
+            m->ids[m->n] = f->id;
+        }
+        m->n++;
+    }
+}
+
+/**
+ * @brief Exact test of a candidate of the R-tree
+ * @param id   Box ID (see tree_build())
+ * @param ctx  Evaluation
+ */
+static void tree_candidate (
+        uint32_t id,
+        void* ctx
+)
+{
+    match_st* m = (match_st*)ctx;
+    uint32_t ncircles = tree_circles(m->s);
+    const polyfence_st* p;
+
+    if (id < ncircles) {
+        match_circle(m, &m->s->fences[id]);
+        return;
+    }
+
+    p = &m->s->polygons[id - ncircles];
+    if (polyfence_contains(p, m->x, m->y, m->z)) {
+        if (m->n < m->max) {
+            m->ids[m->n] = p->id;
+        }
+        m->n++;
+    }
+}
+
+/**
+ * @brief Search the nearest boundary of the circular fences of the grid index. The cells of each level are searched up
+ * to GEOFENCE_MARGIN_RINGS cells away from the cell of the position: a fence of the level registered in none of them
+ * has its box, and its boundary, farther than the searched cells.
+ *
+ * @param m      Search
+ * @param limit  Max distance searched in meters
+ */
+static void grid_margin (
+        margin_st* m,
+        float limit
+)
+{
+    const geofence_grid_st* g = &m->s->grid;
+    int32_t ix = cell_coord(m->x);
+    int32_t iy = cell_coord(m->y);
+    int32_t iz = cell_coord(m->z);
+
+    for (uint32_t levels = g->levels; levels != 0; levels &= levels - 1) {
+        uint32_t level = (uint32_t)__builtin_ctz(levels);
+        float cell = GEOFENCE_GRID_MIN_CELL * (float)(1u << level);
+        int32_t rings = (int32_t)ceilf(limit / cell);
+        int32_t cx = ix >> level;
+        int32_t cy = iy >> level;
+        int32_t cz = iz >> level;
+
+        if (rings > GEOFENCE_MARGIN_RINGS) {
+            rings = GEOFENCE_MARGIN_RINGS;
+            m->margin = fminf(m->margin, (float)rings * cell);
+        }
+
+        for (int32_t dx = -rings; dx <= rings; dx++) {
+            for (int32_t dy = -rings; dy <= rings; dy++) {
+                for (int32_t dz = -rings; dz <= rings; dz++) {
+                    const geofence_cell_st* c;
+
+                    /* Cells out of the range of the keys have no fences */
+                    if (cx + dx < -KEY_AXIS_BIAS || cx + dx >= KEY_AXIS_BIAS || cy + dy < -KEY_AXIS_BIAS ||
+                        cy + dy >= KEY_AXIS_BIAS || cz + dz < -KEY_AXIS_BIAS || cz + dz >= KEY_AXIS_BIAS) {
+                        continue;
+                    }
+                    c = grid_find(g, cell_key(level, cx + dx, cy + dy, cz + dz));
+                    for (uint32_t k = 0; c != NULL && k < c->count; k++) {
+                        margin_circle(m, &m->s->fences[g->items[c->start + k]]);
+                    }
+                }
+            }
+        }
+    }
+}
+
+/**
+ * @brief Distance to the boundary of a circular fence
+ * @param m  Search
+ * @param f  Fence
+ */
+static void margin_circle (
+        margin_st* m,
+        const geofence_st* f
+)
+{
+    float dx = m->x - f->ecef[0];
+    float dy = m->y - f->ecef[1];
+    float dz = m->z - f->ecef[2];
+
+    /* Tombstone */
+    if (f->radius < 0.0f) {
+        return;
+    }
+    m->margin = fminf(m->margin, fabsf(sqrtf(dx * dx + dy * dy + dz * dz) - f->radius));
+}
+
+/**
+ * @brief Distance to the boundary of a fence of the R-tree
+ * @param id   Box ID (see tree_build())
+ * @param ctx  Search
+ */
+static void tree_margin (
+        uint32_t id,
+        void* ctx
+)
+{
+    margin_st* m = (margin_st*)ctx;
+    uint32_t ncircles = tree_circles(m->s);
+
+    if (id < ncircles) {
+        margin_circle(m, &m->s->fences[id]);
+    } else if (m->s->polygons[id - ncircles].nvertices != 0) {
+        m->margin = fminf(m->margin, polyfence_distance(&m->s->polygons[id - ncircles], m->x, m->y, m->z));
+    }
+}
+
+/**
+ * @brief Build the hash table of IDs of a set, with every fence but the tombstones
+ * @param s  Set
+ * @return Zero on success, Otherwise a negative value
+ */
+static int refs_build (
+        geofence_set_st* s
+)
+{
+    uint32_t size = 16;
+
+    /* Hash table at most half full */
+    while (size < (s->count + s->npolygons) * 2) {
+        size *= 2;
+    }
+    s->refs = (geofence_ref_st*)malloc(size * sizeof(geofence_ref_st));
+    if (s->refs == NULL) {
+        return -1;
+    }
+    memset(s->refs, 0xFF, size * sizeof(geofence_ref_st));
+    s->refs_mask = size - 1;
+    s->nrefs = 0;
+
+    for (uint32_t i = 0; i < s->count; i++) {
+        if (s->fences[i].radius >= 0.0f) {
+            refs_put(s, s->fences[i].id, i);
+        }
+    }
+    for (uint32_t i = 0; i < s->npolygons; i++) {
+        if (s->polygons[i].nvertices != 0) {
+            refs_put(s, s->polygons[i].id, GEOFENCE_REF_POLYGON | i);
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief Put an entry in the hash table of IDs, which has room for it
+ * @param s    Set
+ * @param id   User ID
+ * @param ref  Slot of the fence
+ */
+static void refs_put (
+        geofence_set_st* s,
+        uint32_t id,
+        uint32_t ref
+)
+{
+    uint32_t slot = key_hash(id) & s->refs_mask;
+
+    while (s->refs[slot].ref != GEOFENCE_REF_EMPTY) {
+        slot = (slot + 1) & s->refs_mask;
+    }
+    s->refs[slot].id = id;
+    s->refs[slot].ref = ref;
+    s->nrefs++;
+}
+
+/**
+ * @brief Add a new fence to the hash table of IDs, if the set has it. A full table is built again, with the new fence
+ * @param s    Set
+ * @param id   User ID
+ * @param ref  Slot of the fence
+ */
+static void refs_add (
+        geofence_set_st* s,
+        uint32_t id,
+        uint32_t ref
+)
+{
+    if (s->refs == NULL) {
+        return;
+    }
+    if ((s->nrefs + 1) * 2 > s->refs_mask + 1) {
+        refs_free(s);
+        if (refs_build(s) != 0) {
+            refs_free(s);
+        }
+        return;
+    }
+    refs_put(s, id, ref);
+}
+
+/**
+ * @brief Find a fence in the hash table of IDs. The table is built first if the set does not have it
+ * @param s   Set
+ * @param id  User ID
+ * @return Entry of the fence, Otherwise a negative value if no fence has the ID
+ */
+static int32_t refs_find (
+        geofence_set_st* s,
+        uint32_t id
+)
+{
+    uint32_t slot;
+
+    if (s->refs == NULL && refs_build(s) != 0) {
+        refs_free(s);
+        return -1;
+    }
+
+    slot = key_hash(id) & s->refs_mask;
+    while (s->refs[slot].ref != GEOFENCE_REF_EMPTY) {
+        if (s->refs[slot].id == id) {
+            return (int32_t)slot;
+        }
+        slot = (slot + 1) & s->refs_mask;
+    }
+    return -1;
+}
+
+/**
+ * @brief Delete an entry of the hash table of IDs. The next entries of the probe sequence are shifted back, so the
+ * table has no deleted entries
+ *
+ * @param s     Set
+ * @param slot  Entry
+ */
+static void refs_delete (
+        geofence_set_st* s,
+        uint32_t slot
+)
+{
+    uint32_t hole = slot;
+
+    for (uint32_t i = (slot + 1) & s->refs_mask; s->refs[i].ref != GEOFENCE_REF_EMPTY; i = (i + 1) & s->refs_mask) {
+        uint32_t home = key_hash(s->refs[i].id) & s->refs_mask;
+
+        /* The entry can fill the hole if its home slot is not between the hole and the entry */
+        if (((i - home) & s->refs_mask) >= ((i - hole) & s->refs_mask)) {
+            s->refs[hole] = s->refs[i];
+            hole = i;
+        }
+    }
+    s->refs[hole].ref = GEOFENCE_REF_EMPTY;
+    s->nrefs--;
+}
+
+/**
+ * @brief Release the hash table of IDs of a set
+ * @param s  Set
+ */
+static void refs_free (
+        geofence_set_st* s
+)
+{
+    free(s->refs);
+    s->refs = NULL;
+    s->refs_mask = 0;
+    s->nrefs = 0;
+}
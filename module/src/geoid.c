@@ -0,0 +1,297 @@
+/**
+ * @file geoid.c
+ *
+ * Geoid undulation grid
+ *
+ * @license
+ * All rights reserved. Read LICENSE.txt file for the license terms.
+ *
+ * Changelog:
+ *
+ * [18/10/2026]     [miguelgarcia]
+ * Initial version
+ *
+ */
+
+/* -- Includes -- */
+#include <fcntl.h>
+#include <math.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "geoid.h"
+
+/* -- Local functions -- */
+static uint32_t read_u32(const uint8_t* p);
+static float read_f32(const uint8_t* p);
+static void load_cell(const geoid_st* g, int32_t row, int32_t col, int32_t col1, float v[4]);
+
+
+/**
+ * @brief Initialize a grid from a memory buffer with the grid file contents (e.g. a grid stored in flash). The buffer
+ * must be kept while the grid is used.
+ *
+ * @param [out] g     Grid
+ * @param [in]  data  Grid file contents, aligned to 2 bytes
+ * @param [in]  sz    Size of the contents in bytes
+ * @return Zero if the grid is valid, Otherwise a negative value
+ */
+int geoid_init (
+        geoid_st* g,
+        const void* data,
+        size_t sz
+)
+{
+    const uint8_t* p = (const uint8_t*)data;
+    uint32_t header_sz;
+    float dlat, dlon;
+
+    memset(g, 0, sizeof(geoid_st));
+
+    if (p == NULL || sz < GEOID_GRID_HEADER_SZ || ((uintptr_t)p & 1) != 0) {
+        return -1;
+    }
+    if (memcmp(p, GEOID_GRID_MAGIC, 8) != 0 || read_u32(&p[8]) != GEOID_GRID_VERSION) {
+        return -1;
+    }
+
+    header_sz = read_u32(&p[12]);
+    g->lat0 = read_f32(&p[16]);
+    g->lon0 = read_f32(&p[20]);
+    dlat = read_f32(&p[24]);
+    dlon = read_f32(&p[28]);
+    g->rows = read_u32(&p[32]);
+    g->cols = read_u32(&p[36]);
+    g->scale = read_f32(&p[40]);
+    g->offset = read_f32(&p[44]);
+
+    if (header_sz < GEOID_GRID_HEADER_SZ || (header_sz & 1) != 0 || !(dlat > 0.0f) || !(dlon > 0.0f)) {
+        return -1;
+    }
+    if (g->rows < 2 || g->cols < 2 || g->rows > INT32_MAX / g->cols) {
+        return -1;
+    }
+    if (sz < header_sz || (sz - header_sz) / sizeof(int16_t) < (size_t)g->rows * g->cols) {
+        return -1;
+    }
+
+    g->samples = (const int16_t*)(p + header_sz);
+    g->inv_dlat = 1.0f / dlat;
+    g->inv_dlon = 1.0f / dlon;
+
+    /* The grid wraps around the antimeridian when it has a column for every meridian */
+    {
+        uint32_t n360 = (uint32_t)lroundf(360.0f / dlon);
+        if (fabsf((float)n360 * dlon - 360.0f) < dlon * 1e-3f && g->cols >= n360) {
+            g->wrap_cols = n360;
+        }
+    }
+
+    return 0;
+}
+
+
+/**
+ * @brief Map a grid file in memory
+ * @param [out] g     Grid
+ * @param [in]  path  Grid file path
+ * @return Zero if the grid is valid, Otherwise a negative value
+ */
+int geoid_open (
+        geoid_st* g,
+        const char* path
+)
+{
+    struct stat st;
+    void* map;
+    int fd;
+
+    memset(g, 0, sizeof(geoid_st));
+
+    fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return -1;
+    }
+    if (fstat(fd, &st) != 0 || st.st_size < GEOID_GRID_HEADER_SZ) {
+        close(fd);
+        return -1;
+    }
+
+    map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        return -1;
+    }
+
+    if (geoid_init(g, map, (size_t)st.st_size) != 0) {
+        munmap(map, (size_t)st.st_size);
+        return -1;
+    }
+
+    g->map = map;
+    g->map_sz = (size_t)st.st_size;
+    return 0;
+}
+
+
+/**
+ * @brief Release a grid mapped with geoid_open()
+ * @param [in] g  Grid
+ */
+void geoid_close (
+        geoid_st* g
+)
+{
+    if (g->map != NULL) {
+        munmap(g->map, g->map_sz);
+    }
+    memset(g, 0, sizeof(geoid_st));
+}
+
+
+/**
+ * @brief Reset a device cache
+ * @param [out] c  Cache
+ */
+void geoid_cache_reset (
+        geoid_cache_st* c
+)
+{
+    memset(c, 0, sizeof(geoid_cache_st));
+    c->row = -1;
+}
+
+
+/**
+ * @brief Get the geoid undulation at a position
+ * @param [in]     g    Grid
+ * @param [in,out] c    Device cache, can be NULL
+ * @param [in]     lat  Latitude in decimal degrees
+ * @param [in]     lon  Longitude in decimal degrees
+ * @return Geoid undulation in meters (ellipsoidal height = MSL altitude + undulation)
+ */
+float geoid_get_undulation (
+        const geoid_st* g,
+        geoid_cache_st* c,
+        float lat,
+        float lon
+)
+{
+    float fy = (lat - g->lat0) * g->inv_dlat;
+    float fx = (lon - g->lon0) * g->inv_dlon;
+    float ty, tx;
+    int32_t row, col, col1;
+    float local[4];
+    float* v;
+
+    /* Cell row, clamped to the grid */
+    row = (int32_t)floorf(fy);
+    if (row < 0) {
+        row = 0;
+    } else if (row > (int32_t)g->rows - 2) {
+        row = (int32_t)g->rows - 2;
+    }
+    ty = fy - (float)row;
+    ty = (ty < 0.0f) ? 0.0f : ((ty > 1.0f) ? 1.0f : ty);
+
+    /* Cell column, wrapped around the antimeridian or clamped to the grid */
+    if (g->wrap_cols) {
+        fx = fmodf(fx, (float)g->wrap_cols);
+        if (fx < 0.0f) {
+            fx += (float)g->wrap_cols;
+        }
+        col = (int32_t)fx;
+        if (col >= (int32_t)g->wrap_cols) {
+            col = 0;
+            fx = 0.0f;
+        }
+        col1 = (col + 1 == (int32_t)g->wrap_cols) ? 0 : col + 1;
+    } else {
+        col = (int32_t)floorf(fx);
+        if (col < 0) {
+            col = 0;
+        } else if (col > (int32_t)g->cols - 2) {
+            col = (int32_t)g->cols - 2;
+        }
+        col1 = col + 1;
+    }
+    tx = fx - (float)col;
+    tx = (tx < 0.0f) ? 0.0f : ((tx > 1.0f) ? 1.0f : tx);
+
+    /* Corners of the cell, from the device cache if it is the same cell */
+    if (c == NULL) {
+        v = local;
+        load_cell(g, row, col, col1, v);
+    } else {
+        v = c->v;
+        if (c->row == row && c->col == col) {
+            c->hits++;
+        } else {
+            load_cell(g, row, col, col1, v);
+            c->row = row;
+            c->col = col;
+            c->misses++;
+        }
+    }
+
+    /* Bilinear interpolation */
+    {
+        float s = v[0] + (v[1] - v[0]) * tx;
+        float n = v[2] + (v[3] - v[2]) * tx;
+        return s + (n - s) * ty;
+    }
+}
+
+
+/**
+ * @brief Load the undulation at the corners of a cell
+ * @param [in]  g     Grid
+ * @param [in]  row   Cell row
+ * @param [in]  col   Cell west column
+ * @param [in]  col1  Cell east column
+ * @param [out] v     Undulation at the corners (south-west, south-east, north-west, north-east)
+ */
+static void load_cell (
+        const geoid_st* g,
+        int32_t row,
+        int32_t col,
+        int32_t col1,
+        float v[4]
+)
+{
+    const int16_t* south = &g->samples[(size_t)row * g->cols];
+    const int16_t* north = south + g->cols;
+
+    v[0] = g->offset + g->scale * (float)south[col];
+    v[1] = g->offset + g->scale * (float)south[col1];
+    v[2] = g->offset + g->scale * (float)north[col];
+    v[3] = g->offset + g->scale * (float)north[col1];
+}
+
+/**
+ * @brief Read a little-endian uint32
+ * @param p  Input bytes
+ * @return  The value
+ */
+static uint32_t read_u32 (
+        const uint8_t* p
+)
+{
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+/**
+ * @brief Read a little-endian float
+ * @param p  Input bytes
+ * @return  The value
+ */
+static float read_f32 (
+        const uint8_t* p
+)
+{
+    uint32_t u = read_u32(p);
+    float f;
+    memcpy(&f, &u, sizeof(f));
+    return f;
+}
@@ -0,0 +1,670 @@
+/**
+ * @file kdtree.c
+ *
+ * ECEF k-d tree for nearest-target queries
+ *
+ * @license
+ * All rights reserved. Read LICENSE.txt file for the license terms.
+ *
+ * Changelog:
+ *
+ * [18/10/2026]     [miguelgarcia]
+ * Initial version
+ *
+ */
+
+/* -- Includes -- */
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include "parallel.h"
+#include "target.h"
+#include "kdtree.h"
+
+/* -- Definitions -- */
+
+/** Max number of subtrees built in parallel */
+#define BUILD_MAX_TASKS     1024
+/** Subtrees per worker thread, so the workers stay busy when the subtrees are unbalanced */
+#define BUILD_TASKS_WORKER  4
+/** Ranges smaller than this are not split before the parallel build */
+#define BUILD_MIN_SPLIT     1024
+/** Positions converted to ECEF per task */
+#define CONVERT_CHUNK       4096
+/** Queries per task of a batch */
+#define BATCH_CHUNK         64
+
+/* -- Local types -- */
+
+/** Range of nodes [lo, hi) */
+typedef struct {
+    uint32_t lo;
+    uint32_t hi;
+} range_st;
+
+/** State of a parallel build */
+typedef struct {
+    kdtree_st* t;
+    const position_st* points;
+    const range_st* ranges;
+} build_st;
+
+/** State of a batch query */
+typedef struct {
+    const kdtree_st* t;
+    const float* queries;
+    uint32_t nq;
+    uint32_t k;
+    kdtree_result_st* out;
+    uint32_t* counts;
+} batch_st;
+
+/* -- Local functions -- */
+static int tree_alloc(kdtree_st* t, uint32_t n);
+static int tree_build(kdtree_st* t, uint32_t threads);
+static uint32_t split_range(kdtree_st* t, uint32_t lo, uint32_t hi);
+static void build_range(kdtree_st* t, uint32_t lo, uint32_t hi);
+static void select_nth(kdtree_node_st* nodes, uint32_t lo, uint32_t hi, uint32_t nth, uint8_t axis);
+static void convert_task(uint32_t task, uint32_t worker, void* arg);
+static void build_task(uint32_t task, uint32_t worker, void* arg);
+static void batch_task(uint32_t task, uint32_t worker, void* arg);
+static void knn_range(const kdtree_st* t, uint32_t lo, uint32_t hi, const float q[3], uint32_t k,
+                      kdtree_result_st* heap, uint32_t* cnt);
+static void radius_range(const kdtree_st* t, uint32_t lo, uint32_t hi, const float q[3], float r2,
+                         kdtree_result_st* out, uint32_t max, uint32_t* cnt);
+static void heap_sift_down(kdtree_result_st* heap, uint32_t n, uint32_t i);
+
+
+/**
+ * @brief Build a tree from geodetic positions. The ID of each target is its index in the positions.
+ * @param [out] t        Tree
+ * @param [in]  points   Geodetic positions. Latitude and Longitude in decimal degrees, ellipsoidal height in meters
+ * @param [in]  n        Number of positions
+ * @param [in]  threads  Number of worker threads, zero to use all the processors
+ * @return Zero on success, Otherwise a negative value
+ */
+int kdtree_build (
+        kdtree_st* t,
+        const position_st* points,
+        uint32_t n,
+        uint32_t threads
+)
+{
+    build_st b;
+
+    if (tree_alloc(t, n) != 0) {
+        return -1;
+    }
+
+    b.t = t;
+    b.points = points;
+    b.ranges = NULL;
+    parallel_for((n + CONVERT_CHUNK - 1) / CONVERT_CHUNK, threads, convert_task, &b);
+
+    return tree_build(t, threads);
+}
+
+/**
+ * @brief Build a tree from the targets of the target table. The ID of each target is its index in the table.
+ * @param [out] t        Tree
+ * @param [in]  threads  Number of worker threads, zero to use all the processors
+ * @return Zero on success, Otherwise a negative value
+ */
+int kdtree_build_targets (
+        kdtree_st* t,
+        uint32_t threads
+)
+{
+    uint32_t n = target_get_count();
+
+    if (tree_alloc(t, n) != 0) {
+        return -1;
+    }
+
+    for (uint32_t i = 0; i < n; i++) {
+        memcpy(t->nodes[i].p, target_get_entry(i)->ecef, sizeof(t->nodes[i].p));
+        t->nodes[i].id = i;
+    }
+
+    return tree_build(t, threads);
+}
+
+/**
+ * @brief Release a tree
+ * @param [in] t  Tree
+ */
+void kdtree_free (
+        kdtree_st* t
+)
+{
+    free(t->nodes);
+    free(t->axes);
+    memset(t, 0, sizeof(kdtree_st));
+}
+
+/**
+ * @brief Find the k nearest targets to an ECEF position
+ * @param [in]  t    Tree
+ * @param [in]  x    ECEF X
+ * @param [in]  y    ECEF Y
+ * @param [in]  z    ECEF Z
+ * @param [in]  k    Number of targets
+ * @param [out] out  Nearest targets, sorted by distance. Room for k results
+ * @return Number of results, k or the number of targets if it is lower
+ */
+uint32_t kdtree_knn (
+        const kdtree_st* t,
+        float x,
+        float y,
+        float z,
+        uint32_t k,
+        kdtree_result_st* out
+)
+{
+    const float q[3] = {x, y, z};
+    uint32_t cnt = 0;
+
+    if (k == 0) {
+        return 0;
+    }
+
+    /* The output is a max-heap of squared distances during the search */
+    knn_range(t, 0, t->n, q, k, out, &cnt);
+
+    /* Heap sort, ascending */
+    for (uint32_t n = cnt; n > 1; n--) {
+        kdtree_result_st tmp = out[0];
+        out[0] = out[n - 1];
+        out[n - 1] = tmp;
+        heap_sift_down(out, n - 1, 0);
+    }
+    for (uint32_t i = 0; i < cnt; i++) {
+        out[i].dist = sqrtf(out[i].dist);
+    }
+
+    return cnt;
+}
+
+/**
+ * @brief Find the targets within a distance of an ECEF position
+ * @param [in]  t       Tree
+ * @param [in]  x       ECEF X
+ * @param [in]  y       ECEF Y
+ * @param [in]  z       ECEF Z
+ * @param [in]  radius  Max distance in meters (inclusive)
+ * @param [out] out     Targets within the distance, not sorted
+ * @param [in]  max     Size of the output buffer
+ * @return Number of targets within the distance. If it is larger than max, only max results are written
+ */
+uint32_t kdtree_radius (
+        const kdtree_st* t,
+        float x,
+        float y,
+        float z,
+        float radius,
+        kdtree_result_st* out,
+        uint32_t max
+)
+{
+    const float q[3] = {x, y, z};
+    uint32_t cnt = 0;
+
+    if (radius < 0.0f) {
+        return 0;
+    }
+
+    radius_range(t, 0, t->n, q, radius * radius, out, max, &cnt);
+
+    for (uint32_t i = 0; i < cnt && i < max; i++) {
+        out[i].dist = sqrtf(out[i].dist);
+    }
+    return cnt;
+}
+
+/**
+ * @brief Find the k nearest targets to many ECEF positions, using several threads
+ * @param [in]  t        Tree
+ * @param [in]  queries  ECEF positions (x, y, z) * nq
+ * @param [in]  nq       Number of positions
+ * @param [in]  k        Number of targets per position
+ * @param [out] out      Nearest targets of each position, sorted by distance. Room for nq * k results
+ * @param [out] counts   Number of results of each position, can be NULL
+ * @param [in]  threads  Number of worker threads, zero to use all the processors
+ * @return Zero on success, Otherwise a negative value
+ */
+int kdtree_knn_batch (
+        const kdtree_st* t,
+        const float* queries,
+        uint32_t nq,
+        uint32_t k,
+        kdtree_result_st* out,
+        uint32_t* counts,
+        uint32_t threads
+)
+{
+    batch_st b;
+
+    if (queries == NULL || out == NULL) {
+        return -1;
+    }
+
+    b.t = t;
+    b.queries = queries;
+    b.nq = nq;
+    b.k = k;
+    b.out = out;
+    b.counts = counts;
+    parallel_for((nq + BATCH_CHUNK - 1) / BATCH_CHUNK, threads, batch_task, &b);
+
+    return 0;
+}
+
+/**
+ * @brief Allocate the nodes of a tree
+ * @param t  Tree
+ * @param n  Number of nodes
+ * @return Zero on success, Otherwise a negative value
+ */
+static int tree_alloc (
+        kdtree_st* t,
+        uint32_t n
+)
+{
+    memset(t, 0, sizeof(kdtree_st));
+
+    t->nodes = (kdtree_node_st*)malloc(((size_t)n + 1) * sizeof(kdtree_node_st));
+    t->axes = (uint8_t*)malloc((size_t)n + 1);
+    if (t->nodes == NULL || t->axes == NULL) {
+        kdtree_free(t);
+        return -1;
+    }
+    t->n = n;
+    return 0;
+}
+
+/**
+ * @brief Arrange the nodes in implicit tree order. The top levels are split by the calling thread until there are
+ * enough subtrees for the workers, and then the subtrees are built in parallel.
+ *
+ * @param t        Tree
+ * @param threads  Number of worker threads, zero to use all the processors
+ * @return Zero on success, Otherwise a negative value
+ */
+static int tree_build (
+        kdtree_st* t,
+        uint32_t threads
+)
+{
+    range_st* ranges;
+    range_st* next;
+    uint32_t nranges = 1;
+    uint32_t workers = (threads == 0) ? parallel_default_threads() : threads;
+    uint32_t target = workers * BUILD_TASKS_WORKER;
+    build_st b;
+
+    if (target > BUILD_MAX_TASKS) {
+        target = BUILD_MAX_TASKS;
+    }
+
+    ranges = (range_st*)malloc(2 * BUILD_MAX_TASKS * sizeof(range_st));
+    if (ranges == NULL) {
+        return -1;
+    }
+    next = &ranges[BUILD_MAX_TASKS];
+
+    ranges[0].lo = 0;
+    ranges[0].hi = t->n;
+
+    /* Top levels, one level at a time */
+    while (nranges < target && workers > 1) {
+        uint32_t nnext = 0;
+        uint8_t split = 0;
+
+        for (uint32_t r = 0; r < nranges; r++) {
+            if (ranges[r].hi - ranges[r].lo >= BUILD_MIN_SPLIT && nnext + 2 <= BUILD_MAX_TASKS) {
+                uint32_t mid = split_range(t, ranges[r].lo, ranges[r].hi);
+                next[nnext].lo = ranges[r].lo;
+                next[nnext++].hi = mid;
+                next[nnext].lo = mid + 1;
+                next[nnext++].hi = ranges[r].hi;
+                split = 1;
+            } else {
+                next[nnext++] = ranges[r];
+            }
+        }
+
+        memcpy(ranges, next, nnext * sizeof(range_st));
+        nranges = nnext;
+        if (!split) {
+            break;
+        }
+    }
+
+    b.t = t;
+    b.points = NULL;
+    b.ranges = ranges;
+    parallel_for(nranges, workers, build_task, &b);
+
+    free(ranges);
+    return 0;
+}
+
+/**
+ * @brief Make the median of a range the root of the range, splitting on the axis with the largest extent
+ * @param t   Tree
+ * @param lo  First node of the range
+ * @param hi  End of the range
+ * @return  Root of the range
+ */
+static uint32_t split_range (
+        kdtree_st* t,
+        uint32_t lo,
+        uint32_t hi
+)
+{
+    float min[3], max[3];
+    uint32_t mid = lo + (hi - lo) / 2;
+    uint8_t axis = 0;
+
+    memcpy(min, t->nodes[lo].p, sizeof(min));
+    memcpy(max, t->nodes[lo].p, sizeof(max));
+    for (uint32_t i = lo + 1; i < hi; i++) {
+        for (int a = 0; a < 3; a++) {
+            float v = t->nodes[i].p[a];
+            min[a] = (v < min[a]) ? v : min[a];
+            max[a] = (v > max[a]) ? v : max[a];
+        }
+    }
+    for (uint8_t a = 1; a < 3; a++) {
+        if (max[a] - min[a] > max[axis] - min[axis]) {
+            axis = a;
+        }
+    }
+
+    select_nth(t->nodes, lo, hi, mid, axis);
+    t->axes[mid] = axis;
+    return mid;
+}
+
+/**
+ * @brief Arrange a range of nodes in implicit tree order
+ * @param t   Tree
+ * @param lo  First node of the range
+ * @param hi  End of the range
+ */
+static void build_range (
+        kdtree_st* t,
+        uint32_t lo,
+        uint32_t hi
+)
+{
+    while (hi - lo > 1) {
+        uint32_t mid = split_range(t, lo, hi);
+        build_range(t, lo, mid);
+        lo = mid + 1;
+    }
+    if (hi - lo == 1) {
+        t->axes[lo] = 0;
+    }
+}
+
+/**
+ * @brief Partial sort of a range of nodes on an axis, so the nth node is in its sorted place, the nodes before it are
+ * not greater and the nodes after it are not lower. Three-way partitions, so equal coordinates do not degrade it.
+ *
+ * @param nodes  Nodes
+ * @param lo     First node of the range
+ * @param hi     End of the range
+ * @param nth    Node to place
+ * @param axis   Axis
+ */
+static void select_nth (
+        kdtree_node_st* nodes,
+        uint32_t lo,
+        uint32_t hi,
+        uint32_t nth,
+        uint8_t axis
+)
+{
+    while (hi - lo > 1) {
+        float a = nodes[lo].p[axis];
+        float b = nodes[lo + (hi - lo) / 2].p[axis];
+        float c = nodes[hi - 1].p[axis];
+        float pivot = (a < b) ? ((b < c) ? b : ((a < c) ? c : a)) : ((a < c) ? a : ((b < c) ? c : b));
+        uint32_t lt = lo, i = lo, gt = hi;
+
+        while (i < gt) {
+            float v = nodes[i].p[axis];
+            if (v < pivot) {
+                kdtree_node_st tmp = nodes[lt];
+                nodes[lt++] = nodes[i];
+                nodes[i++] = tmp;
+            } else if (v > pivot) {
+                kdtree_node_st tmp = nodes[--gt];
+                nodes[gt] = nodes[i];
+                nodes[i] = tmp;
+            } else {
+                i++;
+            }
+        }
+
+        if (nth < lt) {
+            hi = lt;
+        } else if (nth >= gt) {
+            lo = gt;
+        } else {
+            return;
+        }
+    }
+}
+
+/**
+ * @brief Convert a chunk of positions to ECEF
+ * @param task    Chunk index
+ * @param worker  Worker index
+ * @param arg     Build state
+ */
+static void convert_task (
+        uint32_t task,
+        uint32_t worker,
+        void* arg
+)
+{
+    build_st* b = (build_st*)arg;
+    uint32_t i0 = task * CONVERT_CHUNK;
+    uint32_t i1 = (i0 + CONVERT_CHUNK < b->t->n) ? i0 + CONVERT_CHUNK : b->t->n;
+
+    (void)worker;
+    for (uint32_t i = i0; i < i1; i++) {
+        kdtree_node_st* node = &b->t->nodes[i];
+        position_geodetic_to_ecef(b->points[i].latitude, b->points[i].longitude, b->points[i].altitude,
+                                  &node->p[0], &node->p[1], &node->p[2]);
+        node->id = i;
+    }
+}
+
+/**
+ * @brief Build a subtree
+ * @param task    Subtree index
+ * @param worker  Worker index
+ * @param arg     Build state
+ */
+static void build_task (
+        uint32_t task,
+        uint32_t worker,
+        void* arg
+)
+{
+    build_st* b = (build_st*)arg;
+
+    (void)worker;
+    build_range(b->t, b->ranges[task].lo, b->ranges[task].hi);
+}
+
+/**
+ * @brief Run a chunk of the queries of a batch
+ * @param task    Chunk index
+ * @param worker  Worker index
+ * @param arg     Batch state
+ */
+static void batch_task (
+        uint32_t task,
+        uint32_t worker,
+        void* arg
+)
+{
+    batch_st* b = (batch_st*)arg;
+    uint32_t i0 = task * BATCH_CHUNK;
+    uint32_t i1 = (i0 + BATCH_CHUNK < b->nq) ? i0 + BATCH_CHUNK : b->nq;
+
+    (void)worker;
+    for (uint32_t i = i0; i < i1; i++) {
+        const float* q = &b->queries[(size_t)i * 3];
+        uint32_t n = kdtree_knn(b->t, q[0], q[1], q[2], b->k, &b->out[(size_t)i * b->k]);
+        if (b->counts != NULL) {
+            b->counts[i] = n;
+        }
+    }
+}
+
+/**
+ * @brief k nearest search in a subtree. The nearest side is searched first, and the far side only if the splitting
+ * plane is closer than the k-th distance found.
+ *
+ * @param t     Tree
+ * @param lo    First node of the subtree
+ * @param hi    End of the subtree
+ * @param q     Query position
+ * @param k     Number of targets
+ * @param heap  Max-heap of squared distances
+ * @param cnt   Number of elements of the heap
+ */
+static void knn_range (
+        const kdtree_st* t,
+        uint32_t lo,
+        uint32_t hi,
+        const float q[3],
+        uint32_t k,
+        kdtree_result_st* heap,
+        uint32_t* cnt
+)
+{
+    while (lo < hi) {
+        uint32_t mid = lo + (hi - lo) / 2;
+        const kdtree_node_st* node = &t->nodes[mid];
+        float dx = q[0] - node->p[0];
+        float dy = q[1] - node->p[1];
+        float dz = q[2] - node->p[2];
+        float d2 = dx * dx + dy * dy + dz * dz;
+        float diff = q[t->axes[mid]] - node->p[t->axes[mid]];
+
+        if (*cnt < k) {
+            /* Sift up */
+            uint32_t i = (*cnt)++;
+            while (i > 0 && heap[(i - 1) / 2].dist < d2) {
+                heap[i] = heap[(i - 1) / 2];
+                i = (i - 1) / 2;
+            }
+            heap[i].id = node->id;
+            heap[i].dist = d2;
+        } else if (d2 < heap[0].dist) {
+            heap[0].id = node->id;
+            heap[0].dist = d2;
+            heap_sift_down(heap, k, 0);
+        }
+
+        if (diff < 0.0f) {
+            knn_range(t, lo, mid, q, k, heap, cnt);
+            lo = mid + 1;
+        } else {
+            knn_range(t, mid + 1, hi, q, k, heap, cnt);
+            hi = mid;
+        }
+
+        if (*cnt == k && diff * diff > heap[0].dist) {
+            return;
+        }
+    }
+}
+
+/**
+ * @brief Radius search in a subtree
+ * @param t    Tree
+ * @param lo   First node of the subtree
+ * @param hi   End of the subtree
+ * @param q    Query position
+ * @param r2   Squared radius
+ * @param out  Results, with squared distances
+ * @param max  Size of the results buffer
+ * @param cnt  Number of targets found
+ */
+static void radius_range (
+        const kdtree_st* t,
+        uint32_t lo,
+        uint32_t hi,
+        const float q[3],
+        float r2,
+        kdtree_result_st* out,
+        uint32_t max,
+        uint32_t* cnt
+)
+{
+    while (lo < hi) {
+        uint32_t mid = lo + (hi - lo) / 2;
+        const kdtree_node_st* node = &t->nodes[mid];
+        float dx = q[0] - node->p[0];
+        float dy = q[1] - node->p[1];
+        float dz = q[2] - node->p[2];
+        float d2 = dx * dx + dy * dy + dz * dz;
+        float diff = q[t->axes[mid]] - node->p[t->axes[mid]];
+
+        if (d2 <= r2) {
+            if (*cnt < max) {
+                out[*cnt].id = node->id;
+                out[*cnt].dist = d2;
+            }
+            (*cnt)++;
+        }
+
+        /* Both sides when the sphere crosses the splitting plane */
+        if (diff * diff <= r2) {
+            radius_range(t, lo, mid, q, r2, out, max, cnt);
+            lo = mid + 1;
+        } else if (diff < 0.0f) {
+            hi = mid;
+        } else {
+            lo = mid + 1;
+        }
+    }
+}
+
+/**
+ * @brief Restore the max-heap order below an element
+ * @param heap  Heap
+ * @param n     Number of elements
+ * @param i     Element
+ */
+static void heap_sift_down (
+        kdtree_result_st* heap,
+        uint32_t n,
+        uint32_t i
+)
+{
+    kdtree_result_st e = heap[i];
+
+    for (;;) {
+        uint32_t c = 2 * i + 1;
+        if (c >= n) {
+            break;
+        }
+        if (c + 1 < n && heap[c + 1].dist > heap[c].dist) {
+            c++;
+        }
+        if (heap[c].dist <= e.dist) {
+            break;
+        }
+        heap[i] = heap[c];
+        i = c;
+    }
+    heap[i] = e;
+}
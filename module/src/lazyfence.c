@@ -0,0 +1,144 @@
+/**
+ * @file lazyfence.c
+ *
+ * Lazy geofence evaluation
+ *
+ * @license
+ * All rights reserved. Read LICENSE.txt file for the license terms.
+ *
+ * Changelog:
+ *
+ * [18/10/2026]     [miguelgarcia]
+ * Initial version
+ *
+ * [18/10/2026]     [miguelgarcia]
+ * Edits of the set
+ *
+ * [18/10/2026]     [miguelgarcia]
+ * Displacement bound from position.h
+ *
+ * [18/10/2026]     [miguelgarcia]
+ * Set of the last full evaluation
+ *
+ */
+
+/* -- Includes -- */
+#include <string.h>
+#include "lazyfence.h"
+
+/* -- Local functions -- */
+static uint32_t copy_ids(const lazyfence_st* l, uint32_t* ids, uint32_t max);
+
+
+/**
+ * @brief Initialize an evaluator
+ * @param [out] l          Evaluator
+ * @param [in]  max_speed  Max plausible speed of the device in m/s, zero for no bound
+ */
+void lazyfence_init (
+        lazyfence_st* l,
+        float max_speed
+)
+{
+    memset(l, 0, sizeof(lazyfence_st));
+    l->max_speed = max_speed;
+    l->margin = -1.0f;
+}
+
+/**
+ * @brief Forget the last full evaluation, so the next position is evaluated. Another set is detected by the evaluator,
+ * so it is only needed when the fences of the set change without a new version.
+ * @param [in] l  Evaluator
+ */
+void lazyfence_reset (
+        lazyfence_st* l
+)
+{
+    l->margin = -1.0f;
+    l->set = NULL;
+}
+
+/**
+ * @brief Get an upper bound of the distance from the anchor of an evaluator to a position
+ * @param [in] l    Evaluator, with an anchor
+ * @param [in] llh  Position. Latitude and Longitude in decimal degrees, ellipsoidal height in meters
+ * @return Distance in meters
+ */
+float lazyfence_displacement (
+        const lazyfence_st* l,
+        const position_st* llh
+)
+{
+    return position_displacement_bound(&l->anchor, l->cos_lat, llh);
+}
+
+/**
+ * @brief Find the fences that contain a device position, from the last full evaluation if the device cannot have
+ * crossed a fence boundary since then.
+ *
+ * @param [in]  l     Evaluator
+ * @param [in]  s     Set of fences
+ * @param [in]  llh   Position. Latitude and Longitude in decimal degrees, ellipsoidal height in meters
+ * @param [in]  time  Time of the position in seconds. A time before the last full evaluation does not use the speed
+ * @param [out] ids   IDs of the fences that contain the position
+ * @param [in]  max   Size of the IDs buffer
+ * @return Number of fences that contain the position. If it is larger than max, only max IDs are written
+ */
+uint32_t lazyfence_evaluate (
+        lazyfence_st* l,
+        geofence_set_st* s,
+        const position_st* llh,
+        double time,
+        uint32_t* ids,
+        uint32_t max
+)
+{
+    float xyz[3];
+    uint32_t n;
+
+    /* The kept IDs must fill the output, and they must be found in the same set, not edited since then */
+    if (l->margin > 0.0f && l->set == s && l->version == s->version && (l->n <= l->kept || max <= l->kept)) {
+        uint8_t still = (l->max_speed > 0.0f && time >= l->time && (time - l->time) * l->max_speed < l->margin);
+
+        if (still || lazyfence_displacement(l, llh) < l->margin) {
+            l->skipped++;
+            return copy_ids(l, ids, max);
+        }
+    }
+
+    position_geodetic_to_ecef(llh->latitude, llh->longitude, llh->altitude, &xyz[0], &xyz[1], &xyz[2]);
+    n = geofence_evaluate(s, xyz[0], xyz[1], xyz[2], l->ids, LAZYFENCE_MAX_IDS);
+
+    l->anchor = *llh;
+    l->cos_lat = position_cos_latitude(llh->latitude);
+    l->time = time;
+    l->margin = geofence_margin(s, xyz[0], xyz[1], xyz[2], LAZYFENCE_MAX_MARGIN) - LAZYFENCE_PAD;
+    l->set = s;
+    l->version = s->version;
+    l->n = n;
+    l->kept = (n < LAZYFENCE_MAX_IDS) ? n : LAZYFENCE_MAX_IDS;
+    l->evaluations++;
+
+    /* More fences than kept, the output gets all of them */
+    if (max > l->kept && n > l->kept) {
+        return geofence_evaluate(s, xyz[0], xyz[1], xyz[2], ids, max);
+    }
+    return copy_ids(l, ids, max);
+}
+
+/**
+ * @brief Copy the kept IDs of an evaluator
+ * @param l    Evaluator
+ * @param ids  IDs of the fences that contain the anchor
+ * @param max  Size of the IDs buffer
+ * @return Number of fences that contain the anchor
+ */
+static uint32_t copy_ids (
+        const lazyfence_st* l,
+        uint32_t* ids,
+        uint32_t max
+)
+{
+    memcpy(ids, l->ids, ((l->kept < max) ? l->kept : max) * sizeof(uint32_t));
+    return l->n;
+}
@@ -0,0 +1,282 @@
+/**
+ * @file membership.c
+ *
+ * Device fence membership
+ *
+ * @license
+ * All rights reserved. Read LICENSE.txt file for the license terms.
+ *
+ * Changelog:
+ *
+ * [18/10/2026]     [miguelgarcia]
+ * Initial version
+ *
+ */
+
+/* -- Includes -- */
+#include <stdlib.h>
+#include <string.h>
+#include "membership.h"
+
+/* -- Definitions -- */
+
+/** Number of 64-bit words of a bitset of n fences */
+#define BITSET_WORDS(n)     (((n) + 63) / 64)
+
+/* -- Local functions -- */
+static uint64_t last_word_mask(uint32_t nfences);
+static uint32_t apply(membership_st* m, uint32_t device, const uint64_t* mask);
+static void push_events(membership_st* m, uint32_t device, uint32_t base, uint64_t changed, uint64_t entered);
+
+
+/**
+ * @brief Initialize a state with every device outside every fence
+ * @param [out] m            State
+ * @param [in]  max_devices  Max number of devices
+ * @param [in]  nfences      Number of fences
+ * @param [in]  cb           Callback with the batches of events
+ * @param [in]  ctx          User context passed to the callback
+ * @return Zero on success, Otherwise a negative value
+ */
+int membership_init (
+        membership_st* m,
+        uint32_t max_devices,
+        uint32_t nfences,
+        membership_events_cb cb,
+        void* ctx
+)
+{
+    memset(m, 0, sizeof(membership_st));
+    if (cb == NULL) {
+        return -1;
+    }
+    m->max_devices = max_devices;
+    m->nfences = nfences;
+    m->words = BITSET_WORDS(nfences);
+    m->cb = cb;
+    m->ctx = ctx;
+    if ((size_t)max_devices * m->words > 0) {
+        m->bits = (uint64_t*)calloc((size_t)max_devices * m->words, sizeof(uint64_t));
+        if (m->bits == NULL) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief Release a state. The events not reported yet are lost
+ * @param [in] m  State
+ */
+void membership_free (
+        membership_st* m
+)
+{
+    free(m->bits);
+    memset(m, 0, sizeof(membership_st));
+}
+
+/**
+ * @brief Change the number of fences. The devices keep the state of the fences that remain
+ * @param [in] m        State
+ * @param [in] nfences  Number of fences
+ * @return Zero on success, Otherwise a negative value
+ */
+int membership_resize (
+        membership_st* m,
+        uint32_t nfences
+)
+{
+    uint32_t words = BITSET_WORDS(nfences);
+    uint32_t keep = (words < m->words) ? words : m->words;
+    uint64_t* bits = NULL;
+
+    if (words != m->words && (size_t)m->max_devices * words > 0) {
+        bits = (uint64_t*)calloc((size_t)m->max_devices * words, sizeof(uint64_t));
+        if (bits == NULL) {
+            return -1;
+        }
+        for (uint32_t d = 0; d < m->max_devices; d++) {
+            memcpy(&bits[(size_t)d * words], &m->bits[(size_t)d * m->words], keep * sizeof(uint64_t));
+        }
+    }
+    if (words != m->words) {
+        free(m->bits);
+        m->bits = bits;
+        m->words = words;
+    }
+
+    /* Drop the state of the removed fences of the last word */
+    for (uint32_t d = 0; words > 0 && nfences < m->nfences && d < m->max_devices; d++) {
+        m->bits[(size_t)d * words + words - 1] &= last_word_mask(nfences);
+    }
+    m->nfences = nfences;
+    return 0;
+}
+
+/**
+ * @brief Set the fences that contain a device, and add the events of the fences it entered or left to the batch
+ * @param [in] m       State
+ * @param [in] device  Device index
+ * @param [in] mask    Bit i is set if the device is inside fence i. Room for the words of a bitset
+ * @return Number of events of the device
+ */
+uint32_t membership_update (
+        membership_st* m,
+        uint32_t device,
+        const uint64_t* mask
+)
+{
+    if (device >= m->max_devices || mask == NULL) {
+        return 0;
+    }
+    return apply(m, device, mask);
+}
+
+/**
+ * @brief Take a device out of every fence, for a device without position. The exit events are added to the batch
+ * @param [in] m       State
+ * @param [in] device  Device index
+ * @return Number of events of the device
+ */
+uint32_t membership_clear (
+        membership_st* m,
+        uint32_t device
+)
+{
+    if (device >= m->max_devices) {
+        return 0;
+    }
+    return apply(m, device, NULL);
+}
+
+/**
+ * @brief Report the events of the batch to the callback, if there are any
+ * @param [in] m  State
+ */
+void membership_flush (
+        membership_st* m
+)
+{
+    if (m->nbatch > 0) {
+        m->cb(m->batch, m->nbatch, m->ctx);
+        m->nbatch = 0;
+    }
+}
+
+/**
+ * @brief Check if a device is inside a fence
+ * @param [in] m       State
+ * @param [in] device  Device index
+ * @param [in] fence   Fence index
+ * @return Positive value if the device is inside the fence, Otherwise Zero.
+ */
+uint8_t membership_contains (
+        const membership_st* m,
+        uint32_t device,
+        uint32_t fence
+)
+{
+    if (device >= m->max_devices || fence >= m->nfences) {
+        return 0;
+    }
+    return (uint8_t)((m->bits[(size_t)device * m->words + fence / 64] >> (fence % 64)) & 1);
+}
+
+/**
+ * @brief Return the number of fences that contain a device
+ * @param [in] m       State
+ * @param [in] device  Device index
+ * @return Number of fences
+ */
+uint32_t membership_count (
+        const membership_st* m,
+        uint32_t device
+)
+{
+    uint32_t count = 0;
+
+    if (device >= m->max_devices) {
+        return 0;
+    }
+    for (uint32_t w = 0; w < m->words; w++) {
+        count += (uint32_t)__builtin_popcountll(m->bits[(size_t)device * m->words + w]);
+    }
+    return count;
+}
+
+/**
+ * @brief Valid bits of the last word of a bitset
+ * @param nfences  Number of fences
+ * @return Mask of the bits of the fences
+ */
+static uint64_t last_word_mask (
+        uint32_t nfences
+)
+{
+    return (nfences % 64 == 0) ? ~0ULL : ((1ULL << (nfences % 64)) - 1);
+}
+
+/**
+ * @brief Replace the bitset of a device, and add the events of the bits that changed
+ * @param m       State
+ * @param device  Device index
+ * @param mask    New bitset, or NULL for an empty one
+ * @return Number of events
+ */
+static uint32_t apply (
+        membership_st* m,
+        uint32_t device,
+        const uint64_t* mask
+)
+{
+    uint64_t* bits = &m->bits[(size_t)device * m->words];
+    uint32_t n = 0;
+
+    for (uint32_t w = 0; w < m->words; w++) {
+        uint64_t current = (mask != NULL) ? mask[w] : 0;
+        uint64_t changed;
+
+        if (w == m->words - 1) {
+            current &= last_word_mask(m->nfences);
+        }
+        changed = bits[w] ^ current;
+        if (changed != 0) {
+            push_events(m, device, w * 64, changed, current);
+            n += (uint32_t)__builtin_popcountll(changed);
+            bits[w] = current;
+        }
+    }
+    m->events += n;
+    return n;
+}
+
+/**
+ * @brief Add the events of a word to the batch, reporting the batch each time it is full
+ * @param m        State
+ * @param device   Device index
+ * @param base     Fence index of the first bit of the word
+ * @param changed  Bits that changed
+ * @param entered  New bits: the changed bits that are set are enter events, the others are exit events
+ */
+static void push_events (
+        membership_st* m,
+        uint32_t device,
+        uint32_t base,
+        uint64_t changed,
+        uint64_t entered
+)
+{
+    while (changed != 0) {
+        uint32_t bit = (uint32_t)__builtin_ctzll(changed);
+        membership_event_st* e = &m->batch[m->nbatch++];
+
+        e->device = device;
+        e->fence = base + bit;
+        e->type = ((entered >> bit) & 1) ? membership_enter : membership_exit;
+        if (m->nbatch == MEMBERSHIP_BATCH) {
+            membership_flush(m);
+        }
+        changed &= changed - 1;
+    }
+}
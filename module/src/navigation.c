@@ -16,6 +16,15 @@
  * [28/02/2021]     [miguelgarcia]
  * Initial version
  *
+ * [18/10/2026]     [miguelgarcia]
+ * UTC time of the last GGA sentence
+ *
+ * [18/10/2026]     [miguelgarcia]
+ * Reentrant parser context
+ *
+ * [18/10/2026]     [miguelgarcia]
+ * Geoidal separation reported flag
+ *
  */
 
 /* -- Includes -- */
@@ -23,13 +32,14 @@
 #include <stdlib.h>
 #include <string.h>
 #include <stdint.h>
+#include "dispatch.h"
 #include "position.h"
 #include "navigation.h"
 
 /* -- Definitions -- */
 
-/** Max size of MTK3339 NMEA sentence */
-#define MTK3339_BUF_SZ  255
+/** Max number of fields of a NMEA sentence */
+#define NMEA_MAX_FIELDS 32
 
 /* -- Local types -- */
 
@@ -44,23 +54,13 @@ typedef enum DataState_ {
 
 /* -- Local variables -- */
 
-/** Time, position and fix related data */
-static GgaType gga;
-
-/** Data Buffer */
-static char buf_[MTK3339_BUF_SZ];
-/** Buffer position */
-static int buf_pos_ = 0;
-/** Parser state */
-static DataState parser_state_ = StateStart;
-
-/** LLH : Latitude, Longitude in Decimal Degrees, Altitude in meters */
-static position_st current_llh_;
+/** Parser context of the navigation_* functions */
+static navigation_st nav_;
 
 /* -- Local functions -- */
-static uint8_t parseData(char* data, int len);
-static void parseGGA(char* data, int dataLen);
-static void update_current_llh (void);
+static uint8_t parseData(navigation_st* nav, char* data, int len);
+static void parseGGA(navigation_st* nav, char* data, int dataLen);
+static void update_current_llh (navigation_st* nav);
 
 /**
  * @brief Reset the last read data from the GPS module.
@@ -69,24 +69,98 @@ void navigation_reset (
 
 )
 {
-    memset(&gga, 0, sizeof(GgaType));
+    navigation_ctx_reset(&nav_);
+}
+
+/**
+ * @brief Get current LLH value. Latitude and Longitude in decimal degrees and MSL Altitude in meters
+ * @return Current LLH position
+ */
+position_st navigation_get_llh (
+
+)
+{
+    return navigation_ctx_get_llh(&nav_);
+}
+
+/**
+ * @brief Get the geoidal separation reported by the GPS module in the last GGA sentence. Ellipsoidal height is MSL
+ * Altitude plus the separation.
+ * @param [out] separation  Geoidal separation in meters, zero if it is not reported
+ * @return Positive value if the position is valid and the sentence has the separation field, Otherwise Zero. A
+ * reported separation can be zero.
+ */
+uint8_t navigation_get_geoid_separation (
+        float* separation
+)
+{
+    return navigation_ctx_get_geoid_separation(&nav_, separation);
+}
+
+/**
+ * @brief Get the UTC time of the last GGA sentence
+ * @return Seconds since midnight
+ */
+double navigation_get_time (
+
+)
+{
+    return navigation_ctx_get_time(&nav_);
+}
+
+/**
+ * Add new NMEA char to the NMEA parser
+ * @param [in] d  Input char
+ * @return Positive value if Navigation has a new position value, Otherwise Zero.
+ */
+uint8_t navigation_add_nmea_char (
+        char d
+)
+{
+    return navigation_ctx_add_nmea_char(&nav_, d);
+}
+
+/**
+ * @brief Initialize a parser context, without position and waiting for a new sentence
+ * @param [out] nav  Parser context
+ */
+void navigation_init (
+        navigation_st* nav
+)
+{
+    memset(nav, 0, sizeof(navigation_st));
+    nav->state = StateStart;
+}
+
+/**
+ * @brief Reset the last read data from the GPS module of a parser context
+ * @param [in] nav  Parser context
+ */
+void navigation_ctx_reset (
+        navigation_st* nav
+)
+{
+    memset(&nav->gga, 0, sizeof(GgaType));
 }
 
 
 /**
  * @brief Get latitude in decimal degrees if GPS fix is valid
- * @return Latitude in decimal degrees or zero if position is not valid
+ * @param nav  Parser context
  */
 void update_current_llh (
-
+        navigation_st* nav
 )
 {
+    const GgaType* gga = &nav->gga;
+    position_st* current_llh = &nav->llh;
+
     /* Latitude conversion */
-    if(gga.fix == 0 || gga.nsIndicator == 0) {
-        current_llh_.latitude = 0;
+    if(gga->fix == 0 || gga->nsIndicator == 0) {
+        current_llh->latitude = 0;
     } else {
-        float l = gga.latitude;
-        char ns = gga.nsIndicator;
+        float l = gga->latitude;
+        char ns = gga->nsIndicator;
 
         /* convert from ddmm.mmmm to degrees only 60 minutes is 1 degree */
         int deg = (int)(l / 100);
@@ -96,15 +170,15 @@ void update_current_llh (
             l = -l;
         }
 
-        current_llh_.latitude = l;
+        current_llh->latitude = l;
     }
 
     /* Longitude conversion */
-    if(gga.fix == 0 || gga.ewIndicator == 0) {
-        current_llh_.longitude = 0;
+    if(gga->fix == 0 || gga->ewIndicator == 0) {
+        current_llh->longitude = 0;
     } else {
-        float l = gga.longitude;
-        char ew = gga.ewIndicator;
+        float l = gga->longitude;
+        char ew = gga->ewIndicator;
 
         /* convert from ddmm.mmmm to degrees only 60 minutes is 1 degree */
         int deg = (int)(l / 100);
@@ -114,109 +188,146 @@ void update_current_llh (
             l = -l;
         }
 
-        current_llh_.longitude = l;
+        current_llh->longitude = l;
     }
 
     /* MSL Altitude conversion */
-    if (gga.fix == 0) {
-        current_llh_.altitude = 0;
+    if (gga->fix == 0) {
+        current_llh->altitude = 0;
     } else {
-        current_llh_.altitude = gga.altitude;
+        current_llh->altitude = gga->altitude;
     }
 
     /* Valid Data */
-    if (gga.fix == 0 || gga.nsIndicator == 0 || gga.ewIndicator == 0) {
-        current_llh_.is_valid = pos_invalid;
-    } else if (gga.satellites <= 4) {
-        current_llh_.is_valid = pos_2d;
+    if (gga->fix == 0 || gga->nsIndicator == 0 || gga->ewIndicator == 0) {
+        current_llh->is_valid = pos_invalid;
+    } else if (gga->satellites <= 4) {
+        current_llh->is_valid = pos_2d;
     } else {
-        current_llh_.is_valid = pos_3d;
+        current_llh->is_valid = pos_3d;
     }
 }
 
 /**
- * @brief Get current LLH value. Latitude and Longitude in decimal degrees and MSL Altitude in meters
+ * @brief Get current LLH position of a parser context. Latitude and Longitude in decimal degrees and MSL Altitude in
+ * meters.
+ * @param [in] nav  Parser context
  * @return Current LLH position
  */
-position_st navigation_get_llh (
+position_st navigation_ctx_get_llh (
+        const navigation_st* nav
+)
+{
+    return nav->llh;
+}
 
+/**
+ * @brief Get the geoidal separation reported by the GPS module in the last GGA sentence of a parser context
+ * @param [in]  nav         Parser context
+ * @param [out] separation  Geoidal separation in meters, zero if it is not reported
+ * @return Positive value if the position is valid and the sentence has the separation field, Otherwise Zero. A
+ * reported separation can be zero.
+ */
+uint8_t navigation_ctx_get_geoid_separation (
+        const navigation_st* nav,
+        float* separation
+)
+{
+    uint8_t reported = (nav->llh.is_valid != pos_invalid && nav->gga.geoidal_valid) ? 1 : 0;
+
+    *separation = reported ? nav->gga.geoidal : 0.0f;
+    return reported;
+}
+
+/**
+ * @brief Get the UTC time of the last GGA sentence of a parser context
+ * @param [in] nav  Parser context
+ * @return Seconds since midnight
+ */
+double navigation_ctx_get_time (
+        const navigation_st* nav
 )
 {
-    return current_llh_;
+    const GgaType* gga = &nav->gga;
+
+    return gga->hours * 3600.0 + gga->minutes * 60.0 + gga->seconds + gga->milliseconds * 0.001;
 }
 
 /**
  * Parse a NMEA GGA Sentence
+ * @param nav      Parser context
  * @param data     Input buffer data
  * @param dataLen  Buffer length
  */
 void parseGGA (
+        navigation_st* nav,
         char* data,
         int dataLen
 )
 {
     /* http://aprs.gids.nl/nmea/#gga */
 
+    GgaType* gga = &nav->gga;
     float tm = 0;
+    uint16_t seps[NMEA_MAX_FIELDS];
+    uint32_t nseps;
 
-    memset(&gga, 0, sizeof(GgaType));
+    memset(gga, 0, sizeof(GgaType));
 
-    char* p = data;
-    int pos = 0;
+    nseps = dispatch_get_kernels()->nmea_scan(data, (uint32_t)dataLen, ',', seps, NMEA_MAX_FIELDS);
 
-    p = strchr(p, ',');
-    while (p != NULL && *p != 0) {
-        p++;
+    for (uint32_t pos = 0; pos < nseps; pos++) {
+        char* p = &data[seps[pos] + 1];
 
         switch(pos) {
         case 0: /* time: hhmmss.sss */
             tm = strtof(p, NULL);
-            gga.hours = (int)(tm / 10000);
-            gga.minutes = ((int)tm % 10000) / 100;
-            gga.seconds = ((int)tm % 100);
-            gga.milliseconds = (int)(tm * 1000) % 1000;
+            gga->hours = (int)(tm / 10000);
+            gga->minutes = ((int)tm % 10000) / 100;
+            gga->seconds = ((int)tm % 100);
+            gga->milliseconds = (int)(tm * 1000) % 1000;
             break;
         case 1: /* latitude: ddmm.mmmm */
-            gga.latitude = strtof(p, NULL);
+            gga->latitude = strtof(p, NULL);
             break;
         case 2: /* N/S indicator (north or south) */
             if (*p == 'N' || *p == 'S') {
-                gga.nsIndicator = *p;
+                gga->nsIndicator = *p;
             }
             break;
         case 3: /* longitude: dddmm.mmmm */
-            gga.longitude = strtof(p, NULL);
+            gga->longitude = strtof(p, NULL);
             break;
         case 4: /* E/W indicator (east or west) */
             if (*p == 'E' || *p == 'W') {
-                gga.ewIndicator = *p;
+                gga->ewIndicator = *p;
             }
             break;
         case 5: /* position indicator (1=no fix, 2=GPS fix, 3=Differential) */
-            gga.fix = (int)strtol(p, NULL, 10);
+            gga->fix = (int)strtol(p, NULL, 10);
             break;
         case 6: /* num satellites */
-            gga.satellites = (int)strtol(p, NULL, 10);
+            gga->satellites = (int)strtol(p, NULL, 10);
             break;
         case 7: /* hdop */
-            gga.hdop = strtof(p, NULL);
+            gga->hdop = strtof(p, NULL);
             break;
         case 8: /* altitude */
-            gga.altitude = strtof(p, NULL);
+            gga->altitude = strtof(p, NULL);
             break;
         case 9: /* units */
             /* ignore units */
             break;
-        case 10: /* geoidal separation */
-            gga.geoidal = strtof(p, NULL);
+        case 10: /* geoidal separation, the field can be empty */
+            if (*p != ',' && *p != '*' && *p != '\0') {
+                gga->geoidal = strtof(p, NULL);
+                gga->geoidal_valid = 1;
+            }
             break;
         default:
             /* ignore */
             break;
         }
-        pos++;
-
-        p = strchr(p, ',');
     }
 
 }
@@ -224,11 +335,13 @@ void parseGGA (
 
 /**
  * Parse a Generic NMEA Sentence
+ * @param [in] nav      Parser context
  * @param [in] data     Input buffer data
  * @param [in] dataLen  Buffer length
  * @return Positive value if Navigation has a new position value, Otherwise Zero.
  */
 uint8_t parseData (
+        navigation_st* nav,
         char* data,
         int len
 )
@@ -241,9 +354,7 @@ uint8_t parseData (
         return 0;
     }
     int sum = strtol(&data[len-2], NULL, 16);
-    for(int i = 1; i < len-3; i++) {
-        sum ^= data[i];
-    }
+    sum ^= dispatch_get_kernels()->nmea_xor(&data[1], (len > 4) ? (uint32_t)(len - 4) : 0);
 
     if (sum != 0) {
         // invalid checksum
@@ -251,8 +362,8 @@ uint8_t parseData (
     }
 
     if (strncmp("$GPGGA", data, 6) == 0) {
-        parseGGA(data, len);
-        update_current_llh();
+        parseGGA(nav, data, len);
+        update_current_llh(nav);
         res = 1;
     }
 
@@ -260,35 +371,37 @@ uint8_t parseData (
 }
 
 /**
- * Add new NMEA char to the NMEA parser
- * @param [in] d  Input char
- * @return Positive value if Navigation has a new position value, Otherwise Zero.
+ * Add new NMEA char to the NMEA parser of a parser context
+ * @param [in] nav  Parser context
+ * @param [in] d    Input char
+ * @return Positive value if the context has a new position value, Otherwise Zero.
  */
-uint8_t navigation_add_nmea_char (
+uint8_t navigation_ctx_add_nmea_char (
+        navigation_st* nav,
         char d
 )
 {
     uint8_t res = 0;
 
-    if(parser_state_ == StateStart) {
+    if(nav->state == StateStart) {
         if (d == '$') {
-            buf_[0] = '$';
-            buf_pos_ = 1;
-            parser_state_ = StateData;
+            nav->buf[0] = '$';
+            nav->buf_pos = 1;
+            nav->state = StateData;
         }
 
     } else {
-        if (buf_pos_ >= MTK3339_BUF_SZ) {
+        if (nav->buf_pos >= NAVIGATION_BUF_SZ) {
             // error
-            parser_state_ = StateStart;
+            nav->state = StateStart;
 
         } else if (d == '\r') {
-            buf_[buf_pos_] = 0;
-            res = parseData(buf_, buf_pos_);
-            parser_state_ = StateStart;
+            nav->buf[nav->buf_pos] = 0;
+            res = parseData(nav, nav->buf, nav->buf_pos);
+            nav->state = StateStart;
 
         } else {
-            buf_[buf_pos_++] = d;
+            nav->buf[nav->buf_pos++] = d;
         }
     }
 
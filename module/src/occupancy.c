@@ -0,0 +1,461 @@
+/**
+ * @file occupancy.c
+ *
+ * Fence occupancy index
+ *
+ * @license
+ * All rights reserved. Read LICENSE.txt file for the license terms.
+ *
+ * Changelog:
+ *
+ * [18/10/2026]     [miguelgarcia]
+ * Initial version
+ *
+ */
+
+/* -- Includes -- */
+#include <stdlib.h>
+#include <string.h>
+#include "occupancy.h"
+
+/* -- Definitions -- */
+
+/** Min size of a hash table */
+#define MIN_TABLE       8
+
+/* -- Local functions -- */
+static uint32_t hash(uint32_t v);
+static occupancy_fence_st* find_fence(const occupancy_st* o, uint32_t id);
+static occupancy_fence_st* add_fence(occupancy_st* o, uint32_t id);
+static int index_resize(occupancy_st* o, uint32_t size);
+static int set_resize(occupancy_fence_st* f, uint32_t size);
+static int32_t set_find(const occupancy_fence_st* f, uint32_t device);
+static uint8_t is_listed(const uint32_t* ids, uint32_t n, uint32_t id);
+
+
+/**
+ * @brief Initialize an empty occupancy index
+ * @param [out] o  Occupancy index
+ * @return Zero on success, Otherwise a negative value
+ */
+int occupancy_init (
+        occupancy_st* o
+)
+{
+    memset(o, 0, sizeof(occupancy_st));
+    return index_resize(o, MIN_TABLE);
+}
+
+/**
+ * @brief Release an occupancy index
+ * @param [in] o  Occupancy index
+ */
+void occupancy_free (
+        occupancy_st* o
+)
+{
+    for (uint32_t i = 0; i < o->nfences; i++) {
+        free(o->fences[i].devices);
+    }
+    free(o->fences);
+    free(o->index);
+    memset(o, 0, sizeof(occupancy_st));
+}
+
+/**
+ * @brief Register that a device entered a fence
+ * @param [in] o       Occupancy index
+ * @param [in] fence   User ID of the fence
+ * @param [in] device  Device index, not OCCUPANCY_EMPTY
+ * @return Zero on success, Otherwise a negative value
+ */
+int occupancy_enter (
+        occupancy_st* o,
+        uint32_t fence,
+        uint32_t device
+)
+{
+    occupancy_fence_st* f = find_fence(o, fence);
+    uint32_t slot;
+
+    if (device == OCCUPANCY_EMPTY) {
+        return -1;
+    }
+    if (f == NULL && (f = add_fence(o, fence)) == NULL) {
+        return -1;
+    }
+    if (set_find(f, device) >= 0) {
+        return 0;
+    }
+
+    /* Hash table at most half full */
+    if (f->devices == NULL || (f->count + 1) * 2 > f->mask + 1) {
+        if (set_resize(f, (f->devices == NULL) ? MIN_TABLE : (f->mask + 1) * 2) != 0) {
+            return -1;
+        }
+    }
+
+    slot = hash(device) & f->mask;
+    while (f->devices[slot] != OCCUPANCY_EMPTY) {
+        slot = (slot + 1) & f->mask;
+    }
+    f->devices[slot] = device;
+    f->count++;
+    return 0;
+}
+
+/**
+ * @brief Register that a device left a fence
+ * @param [in] o       Occupancy index
+ * @param [in] fence   User ID of the fence
+ * @param [in] device  Device index
+ * @return Zero on success, Otherwise a negative value if the device was not inside the fence
+ */
+int occupancy_exit (
+        occupancy_st* o,
+        uint32_t fence,
+        uint32_t device
+)
+{
+    occupancy_fence_st* f = find_fence(o, fence);
+    int32_t found = (f != NULL) ? set_find(f, device) : -1;
+    uint32_t hole;
+
+    if (found < 0) {
+        return -1;
+    }
+
+    /* The next devices of the probe sequence are shifted back, if the hole is between their home slot and them */
+    hole = (uint32_t)found;
+    for (uint32_t i = (hole + 1) & f->mask; f->devices[i] != OCCUPANCY_EMPTY; i = (i + 1) & f->mask) {
+        uint32_t home = hash(f->devices[i]) & f->mask;
+
+        if (((i - home) & f->mask) >= ((i - hole) & f->mask)) {
+            f->devices[hole] = f->devices[i];
+            hole = i;
+        }
+    }
+    f->devices[hole] = OCCUPANCY_EMPTY;
+    f->count--;
+
+    /* The memory follows the devices inside the fence. A failed shrink keeps the larger table */
+    if (f->count == 0) {
+        free(f->devices);
+        f->devices = NULL;
+        f->mask = 0;
+    } else if (f->count * 8 < f->mask + 1 && f->mask + 1 > MIN_TABLE) {
+        set_resize(f, (f->mask + 1) / 2);
+    }
+    return 0;
+}
+
+/**
+ * @brief Apply the transitions of a device between two evaluations: it leaves the fences of the previous evaluation
+ * that are not in the new one, and enters the fences of the new evaluation that were not in the previous one.
+ *
+ * @param [in] o         Occupancy index
+ * @param [in] device    Device index
+ * @param [in] previous  IDs of the fences of the previous evaluation
+ * @param [in] nprevious Number of fences of the previous evaluation
+ * @param [in] current   IDs of the fences of the new evaluation
+ * @param [in] ncurrent  Number of fences of the new evaluation
+ * @return Zero on success, Otherwise a negative value
+ */
+int occupancy_update (
+        occupancy_st* o,
+        uint32_t device,
+        const uint32_t* previous,
+        uint32_t nprevious,
+        const uint32_t* current,
+        uint32_t ncurrent
+)
+{
+    int ret = 0;
+
+    /* A device is in a few fences, the lists are compared directly */
+    for (uint32_t i = 0; i < nprevious; i++) {
+        if (!is_listed(current, ncurrent, previous[i])) {
+            occupancy_exit(o, previous[i], device);
+        }
+    }
+    for (uint32_t i = 0; i < ncurrent; i++) {
+        if (!is_listed(previous, nprevious, current[i]) && occupancy_enter(o, current[i], device) != 0) {
+            ret = -1;
+        }
+    }
+    return ret;
+}
+
+/**
+ * @brief Remove every device from a fence, for a fence removed from the set
+ * @param [in] o      Occupancy index
+ * @param [in] fence  User ID of the fence
+ */
+void occupancy_clear (
+        occupancy_st* o,
+        uint32_t fence
+)
+{
+    occupancy_fence_st* f = find_fence(o, fence);
+
+    if (f != NULL) {
+        free(f->devices);
+        f->devices = NULL;
+        f->mask = 0;
+        f->count = 0;
+    }
+}
+
+/**
+ * @brief Return the number of devices inside a fence
+ * @param [in] o      Occupancy index
+ * @param [in] fence  User ID of the fence
+ * @return Number of devices
+ */
+uint32_t occupancy_count (
+        const occupancy_st* o,
+        uint32_t fence
+)
+{
+    const occupancy_fence_st* f = find_fence(o, fence);
+
+    return (f != NULL) ? f->count : 0;
+}
+
+/**
+ * @brief Check if a device is inside a fence
+ * @param [in] o       Occupancy index
+ * @param [in] fence   User ID of the fence
+ * @param [in] device  Device index
+ * @return Positive value if the device is inside the fence, Otherwise Zero.
+ */
+uint8_t occupancy_contains (
+        const occupancy_st* o,
+        uint32_t fence,
+        uint32_t device
+)
+{
+    const occupancy_fence_st* f = find_fence(o, fence);
+
+    return (f != NULL && set_find(f, device) >= 0) ? 1 : 0;
+}
+
+/**
+ * @brief Get the devices inside a fence, in no particular order
+ * @param [in]  o        Occupancy index
+ * @param [in]  fence    User ID of the fence
+ * @param [out] devices  Device indexes
+ * @param [in]  max      Size of the device buffer
+ * @return Number of devices inside the fence. If it is larger than max, only max devices are written
+ */
+uint32_t occupancy_members (
+        const occupancy_st* o,
+        uint32_t fence,
+        uint32_t* devices,
+        uint32_t max
+)
+{
+    const occupancy_fence_st* f = find_fence(o, fence);
+    uint32_t n = 0;
+
+    if (f == NULL || f->devices == NULL) {
+        return 0;
+    }
+    for (uint32_t i = 0; i <= f->mask && n < max; i++) {
+        if (f->devices[i] != OCCUPANCY_EMPTY) {
+            devices[n++] = f->devices[i];
+        }
+    }
+    return f->count;
+}
+
+/**
+ * @brief Hash of a device index or a fence ID
+ * @param v  Value
+ * @return  Hash
+ */
+static uint32_t hash (
+        uint32_t v
+)
+{
+    v ^= v >> 16;
+    v *= 0x7feb352du;
+    v ^= v >> 15;
+    v *= 0x846ca68bu;
+    v ^= v >> 16;
+    return v;
+}
+
+/**
+ * @brief Find a fence by its user ID
+ * @param o   Occupancy index
+ * @param id  User ID
+ * @return The fence, or NULL if it never had devices
+ */
+static occupancy_fence_st* find_fence (
+        const occupancy_st* o,
+        uint32_t id
+)
+{
+    uint32_t slot = hash(id) & o->index_mask;
+
+    if (o->index == NULL) {
+        return NULL;
+    }
+    while (o->index[slot] != OCCUPANCY_EMPTY) {
+        if (o->fences[o->index[slot]].id == id) {
+            return &o->fences[o->index[slot]];
+        }
+        slot = (slot + 1) & o->index_mask;
+    }
+    return NULL;
+}
+
+/**
+ * @brief Add a fence without devices
+ * @param o   Occupancy index
+ * @param id  User ID
+ * @return The fence, or NULL if there is no memory
+ */
+static occupancy_fence_st* add_fence (
+        occupancy_st* o,
+        uint32_t id
+)
+{
+    occupancy_fence_st* f;
+    uint32_t slot;
+
+    if (o->nfences == o->capacity) {
+        uint32_t capacity = (o->capacity == 0) ? MIN_TABLE : o->capacity * 2;
+        occupancy_fence_st* fences = (occupancy_fence_st*)realloc(o->fences, capacity * sizeof(occupancy_fence_st));
+        if (fences == NULL) {
+            return NULL;
+        }
+        o->fences = fences;
+        o->capacity = capacity;
+    }
+    if ((o->nfences + 1) * 2 > o->index_mask + 1 && index_resize(o, (o->index_mask + 1) * 2) != 0) {
+        return NULL;
+    }
+
+    f = &o->fences[o->nfences];
+    memset(f, 0, sizeof(occupancy_fence_st));
+    f->id = id;
+
+    slot = hash(id) & o->index_mask;
+    while (o->index[slot] != OCCUPANCY_EMPTY) {
+        slot = (slot + 1) & o->index_mask;
+    }
+    o->index[slot] = o->nfences++;
+    return f;
+}
+
+/**
+ * @brief Build the hash table of the fences with a new size
+ * @param o     Occupancy index
+ * @param size  Size of the table, a power of two
+ * @return Zero on success, Otherwise a negative value
+ */
+static int index_resize (
+        occupancy_st* o,
+        uint32_t size
+)
+{
+    uint32_t* index = (uint32_t*)malloc(size * sizeof(uint32_t));
+
+    if (index == NULL) {
+        return -1;
+    }
+    memset(index, 0xFF, size * sizeof(uint32_t));
+
+    for (uint32_t i = 0; i < o->nfences; i++) {
+        uint32_t slot = hash(o->fences[i].id) & (size - 1);
+        while (index[slot] != OCCUPANCY_EMPTY) {
+            slot = (slot + 1) & (size - 1);
+        }
+        index[slot] = i;
+    }
+    free(o->index);
+    o->index = index;
+    o->index_mask = size - 1;
+    return 0;
+}
+
+/**
+ * @brief Move the devices of a fence to a hash table of a new size
+ * @param f     Fence
+ * @param size  Size of the table, a power of two larger than twice the devices
+ * @return Zero on success, Otherwise a negative value
+ */
+static int set_resize (
+        occupancy_fence_st* f,
+        uint32_t size
+)
+{
+    uint32_t* devices = (uint32_t*)malloc(size * sizeof(uint32_t));
+
+    if (devices == NULL) {
+        return -1;
+    }
+    memset(devices, 0xFF, size * sizeof(uint32_t));
+
+    for (uint32_t i = 0; f->devices != NULL && i <= f->mask; i++) {
+        if (f->devices[i] != OCCUPANCY_EMPTY) {
+            uint32_t slot = hash(f->devices[i]) & (size - 1);
+            while (devices[slot] != OCCUPANCY_EMPTY) {
+                slot = (slot + 1) & (size - 1);
+            }
+            devices[slot] = f->devices[i];
+        }
+    }
+    free(f->devices);
+    f->devices = devices;
+    f->mask = size - 1;
+    return 0;
+}
+
+/**
+ * @brief Find a device in the membership set of a fence
+ * @param f       Fence
+ * @param device  Device index
+ * @return Entry of the device, Otherwise a negative value if it is not inside the fence
+ */
+static int32_t set_find (
+        const occupancy_fence_st* f,
+        uint32_t device
+)
+{
+    uint32_t slot = hash(device) & f->mask;
+
+    if (f->devices == NULL) {
+        return -1;
+    }
+    while (f->devices[slot] != OCCUPANCY_EMPTY) {
+        if (f->devices[slot] == device) {
+            return (int32_t)slot;
+        }
+        slot = (slot + 1) & f->mask;
+    }
+    return -1;
+}
+
+/**
+ * @brief Check if an ID is in a list
+ * @param ids  List of IDs
+ * @param n    Number of IDs
+ * @param id   ID
+ * @return Positive value if the ID is in the list, Otherwise Zero.
+ */
+static uint8_t is_listed (
+        const uint32_t* ids,
+        uint32_t n,
+        uint32_t id
+)
+{
+    for (uint32_t i = 0; i < n; i++) {
+        if (ids[i] == id) {
+            return 1;
+        }
+    }
+    return 0;
+}
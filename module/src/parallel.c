@@ -0,0 +1,134 @@
+/**
+ * @file parallel.c
+ *
+ * Parallel task runner
+ *
+ * @license
+ * All rights reserved. Read LICENSE.txt file for the license terms.
+ *
+ * Changelog:
+ *
+ * [18/10/2026]     [miguelgarcia]
+ * Initial version
+ *
+ */
+
+/* -- Includes -- */
+#include <pthread.h>
+#include <unistd.h>
+#include "parallel.h"
+
+/* -- Local types -- */
+
+/** State shared by the workers of a parallel_for() call */
+typedef struct {
+    /** Next task to run */
+    uint32_t next;
+    /** Number of tasks */
+    uint32_t tasks;
+    /** Task function */
+    parallel_task_fn fn;
+    /** User context */
+    void* ctx;
+} pool_st;
+
+/** Worker arguments */
+typedef struct {
+    pool_st* pool;
+    uint32_t worker;
+} worker_st;
+
+/* -- Local functions -- */
+static void* worker_run(void* arg);
+
+
+/**
+ * @brief Return the number of worker threads used when zero threads are requested
+ * @return Number of online processors
+ */
+uint32_t parallel_default_threads (
+
+)
+{
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    if (n < 1) {
+        return 1;
+    }
+    return (n > PARALLEL_MAX_THREADS) ? PARALLEL_MAX_THREADS : (uint32_t)n;
+}
+
+/**
+ * @brief Run the tasks [0, tasks) on a pool of worker threads and wait until all of them are done. The calling thread
+ * is one of the workers.
+ *
+ * @param [in] tasks    Number of tasks
+ * @param [in] threads  Number of worker threads, zero to use parallel_default_threads()
+ * @param [in] fn       Task function
+ * @param [in] ctx      User context passed to the task function
+ * @return Number of workers used. If some worker threads cannot be created, the tasks are run by the others
+ */
+int parallel_for (
+        uint32_t tasks,
+        uint32_t threads,
+        parallel_task_fn fn,
+        void* ctx
+)
+{
+    pthread_t tid[PARALLEL_MAX_THREADS];
+    worker_st args[PARALLEL_MAX_THREADS];
+    pool_st pool = {.next = 0, .tasks = tasks, .fn = fn, .ctx = ctx};
+    uint32_t started = 1;
+
+    if (threads == 0) {
+        threads = parallel_default_threads();
+    }
+    if (threads > PARALLEL_MAX_THREADS) {
+        threads = PARALLEL_MAX_THREADS;
+    }
+    if (threads > tasks) {
+        threads = (tasks == 0) ? 1 : tasks;
+    }
+
+    /* Worker 0 is the calling thread */
+    for (uint32_t i = 1; i < threads; i++) {
+        args[i].pool = &pool;
+        args[i].worker = i;
+        if (pthread_create(&tid[i], NULL, worker_run, &args[i]) != 0) {
+            break;
+        }
+        started++;
+    }
+
+    args[0].pool = &pool;
+    args[0].worker = 0;
+    worker_run(&args[0]);
+
+    for (uint32_t i = 1; i < started; i++) {
+        pthread_join(tid[i], NULL);
+    }
+
+    return (int)started;
+}
+
+/**
+ * @brief Worker loop. Takes tasks from the shared counter until there are no more.
+ * @param arg  Worker arguments
+ * @return NULL
+ */
+static void* worker_run (
+        void* arg
+)
+{
+    worker_st* w = (worker_st*)arg;
+    pool_st* pool = w->pool;
+
+    for (;;) {
+        uint32_t task = __atomic_fetch_add(&pool->next, 1, __ATOMIC_RELAXED);
+        if (task >= pool->tasks) {
+            break;
+        }
+        pool->fn(task, w->worker, pool->ctx);
+    }
+
+    return NULL;
+}
@@ -0,0 +1,495 @@
+/**
+ * @file polyfence.c
+ *
+ * Polygon geofences
+ *
+ * @license
+ * All rights reserved. Read LICENSE.txt file for the license terms.
+ *
+ * Changelog:
+ *
+ * [18/10/2026]     [miguelgarcia]
+ * Initial version
+ *
+ * [18/10/2026]     [miguelgarcia]
+ * Vertical bounds and ECEF bounding box
+ *
+ * [18/10/2026]     [miguelgarcia]
+ * Distance to the boundary
+ *
+ */
+
+/* -- Includes -- */
+#include <float.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include "dispatch.h"
+#include "polyfence.h"
+
+/* -- Definitions -- */
+
+/** Alignment of the edge arrays */
+#define EDGE_ALIGN      64
+/** Padding of the edges of each band, so the SIMD kernel can read whole vectors */
+#define EDGE_PAD        16
+/** Max average number of bands per edge. Above it the number of bands is halved */
+#define MAX_BANDS_PER_EDGE  4
+
+#define DEG_TO_RAD      0.017453292519943295f
+
+/* -- Local functions -- */
+static void set_frame(polyfence_st* p, const position_st* vertices, uint32_t n);
+static uint8_t inside_plane(const polyfence_st* p, float east, float north);
+static uint32_t band_of(const polyfence_st* p, float north);
+static uint8_t edge_bands(const polyfence_st* p, float ya, float yb, uint32_t* b0, uint32_t* b1);
+static int bucket_edges(polyfence_st* p, const float* ex, const float* ey, uint32_t n);
+
+
+/**
+ * @brief Build a polygon fence
+ * @param [out] p         Fence
+ * @param [in]  id        User ID
+ * @param [in]  vertices  Vertices of the ring, in either order. Latitude and Longitude in decimal degrees, the altitude
+ *                        is not used. The ring is closed implicitly, the last vertex can repeat the first one
+ * @param [in]  n         Number of vertices
+ * @return Zero on success, Otherwise a negative value
+ */
+int polyfence_init (
+        polyfence_st* p,
+        uint32_t id,
+        const position_st* vertices,
+        uint32_t n
+)
+{
+    float* ex;
+    float* ey;
+    float min_up = 0.0f;
+    int ret;
+
+    memset(p, 0, sizeof(polyfence_st));
+    if (vertices == NULL) {
+        return -1;
+    }
+    if (n > 1 && vertices[0].latitude == vertices[n - 1].latitude &&
+        vertices[0].longitude == vertices[n - 1].longitude) {
+        n--;
+    }
+    if (n < 3) {
+        return -1;
+    }
+
+    ex = (float*)malloc(n * sizeof(float));
+    ey = (float*)malloc(n * sizeof(float));
+    if (ex == NULL || ey == NULL) {
+        free(ex);
+        free(ey);
+        return -1;
+    }
+
+    p->id = id;
+    p->nvertices = n;
+    set_frame(p, vertices, n);
+
+    for (uint32_t i = 0; i < n; i++) {
+        float x, y, z, up;
+
+        position_geodetic_to_ecef(vertices[i].latitude, vertices[i].longitude, 0.0f, &x, &y, &z);
+        up = polyfence_project(p, x, y, z, &ex[i], &ey[i]);
+        if (i == 0 || up < min_up) {
+            min_up = up;
+        }
+        if (i == 0) {
+            p->min[0] = p->max[0] = ex[i];
+            p->min[1] = p->max[1] = ey[i];
+        } else {
+            p->min[0] = fminf(p->min[0], ex[i]);
+            p->max[0] = fmaxf(p->max[0], ex[i]);
+            p->min[1] = fminf(p->min[1], ey[i]);
+            p->max[1] = fmaxf(p->max[1], ey[i]);
+        }
+    }
+    p->min_up = min_up - POLYFENCE_MAX_DEPTH;
+    p->max_up = POLYFENCE_MAX_HEIGHT;
+
+    /* The vertices are kept for polyfence_distance() */
+    p->vx = ex;
+    p->vy = ey;
+    ret = bucket_edges(p, ex, ey, n);
+    if (ret < 0) {
+        polyfence_free(p);
+    }
+    return ret;
+}
+
+/**
+ * @brief Release a polygon fence
+ * @param [in] p  Fence
+ */
+void polyfence_free (
+        polyfence_st* p
+)
+{
+    free(p->x0);
+    free(p->y0);
+    free(p->x1);
+    free(p->y1);
+    free(p->band_start);
+    free(p->band_count);
+    free(p->vx);
+    free(p->vy);
+    memset(p, 0, sizeof(polyfence_st));
+}
+
+/**
+ * @brief Project an ECEF position to the local plane of a fence
+ * @param [in]  p      Fence
+ * @param [in]  x      ECEF X
+ * @param [in]  y      ECEF Y
+ * @param [in]  z      ECEF Z
+ * @param [out] east   East coordinate in meters
+ * @param [out] north  North coordinate in meters
+ * @return Up coordinate in meters
+ */
+float polyfence_project (
+        const polyfence_st* p,
+        float x,
+        float y,
+        float z,
+        float* east,
+        float* north
+)
+{
+    float dx = x - p->origin[0];
+    float dy = y - p->origin[1];
+    float dz = z - p->origin[2];
+
+    *east = p->rotation[0][0] * dx + p->rotation[0][1] * dy + p->rotation[0][2] * dz;
+    *north = p->rotation[1][0] * dx + p->rotation[1][1] * dy + p->rotation[1][2] * dz;
+    return p->rotation[2][0] * dx + p->rotation[2][1] * dy + p->rotation[2][2] * dz;
+}
+
+/**
+ * @brief Get the ECEF bounding box of the positions inside a fence
+ * @param [in]  p    Fence
+ * @param [out] min  Min ECEF (x, y, z)
+ * @param [out] max  Max ECEF (x, y, z)
+ */
+void polyfence_get_bounds (
+        const polyfence_st* p,
+        float min[3],
+        float max[3]
+)
+{
+    /* The local box is rotated, so the ECEF box is the box of its 8 corners. The rotation is orthonormal, so its
+     * transpose maps local to ECEF */
+    for (int c = 0; c < 8; c++) {
+        float e = (c & 1) ? p->max[0] : p->min[0];
+        float n = (c & 2) ? p->max[1] : p->min[1];
+        float u = (c & 4) ? p->max_up : p->min_up;
+
+        for (int a = 0; a < 3; a++) {
+            float v = p->origin[a] + p->rotation[0][a] * e + p->rotation[1][a] * n + p->rotation[2][a] * u;
+            if (c == 0 || v < min[a]) {
+                min[a] = v;
+            }
+            if (c == 0 || v > max[a]) {
+                max[a] = v;
+            }
+        }
+    }
+}
+
+/**
+ * @brief Check if an ECEF position is inside a fence
+ * @param [in] p  Fence
+ * @param [in] x  ECEF X
+ * @param [in] y  ECEF Y
+ * @param [in] z  ECEF Z
+ * @return Positive value if it is inside, Otherwise Zero
+ */
+uint8_t polyfence_contains (
+        const polyfence_st* p,
+        float x,
+        float y,
+        float z
+)
+{
+    float east, north, up;
+
+    if (p->x0 == NULL) {
+        return 0;
+    }
+
+    up = polyfence_project(p, x, y, z, &east, &north);
+    if (up < p->min_up || up > p->max_up) {
+        return 0;
+    }
+    return inside_plane(p, east, north);
+}
+
+/**
+ * @brief Get the distance from an ECEF position to the boundary of a fence, in the local frame: the boundary of the
+ * polygon extruded between the vertical bounds. The projection does not stretch distances, so a position closer than
+ * this to the given one is inside the fence if and only if the given one is.
+ *
+ * @param [in] p  Fence
+ * @param [in] x  ECEF X
+ * @param [in] y  ECEF Y
+ * @param [in] z  ECEF Z
+ * @return Distance in meters
+ */
+float polyfence_distance (
+        const polyfence_st* p,
+        float x,
+        float y,
+        float z
+)
+{
+    float east, north, up, dv;
+    float d2 = FLT_MAX;
+
+    if (p->vx == NULL) {
+        return 0.0f;
+    }
+
+    up = polyfence_project(p, x, y, z, &east, &north);
+    for (uint32_t i = 0; i < p->nvertices; i++) {
+        uint32_t j = (i + 1 < p->nvertices) ? i + 1 : 0;
+        float ex = p->vx[j] - p->vx[i];
+        float ey = p->vy[j] - p->vy[i];
+        float px = east - p->vx[i];
+        float py = north - p->vy[i];
+        float len2 = ex * ex + ey * ey;
+        /* Nearest point of the edge, clamped to its ends */
+        float t = (len2 > 0.0f) ? (px * ex + py * ey) / len2 : 0.0f;
+
+        t = (t < 0.0f) ? 0.0f : ((t > 1.0f) ? 1.0f : t);
+        px -= t * ex;
+        py -= t * ey;
+        d2 = fminf(d2, px * px + py * py);
+    }
+
+    /* Out of the vertical bounds */
+    dv = fmaxf(fmaxf(p->min_up - up, up - p->max_up), 0.0f);
+    if (!inside_plane(p, east, north)) {
+        return sqrtf(d2 + dv * dv);
+    }
+    if (dv > 0.0f) {
+        return dv;
+    }
+    return fminf(sqrtf(d2), fminf(up - p->min_up, p->max_up - up));
+}
+
+/**
+ * @brief Check if a projected position is inside the polygon of a fence
+ * @param p      Fence
+ * @param east   East coordinate in meters
+ * @param north  North coordinate in meters
+ * @return Positive value if it is inside, Otherwise Zero
+ */
+static uint8_t inside_plane (
+        const polyfence_st* p,
+        float east,
+        float north
+)
+{
+    uint32_t b;
+
+    /* Bounding box reject */
+    if (east < p->min[0] || east > p->max[0] || north < p->min[1] || north > p->max[1]) {
+        return 0;
+    }
+
+    /* Crossing number over the edges of the band of the position */
+    b = band_of(p, north);
+    return (uint8_t)(dispatch_get_kernels()->crossings(&p->x0[p->band_start[b]], &p->y0[p->band_start[b]],
+                                                       &p->x1[p->band_start[b]], &p->y1[p->band_start[b]],
+                                                       p->band_count[b], east, north) & 1);
+}
+
+/**
+ * @brief Set the local frame of a fence, centered at the mean of its vertices
+ * @param p         Fence
+ * @param vertices  Vertices
+ * @param n         Number of vertices
+ */
+static void set_frame (
+        polyfence_st* p,
+        const position_st* vertices,
+        uint32_t n
+)
+{
+    double sum[3] = {0.0, 0.0, 0.0};
+    float lat, lon, h;
+    float slat, clat, slon, clon;
+
+    /* The mean is taken in ECEF, so it is right across the antimeridian */
+    for (uint32_t i = 0; i < n; i++) {
+        float x, y, z;
+        position_geodetic_to_ecef(vertices[i].latitude, vertices[i].longitude, 0.0f, &x, &y, &z);
+        sum[0] += x;
+        sum[1] += y;
+        sum[2] += z;
+    }
+    position_ecef_to_geodetic((float)(sum[0] / n), (float)(sum[1] / n), (float)(sum[2] / n), &lat, &lon, &h);
+    position_geodetic_to_ecef(lat, lon, 0.0f, &p->origin[0], &p->origin[1], &p->origin[2]);
+
+    slat = sinf(lat * DEG_TO_RAD);
+    clat = cosf(lat * DEG_TO_RAD);
+    slon = sinf(lon * DEG_TO_RAD);
+    clon = cosf(lon * DEG_TO_RAD);
+
+    p->rotation[0][0] = -slon;
+    p->rotation[0][1] = clon;
+    p->rotation[0][2] = 0.0f;
+    p->rotation[1][0] = -slat * clon;
+    p->rotation[1][1] = -slat * slon;
+    p->rotation[1][2] = clat;
+    p->rotation[2][0] = clat * clon;
+    p->rotation[2][1] = clat * slon;
+    p->rotation[2][2] = slat;
+}
+
+/**
+ * @brief Get the band of a north coordinate. It is monotonic, so an edge registered in the bands of its end points is
+ * in the band of every point between them.
+ * @param p      Fence
+ * @param north  North coordinate
+ * @return Band
+ */
+static inline uint32_t band_of (
+        const polyfence_st* p,
+        float north
+)
+{
+    float b = (north - p->min[1]) * p->band_scale;
+
+    if (!(b > 0.0f)) {
+        return 0;
+    }
+    return b < (float)p->nbands ? (uint32_t)b : p->nbands - 1;
+}
+
+/**
+ * @brief Get the bands of an edge
+ * @param p   Fence
+ * @param ya  North coordinate of the start point
+ * @param yb  North coordinate of the end point
+ * @param b0  First band
+ * @param b1  Last band
+ * @return Positive value if the edge can be crossed, Otherwise Zero (horizontal edges are never crossed)
+ */
+static uint8_t edge_bands (
+        const polyfence_st* p,
+        float ya,
+        float yb,
+        uint32_t* b0,
+        uint32_t* b1
+)
+{
+    if (ya == yb) {
+        return 0;
+    }
+    *b0 = band_of(p, ya < yb ? ya : yb);
+    *b1 = band_of(p, ya < yb ? yb : ya);
+    return 1;
+}
+
+/**
+ * @brief Bucket the edges of a fence in bands
+ * @param p   Fence, with the bounding box set
+ * @param ex  East coordinates of the vertices
+ * @param ey  North coordinates of the vertices
+ * @param n   Number of vertices
+ * @return Zero on success, Otherwise a negative value
+ */
+static int bucket_edges (
+        polyfence_st* p,
+        const float* ex,
+        const float* ey,
+        uint32_t n
+)
+{
+    float height = p->max[1] - p->min[1];
+    uint32_t nbands = 1;
+    uint32_t total = 0;
+
+    if (n > POLYFENCE_BAND_MIN_EDGES && height > 0.0f) {
+        nbands = n / POLYFENCE_BAND_EDGES;
+        if (nbands > POLYFENCE_MAX_BANDS) {
+            nbands = POLYFENCE_MAX_BANDS;
+        }
+    }
+
+    /* Count the edges of each band. Long north-south edges are in many bands, so the bands are merged if the copies
+     * take too much memory */
+    for (;;) {
+        uint64_t refs = 0;
+
+        p->nbands = nbands;
+        p->band_scale = height > 0.0f ? (float)nbands / height : 0.0f;
+        p->band_count = (uint32_t*)calloc(nbands, sizeof(uint32_t));
+        if (p->band_count == NULL) {
+            return -1;
+        }
+        for (uint32_t i = 0; i < n; i++) {
+            uint32_t j = (i + 1 < n) ? i + 1 : 0;
+            uint32_t b0, b1;
+            if (edge_bands(p, ey[i], ey[j], &b0, &b1)) {
+                for (uint32_t b = b0; b <= b1; b++) {
+                    p->band_count[b]++;
+                }
+                refs += b1 - b0 + 1;
+            }
+        }
+        if (nbands == 1 || refs <= (uint64_t)n * MAX_BANDS_PER_EDGE) {
+            break;
+        }
+        free(p->band_count);
+        p->band_count = NULL;
+        nbands /= 2;
+    }
+
+    /* Each band starts at a vector boundary */
+    p->band_start = (uint32_t*)malloc(nbands * sizeof(uint32_t));
+    if (p->band_start == NULL) {
+        return -1;
+    }
+    for (uint32_t b = 0; b < nbands; b++) {
+        p->band_start[b] = total;
+        total += ((p->band_count[b] + EDGE_PAD - 1) / EDGE_PAD) * EDGE_PAD;
+    }
+    if (total == 0) {
+        total = EDGE_PAD;
+    }
+    p->nedges = total;
+
+    /* The padding is zeroed, so it is made of degenerate edges */
+    if (posix_memalign((void**)&p->x0, EDGE_ALIGN, total * sizeof(float)) != 0 ||
+        posix_memalign((void**)&p->y0, EDGE_ALIGN, total * sizeof(float)) != 0 ||
+        posix_memalign((void**)&p->x1, EDGE_ALIGN, total * sizeof(float)) != 0 ||
+        posix_memalign((void**)&p->y1, EDGE_ALIGN, total * sizeof(float)) != 0) {
+        return -1;
+    }
+    memset(p->x0, 0, total * sizeof(float));
+    memset(p->y0, 0, total * sizeof(float));
+    memset(p->x1, 0, total * sizeof(float));
+    memset(p->y1, 0, total * sizeof(float));
+
+    memset(p->band_count, 0, nbands * sizeof(uint32_t));
+    for (uint32_t i = 0; i < n; i++) {
+        uint32_t j = (i + 1 < n) ? i + 1 : 0;
+        uint32_t b0, b1;
+        if (edge_bands(p, ey[i], ey[j], &b0, &b1)) {
+            for (uint32_t b = b0; b <= b1; b++) {
+                uint32_t k = p->band_start[b] + p->band_count[b]++;
+                p->x0[k] = ex[i];
+                p->y0[k] = ey[i];
+                p->x1[k] = ex[j];
+                p->y1[k] = ey[j];
+            }
+        }
+    }
+    return 0;
+}
@@ -22,6 +22,9 @@
  * [27/02/2021]     [miguelgarcia]
  * Version based on Govert implementation
  *
+ * [18/10/2026]     [miguelgarcia]
+ * Displacement bound
+ *
  */
 
 /* -- Includes -- */
@@ -39,10 +42,15 @@
 #define ELLIPSOID_FLATNESS     ((EARTH_SEMIMAJOR_AXIS - EARTH_SEMIMINOR_AXIS) / EARTH_SEMIMAJOR_AXIS)
 /* Square of Eccentricity */
 #define ECCENTRICITY_SQ        (ELLIPSOID_FLATNESS * (2.0f - ELLIPSOID_FLATNESS))
+/* Largest radius of curvature (m), of the meridian and the prime vertical at the poles */
+#define MAX_RADIUS             6399593.6f
+/* Upper bound of the meters per degree of arc, on a meridian or the equator, up to POSITION_MAX_HEIGHT */
+#define METERS_PER_DEG         ((MAX_RADIUS + POSITION_MAX_HEIGHT) * 0.017453292519943295f)
 
 
 /* -- Local functions -- */
 static float degrees_to_radians(float degrees);
+static float radians_to_degrees(float radians);
 
 
 /**
@@ -164,6 +172,161 @@ void position_geodetic_to_enu (
 }
 
 
+/**
+ * @brief Converts the East-North-Up coordinates of a Local Tangent Plane centered at the (WGS-84) Geodetic point
+ * (lat0, lon0, h0) to the Earth-Centered Earth-Fixed (ECEF) coordinates (x, y, z).
+ *
+ * @param [in]  xEast   ENU East coordinate
+ * @param [in]  yNorth  ENU North coordinate
+ * @param [in]  zUp     ENU UP coordinate
+ * @param [in]  lat0    Geodetic initial latitude
+ * @param [in]  lon0    Geodetic initial longitude
+ * @param [in]  h0      Geodetic initial altitude
+ * @param [out] x       ECEF X
+ * @param [out] y       ECEF Y
+ * @param [out] z       ECEF Z
+ */
+void position_enu_to_ecef (
+        float xEast,
+        float yNorth,
+        float zUp,
+        float lat0,
+        float lon0,
+        float h0,
+        float* x,
+        float* y,
+        float* z
+)
+{
+    /* Convert to radians in notation consistent with the paper */
+    float lambda = degrees_to_radians(lat0);
+    float phi = degrees_to_radians(lon0);
+
+    float sin_lambda = sinf(lambda);
+    float cos_lambda = cosf(lambda);
+    float cos_phi = cosf(phi);
+    float sin_phi = sinf(phi);
+
+    float x0, y0, z0;
+    position_geodetic_to_ecef(lat0, lon0, h0, &x0, &y0, &z0);
+
+    /* The rotation matrix is orthonormal, so its inverse is the transpose */
+    *x = x0 - sin_phi * xEast - cos_phi * sin_lambda * yNorth + cos_lambda * cos_phi * zUp;
+    *y = y0 + cos_phi * xEast - sin_lambda * sin_phi * yNorth + cos_lambda * sin_phi * zUp;
+    *z = z0 + cos_lambda * yNorth + sin_lambda * zUp;
+}
+
+
+/**
+ * @brief Converts the Earth-Centered Earth-Fixed (ECEF) coordinates (x, y, z) to the WGS-84 Geodetic point
+ * (lat, lon, h).
+ *
+ * Closed-form solution according to the paper:
+ *   H. Vermeille, "An analytical method to transform geocentric into geodetic coordinates", J. Geodesy (2011).
+ * It does not iterate and it is exact for any point outside the evolute of the ellipsoid (~43 km around the Earth
+ * center).
+ *
+ * @param [in]  x    ECEF X
+ * @param [in]  y    ECEF Y
+ * @param [in]  z    ECEF Z
+ * @param [out] lat  Latitude in decimal degrees
+ * @param [out] lon  Longitude in decimal degrees
+ * @param [out] h    Geodetic Altitude
+ */
+void position_ecef_to_geodetic (
+        float x,
+        float y,
+        float z,
+        float* lat,
+        float* lon,
+        float* h
+)
+{
+    static const float inv_a2 = 1.0f / (EARTH_SEMIMAJOR_AXIS * EARTH_SEMIMAJOR_AXIS);
+    static const float e4 = ECCENTRICITY_SQ * ECCENTRICITY_SQ;
+
+    float w2 = x * x + y * y;
+    float w = sqrtf(w2);
+    float z2 = z * z;
+
+    float p = w2 * inv_a2;
+    float q = (1 - ECCENTRICITY_SQ) * z2 * inv_a2;
+    float r = (p + q - e4) / 6.0f;
+    float s = e4 * p * q / (4.0f * r * r * r);
+    float t = cbrtf(1.0f + s + sqrtf(s * (2.0f + s)));
+    float u = r * (1.0f + t + 1.0f / t);
+    float v = sqrtf(u * u + e4 * q);
+    float wk = ECCENTRICITY_SQ * (u + v - q) / (2.0f * v);
+    float k = sqrtf(u + v + wk * wk) - wk;
+    float D = k * w / (k + ECCENTRICITY_SQ);
+    float Dz = sqrtf(D * D + z2);
+
+    *lat = radians_to_degrees(2.0f * atan2f(z, D + Dz));
+    *lon = (w2 > 0.0f) ? radians_to_degrees(atan2f(y, x)) : 0.0f;
+    *h = (k + ECCENTRICITY_SQ - 1.0f) / k * Dz;
+}
+
+
+/**
+ * @brief Converts an array of Earth-Centered Earth-Fixed (ECEF) coordinates to WGS-84 Geodetic points.
+ * Input and output arrays are structure-of-arrays of n elements.
+ *
+ * @param [in]  x    ECEF X array
+ * @param [in]  y    ECEF Y array
+ * @param [in]  z    ECEF Z array
+ * @param [out] lat  Latitude array in decimal degrees
+ * @param [out] lon  Longitude array in decimal degrees
+ * @param [out] h    Geodetic Altitude array
+ * @param [in]  n    Number of points
+ */
+void position_ecef_to_geodetic_array (
+        const float* x,
+        const float* y,
+        const float* z,
+        float* lat,
+        float* lon,
+        float* h,
+        uint32_t n
+)
+{
+    for (uint32_t i = 0; i < n; i++) {
+        position_ecef_to_geodetic(x[i], y[i], z[i], &lat[i], &lon[i], &h[i]);
+    }
+}
+
+
+/**
+ * @brief Converts the East-North-Up coordinates of a Local Tangent Plane centered at the (WGS-84) Geodetic point
+ * (lat0, lon0, h0) to the WGS-84 Geodetic point (lat, lon, h).
+ *
+ * @param [in]  xEast   ENU East coordinate
+ * @param [in]  yNorth  ENU North coordinate
+ * @param [in]  zUp     ENU UP coordinate
+ * @param [in]  lat0    Geodetic initial latitude
+ * @param [in]  lon0    Geodetic initial longitude
+ * @param [in]  h0      Geodetic initial altitude
+ * @param [out] lat     Latitude in decimal degrees
+ * @param [out] lon     Longitude in decimal degrees
+ * @param [out] h       Geodetic Altitude
+ */
+void position_enu_to_geodetic (
+        float xEast,
+        float yNorth,
+        float zUp,
+        float lat0,
+        float lon0,
+        float h0,
+        float* lat,
+        float* lon,
+        float* h
+)
+{
+    float x, y, z;
+    position_enu_to_ecef(xEast, yNorth, zUp, lat0, lon0, h0, &x, &y, &z);
+    position_ecef_to_geodetic(x, y, z, lat, lon, h);
+}
+
+
 /**
  * @brief  Calculate the distance between two 3D-points
  * @param [in] x0   X0 coordinate in meters
@@ -190,6 +353,45 @@ float position_xyz_distance (
 }
 
 
+/**
+ * @brief Cosine of a latitude, computed once for each reference position of position_displacement_bound()
+ * @param [in] lat  Latitude in decimal degrees
+ * @return Cosine of the latitude
+ */
+float position_cos_latitude (
+        float lat
+)
+{
+    return cosf(degrees_to_radians(lat));
+}
+
+
+/**
+ * @brief Get an upper bound of the distance between a reference position and another one, without trigonometry: the
+ * length of the path along the parallel of the reference position, then along the meridian of the other one, then up
+ * or down, with the largest radius of curvature of the WGS-84 ellipsoid at POSITION_MAX_HEIGHT.
+ *
+ * @param [in] ref      Reference position. Latitude and Longitude in decimal degrees, ellipsoidal height in meters
+ * @param [in] cos_lat  Cosine of the reference latitude (see position_cos_latitude())
+ * @param [in] llh      Position. Latitude and Longitude in decimal degrees, ellipsoidal height in meters
+ * @return Distance in meters. It is not a bound above POSITION_MAX_HEIGHT
+ */
+float position_displacement_bound (
+        const position_st* ref,
+        float cos_lat,
+        const position_st* llh
+)
+{
+    float dlat = fabsf(llh->latitude - ref->latitude);
+    float dlon = fabsf(llh->longitude - ref->longitude);
+
+    if (dlon > 180.0f) {
+        dlon = 360.0f - dlon;
+    }
+    return (dlon * cos_lat + dlat) * METERS_PER_DEG + fabsf(llh->altitude - ref->altitude);
+}
+
+
 /**
  * @brief  Decimal degress to radians converter
  * @param degrees  Decimar degrees
@@ -202,3 +404,17 @@ static float degrees_to_radians (
     static const float PI = 3.14159265358979323846f;
     return (PI / 180.0f) * degrees;
 }
+
+
+/**
+ * @brief  Radians to decimal degress converter
+ * @param radians  Radians
+ * @return  Equivalent in decimal degrees
+ */
+static float radians_to_degrees (
+        float radians
+)
+{
+    static const float PI = 3.14159265358979323846f;
+    return (180.0f / PI) * radians;
+}
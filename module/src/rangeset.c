@@ -0,0 +1,221 @@
+/**
+ * @file rangeset.c
+ *
+ * Brute-force target set
+ *
+ * @license
+ * All rights reserved. Read LICENSE.txt file for the license terms.
+ *
+ * Changelog:
+ *
+ * [18/10/2026]     [miguelgarcia]
+ * Initial version
+ *
+ */
+
+/* -- Includes -- */
+#include <stdlib.h>
+#include <string.h>
+#include "dispatch.h"
+#include "rangeset.h"
+#include "target.h"
+
+/* -- Definitions -- */
+
+/** Alignment of the set arrays */
+#define SET_ALIGN       64
+/** Padding of the set arrays in elements, so the SIMD kernel can read whole vectors */
+#define SET_PAD         16
+/** Targets tested per kernel call by rangeset_find(), a multiple of SET_PAD */
+#define FIND_BLOCK      1024
+
+/* -- Local functions -- */
+static int alloc_set(rangeset_st* s, uint32_t n);
+static float* alloc_array(uint32_t n);
+
+
+/**
+ * @brief Build a set
+ * @param [out] s       Set
+ * @param [in]  ids     User ID of each target, or NULL to use the index of the target
+ * @param [in]  ecef    ECEF centers (x, y, z) * n
+ * @param [in]  ranges  Range of each target in meters
+ * @param [in]  n       Number of targets
+ * @return Zero on success, Otherwise a negative value
+ */
+int rangeset_build (
+        rangeset_st* s,
+        const uint32_t* ids,
+        const float* ecef,
+        const float* ranges,
+        uint32_t n
+)
+{
+    if ((n > 0 && (ecef == NULL || ranges == NULL)) || alloc_set(s, n) != 0) {
+        return -1;
+    }
+
+    for (uint32_t i = 0; i < n; i++) {
+        s->x[i] = ecef[i * 3];
+        s->y[i] = ecef[i * 3 + 1];
+        s->z[i] = ecef[i * 3 + 2];
+        s->range_sq[i] = ranges[i] * ranges[i];
+        s->ids[i] = (ids != NULL) ? ids[i] : i;
+    }
+    return 0;
+}
+
+/**
+ * @brief Build a set with the targets of the target table. The ID of each target is its index in the table.
+ * @param [out] s  Set
+ * @return Zero on success, Otherwise a negative value
+ */
+int rangeset_build_targets (
+        rangeset_st* s
+)
+{
+    if (alloc_set(s, target_get_count()) != 0) {
+        return -1;
+    }
+
+    for (uint32_t i = 0; i < s->n; i++) {
+        const target_entry_st* t = target_get_entry(i);
+        s->x[i] = t->ecef[0];
+        s->y[i] = t->ecef[1];
+        s->z[i] = t->ecef[2];
+        s->range_sq[i] = t->range_sq;
+        s->ids[i] = i;
+    }
+    return 0;
+}
+
+/**
+ * @brief Release a set
+ * @param [in] s  Set
+ */
+void rangeset_free (
+        rangeset_st* s
+)
+{
+    free(s->x);
+    free(s->y);
+    free(s->z);
+    free(s->range_sq);
+    free(s->ids);
+    memset(s, 0, sizeof(rangeset_st));
+}
+
+/**
+ * @brief Get the targets in range of an ECEF position, as a bitmask
+ * @param [in]  s     Set
+ * @param [in]  x     ECEF X
+ * @param [in]  y     ECEF Y
+ * @param [in]  z     ECEF Z
+ * @param [out] mask  Bit i is set if target i is in range. Room for RANGESET_WORDS(n) words
+ * @return Number of targets in range
+ */
+uint32_t rangeset_evaluate (
+        const rangeset_st* s,
+        float x,
+        float y,
+        float z,
+        uint64_t* mask
+)
+{
+    return dispatch_get_kernels()->range_mask(s->x, s->y, s->z, s->range_sq, s->n, x, y, z, mask);
+}
+
+/**
+ * @brief Get the IDs of the targets in range of an ECEF position
+ * @param [in]  s    Set
+ * @param [in]  x    ECEF X
+ * @param [in]  y    ECEF Y
+ * @param [in]  z    ECEF Z
+ * @param [out] ids  IDs of the targets in range, in target order
+ * @param [in]  max  Size of the IDs buffer
+ * @return Number of targets in range. If it is larger than max, only max IDs are written
+ */
+uint32_t rangeset_find (
+        const rangeset_st* s,
+        float x,
+        float y,
+        float z,
+        uint32_t* ids,
+        uint32_t max
+)
+{
+    dispatch_range_mask_fn range_mask = dispatch_get_kernels()->range_mask;
+    uint64_t mask[RANGESET_WORDS(FIND_BLOCK)];
+    uint32_t n = 0;
+
+    /* The set is tested in blocks, so the bitmask stays on the stack */
+    for (uint32_t first = 0; first < s->n; first += FIND_BLOCK) {
+        uint32_t count = (s->n - first < FIND_BLOCK) ? s->n - first : FIND_BLOCK;
+
+        if (range_mask(&s->x[first], &s->y[first], &s->z[first], &s->range_sq[first], count, x, y, z, mask) == 0) {
+            continue;
+        }
+        for (uint32_t w = 0; w < RANGESET_WORDS(count); w++) {
+            for (uint64_t bits = mask[w]; bits != 0; bits &= bits - 1) {
+                if (n < max) {
+                    ids[n] = s->ids[first + w * 64 + (uint32_t)__builtin_ctzll(bits)];
+                }
+                n++;
+            }
+        }
+    }
+    return n;
+}
+
+/**
+ * @brief Allocate the arrays of a set of n targets. The padding is out of range of any position.
+ * @param s  Set
+ * @param n  Number of targets
+ * @return Zero on success, Otherwise a negative value
+ */
+static int alloc_set (
+        rangeset_st* s,
+        uint32_t n
+)
+{
+    uint32_t padded = ((n + SET_PAD - 1) / SET_PAD) * SET_PAD;
+
+    memset(s, 0, sizeof(rangeset_st));
+    s->x = alloc_array(n);
+    s->y = alloc_array(n);
+    s->z = alloc_array(n);
+    s->range_sq = alloc_array(n);
+    s->ids = (uint32_t*)malloc((n + 1) * sizeof(uint32_t));
+    if (s->x == NULL || s->y == NULL || s->z == NULL || s->range_sq == NULL || s->ids == NULL) {
+        rangeset_free(s);
+        return -1;
+    }
+
+    for (uint32_t i = n; i < padded; i++) {
+        s->range_sq[i] = -1.0f;
+    }
+    s->n = n;
+    return 0;
+}
+
+/**
+ * @brief Allocate an aligned and padded array of floats, zeroed
+ * @param n  Number of elements
+ * @return  The array, or NULL if there is no memory
+ */
+static float* alloc_array (
+        uint32_t n
+)
+{
+    size_t sz = (((size_t)n + SET_PAD - 1) / SET_PAD) * SET_PAD * sizeof(float);
+    void* p = NULL;
+
+    if (sz == 0) {
+        sz = SET_PAD * sizeof(float);
+    }
+    if (posix_memalign(&p, SET_ALIGN, sz) != 0) {
+        return NULL;
+    }
+    memset(p, 0, sz);
+    return (float*)p;
+}
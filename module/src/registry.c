@@ -0,0 +1,479 @@
+/**
+ * @file registry.c
+ *
+ * Device registry
+ *
+ * @license
+ * All rights reserved. Read LICENSE.txt file for the license terms.
+ *
+ * Changelog:
+ *
+ * [18/10/2026]     [miguelgarcia]
+ * Initial version
+ *
+ */
+
+/* -- Includes -- */
+#include <stdlib.h>
+#include <string.h>
+#include "registry.h"
+
+/* -- Definitions -- */
+
+/** Min number of slots of a table */
+#define MIN_SLOTS       16
+
+/* -- Local functions -- */
+static uint64_t key_hash(uint64_t key);
+static registry_table_st* table_alloc(uint32_t size);
+static void table_release(registry_table_st* t);
+static uint8_t table_probe(const registry_table_st* t, uint64_t key, uint32_t* slot);
+static void table_put(registry_table_st* t, uint64_t key, uint32_t index);
+static void table_delete(registry_table_st* t, uint32_t slot);
+static void store_slot(registry_slot_st* s, uint64_t key, uint32_t index, uint32_t dist);
+static void migrate_step(registry_st* r);
+static void write_begin(registry_st* r);
+static void write_end(registry_st* r);
+
+
+/**
+ * @brief Initialize an empty registry
+ * @param [out] r         Registry
+ * @param [in]  capacity  Expected number of keys, it can grow later
+ * @return Zero on success, Otherwise a negative value
+ */
+int registry_init (
+        registry_st* r,
+        uint32_t capacity
+)
+{
+    uint32_t size = MIN_SLOTS;
+
+    memset(r, 0, sizeof(registry_st));
+
+    /* At most 3/4 full with the expected keys */
+    while (size < 0x80000000u && (uint64_t)size * 3 < (uint64_t)capacity * 4) {
+        size *= 2;
+    }
+    r->table = table_alloc(size);
+    if (r->table == NULL) {
+        return -1;
+    }
+    if (pthread_mutex_init(&r->lock, NULL) != 0) {
+        table_release(r->table);
+        r->table = NULL;
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * @brief Release a registry. No lookup can use it anymore
+ * @param [in] r  Registry
+ */
+void registry_free (
+        registry_st* r
+)
+{
+    if (r->table == NULL) {
+        return;
+    }
+    registry_reclaim(r);
+    table_release(r->table);
+    table_release(r->old);
+    free(r->reuse);
+    pthread_mutex_destroy(&r->lock);
+    memset(r, 0, sizeof(registry_st));
+}
+
+/**
+ * @brief Add a key to the registry, if it is not in it
+ * @param [in] r    Registry
+ * @param [in] key  Device key
+ * @return Index of the key, lower than the number of indexes given. REGISTRY_NONE if there is no memory
+ */
+uint32_t registry_insert (
+        registry_st* r,
+        uint64_t key
+)
+{
+    registry_table_st* grown = NULL;
+    uint32_t slot, index;
+    uint8_t grow;
+
+    pthread_mutex_lock(&r->lock);
+
+    /* Already in the registry */
+    if (table_probe(r->table, key, &slot)) {
+        index = r->table->slots[slot].index;
+        pthread_mutex_unlock(&r->lock);
+        return index;
+    }
+    if (r->old != NULL && table_probe(r->old, key, &slot) && r->old->slots[slot].index != REGISTRY_NONE) {
+        index = r->old->slots[slot].index;
+        pthread_mutex_unlock(&r->lock);
+        return index;
+    }
+
+    /* The new table is allocated before the lookups are blocked */
+    grow = ((uint64_t)(r->table->count + 1) * 4 > (uint64_t)(r->table->mask + 1) * 3);
+    if (grow) {
+        grown = table_alloc((r->table->mask + 1) * 2);
+        if (grown == NULL) {
+            pthread_mutex_unlock(&r->lock);
+            return REGISTRY_NONE;
+        }
+    }
+
+    write_begin(r);
+    if (grow) {
+        /* The previous growth is finished first, there is only one old table */
+        while (r->old != NULL) {
+            migrate_step(r);
+        }
+        __atomic_store_n(&r->old, r->table, __ATOMIC_RELEASE);
+        __atomic_store_n(&r->table, grown, __ATOMIC_RELEASE);
+        r->migrated = 0;
+    }
+    if (r->old != NULL) {
+        migrate_step(r);
+    }
+    index = (r->nreuse > 0) ? r->reuse[--r->nreuse] : r->indexes++;
+    table_put(r->table, key, index);
+    write_end(r);
+
+    r->count++;
+    pthread_mutex_unlock(&r->lock);
+    return index;
+}
+
+/**
+ * @brief Remove a key from the registry. Its index is given to a next key
+ * @param [in] r    Registry
+ * @param [in] key  Device key
+ * @return Index of the key, or REGISTRY_NONE if it is not in the registry
+ */
+uint32_t registry_remove (
+        registry_st* r,
+        uint64_t key
+)
+{
+    uint32_t index = REGISTRY_NONE;
+    uint32_t slot, old_slot;
+    uint8_t in_table, in_old;
+
+    pthread_mutex_lock(&r->lock);
+
+    in_table = table_probe(r->table, key, &slot);
+    in_old = (r->old != NULL && table_probe(r->old, key, &old_slot) &&
+              r->old->slots[old_slot].index != REGISTRY_NONE);
+
+    if (in_table || in_old) {
+        index = in_table ? r->table->slots[slot].index : r->old->slots[old_slot].index;
+
+        /* The index is reused by a next key */
+        if (r->nreuse == r->reuse_capacity) {
+            uint32_t capacity = (r->reuse_capacity == 0) ? 16 : r->reuse_capacity * 2;
+            uint32_t* reuse = (uint32_t*)realloc(r->reuse, capacity * sizeof(uint32_t));
+            if (reuse == NULL) {
+                pthread_mutex_unlock(&r->lock);
+                return REGISTRY_NONE;
+            }
+            r->reuse = reuse;
+            r->reuse_capacity = capacity;
+        }
+        r->reuse[r->nreuse++] = index;
+
+        write_begin(r);
+        if (in_table) {
+            table_delete(r->table, slot);
+        }
+        /* The old table is not shifted, so the slots not moved yet stay after the moved ones */
+        if (in_old) {
+            __atomic_store_n(&r->old->slots[old_slot].index, REGISTRY_NONE, __ATOMIC_RELAXED);
+        }
+        write_end(r);
+        r->count--;
+    }
+
+    pthread_mutex_unlock(&r->lock);
+    return index;
+}
+
+/**
+ * @brief Find the index of a key. It takes no lock, and it can be called at the same time as a writer
+ * @param [in] r    Registry
+ * @param [in] key  Device key
+ * @return Index of the key, or REGISTRY_NONE if it is not in the registry
+ */
+uint32_t registry_find (
+        const registry_st* r,
+        uint64_t key
+)
+{
+    for (;;) {
+        uint32_t seq = __atomic_load_n(&r->seq, __ATOMIC_ACQUIRE);
+        const registry_table_st* table;
+        const registry_table_st* old;
+        uint32_t index = REGISTRY_NONE;
+        uint32_t slot;
+
+        /* A writer is changing the tables */
+        if (seq & 1) {
+            continue;
+        }
+
+        table = __atomic_load_n(&r->table, __ATOMIC_ACQUIRE);
+        old = __atomic_load_n(&r->old, __ATOMIC_ACQUIRE);
+        if (table_probe(table, key, &slot)) {
+            index = __atomic_load_n(&table->slots[slot].index, __ATOMIC_RELAXED);
+        } else if (old != NULL && table_probe(old, key, &slot)) {
+            index = __atomic_load_n(&old->slots[slot].index, __ATOMIC_RELAXED);
+        }
+
+        /* The slots read are valid if no writer changed them meanwhile */
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (__atomic_load_n(&r->seq, __ATOMIC_RELAXED) == seq) {
+            return index;
+        }
+    }
+}
+
+/**
+ * @brief Release the replaced tables. It must not be called while a lookup runs
+ * @param [in] r  Registry
+ * @return Number of released tables
+ */
+uint32_t registry_reclaim (
+        registry_st* r
+)
+{
+    uint32_t n = 0;
+
+    pthread_mutex_lock(&r->lock);
+    while (r->retired != NULL) {
+        registry_table_st* next = r->retired->next;
+        table_release(r->retired);
+        r->retired = next;
+        n++;
+    }
+    pthread_mutex_unlock(&r->lock);
+    return n;
+}
+
+/**
+ * @brief Hash of a key
+ * @param key  Key
+ * @return Hash
+ */
+static uint64_t key_hash (
+        uint64_t key
+)
+{
+    key ^= key >> 30;
+    key *= 0xbf58476d1ce4e5b9ULL;
+    key ^= key >> 27;
+    key *= 0x94d049bb133111ebULL;
+    key ^= key >> 31;
+    return key;
+}
+
+/**
+ * @brief Allocate an empty table
+ * @param size  Number of slots, a power of two
+ * @return The table, or NULL if there is no memory
+ */
+static registry_table_st* table_alloc (
+        uint32_t size
+)
+{
+    registry_table_st* t = (registry_table_st*)calloc(1, sizeof(registry_table_st));
+
+    if (t == NULL) {
+        return NULL;
+    }
+    t->slots = (registry_slot_st*)calloc(size, sizeof(registry_slot_st));
+    if (t->slots == NULL) {
+        free(t);
+        return NULL;
+    }
+    t->mask = size - 1;
+    return t;
+}
+
+/**
+ * @brief Release a table
+ * @param t  Table, or NULL
+ */
+static void table_release (
+        registry_table_st* t
+)
+{
+    if (t != NULL) {
+        free(t->slots);
+        free(t);
+    }
+}
+
+/**
+ * @brief Find the slot of a key. The slots are read with atomic loads, so a lookup can read a table while a writer
+ * changes it: the result is then discarded by the sequence counter.
+ *
+ * @param t     Table
+ * @param key   Key
+ * @param slot  Slot of the key
+ * @return Positive value if the key has a slot, Otherwise Zero.
+ */
+static uint8_t table_probe (
+        const registry_table_st* t,
+        uint64_t key,
+        uint32_t* slot
+)
+{
+    uint32_t pos = (uint32_t)key_hash(key) & t->mask;
+
+    for (uint32_t dist = 1; dist <= t->mask + 1; dist++) {
+        const registry_slot_st* s = &t->slots[pos];
+
+        /* A slot closer to its home than the key would be: the key is not in the table */
+        if (__atomic_load_n(&s->dist, __ATOMIC_RELAXED) < dist) {
+            return 0;
+        }
+        if (__atomic_load_n(&s->key, __ATOMIC_RELAXED) == key) {
+            *slot = pos;
+            return 1;
+        }
+        pos = (pos + 1) & t->mask;
+    }
+    return 0;
+}
+
+/**
+ * @brief Add a key to a table. The key takes the slot of the first key closer to its home, and that key moves on.
+ * @param t      Table, not full
+ * @param key    Key, not in the table
+ * @param index  Index of the key
+ */
+static void table_put (
+        registry_table_st* t,
+        uint64_t key,
+        uint32_t index
+)
+{
+    uint32_t pos = (uint32_t)key_hash(key) & t->mask;
+    uint32_t dist = 1;
+
+    for (;;) {
+        registry_slot_st* s = &t->slots[pos];
+
+        if (s->dist == 0) {
+            store_slot(s, key, index, dist);
+            t->count++;
+            return;
+        }
+        if (s->dist < dist) {
+            registry_slot_st moved = *s;
+            store_slot(s, key, index, dist);
+            key = moved.key;
+            index = moved.index;
+            dist = moved.dist;
+        }
+        pos = (pos + 1) & t->mask;
+        dist++;
+    }
+}
+
+/**
+ * @brief Remove the key of a slot. The next slots of the probe sequence are shifted back
+ * @param t     Table
+ * @param slot  Slot of the key
+ */
+static void table_delete (
+        registry_table_st* t,
+        uint32_t slot
+)
+{
+    for (;;) {
+        uint32_t next = (slot + 1) & t->mask;
+        const registry_slot_st* n = &t->slots[next];
+
+        /* Empty, or at its home slot */
+        if (n->dist <= 1) {
+            store_slot(&t->slots[slot], 0, 0, 0);
+            break;
+        }
+        store_slot(&t->slots[slot], n->key, n->index, n->dist - 1);
+        slot = next;
+    }
+    t->count--;
+}
+
+/**
+ * @brief Write a slot with atomic stores, for the lookups that read it at the same time
+ * @param s      Slot
+ * @param key    Key
+ * @param index  Index
+ * @param dist   Probe distance plus one
+ */
+static void store_slot (
+        registry_slot_st* s,
+        uint64_t key,
+        uint32_t index,
+        uint32_t dist
+)
+{
+    __atomic_store_n(&s->key, key, __ATOMIC_RELAXED);
+    __atomic_store_n(&s->index, index, __ATOMIC_RELAXED);
+    __atomic_store_n(&s->dist, dist, __ATOMIC_RELAXED);
+}
+
+/**
+ * @brief Move the next slots of the old table to the new one. The old table is replaced when all are moved
+ * @param r  Registry, with an old table
+ */
+static void migrate_step (
+        registry_st* r
+)
+{
+    registry_table_st* old = r->old;
+    uint32_t end = (old->mask + 1 - r->migrated > REGISTRY_MIGRATE_STEP) ?
+                   r->migrated + REGISTRY_MIGRATE_STEP : old->mask + 1;
+
+    /* The moved keys stay in the old table too, the lookups find them first in the new one */
+    for (uint32_t i = r->migrated; i < end; i++) {
+        const registry_slot_st* s = &old->slots[i];
+        if (s->dist != 0 && s->index != REGISTRY_NONE) {
+            table_put(r->table, s->key, s->index);
+        }
+    }
+    r->migrated = end;
+
+    if (end == old->mask + 1) {
+        old->next = r->retired;
+        r->retired = old;
+        __atomic_store_n(&r->old, NULL, __ATOMIC_RELAXED);
+    }
+}
+
+/**
+ * @brief Start a change of the tables: the lookups that overlap it are repeated
+ * @param r  Registry
+ */
+static void write_begin (
+        registry_st* r
+)
+{
+    __atomic_store_n(&r->seq, r->seq + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+}
+
+/**
+ * @brief End a change of the tables
+ * @param r  Registry
+ */
+static void write_end (
+        registry_st* r
+)
+{
+    __atomic_store_n(&r->seq, r->seq + 1, __ATOMIC_RELEASE);
+}
@@ -0,0 +1,485 @@
+/**
+ * @file rtree.c
+ *
+ * Bulk-loaded R-tree of bounding boxes
+ *
+ * @license
+ * All rights reserved. Read LICENSE.txt file for the license terms.
+ *
+ * Changelog:
+ *
+ * [18/10/2026]     [miguelgarcia]
+ * Initial version
+ *
+ * [18/10/2026]     [miguelgarcia]
+ * Box queries
+ *
+ */
+
+/* -- Includes -- */
+#include <float.h>
+#include <stdlib.h>
+#include <string.h>
+#include "dispatch.h"
+#include "parallel.h"
+#include "rtree.h"
+
+/* -- Definitions -- */
+
+/** Alignment of the nodes */
+#define NODE_ALIGN      64
+
+/* -- Local types -- */
+
+/** Box being packed, a box of the input or the box of a node of the previous level */
+typedef struct {
+    rtree_box_st box;
+    uint32_t idx;
+} entry_st;
+
+/** State of a slab sort */
+typedef struct {
+    entry_st* entries;
+    /** Number of entries */
+    uint32_t n;
+    /** Entries per slab */
+    uint32_t slab;
+} slab_job_st;
+
+/** Output of rtree_query() */
+typedef struct {
+    uint32_t* ids;
+    uint32_t max;
+    /** Number of boxes found */
+    uint32_t n;
+} collect_st;
+
+/* -- Local functions -- */
+static void collect(uint32_t id, void* ctx);
+static void str_sort(entry_st* entries, uint32_t n, uint32_t threads);
+static void slab_task(uint32_t task, uint32_t worker, void* arg);
+static void pack(rtree_node_st* nodes, const entry_st* entries, uint32_t n, uint32_t first);
+static void node_box(const rtree_node_st* node, rtree_box_st* box);
+static uint32_t overlap_mask(const rtree_node_st* node, const rtree_box_st* box);
+static int compare_axis(const void* a, const void* b, int axis);
+static int compare_x(const void* a, const void* b);
+static int compare_y(const void* a, const void* b);
+static int compare_z(const void* a, const void* b);
+
+
+/**
+ * @brief Build a tree. The ID of each box is its index in the boxes.
+ * @param [out] t        Tree
+ * @param [in]  boxes    Boxes
+ * @param [in]  n        Number of boxes
+ * @param [in]  threads  Number of worker threads, zero to use all the processors
+ * @return Zero on success, Otherwise a negative value
+ */
+int rtree_build (
+        rtree_st* t,
+        const rtree_box_st* boxes,
+        uint32_t n,
+        uint32_t threads
+)
+{
+    entry_st* entries;
+    rtree_node_st* level;
+    uint32_t base = 0;
+    uint32_t m;
+
+    memset(t, 0, sizeof(rtree_st));
+    if (n == 0) {
+        return 0;
+    }
+    if (boxes == NULL) {
+        return -1;
+    }
+
+    for (m = n; ; ) {
+        m = (m + RTREE_FANOUT - 1) / RTREE_FANOUT;
+        t->nnodes += m;
+        t->depth++;
+        if (m == 1) {
+            break;
+        }
+    }
+
+    entries = (entry_st*)malloc(n * sizeof(entry_st));
+    level = (rtree_node_st*)malloc(((n + RTREE_FANOUT - 1) / RTREE_FANOUT) * sizeof(rtree_node_st));
+    t->items = (uint32_t*)malloc(n * sizeof(uint32_t));
+    if (posix_memalign((void**)&t->nodes, NODE_ALIGN, t->nnodes * sizeof(rtree_node_st)) != 0) {
+        t->nodes = NULL;
+    }
+    if (entries == NULL || level == NULL || t->items == NULL || t->nodes == NULL) {
+        free(entries);
+        free(level);
+        rtree_free(t);
+        return -1;
+    }
+    t->n = n;
+
+    /* Leaves */
+    for (uint32_t i = 0; i < n; i++) {
+        entries[i].box = boxes[i];
+        entries[i].idx = i;
+    }
+    str_sort(entries, n, threads);
+    for (uint32_t i = 0; i < n; i++) {
+        t->items[i] = entries[i].idx;
+    }
+    m = (n + RTREE_FANOUT - 1) / RTREE_FANOUT;
+    pack(level, entries, n, 0);
+    t->nleaves = m;
+
+    /* Each level is sorted and stored in the tree, and its parents are packed from it. The children of the parents
+     * are the stored nodes, which are contiguous */
+    while (m > 1) {
+        for (uint32_t j = 0; j < m; j++) {
+            node_box(&level[j], &entries[j].box);
+            entries[j].idx = j;
+        }
+        str_sort(entries, m, threads);
+        for (uint32_t j = 0; j < m; j++) {
+            t->nodes[base + j] = level[entries[j].idx];
+        }
+        pack(level, entries, m, base);
+        base += m;
+        m = (m + RTREE_FANOUT - 1) / RTREE_FANOUT;
+    }
+    t->nodes[base] = level[0];
+
+    free(entries);
+    free(level);
+    return 0;
+}
+
+/**
+ * @brief Release a tree
+ * @param [in] t  Tree
+ */
+void rtree_free (
+        rtree_st* t
+)
+{
+    free(t->nodes);
+    free(t->items);
+    memset(t, 0, sizeof(rtree_st));
+}
+
+/**
+ * @brief Find the boxes that contain an ECEF position
+ * @param [in]  t    Tree
+ * @param [in]  x    ECEF X
+ * @param [in]  y    ECEF Y
+ * @param [in]  z    ECEF Z
+ * @param [out] ids  IDs of the boxes that contain the position, not sorted
+ * @param [in]  max  Size of the IDs buffer
+ * @return Number of boxes that contain the position. If it is larger than max, only max IDs are written
+ */
+uint32_t rtree_query (
+        const rtree_st* t,
+        float x,
+        float y,
+        float z,
+        uint32_t* ids,
+        uint32_t max
+)
+{
+    collect_st c = {ids, max, 0};
+
+    return rtree_visit(t, x, y, z, collect, &c);
+}
+
+/**
+ * @brief Call a function with every box that contains an ECEF position
+ * @param [in] t    Tree
+ * @param [in] x    ECEF X
+ * @param [in] y    ECEF Y
+ * @param [in] z    ECEF Z
+ * @param [in] cb   Function called with the ID of each box
+ * @param [in] ctx  User context passed to the function
+ * @return Number of boxes that contain the position
+ */
+uint32_t rtree_visit (
+        const rtree_st* t,
+        float x,
+        float y,
+        float z,
+        rtree_visit_cb cb,
+        void* ctx
+)
+{
+    /* Each visited node pushes at most RTREE_FANOUT children and pops itself */
+    uint32_t stack[RTREE_MAX_DEPTH * RTREE_FANOUT];
+    dispatch_box_mask_fn box_mask = dispatch_get_kernels()->box_mask;
+    uint32_t sp = 0;
+    uint32_t n = 0;
+
+    if (t->nnodes == 0) {
+        return 0;
+    }
+
+    stack[sp++] = t->nnodes - 1;
+    while (sp > 0) {
+        uint32_t idx = stack[--sp];
+        const rtree_node_st* node = &t->nodes[idx];
+        /* Every child is tested at once, the empty ones never contain a position */
+        uint32_t mask = box_mask(&node->min[0][0], x, y, z);
+
+        if (idx < t->nleaves) {
+            for (; mask != 0; mask &= mask - 1) {
+                cb(t->items[node->first + (uint32_t)__builtin_ctz(mask)], ctx);
+                n++;
+            }
+        } else {
+            for (; mask != 0; mask &= mask - 1) {
+                uint32_t child = node->first + (uint32_t)__builtin_ctz(mask);
+                __builtin_prefetch(&t->nodes[child]);
+                stack[sp++] = child;
+            }
+        }
+    }
+
+    return n;
+}
+
+/**
+ * @brief Call a function with every box that overlaps a box
+ * @param [in] t    Tree
+ * @param [in] box  Box of the query
+ * @param [in] cb   Function called with the ID of each box
+ * @param [in] ctx  User context passed to the function
+ * @return Number of boxes that overlap the box of the query
+ */
+uint32_t rtree_visit_box (
+        const rtree_st* t,
+        const rtree_box_st* box,
+        rtree_visit_cb cb,
+        void* ctx
+)
+{
+    uint32_t stack[RTREE_MAX_DEPTH * RTREE_FANOUT];
+    uint32_t sp = 0;
+    uint32_t n = 0;
+
+    if (t->nnodes == 0) {
+        return 0;
+    }
+
+    stack[sp++] = t->nnodes - 1;
+    while (sp > 0) {
+        uint32_t idx = stack[--sp];
+        const rtree_node_st* node = &t->nodes[idx];
+        uint32_t mask = overlap_mask(node, box);
+
+        if (idx < t->nleaves) {
+            for (; mask != 0; mask &= mask - 1) {
+                cb(t->items[node->first + (uint32_t)__builtin_ctz(mask)], ctx);
+                n++;
+            }
+        } else {
+            for (; mask != 0; mask &= mask - 1) {
+                stack[sp++] = node->first + (uint32_t)__builtin_ctz(mask);
+            }
+        }
+    }
+
+    return n;
+}
+
+/**
+ * @brief Store the ID of a box in the output of rtree_query()
+ * @param id   Box ID
+ * @param ctx  Output
+ */
+static void collect (
+        uint32_t id,
+        void* ctx
+)
+{
+    collect_st* c = (collect_st*)ctx;
+
+    if (c->n < c->max) {
+        c->ids[c->n] = id;
+    }
+    c->n++;
+}
+
+/**
+ * @brief Sort boxes in Sort-Tile-Recursive order: consecutive groups of RTREE_FANOUT boxes are close to each other.
+ * The slabs of the X sort are independent, so they are sorted by several threads.
+ *
+ * @param entries  Boxes
+ * @param n        Number of boxes
+ * @param threads  Number of worker threads, zero to use all the processors
+ */
+static void str_sort (
+        entry_st* entries,
+        uint32_t n,
+        uint32_t threads
+)
+{
+    uint32_t nodes = (n + RTREE_FANOUT - 1) / RTREE_FANOUT;
+    uint32_t slabs = 1;
+    slab_job_st b;
+
+    /* Cube root of the number of nodes, rounded up */
+    while ((uint64_t)slabs * slabs * slabs < nodes) {
+        slabs++;
+    }
+
+    qsort(entries, n, sizeof(entry_st), compare_x);
+
+    b.entries = entries;
+    b.n = n;
+    b.slab = ((nodes + slabs - 1) / slabs) * RTREE_FANOUT;
+    parallel_for((n + b.slab - 1) / b.slab, threads, slab_task, &b);
+}
+
+/**
+ * @brief Sort a slab by Y, then its runs by Z
+ * @param task    Slab
+ * @param worker  Worker index
+ * @param arg     Job
+ */
+static void slab_task (
+        uint32_t task,
+        uint32_t worker,
+        void* arg
+)
+{
+    const slab_job_st* b = (const slab_job_st*)arg;
+    entry_st* e = &b->entries[task * b->slab];
+    uint32_t n = (b->n - task * b->slab < b->slab) ? b->n - task * b->slab : b->slab;
+    uint32_t nodes = (n + RTREE_FANOUT - 1) / RTREE_FANOUT;
+    uint32_t runs = 1;
+    uint32_t run;
+
+    (void)worker;
+
+    /* Square root of the number of nodes of the slab, rounded up */
+    while (runs * runs < nodes) {
+        runs++;
+    }
+    run = ((nodes + runs - 1) / runs) * RTREE_FANOUT;
+
+    qsort(e, n, sizeof(entry_st), compare_y);
+    for (uint32_t r = 0; r < n; r += run) {
+        qsort(&e[r], (n - r < run) ? n - r : run, sizeof(entry_st), compare_z);
+    }
+}
+
+/**
+ * @brief Pack consecutive groups of RTREE_FANOUT boxes in nodes
+ * @param nodes    Nodes, room for n / RTREE_FANOUT rounded up
+ * @param entries  Boxes, in STR order
+ * @param n        Number of boxes
+ * @param first    Child index of the first box
+ */
+static void pack (
+        rtree_node_st* nodes,
+        const entry_st* entries,
+        uint32_t n,
+        uint32_t first
+)
+{
+    for (uint32_t j = 0; j * RTREE_FANOUT < n; j++) {
+        rtree_node_st* node = &nodes[j];
+        uint32_t start = j * RTREE_FANOUT;
+
+        memset(node, 0, sizeof(rtree_node_st));
+        node->first = first + start;
+        node->count = (n - start < RTREE_FANOUT) ? n - start : RTREE_FANOUT;
+        for (uint32_t k = 0; k < RTREE_FANOUT; k++) {
+            for (int a = 0; a < 3; a++) {
+                /* Empty children are inverted boxes */
+                node->min[a][k] = (k < node->count) ? entries[start + k].box.min[a] : FLT_MAX;
+                node->max[a][k] = (k < node->count) ? entries[start + k].box.max[a] : -FLT_MAX;
+            }
+        }
+    }
+}
+
+/**
+ * @brief Get the box of the children of a node
+ * @param node  Node
+ * @param box   Box
+ */
+static void node_box (
+        const rtree_node_st* node,
+        rtree_box_st* box
+)
+{
+    for (int a = 0; a < 3; a++) {
+        box->min[a] = node->min[a][0];
+        box->max[a] = node->max[a][0];
+        for (uint32_t k = 1; k < node->count; k++) {
+            box->min[a] = (node->min[a][k] < box->min[a]) ? node->min[a][k] : box->min[a];
+            box->max[a] = (node->max[a][k] > box->max[a]) ? node->max[a][k] : box->max[a];
+        }
+    }
+}
+
+/**
+ * @brief Get the children of a node that overlap a box. Box queries are rare, so the test is not vectorized.
+ * @param node  Node
+ * @param box   Box
+ * @return Bit k is set if child k overlaps the box
+ */
+static uint32_t overlap_mask (
+        const rtree_node_st* node,
+        const rtree_box_st* box
+)
+{
+    uint32_t mask = 0;
+
+    for (uint32_t k = 0; k < node->count; k++) {
+        uint32_t in = 1;
+        for (int a = 0; a < 3; a++) {
+            in &= (node->min[a][k] <= box->max[a]) & (node->max[a][k] >= box->min[a]);
+        }
+        mask |= in << k;
+    }
+    return mask;
+}
+
+/**
+ * @brief Compare the centers of two boxes on an axis, for qsort()
+ */
+static int compare_axis (
+        const void* a,
+        const void* b,
+        int axis
+)
+{
+    const rtree_box_st* ba = &((const entry_st*)a)->box;
+    const rtree_box_st* bb = &((const entry_st*)b)->box;
+    float ca = ba->min[axis] + ba->max[axis];
+    float cb = bb->min[axis] + bb->max[axis];
+
+    return (ca > cb) - (ca < cb);
+}
+
+static int compare_x (
+        const void* a,
+        const void* b
+)
+{
+    return compare_axis(a, b, 0);
+}
+
+static int compare_y (
+        const void* a,
+        const void* b
+)
+{
+    return compare_axis(a, b, 1);
+}
+
+static int compare_z (
+        const void* a,
+        const void* b
+)
+{
+    return compare_axis(a, b, 2);
+}
@@ -13,20 +13,22 @@
  * [27/02/2021]     [miguelgarcia]
  * Initial version
  *
+ * [18/10/2026]     [miguelgarcia]
+ * Targets are read from the generated target table
+ *
  */
 
 /* -- Includes -- */
+#include <stddef.h>
 #include <stdint.h>
 #include "target.h"
 
-/* -- Local variables -- */
-
-/** Target position (Lat=39.4731325, Lon=-0.3677324, Alt=8.0) */
-static const position_st target_pos = {.latitude = 39.4731325f, .longitude = -0.3677324f, .altitude = 8.0f,
-                                       .is_valid = pos_3d};
+/* -- External variables -- */
 
-/** Range distance to target in meters */
-static const float target_range = 100.0f;
+/** Target table generated at build time by target_table_gen (target_table.c) */
+extern const target_entry_st target_table_[];
+/** Number of targets of the target table */
+extern const uint32_t target_table_count_;
 
 /**
  * @brief Return the target position
@@ -36,7 +38,7 @@ position_st target_get_position (
 
 )
 {
-    return target_pos;
+    return target_table_[0].llh;
 }
 
 /**
@@ -47,5 +49,86 @@ uint32_t target_get_range (
 
 )
 {
-    return target_range;
+    return target_table_[0].range;
+}
+
+/**
+ * @brief Return the number of targets of the target table
+ * @return Number of targets
+ */
+uint32_t target_get_count (
+
+)
+{
+    return target_table_count_;
+}
+
+/**
+ * @brief Return a target of the target table
+ * @param [in] idx  Target index, lower than target_get_count()
+ * @return Target entry, or NULL if the index is out of the table
+ */
+const target_entry_st* target_get_entry (
+        uint32_t idx
+)
+{
+    if (idx >= target_table_count_) {
+        return NULL;
+    }
+    return &target_table_[idx];
+}
+
+/**
+ * @brief Converts the Earth-Centered Earth-Fixed (ECEF) coordinates (x, y, z) to East-North-Up coordinates in the
+ * Local Tangent Plane of the target.
+ *
+ * @param [in]  t       Target entry
+ * @param [in]  x       ECEF X
+ * @param [in]  y       ECEF Y
+ * @param [in]  z       ECEF Z
+ * @param [out] xEast   ENU East coordinate
+ * @param [out] yNorth  ENU North coordinate
+ * @param [out] zUp     ENU UP coordinate
+ */
+void target_ecef_to_enu (
+        const target_entry_st* t,
+        float x,
+        float y,
+        float z,
+        float* xEast,
+        float* yNorth,
+        float* zUp
+)
+{
+    float xd = x - t->ecef[0];
+    float yd = y - t->ecef[1];
+    float zd = z - t->ecef[2];
+
+    *xEast = t->rotation[0][0] * xd + t->rotation[0][1] * yd + t->rotation[0][2] * zd;
+    *yNorth = t->rotation[1][0] * xd + t->rotation[1][1] * yd + t->rotation[1][2] * zd;
+    *zUp = t->rotation[2][0] * xd + t->rotation[2][1] * yd + t->rotation[2][2] * zd;
+}
+
+/**
+ * @brief Check if an ECEF position is within the range of the target. The rotation to ENU keeps the distances, so the
+ * check is done directly in ECEF against the squared range.
+ *
+ * @param [in] t  Target entry
+ * @param [in] x  ECEF X
+ * @param [in] y  ECEF Y
+ * @param [in] z  ECEF Z
+ * @return Positive value if the position is on range, Otherwise Zero.
+ */
+uint8_t target_is_on_range (
+        const target_entry_st* t,
+        float x,
+        float y,
+        float z
+)
+{
+    float dx = x - t->ecef[0];
+    float dy = y - t->ecef[1];
+    float dz = z - t->ecef[2];
+
+    return ((dx * dx + dy * dy + dz * dz) <= t->range_sq) ? 1 : 0;
 }
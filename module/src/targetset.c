@@ -0,0 +1,296 @@
+/**
+ * @file targetset.c
+ *
+ * Hot-swappable target set
+ *
+ * @license
+ * All rights reserved. Read LICENSE.txt file for the license terms.
+ *
+ * Changelog:
+ *
+ * [18/10/2026]     [miguelgarcia]
+ * Initial version
+ *
+ */
+
+/* -- Includes -- */
+#include <stdlib.h>
+#include <string.h>
+#include "targetset.h"
+
+/* -- Local functions -- */
+static uint8_t is_in_use(const targetset_st* t, uint64_t retired);
+static uint32_t reclaim_locked(targetset_st* t);
+
+
+/**
+ * @brief Initialize a target set without snapshot
+ * @param [out] t  Target set
+ * @return Zero on success, Otherwise a negative value
+ */
+int targetset_init (
+        targetset_st* t
+)
+{
+    memset(t, 0, sizeof(targetset_st));
+    t->epoch = 1;
+    return (pthread_mutex_init(&t->lock, NULL) == 0) ? 0 : -1;
+}
+
+/**
+ * @brief Release a target set and all its snapshots. No reader can use it anymore
+ * @param [in] t  Target set
+ */
+void targetset_free (
+        targetset_st* t
+)
+{
+    targetset_snapshot_st* s = t->retired;
+
+    while (s != NULL) {
+        targetset_snapshot_st* next = s->next;
+        geofence_set_free(&s->fences);
+        free(s);
+        s = next;
+    }
+    if (t->current != NULL) {
+        geofence_set_free(&t->current->fences);
+        free(t->current);
+    }
+    pthread_mutex_destroy(&t->lock);
+    memset(t, 0, sizeof(targetset_st));
+}
+
+/**
+ * @brief Register a reader of a target set. Each thread that reads the set needs its own reader
+ * @param [in] t  Target set
+ * @return Reader index, Otherwise a negative value if all the slots are registered
+ */
+int targetset_reader_register (
+        targetset_st* t
+)
+{
+    for (int i = 0; i < TARGETSET_MAX_READERS; i++) {
+        uint32_t expected = 0;
+
+        if (__atomic_compare_exchange_n(&t->readers[i].used, &expected, 1, 0, __ATOMIC_SEQ_CST, __ATOMIC_RELAXED)) {
+            __atomic_store_n(&t->readers[i].epoch, 0, __ATOMIC_SEQ_CST);
+            return i;
+        }
+    }
+    return -1;
+}
+
+/**
+ * @brief Unregister a reader of a target set. The reader must be outside the read sections
+ * @param [in] t       Target set
+ * @param [in] reader  Reader index
+ */
+void targetset_reader_unregister (
+        targetset_st* t,
+        int reader
+)
+{
+    if (reader >= 0 && reader < TARGETSET_MAX_READERS) {
+        __atomic_store_n(&t->readers[reader].epoch, 0, __ATOMIC_SEQ_CST);
+        __atomic_store_n(&t->readers[reader].used, 0, __ATOMIC_SEQ_CST);
+    }
+}
+
+/**
+ * @brief Start a read section and get the current snapshot. The snapshot is valid until targetset_read_end(). The read
+ * sections of a reader cannot be nested.
+ *
+ * @param [in] t       Target set
+ * @param [in] reader  Reader index
+ * @return Current snapshot, or NULL if nothing was published
+ */
+targetset_snapshot_st* targetset_read_begin (
+        targetset_st* t,
+        int reader
+)
+{
+    /* The slot is written before the pointer is read. A writer that did not see the slot yet has not swapped the
+     * pointer, or it advanced the epoch after the swap and this read gets the new snapshot */
+    __atomic_store_n(&t->readers[reader].epoch, __atomic_load_n(&t->epoch, __ATOMIC_SEQ_CST), __ATOMIC_SEQ_CST);
+    return __atomic_load_n(&t->current, __ATOMIC_SEQ_CST);
+}
+
+/**
+ * @brief End a read section. The snapshot of the section must not be used anymore
+ * @param [in] t       Target set
+ * @param [in] reader  Reader index
+ */
+void targetset_read_end (
+        targetset_st* t,
+        int reader
+)
+{
+    __atomic_store_n(&t->readers[reader].epoch, 0, __ATOMIC_SEQ_CST);
+}
+
+/**
+ * @brief Find the fences of the current snapshot that contain an ECEF position, in a read section
+ * @param [in]  t        Target set
+ * @param [in]  reader   Reader index
+ * @param [in]  x        ECEF X
+ * @param [in]  y        ECEF Y
+ * @param [in]  z        ECEF Z
+ * @param [out] ids      IDs of the fences that contain the position
+ * @param [in]  max      Size of the IDs buffer
+ * @param [out] version  Version of the snapshot, zero if nothing was published. It can be NULL
+ * @return Number of fences that contain the position. If it is larger than max, only max IDs are written
+ */
+uint32_t targetset_evaluate (
+        targetset_st* t,
+        int reader,
+        float x,
+        float y,
+        float z,
+        uint32_t* ids,
+        uint32_t max,
+        uint64_t* version
+)
+{
+    targetset_snapshot_st* s = targetset_read_begin(t, reader);
+    uint32_t n = 0;
+
+    if (s != NULL) {
+        n = geofence_evaluate(&s->fences, x, y, z, ids, max);
+    }
+    if (version != NULL) {
+        *version = (s != NULL) ? s->version : 0;
+    }
+    targetset_read_end(t, reader);
+    return n;
+}
+
+/**
+ * @brief Publish a new snapshot. The indexes of the fences are built, and the fences are moved into the snapshot: the
+ * set given is left empty, as if it was released. The replaced snapshot is released once no reader uses it.
+ *
+ * @param [in] t       Target set
+ * @param [in] fences  Fences of the snapshot
+ * @return Zero on success, Otherwise a negative value and the fences are not moved
+ */
+int targetset_publish (
+        targetset_st* t,
+        geofence_set_st* fences
+)
+{
+    targetset_snapshot_st* s;
+    targetset_snapshot_st* old;
+
+    /* The readers never build the indexes, so the snapshot is not written after it is published */
+    if (geofence_build(fences) != 0) {
+        return -1;
+    }
+    s = (targetset_snapshot_st*)malloc(sizeof(targetset_snapshot_st));
+    if (s == NULL) {
+        return -1;
+    }
+    s->fences = *fences;
+    s->retired = 0;
+    s->next = NULL;
+    memset(fences, 0, sizeof(geofence_set_st));
+
+    pthread_mutex_lock(&t->lock);
+    s->version = ++t->version;
+    old = __atomic_exchange_n(&t->current, s, __ATOMIC_SEQ_CST);
+    if (old != NULL) {
+        /* The readers that may use the old snapshot started in this epoch or before */
+        old->retired = __atomic_fetch_add(&t->epoch, 1, __ATOMIC_SEQ_CST);
+        old->next = t->retired;
+        t->retired = old;
+    }
+    reclaim_locked(t);
+    pthread_mutex_unlock(&t->lock);
+    return 0;
+}
+
+/**
+ * @brief Publish a snapshot with the targets of the target table (see geofence_add_targets())
+ * @param [in] t  Target set
+ * @return Zero on success, Otherwise a negative value
+ */
+int targetset_publish_targets (
+        targetset_st* t
+)
+{
+    geofence_set_st s;
+
+    if (geofence_set_init(&s, target_get_count()) != 0) {
+        return -1;
+    }
+    geofence_set_index(&s, geofence_index_scan);
+    if (geofence_add_targets(&s) != 0 || targetset_publish(t, &s) != 0) {
+        geofence_set_free(&s);
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * @brief Release the replaced snapshots that no reader uses
+ * @param [in] t  Target set
+ * @return Number of replaced snapshots not released yet
+ */
+uint32_t targetset_reclaim (
+        targetset_st* t
+)
+{
+    uint32_t n;
+
+    pthread_mutex_lock(&t->lock);
+    n = reclaim_locked(t);
+    pthread_mutex_unlock(&t->lock);
+    return n;
+}
+
+/**
+ * @brief Check if a reader may use a snapshot replaced in an epoch
+ * @param t        Target set
+ * @param retired  Epoch when the snapshot was replaced
+ * @return Positive value if a read section started in that epoch or before is in progress, Otherwise Zero
+ */
+static uint8_t is_in_use (
+        const targetset_st* t,
+        uint64_t retired
+)
+{
+    for (int i = 0; i < TARGETSET_MAX_READERS; i++) {
+        uint64_t epoch = __atomic_load_n(&t->readers[i].epoch, __ATOMIC_SEQ_CST);
+
+        if (epoch != 0 && epoch <= retired) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief Release the replaced snapshots that no reader uses, with the lock of the writers taken
+ * @param t  Target set
+ * @return Number of replaced snapshots not released yet
+ */
+static uint32_t reclaim_locked (
+        targetset_st* t
+)
+{
+    targetset_snapshot_st** link = &t->retired;
+    uint32_t n = 0;
+
+    while (*link != NULL) {
+        targetset_snapshot_st* s = *link;
+
+        if (is_in_use(t, s->retired)) {
+            link = &s->next;
+            n++;
+            continue;
+        }
+        *link = s->next;
+        geofence_set_free(&s->fences);
+        free(s);
+    }
+    return n;
+}
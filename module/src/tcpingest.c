@@ -0,0 +1,571 @@
+/**
+ * @file tcpingest.c
+ *
+ * TCP ingestion server
+ *
+ * @license
+ * All rights reserved. Read LICENSE.txt file for the license terms.
+ *
+ * Changelog:
+ *
+ * [18/10/2026]     [miguelgarcia]
+ * Initial version
+ *
+ * [18/10/2026]     [miguelgarcia]
+ * Refuse the connections when the process is out of descriptors
+ *
+ * [18/10/2026]     [miguelgarcia]
+ * Descriptor zero is a valid descriptor
+ *
+ */
+
+/* -- Includes -- */
+#define _GNU_SOURCE
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <netinet/in.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include "tcpingest.h"
+
+/* -- Definitions -- */
+
+#ifndef EPOLLEXCLUSIVE
+#define EPOLLEXCLUSIVE  (1u << 28)
+#endif
+
+/** Max wait of a loop for events in milliseconds, when there is an idle timeout */
+#define MAX_WAIT_MS     1000
+
+/* -- Local types -- */
+
+/** Connection of an event loop */
+typedef struct tcpingest_conn {
+
+    /** Socket */
+    int fd;
+    /** Device ID */
+    uint32_t device;
+    /** Time of the last data in milliseconds */
+    uint64_t last;
+    /** Connection with older data */
+    struct tcpingest_conn* prev;
+    /** Connection with newer data */
+    struct tcpingest_conn* next;
+
+} conn_st;
+
+/* -- Local functions -- */
+static uint64_t now_ms(void);
+static int loop_init(tcpingest_st* t, tcpingest_loop_st* l);
+static void loop_free(tcpingest_loop_st* l);
+static void* loop_run(void* arg);
+static void accept_all(tcpingest_loop_st* l, uint64_t now);
+static uint8_t refuse(tcpingest_loop_st* l);
+static void listener_pause(tcpingest_loop_st* l, uint64_t now);
+static int listener_resume(tcpingest_loop_st* l);
+static void conn_read(tcpingest_loop_st* l, conn_st* c, uint32_t events, uint64_t now);
+static void conn_close(tcpingest_loop_st* l, conn_st* c);
+static void list_append(tcpingest_loop_st* l, conn_st* c);
+static void list_unlink(tcpingest_loop_st* l, conn_st* c);
+
+
+/**
+ * @brief Start a TCP ingestion server listening on all the addresses
+ * @param [out] t        Server
+ * @param [in]  fleet    Fleet engine fed by the server. It must outlive the server
+ * @param [in]  port     Listening port, zero for a port given by the system (see tcpingest_port())
+ * @param [in]  loops    Number of event-loop threads, zero for one. TCPINGEST_MAX_LOOPS at most
+ * @param [in]  idle_ms  Idle timeout of a connection in milliseconds, zero for none
+ * @param [in]  cb       Callback that gives the device ID of a new connection, or NULL for sequential IDs from one
+ * @param [in]  ctx      User context passed to the callback
+ * @return Zero on success, Otherwise a negative value
+ */
+int tcpingest_init (
+        tcpingest_st* t,
+        fleet_st* fleet,
+        uint16_t port,
+        uint32_t loops,
+        uint32_t idle_ms,
+        tcpingest_connect_cb cb,
+        void* ctx
+)
+{
+    struct sockaddr_in addr;
+    socklen_t addr_len = sizeof(addr);
+    int on = 1;
+
+    memset(t, 0, sizeof(tcpingest_st));
+    t->listen = -1;
+    for (uint32_t i = 0; i < TCPINGEST_MAX_LOOPS; i++) {
+        t->loops[i].epoll = -1;
+        t->loops[i].wake = -1;
+        t->loops[i].spare = -1;
+    }
+    t->fleet = fleet;
+    t->idle_ms = idle_ms;
+    t->cb = cb;
+    t->ctx = ctx;
+
+    if (loops == 0) {
+        loops = 1;
+    }
+    if (loops > TCPINGEST_MAX_LOOPS) {
+        loops = TCPINGEST_MAX_LOOPS;
+    }
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    addr.sin_port = htons(port);
+
+    t->listen = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (t->listen < 0) {
+        return -1;
+    }
+    if (setsockopt(t->listen, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on)) != 0 ||
+        bind(t->listen, (struct sockaddr*)&addr, sizeof(addr)) != 0 ||
+        listen(t->listen, SOMAXCONN) != 0 ||
+        getsockname(t->listen, (struct sockaddr*)&addr, &addr_len) != 0) {
+        tcpingest_free(t);
+        return -1;
+    }
+    t->port = ntohs(addr.sin_port);
+
+    for (uint32_t i = 0; i < loops; i++) {
+        if (loop_init(t, &t->loops[i]) != 0) {
+            tcpingest_free(t);
+            return -1;
+        }
+        t->nloops++;
+    }
+    return 0;
+}
+
+/**
+ * @brief Stop the server and close all its connections. The bytes already received are submitted to the fleet engine
+ * @param [in] t  Server
+ */
+void tcpingest_free (
+        tcpingest_st* t
+)
+{
+    for (uint32_t i = 0; i < t->nloops; i++) {
+        tcpingest_loop_st* l = &t->loops[i];
+        uint64_t one = 1;
+
+        if (write(l->wake, &one, sizeof(one)) == sizeof(one)) {
+            pthread_join(l->thread, NULL);
+        }
+        loop_free(l);
+    }
+    if (t->listen >= 0) {
+        close(t->listen);
+    }
+    memset(t, 0, sizeof(tcpingest_st));
+    t->listen = -1;
+}
+
+/**
+ * @brief Return the listening port of the server
+ * @param [in] t  Server
+ * @return Port
+ */
+uint16_t tcpingest_port (
+        const tcpingest_st* t
+)
+{
+    return t->port;
+}
+
+/**
+ * @brief Get the counters of the server. It can be called from any thread
+ * @param [in]  t      Server
+ * @param [out] stats  Counters
+ */
+void tcpingest_get_stats (
+        tcpingest_st* t,
+        tcpingest_stats_st* stats
+)
+{
+    memset(stats, 0, sizeof(tcpingest_stats_st));
+    for (uint32_t i = 0; i < t->nloops; i++) {
+        const tcpingest_stats_st* s = &t->loops[i].stats;
+
+        stats->accepted += __atomic_load_n(&s->accepted, __ATOMIC_RELAXED);
+        stats->closed += __atomic_load_n(&s->closed, __ATOMIC_RELAXED);
+        stats->timeouts += __atomic_load_n(&s->timeouts, __ATOMIC_RELAXED);
+        stats->bytes += __atomic_load_n(&s->bytes, __ATOMIC_RELAXED);
+        stats->refused += __atomic_load_n(&s->refused, __ATOMIC_RELAXED);
+    }
+}
+
+/**
+ * @brief Monotonic time
+ * @return Milliseconds
+ */
+static uint64_t now_ms (
+
+)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000u + (uint64_t)ts.tv_nsec / 1000000u;
+}
+
+/**
+ * @brief Create the epoll set of a loop and start its thread
+ * @param t  Server
+ * @param l  Loop, zeroed, with its descriptors at -1
+ * @return Zero on success, Otherwise a negative value. The loop is released on error
+ */
+static int loop_init (
+        tcpingest_st* t,
+        tcpingest_loop_st* l
+)
+{
+    struct epoll_event ev;
+
+    l->server = t;
+    l->epoll = epoll_create1(EPOLL_CLOEXEC);
+    l->wake = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    l->buf = (char*)malloc(TCPINGEST_READ_BYTES);
+    l->spare = open("/dev/null", O_RDONLY | O_CLOEXEC);
+    if (l->epoll < 0 || l->wake < 0 || l->buf == NULL || l->spare < 0) {
+        loop_free(l);
+        return -1;
+    }
+
+    /* The event data of the wake event and the listening socket are their descriptors in the server */
+    memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN;
+    ev.data.ptr = &l->wake;
+    if (epoll_ctl(l->epoll, EPOLL_CTL_ADD, l->wake, &ev) != 0) {
+        loop_free(l);
+        return -1;
+    }
+    if (listener_resume(l) != 0) {
+        loop_free(l);
+        return -1;
+    }
+
+    if (pthread_create(&l->thread, NULL, loop_run, l) != 0) {
+        loop_free(l);
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * @brief Release a loop whose thread is stopped
+ * @param l  Loop
+ */
+static void loop_free (
+        tcpingest_loop_st* l
+)
+{
+    while (l->oldest != NULL) {
+        conn_close(l, l->oldest);
+    }
+    if (l->epoll >= 0) {
+        close(l->epoll);
+    }
+    if (l->wake >= 0) {
+        close(l->wake);
+    }
+    if (l->spare >= 0) {
+        close(l->spare);
+    }
+    free(l->buf);
+    l->epoll = -1;
+    l->wake = -1;
+    l->spare = -1;
+    l->buf = NULL;
+}
+
+/**
+ * @brief Event loop. Accepts and reads connections and closes the expired ones, until the wake event is signaled
+ * @param arg  Loop
+ * @return NULL
+ */
+static void* loop_run (
+        void* arg
+)
+{
+    tcpingest_loop_st* l = (tcpingest_loop_st*)arg;
+    tcpingest_st* t = l->server;
+    struct epoll_event events[TCPINGEST_MAX_EVENTS];
+    int timeout = -1;
+    uint8_t stop = 0;
+
+    if (t->idle_ms > 0) {
+        timeout = (t->idle_ms / 4 + 1 < MAX_WAIT_MS) ? (int)(t->idle_ms / 4 + 1) : MAX_WAIT_MS;
+    }
+
+    while (!stop) {
+        uint64_t closed = l->stats.closed;
+        int wait = (l->paused && (timeout < 0 || timeout > TCPINGEST_PAUSE_MS)) ? TCPINGEST_PAUSE_MS : timeout;
+        int n = epoll_wait(l->epoll, events, TCPINGEST_MAX_EVENTS, wait);
+        uint64_t now = now_ms();
+
+        for (int i = 0; i < n; i++) {
+            void* ptr = events[i].data.ptr;
+
+            if (ptr == &l->wake) {
+                stop = 1;
+            } else if (ptr == &t->listen) {
+                accept_all(l, now);
+            } else {
+                conn_read(l, (conn_st*)ptr, events[i].events, now);
+            }
+        }
+
+        /* The oldest connections are the first to expire */
+        while (t->idle_ms > 0 && l->oldest != NULL && now - l->oldest->last >= t->idle_ms) {
+            __atomic_fetch_add(&l->stats.timeouts, 1, __ATOMIC_RELAXED);
+            conn_close(l, l->oldest);
+        }
+
+        /* Watch the listening socket again when a connection freed a descriptor, or at the end of the pause */
+        if (l->paused && (l->stats.closed != closed || now >= l->resume_at)) {
+            listener_resume(l);
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief Accept the pending connections of the listening socket
+ * @param l    Loop
+ * @param now  Current time in milliseconds
+ */
+static void accept_all (
+        tcpingest_loop_st* l,
+        uint64_t now
+)
+{
+    tcpingest_st* t = l->server;
+
+    for (;;) {
+        struct sockaddr_storage peer;
+        socklen_t peer_len = sizeof(peer);
+        struct epoll_event ev;
+        conn_st* c;
+        int fd;
+
+        fd = accept4(t->listen, (struct sockaddr*)&peer, &peer_len, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) {
+            if (errno == EINTR || errno == ECONNABORTED) {
+                continue;
+            }
+            if (errno == EMFILE || errno == ENFILE) {
+                /* The listening socket is level-triggered: it must not stay ready with pending connections */
+                if (refuse(l)) {
+                    continue;
+                }
+                listener_pause(l, now);
+            } else if (errno == ENOBUFS || errno == ENOMEM) {
+                listener_pause(l, now);
+            }
+            /* EAGAIN: no more pending connections */
+            return;
+        }
+
+        c = (conn_st*)malloc(sizeof(conn_st));
+        if (c == NULL) {
+            close(fd);
+            continue;
+        }
+        c->fd = fd;
+        c->last = now;
+        if (t->cb != NULL) {
+            c->device = t->cb((struct sockaddr*)&peer, peer_len, t->ctx);
+        } else {
+            c->device = __atomic_add_fetch(&t->last_device, 1, __ATOMIC_RELAXED);
+        }
+
+        memset(&ev, 0, sizeof(ev));
+        ev.events = EPOLLIN | EPOLLRDHUP | EPOLLET;
+        ev.data.ptr = c;
+        if (epoll_ctl(l->epoll, EPOLL_CTL_ADD, fd, &ev) != 0) {
+            close(fd);
+            free(c);
+            continue;
+        }
+        list_append(l, c);
+        __atomic_fetch_add(&l->stats.accepted, 1, __ATOMIC_RELAXED);
+    }
+}
+
+/**
+ * @brief Refuse a pending connection when the process is out of descriptors: the spare descriptor is freed to accept
+ * the connection, that is closed at once, and it is opened again
+ * @param l  Loop
+ * @return Positive value if a connection was refused, Otherwise Zero
+ */
+static uint8_t refuse (
+        tcpingest_loop_st* l
+)
+{
+    int fd;
+
+    if (l->spare < 0) {
+        l->spare = open("/dev/null", O_RDONLY | O_CLOEXEC);
+        if (l->spare < 0) {
+            return 0;
+        }
+    }
+    close(l->spare);
+    fd = accept4(l->server->listen, NULL, NULL, SOCK_CLOEXEC);
+    if (fd >= 0) {
+        close(fd);
+        __atomic_fetch_add(&l->stats.refused, 1, __ATOMIC_RELAXED);
+    }
+    l->spare = open("/dev/null", O_RDONLY | O_CLOEXEC);
+    return (fd >= 0) ? 1 : 0;
+}
+
+/**
+ * @brief Stop watching the listening socket for TCPINGEST_PAUSE_MS, or until a connection of the loop is closed
+ * @param l    Loop
+ * @param now  Current time in milliseconds
+ */
+static void listener_pause (
+        tcpingest_loop_st* l,
+        uint64_t now
+)
+{
+    /* The listening socket is in exclusive mode, that cannot be modified: it is removed and added again */
+    if (!l->paused && epoll_ctl(l->epoll, EPOLL_CTL_DEL, l->server->listen, NULL) == 0) {
+        l->paused = 1;
+    }
+    l->resume_at = now + TCPINGEST_PAUSE_MS;
+}
+
+/**
+ * @brief Watch the listening socket
+ * @param l  Loop
+ * @return Zero on success, Otherwise a negative value
+ */
+static int listener_resume (
+        tcpingest_loop_st* l
+)
+{
+    struct epoll_event ev;
+
+    memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN | EPOLLEXCLUSIVE;
+    ev.data.ptr = &l->server->listen;
+    if (epoll_ctl(l->epoll, EPOLL_CTL_ADD, l->server->listen, &ev) != 0) {
+        return -1;
+    }
+    l->paused = 0;
+    return 0;
+}
+
+/**
+ * @brief Read a ready connection until it is drained, and submit the data to the fleet engine
+ * @param l       Loop
+ * @param c       Connection
+ * @param events  epoll events of the connection
+ * @param now     Current time in milliseconds
+ */
+static void conn_read (
+        tcpingest_loop_st* l,
+        conn_st* c,
+        uint32_t events,
+        uint64_t now
+)
+{
+    for (;;) {
+        ssize_t n = read(c->fd, l->buf, TCPINGEST_READ_BYTES);
+
+        if (n > 0) {
+            fleet_submit(l->server->fleet, c->device, l->buf, (uint32_t)n);
+            __atomic_fetch_add(&l->stats.bytes, (uint64_t)n, __ATOMIC_RELAXED);
+
+            /* A short read drained the socket: new data raises a new edge. After a hang-up no edge comes, so the
+             * end of the stream is read now */
+            if (n < TCPINGEST_READ_BYTES && (events & (EPOLLRDHUP | EPOLLHUP | EPOLLERR)) == 0) {
+                break;
+            }
+        } else if (n < 0 && errno == EINTR) {
+            continue;
+        } else if (n < 0 && errno == EAGAIN) {
+            break;
+        } else {
+            /* End of stream or error. Nothing is sent to the peers, so a half-closed one is closed too */
+            conn_close(l, c);
+            return;
+        }
+    }
+
+    c->last = now;
+    list_unlink(l, c);
+    list_append(l, c);
+}
+
+/**
+ * @brief Close a connection and release it
+ * @param l  Loop
+ * @param c  Connection
+ */
+static void conn_close (
+        tcpingest_loop_st* l,
+        conn_st* c
+)
+{
+    list_unlink(l, c);
+    close(c->fd);
+    free(c);
+    __atomic_fetch_add(&l->stats.closed, 1, __ATOMIC_RELAXED);
+}
+
+/**
+ * @brief Append a connection as the newest of a loop
+ * @param l  Loop
+ * @param c  Connection, not in the list
+ */
+static void list_append (
+        tcpingest_loop_st* l,
+        conn_st* c
+)
+{
+    c->prev = l->newest;
+    c->next = NULL;
+    if (l->newest != NULL) {
+        l->newest->next = c;
+    } else {
+        l->oldest = c;
+    }
+    l->newest = c;
+}
+
+/**
+ * @brief Remove a connection from the list of a loop
+ * @param l  Loop
+ * @param c  Connection in the list
+ */
+static void list_unlink (
+        tcpingest_loop_st* l,
+        conn_st* c
+)
+{
+    if (c->prev != NULL) {
+        c->prev->next = c->next;
+    } else {
+        l->oldest = c->next;
+    }
+    if (c->next != NULL) {
+        c->next->prev = c->prev;
+    } else {
+        l->newest = c->prev;
+    }
+    c->prev = NULL;
+    c->next = NULL;
+}
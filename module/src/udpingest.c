@@ -0,0 +1,372 @@
+/**
+ * @file udpingest.c
+ *
+ * UDP ingestion listener
+ *
+ * @license
+ * All rights reserved. Read LICENSE.txt file for the license terms.
+ *
+ * Changelog:
+ *
+ * [18/10/2026]     [miguelgarcia]
+ * Initial version
+ *
+ * [18/10/2026]     [miguelgarcia]
+ * Descriptor zero is a valid descriptor
+ *
+ */
+
+/* -- Includes -- */
+#define _GNU_SOURCE
+#include <errno.h>
+#include <poll.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <netinet/in.h>
+#include <sys/eventfd.h>
+#include "parallel.h"
+#include "udpingest.h"
+
+/* -- Local types -- */
+
+/** Buffers and headers of a batch of datagrams */
+typedef struct udpingest_batch {
+
+    /** Headers of recvmmsg() */
+    struct mmsghdr msgs[UDPINGEST_BATCH];
+    /** Buffer of each datagram */
+    struct iovec iov[UDPINGEST_BATCH];
+    /** Source of each datagram */
+    struct sockaddr_in sources[UDPINGEST_BATCH];
+    /** Bytes of the datagrams */
+    char data[UDPINGEST_BATCH][UDPINGEST_DGRAM_BYTES];
+
+} batch_st;
+
+/* -- Local functions -- */
+static int worker_init(udpingest_st* u, udpingest_worker_st* w);
+static void worker_free(udpingest_worker_st* w);
+static void* worker_run(void* arg);
+static void receive_all(udpingest_worker_st* w);
+static uint32_t source_device(udpingest_worker_st* w, const struct sockaddr_in* source, socklen_t source_len);
+
+
+/**
+ * @brief Start a UDP ingestion listener on all the addresses
+ * @param [out] u        Listener
+ * @param [in]  fleet    Fleet engine fed by the listener. It must outlive the listener
+ * @param [in]  port     Listening port, zero for a port given by the system (see udpingest_port())
+ * @param [in]  workers  Number of sockets and worker threads, zero to use parallel_default_threads().
+ *                       UDPINGEST_MAX_WORKERS at most
+ * @param [in]  cb       Callback that gives the device ID of a new source, or NULL for sequential IDs from one
+ * @param [in]  ctx      User context passed to the callback
+ * @return Zero on success, Otherwise a negative value
+ */
+int udpingest_init (
+        udpingest_st* u,
+        fleet_st* fleet,
+        uint16_t port,
+        uint32_t workers,
+        udpingest_source_cb cb,
+        void* ctx
+)
+{
+    memset(u, 0, sizeof(udpingest_st));
+    for (uint32_t i = 0; i < UDPINGEST_MAX_WORKERS; i++) {
+        u->workers[i].fd = -1;
+        u->workers[i].wake = -1;
+    }
+    u->fleet = fleet;
+    u->port = port;
+    u->cb = cb;
+    u->ctx = ctx;
+
+    if (workers == 0) {
+        workers = parallel_default_threads();
+    }
+    if (workers > UDPINGEST_MAX_WORKERS) {
+        workers = UDPINGEST_MAX_WORKERS;
+    }
+
+    /* The first socket gets the port if it is zero, the next ones join it */
+    for (uint32_t i = 0; i < workers; i++) {
+        if (worker_init(u, &u->workers[i]) != 0) {
+            udpingest_free(u);
+            return -1;
+        }
+        u->nworkers++;
+    }
+    return 0;
+}
+
+/**
+ * @brief Stop the listener and close its sockets. The datagrams already received are submitted to the fleet engine
+ * @param [in] u  Listener
+ */
+void udpingest_free (
+        udpingest_st* u
+)
+{
+    for (uint32_t i = 0; i < u->nworkers; i++) {
+        udpingest_worker_st* w = &u->workers[i];
+        uint64_t one = 1;
+
+        if (write(w->wake, &one, sizeof(one)) == sizeof(one)) {
+            pthread_join(w->thread, NULL);
+        }
+        worker_free(w);
+    }
+    memset(u, 0, sizeof(udpingest_st));
+}
+
+/**
+ * @brief Return the listening port of the listener
+ * @param [in] u  Listener
+ * @return Port
+ */
+uint16_t udpingest_port (
+        const udpingest_st* u
+)
+{
+    return u->port;
+}
+
+/**
+ * @brief Get the counters of the listener. It can be called from any thread
+ * @param [in]  u      Listener
+ * @param [out] stats  Counters
+ */
+void udpingest_get_stats (
+        udpingest_st* u,
+        udpingest_stats_st* stats
+)
+{
+    memset(stats, 0, sizeof(udpingest_stats_st));
+    for (uint32_t i = 0; i < u->nworkers; i++) {
+        const udpingest_stats_st* s = &u->workers[i].stats;
+
+        stats->datagrams += __atomic_load_n(&s->datagrams, __ATOMIC_RELAXED);
+        stats->batches += __atomic_load_n(&s->batches, __ATOMIC_RELAXED);
+        stats->truncated += __atomic_load_n(&s->truncated, __ATOMIC_RELAXED);
+        stats->bytes += __atomic_load_n(&s->bytes, __ATOMIC_RELAXED);
+        stats->sources += __atomic_load_n(&s->sources, __ATOMIC_RELAXED);
+    }
+}
+
+/**
+ * @brief Open the socket of a worker and start its thread
+ * @param u  Listener. Its port is set by the first socket if it is zero
+ * @param w  Worker, zeroed, with its descriptors at -1
+ * @return Zero on success, Otherwise a negative value. The worker is released on error
+ */
+static int worker_init (
+        udpingest_st* u,
+        udpingest_worker_st* w
+)
+{
+    struct sockaddr_in addr;
+    socklen_t addr_len = sizeof(addr);
+    int on = 1;
+    int rcvbuf = UDPINGEST_RCVBUF;
+
+    w->listener = u;
+    w->fd = socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    w->wake = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    w->batch = (batch_st*)malloc(sizeof(batch_st));
+    if (w->fd < 0 || w->wake < 0 || w->batch == NULL || registry_init(&w->sources, 0) != 0) {
+        worker_free(w);
+        return -1;
+    }
+
+    for (uint32_t i = 0; i < UDPINGEST_BATCH; i++) {
+        w->batch->iov[i].iov_base = w->batch->data[i];
+        w->batch->iov[i].iov_len = UDPINGEST_DGRAM_BYTES;
+        memset(&w->batch->msgs[i], 0, sizeof(struct mmsghdr));
+        w->batch->msgs[i].msg_hdr.msg_iov = &w->batch->iov[i];
+        w->batch->msgs[i].msg_hdr.msg_iovlen = 1;
+        w->batch->msgs[i].msg_hdr.msg_name = &w->batch->sources[i];
+    }
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    addr.sin_port = htons(u->port);
+
+    /* A smaller receive buffer than requested is not an error */
+    setsockopt(w->fd, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof(rcvbuf));
+    if (setsockopt(w->fd, SOL_SOCKET, SO_REUSEPORT, &on, sizeof(on)) != 0 ||
+        bind(w->fd, (struct sockaddr*)&addr, sizeof(addr)) != 0 ||
+        getsockname(w->fd, (struct sockaddr*)&addr, &addr_len) != 0) {
+        worker_free(w);
+        return -1;
+    }
+    u->port = ntohs(addr.sin_port);
+
+    if (pthread_create(&w->thread, NULL, worker_run, w) != 0) {
+        worker_free(w);
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * @brief Release a worker whose thread is stopped
+ * @param w  Worker
+ */
+static void worker_free (
+        udpingest_worker_st* w
+)
+{
+    if (w->fd >= 0) {
+        close(w->fd);
+    }
+    if (w->wake >= 0) {
+        close(w->wake);
+    }
+    free(w->batch);
+    free(w->devices);
+    registry_free(&w->sources);
+    w->fd = -1;
+    w->wake = -1;
+    w->batch = NULL;
+    w->devices = NULL;
+}
+
+/**
+ * @brief Worker loop. Receives the datagrams of its socket until the wake event is signaled
+ * @param arg  Worker
+ * @return NULL
+ */
+static void* worker_run (
+        void* arg
+)
+{
+    udpingest_worker_st* w = (udpingest_worker_st*)arg;
+    struct pollfd fds[2];
+
+    fds[0].fd = w->fd;
+    fds[0].events = POLLIN;
+    fds[1].fd = w->wake;
+    fds[1].events = POLLIN;
+
+    for (;;) {
+        if (poll(fds, 2, -1) < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            break;
+        }
+        if (fds[1].revents != 0) {
+            break;
+        }
+        if (fds[0].revents != 0) {
+            receive_all(w);
+        }
+    }
+
+    /* The datagrams received before the stop */
+    receive_all(w);
+    return NULL;
+}
+
+/**
+ * @brief Receive the datagrams queued in the socket of a worker, in batches, and submit them to the fleet engine
+ * @param w  Worker
+ */
+static void receive_all (
+        udpingest_worker_st* w
+)
+{
+    batch_st* b = w->batch;
+    fleet_st* fleet = w->listener->fleet;
+
+    for (;;) {
+        uint64_t bytes = 0;
+        uint32_t truncated = 0;
+        int n;
+
+        /* recvmmsg() overwrites the length of each source address */
+        for (uint32_t i = 0; i < UDPINGEST_BATCH; i++) {
+            b->msgs[i].msg_hdr.msg_namelen = sizeof(struct sockaddr_in);
+        }
+
+        n = recvmmsg(w->fd, b->msgs, UDPINGEST_BATCH, MSG_DONTWAIT, NULL);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            return;
+        }
+
+        for (int i = 0; i < n; i++) {
+            uint32_t len = b->msgs[i].msg_len;
+            uint32_t device;
+
+            if ((b->msgs[i].msg_hdr.msg_flags & MSG_TRUNC) != 0) {
+                truncated++;
+                continue;
+            }
+            device = source_device(w, &b->sources[i], b->msgs[i].msg_hdr.msg_namelen);
+            if (device != REGISTRY_NONE) {
+                fleet_submit(fleet, device, b->data[i], len);
+            }
+            bytes += len;
+        }
+
+        __atomic_fetch_add(&w->stats.datagrams, (uint64_t)n, __ATOMIC_RELAXED);
+        __atomic_fetch_add(&w->stats.batches, 1, __ATOMIC_RELAXED);
+        __atomic_fetch_add(&w->stats.truncated, truncated, __ATOMIC_RELAXED);
+        __atomic_fetch_add(&w->stats.bytes, bytes, __ATOMIC_RELAXED);
+
+        /* A partial batch drained the socket */
+        if (n < UDPINGEST_BATCH) {
+            return;
+        }
+    }
+}
+
+/**
+ * @brief Device ID of the source of a datagram. A new source is added to the registry of the worker
+ * @param w           Worker
+ * @param source      Source address
+ * @param source_len  Length of the source address
+ * @return Device ID, or REGISTRY_NONE if there is no memory for a new source
+ */
+static uint32_t source_device (
+        udpingest_worker_st* w,
+        const struct sockaddr_in* source,
+        socklen_t source_len
+)
+{
+    udpingest_st* u = w->listener;
+    uint64_t key = ((uint64_t)source->sin_addr.s_addr << 16) | source->sin_port;
+    uint32_t index = registry_find(&w->sources, key);
+
+    if (index != REGISTRY_NONE) {
+        return w->devices[index];
+    }
+
+    /* The sources are never removed, so the registry gives the indexes in order */
+    if (w->sources.count == w->capacity) {
+        uint32_t capacity = (w->capacity == 0) ? 64 : w->capacity * 2;
+        uint32_t* devices = (uint32_t*)realloc(w->devices, capacity * sizeof(uint32_t));
+        if (devices == NULL) {
+            return REGISTRY_NONE;
+        }
+        w->devices = devices;
+        w->capacity = capacity;
+    }
+    index = registry_insert(&w->sources, key);
+    if (index == REGISTRY_NONE) {
+        return REGISTRY_NONE;
+    }
+
+    if (u->cb != NULL) {
+        w->devices[index] = u->cb((const struct sockaddr*)source, source_len, u->ctx);
+    } else {
+        w->devices[index] = __atomic_add_fetch(&u->last_device, 1, __ATOMIC_RELAXED);
+    }
+    __atomic_fetch_add(&w->stats.sources, 1, __ATOMIC_RELAXED);
+    return w->devices[index];
+}
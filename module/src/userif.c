@@ -13,6 +13,9 @@
  * [01/03/2021]     [miguelgarcia]
  * Initial version
  *
+ * [18/10/2026]     [miguelgarcia]
+ * Per-fence state
+ *
  */
 
 
@@ -27,6 +30,11 @@ static uint8_t on_range_ = 0;
 /** GPS-Fix Active indicator */
 static uint8_t gps_fix_ = 0;
 
+/** Reached fences */
+static uint32_t fences_[USERIF_MAX_FENCES];
+/** Number of reached fences */
+static uint32_t fences_count_ = 0;
+
 
 /**
  * @brief Update the USER INTERFACE with the status of the Target. When the target is reached, the argument must be
@@ -55,6 +63,59 @@ uint8_t userif_get_target_reached (
     return on_range_;
 }
 
+/**
+ * @brief Update the USER INTERFACE with the fences that contain the device. Only the first USERIF_MAX_FENCES are kept.
+ *
+ * @param [in] ids  IDs of the reached fences
+ * @param [in] n    Number of reached fences
+ */
+void userif_set_fences_reached (
+        const uint32_t* ids,
+        uint32_t n
+)
+{
+    fences_count_ = (n > USERIF_MAX_FENCES) ? USERIF_MAX_FENCES : n;
+    for (uint32_t i = 0; i < fences_count_; i++) {
+        fences_[i] = ids[i];
+    }
+}
+
+
+/**
+ * @brief Return the fences that contain the device
+ * @param [out] ids  IDs of the reached fences
+ * @param [in]  max  Size of the IDs buffer
+ * @return Number of reached fences. If it is larger than max, only max IDs are written
+ */
+uint32_t userif_get_fences_reached (
+        uint32_t* ids,
+        uint32_t max
+)
+{
+    for (uint32_t i = 0; i < fences_count_ && i < max; i++) {
+        ids[i] = fences_[i];
+    }
+    return fences_count_;
+}
+
+
+/**
+ * @brief Return the state of a fence
+ * @param [in] id  Fence ID
+ * @return Positive value if the fence contains the device, Otherwise Zero.
+ */
+uint8_t userif_is_fence_reached (
+        uint32_t id
+)
+{
+    for (uint32_t i = 0; i < fences_count_; i++) {
+        if (fences_[i] == id) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
 /**
  * @brief Update the USER INTERFACE with the status of the GPS. If the position is not valid (FIX==0), or it is
  * valid (FIX>0)
@@ -0,0 +1,191 @@
+/**
+ * @file fencefile_build.c
+ *
+ * Geofence index file builder
+ *
+ * Reads a CSV list of fences and writes a geofence index file (see fencefile.h), with the ECEF data of every fence and
+ * the R-tree already built, so the ingestion nodes map it instead of building the indexes at startup. The file is
+ * opened and verified again after it is written. Empty lines and lines starting with '#' are ignored. Each line is
+ * one fence:
+ *
+ *   circle,<id>,<latitude>,<longitude>,<ellipsoidal height>,<radius>
+ *   polygon,<id>,<latitude>,<longitude>,<latitude>,<longitude>,...
+ *
+ * Usage: fencefile_build <fences.csv> <index file>
+ *
+ * @license
+ * All rights reserved. Read LICENSE.txt file for the license terms.
+ *
+ * Changelog:
+ *
+ * [18/10/2026]     [miguelgarcia]
+ * Initial version
+ *
+ */
+
+/* -- Includes -- */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "fencefile.h"
+#include "geofence.h"
+
+/* -- Definitions -- */
+
+/** Max length of a line of the CSV file */
+#define MAX_LINE        (1 << 20)
+
+/* -- Local functions -- */
+static int read_fences(const char* path, geofence_set_st* s);
+static int parse_line(char* line, geofence_set_st* s, position_st* ring, uint32_t max);
+
+
+int main (
+        int argc,
+        char** argv
+)
+{
+    geofence_set_st s;
+    fencefile_st f;
+
+    if (argc != 3) {
+        fprintf(stderr, "Usage: %s <fences.csv> <index file>\n", argv[0]);
+        return 1;
+    }
+
+    if (geofence_set_init(&s, 0) != 0 || read_fences(argv[1], &s) != 0) {
+        geofence_set_free(&s);
+        return 1;
+    }
+
+    if (fencefile_write(&s, argv[2]) != 0) {
+        fprintf(stderr, "fencefile_build: cannot write %s\n", argv[2]);
+        geofence_set_free(&s);
+        return 1;
+    }
+    geofence_set_free(&s);
+
+    if (fencefile_open(&f, argv[2], FENCEFILE_VERIFY) != 0) {
+        fprintf(stderr, "fencefile_build: %s does not verify\n", argv[2]);
+        return 1;
+    }
+    printf("%s: %u circles, %u polygons, %u nodes, %zu bytes\n", argv[2], f.header->ncircles, f.header->npolygons,
+           f.header->nnodes, f.size);
+    fencefile_close(&f);
+    return 0;
+}
+
+/**
+ * @brief Read the CSV list of fences
+ * @param path  CSV file path
+ * @param s     Set of fences
+ * @return Zero on success, Otherwise a negative value
+ */
+static int read_fences (
+        const char* path,
+        geofence_set_st* s
+)
+{
+    FILE* file = fopen(path, "r");
+    char* line = (char*)malloc(MAX_LINE);
+    /* A line has at most one vertex per 4 characters */
+    uint32_t max = MAX_LINE / 4;
+    position_st* ring = (position_st*)malloc(max * sizeof(position_st));
+    uint32_t line_num = 0;
+    int ret = 0;
+
+    if (file == NULL || line == NULL || ring == NULL) {
+        fprintf(stderr, "fencefile_build: cannot read %s\n", path);
+        ret = -1;
+    }
+
+    while (ret == 0 && fgets(line, MAX_LINE, file) != NULL) {
+        line_num++;
+        line[strcspn(line, "\r\n")] = '\0';
+        if (line[0] == '\0' || line[0] == '#' || line[strspn(line, " \t")] == '\0') {
+            continue;
+        }
+        if (parse_line(line, s, ring, max) != 0) {
+            fprintf(stderr, "fencefile_build: %s:%u: invalid fence\n", path, line_num);
+            ret = -1;
+        }
+    }
+
+    if (file != NULL) {
+        fclose(file);
+    }
+    free(line);
+    free(ring);
+    return ret;
+}
+
+/**
+ * @brief Add the fence of a line to the set
+ * @param line  Line, without the end of line. It is modified
+ * @param s     Set of fences
+ * @param ring  Buffer of vertices
+ * @param max   Size of the buffer of vertices
+ * @return Zero on success, Otherwise a negative value
+ */
+static int parse_line (
+        char* line,
+        geofence_set_st* s,
+        position_st* ring,
+        uint32_t max
+)
+{
+    char* kind = strtok(line, ",");
+    char* field = strtok(NULL, ",");
+    uint32_t id;
+    uint32_t n = 0;
+    char* end;
+
+    if (kind == NULL || field == NULL) {
+        return -1;
+    }
+    id = (uint32_t)strtoul(field, &end, 10);
+    if (end == field) {
+        return -1;
+    }
+
+    if (strcmp(kind, "circle") == 0) {
+        double c[4];
+        position_st center;
+
+        for (int i = 0; i < 4; i++) {
+            field = strtok(NULL, ",");
+            if (field == NULL || (c[i] = strtod(field, &end), end == field)) {
+                return -1;
+            }
+        }
+        center.latitude = (float)c[0];
+        center.longitude = (float)c[1];
+        center.altitude = (float)c[2];
+        center.is_valid = pos_3d;
+        return geofence_add(s, id, &center, (float)c[3]);
+    }
+
+    if (strcmp(kind, "polygon") != 0) {
+        return -1;
+    }
+    /* Latitude and longitude of each vertex */
+    while ((field = strtok(NULL, ",")) != NULL) {
+        double v = strtod(field, &end);
+
+        if (end == field || n / 2 >= max) {
+            return -1;
+        }
+        if (n % 2 == 0) {
+            ring[n / 2].latitude = (float)v;
+        } else {
+            ring[n / 2].longitude = (float)v;
+            ring[n / 2].altitude = 0.0f;
+            ring[n / 2].is_valid = pos_2d;
+        }
+        n++;
+    }
+    if (n % 2 != 0) {
+        return -1;
+    }
+    return geofence_add_polygon(s, id, ring, n / 2);
+}
@@ -0,0 +1,198 @@
+/**
+ * @file target_table_gen.cpp
+ *
+ * Target table generator
+ *
+ * Reads a CSV list of targets (latitude, longitude, MSL altitude, range and geoidal separation at the target) and
+ * writes a C source file with the constant target table used by target.c. The ECEF origin, the ECEF to ENU rotation
+ * matrix and the squared range of every target are computed here in double precision, so the device does not do any
+ * target-side math at runtime.
+ *
+ * Usage: target_table_gen <targets.csv> <target_table.c>
+ *
+ * @license
+ * All rights reserved. Read LICENSE.txt file for the license terms.
+ *
+ * Changelog:
+ *
+ * [18/10/2026]     [miguelgarcia]
+ * Initial version
+ *
+ * [18/10/2026]     [miguelgarcia]
+ * The geoidal separation of the targets is mandatory
+ *
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "geodesy.hpp"
+
+using namespace ::std;
+
+/** Target read from the CSV file */
+struct TargetRow {
+    double latitude;
+    double longitude;
+    double altitude;
+    double range;
+    double separation;
+};
+
+/**
+ * Read CSV file with the list of targets. Empty lines and lines starting with '#' are ignored. The geoidal separation
+ * is mandatory: the devices are evaluated at their ellipsoidal height, so a target without it would be placed tens of
+ * meters off along the vertical.
+ * @param [in]  path     CSV file path
+ * @param [out] targets  The list of targets
+ * @return  True if the file was read without errors
+ */
+static bool ReadTargets (
+        const string& path,
+        vector<TargetRow>& targets
+)
+{
+    ifstream file(path);
+    string line;
+    int line_num = 0;
+
+    if (!file) {
+        fprintf(stderr, "target_table_gen: cannot open %s\n", path.c_str());
+        return false;
+    }
+
+    while (getline(file, line)) {
+        line_num++;
+        if (line.empty() || line[0] == '#' || line.find_first_not_of(" \t\r") == string::npos) {
+            continue;
+        }
+
+        istringstream s(line);
+        string field;
+        double v[5] = {0.0, 0.0, 0.0, 0.0, 0.0};
+        int n = 0;
+
+        while (n < 5 && getline(s, field, ',')) {
+            char* end = NULL;
+            v[n] = strtod(field.c_str(), &end);
+            if (end == field.c_str()) {
+                break;
+            }
+            n++;
+        }
+
+        if (n == 4) {
+            fprintf(stderr, "target_table_gen: %s:%d: missing geoidal separation '%s'\n", path.c_str(), line_num,
+                    line.c_str());
+            return false;
+        }
+        if (n < 5 || v[0] < -90.0 || v[0] > 90.0 || v[1] < -180.0 || v[1] > 180.0 || v[3] < 0.0) {
+            fprintf(stderr, "target_table_gen: %s:%d: invalid target '%s'\n", path.c_str(), line_num, line.c_str());
+            return false;
+        }
+
+        targets.push_back({v[0], v[1], v[2], v[3], v[4]});
+    }
+
+    if (targets.empty()) {
+        fprintf(stderr, "target_table_gen: %s has no targets\n", path.c_str());
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * Format a value as a C float literal
+ * @param [in] v  Value
+ * @return  The float literal
+ */
+static string FloatLiteral (
+        double v
+)
+{
+    char str[32];
+    snprintf(str, sizeof(str), "%.9g", v);
+
+    string res(str);
+    if (res.find_first_of(".e") == string::npos) {
+        res += ".0";
+    }
+    return res + "f";
+}
+
+/**
+ * Write the C source file with the target table
+ * @param [in] path     Output file path
+ * @param [in] targets  The list of targets
+ * @return  True if the file was written without errors
+ */
+static bool WriteTable (
+        const string& path,
+        const vector<TargetRow>& targets
+)
+{
+    FILE* f = fopen(path.c_str(), "w");
+    if (f == NULL) {
+        fprintf(stderr, "target_table_gen: cannot create %s\n", path.c_str());
+        return false;
+    }
+
+    fprintf(f, "/* Generated by target_table_gen. Do not edit. */\n\n");
+    fprintf(f, "#include <stdint.h>\n#include \"target.h\"\n\n");
+    fprintf(f, "const uint32_t target_table_count_ = %uu;\n\n", (unsigned)targets.size());
+    fprintf(f, "const target_entry_st target_table_[%u] = {\n", (unsigned)targets.size());
+
+    for (const auto& t : targets) {
+        /* The local frame is centered at the ellipsoidal height of the target */
+        auto frame = geodesy::enu_frame<double>::from_geodetic(t.latitude, t.longitude, t.altitude + t.separation);
+
+        fprintf(f, "    {\n");
+        fprintf(f, "        .llh = {.latitude = %s, .longitude = %s, .altitude = %s, .is_valid = pos_3d},\n",
+                FloatLiteral(t.latitude).c_str(), FloatLiteral(t.longitude).c_str(),
+                FloatLiteral(t.altitude).c_str());
+        fprintf(f, "        .ecef = {%s, %s, %s},\n",
+                FloatLiteral(frame.x0).c_str(), FloatLiteral(frame.y0).c_str(), FloatLiteral(frame.z0).c_str());
+        fprintf(f, "        .rotation = {{%s, %s, %s},\n",
+                FloatLiteral(-frame.sin_lon).c_str(), FloatLiteral(frame.cos_lon).c_str(), FloatLiteral(0.0).c_str());
+        fprintf(f, "                     {%s, %s, %s},\n",
+                FloatLiteral(-frame.cos_lon * frame.sin_lat).c_str(),
+                FloatLiteral(-frame.sin_lat * frame.sin_lon).c_str(),
+                FloatLiteral(frame.cos_lat).c_str());
+        fprintf(f, "                     {%s, %s, %s}},\n",
+                FloatLiteral(frame.cos_lat * frame.cos_lon).c_str(),
+                FloatLiteral(frame.cos_lat * frame.sin_lon).c_str(),
+                FloatLiteral(frame.sin_lat).c_str());
+        fprintf(f, "        .range = %s,\n", FloatLiteral(t.range).c_str());
+        fprintf(f, "        .range_sq = %s,\n", FloatLiteral(t.range * t.range).c_str());
+        fprintf(f, "        .separation = %s,\n", FloatLiteral(t.separation).c_str());
+        fprintf(f, "    },\n");
+    }
+
+    fprintf(f, "};\n");
+
+    bool ok = (ferror(f) == 0);
+    if (fclose(f) != 0) {
+        ok = false;
+    }
+    return ok;
+}
+
+int main(int argc, char **argv) {
+
+    vector<TargetRow> targets;
+
+    if (argc != 3) {
+        fprintf(stderr, "Usage: %s <targets.csv> <target_table.c>\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    if (!ReadTargets(argv[1], targets) || !WriteTable(argv[2], targets)) {
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,319 @@
+/**
+ * @file geodesy_harness.cpp
+ *
+ * Accuracy versus speed characterization of the geodesy kernels
+ *
+ * Sweeps a global grid of latitudes, longitudes, altitudes and separation distances. Every kernel is compared with
+ * a long double reference (geodesy.hpp) and timed. One CSV row is written per kernel and group of the sweep:
+ *
+ *     kernel,lat_min,lat_max,altitude_m,separation_m,points,max_error_m,rms_error_m,ns_per_point
+ *
+ * Position kernels report the 3D position error in meters and distance kernels the absolute distance error in
+ * meters. The separation is zero for the kernels that work on a single point.
+ *
+ * Usage: gpslocator_geodesy_harness [--quick] [--output <file.csv>]
+ *
+ * @license
+ * All rights reserved. Read LICENSE.txt file for the license terms.
+ *
+ * Changelog:
+ *
+ * [18/10/2026]     [miguelgarcia]
+ * Initial version
+ *
+ */
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+#include "geodesy.hpp"
+#include "position.h"
+
+using namespace ::std;
+
+typedef long double ref_t;
+
+/** Point of the sweep, and a second point at the separation distance for the pairwise kernels */
+struct Sample {
+    /** First point */
+    ref_t lat0, lon0, h0;
+    /** Second point */
+    ref_t lat1, lon1, h1;
+    /** Reference ECEF of the first point */
+    ref_t x0, y0, z0;
+};
+
+/** Kernel under test */
+struct Kernel {
+    /** Kernel name */
+    const char* name;
+    /** True if the kernel works on pairs of points */
+    bool pairwise;
+    /** Run the kernel. Outputs up to 3 values */
+    void (*run)(const Sample& s, double out[3]);
+    /** Error of the outputs in meters */
+    ref_t (*error)(const Sample& s, const double out[3]);
+};
+
+/** Sweep configuration */
+struct Sweep {
+    double lat_step;
+    double lon_step;
+    double band;
+    vector<double> altitudes;
+    vector<double> separations;
+};
+
+/* -- Reference values -- */
+
+static ref_t RefDistance (const Sample& s)
+{
+    ref_t e, n, u;
+    geodesy::geodetic_to_enu<ref_t>(s.lat1, s.lon1, s.h1, s.lat0, s.lon0, s.h0, e, n, u);
+    return sqrtl(e * e + n * n + u * u);
+}
+
+static ref_t EcefError (const Sample& s, const double out[3])
+{
+    ref_t dx = out[0] - s.x0;
+    ref_t dy = out[1] - s.y0;
+    ref_t dz = out[2] - s.z0;
+    return sqrtl(dx * dx + dy * dy + dz * dz);
+}
+
+static ref_t GeodeticError (const Sample& s, const double out[3])
+{
+    ref_t x, y, z;
+    geodesy::geodetic_to_ecef<ref_t>(out[0], out[1], out[2], x, y, z);
+    ref_t dx = x - s.x0;
+    ref_t dy = y - s.y0;
+    ref_t dz = z - s.z0;
+    return sqrtl(dx * dx + dy * dy + dz * dz);
+}
+
+static ref_t EnuError (const Sample& s, const double out[3])
+{
+    ref_t e, n, u;
+    geodesy::geodetic_to_enu<ref_t>(s.lat1, s.lon1, s.h1, s.lat0, s.lon0, s.h0, e, n, u);
+    ref_t de = out[0] - e;
+    ref_t dn = out[1] - n;
+    ref_t du = out[2] - u;
+    return sqrtl(de * de + dn * dn + du * du);
+}
+
+static ref_t DistanceError (const Sample& s, const double out[3])
+{
+    return fabsl(out[0] - RefDistance(s));
+}
+
+/* -- Kernels -- */
+
+static void CGeodeticToEcef (const Sample& s, double out[3])
+{
+    float x, y, z;
+    position_geodetic_to_ecef((float)s.lat0, (float)s.lon0, (float)s.h0, &x, &y, &z);
+    out[0] = x; out[1] = y; out[2] = z;
+}
+
+static void TplGeodeticToEcefFloat (const Sample& s, double out[3])
+{
+    float x, y, z;
+    geodesy::geodetic_to_ecef<float>((float)s.lat0, (float)s.lon0, (float)s.h0, x, y, z);
+    out[0] = x; out[1] = y; out[2] = z;
+}
+
+static void TplGeodeticToEcefDouble (const Sample& s, double out[3])
+{
+    geodesy::geodetic_to_ecef<double>((double)s.lat0, (double)s.lon0, (double)s.h0, out[0], out[1], out[2]);
+}
+
+static void CEcefToGeodetic (const Sample& s, double out[3])
+{
+    float lat, lon, h;
+    position_ecef_to_geodetic((float)s.x0, (float)s.y0, (float)s.z0, &lat, &lon, &h);
+    out[0] = lat; out[1] = lon; out[2] = h;
+}
+
+static void TplEcefToGeodeticDouble (const Sample& s, double out[3])
+{
+    geodesy::ecef_to_geodetic<double>((double)s.x0, (double)s.y0, (double)s.z0, out[0], out[1], out[2]);
+}
+
+static void CGeodeticToEnu (const Sample& s, double out[3])
+{
+    float e, n, u;
+    position_geodetic_to_enu((float)s.lat1, (float)s.lon1, (float)s.h1, (float)s.lat0, (float)s.lon0, (float)s.h0,
+                             &e, &n, &u);
+    out[0] = e; out[1] = n; out[2] = u;
+}
+
+static void TplGeodeticToEnuDouble (const Sample& s, double out[3])
+{
+    geodesy::geodetic_to_enu<double>((double)s.lat1, (double)s.lon1, (double)s.h1,
+                                     (double)s.lat0, (double)s.lon0, (double)s.h0, out[0], out[1], out[2]);
+}
+
+static void CEnuDistance (const Sample& s, double out[3])
+{
+    float e, n, u;
+    position_geodetic_to_enu((float)s.lat1, (float)s.lon1, (float)s.h1, (float)s.lat0, (float)s.lon0, (float)s.h0,
+                             &e, &n, &u);
+    out[0] = position_xyz_distance(0.0f, 0.0f, 0.0f, e, n, u);
+}
+
+static void CEcefChordDistance (const Sample& s, double out[3])
+{
+    float a[3], b[3];
+    position_geodetic_to_ecef((float)s.lat0, (float)s.lon0, (float)s.h0, &a[0], &a[1], &a[2]);
+    position_geodetic_to_ecef((float)s.lat1, (float)s.lon1, (float)s.h1, &b[0], &b[1], &b[2]);
+    out[0] = position_xyz_distance(a[0], a[1], a[2], b[0], b[1], b[2]);
+}
+
+static const Kernel kernels[] = {
+    {"c_geodetic_to_ecef", false, CGeodeticToEcef, EcefError},
+    {"tpl_geodetic_to_ecef_float", false, TplGeodeticToEcefFloat, EcefError},
+    {"tpl_geodetic_to_ecef_double", false, TplGeodeticToEcefDouble, EcefError},
+    {"c_ecef_to_geodetic", false, CEcefToGeodetic, GeodeticError},
+    {"tpl_ecef_to_geodetic_double", false, TplEcefToGeodeticDouble, GeodeticError},
+    {"c_geodetic_to_enu", true, CGeodeticToEnu, EnuError},
+    {"tpl_geodetic_to_enu_double", true, TplGeodeticToEnuDouble, EnuError},
+    {"c_enu_distance", true, CEnuDistance, DistanceError},
+    {"c_ecef_chord_distance", true, CEcefChordDistance, DistanceError},
+};
+
+/**
+ * Build the samples of a group of the sweep
+ * @param sweep  Sweep configuration
+ * @param lat_min  Min latitude of the band
+ * @param lat_max  Max latitude of the band (exclusive, except for the last band)
+ * @param h    Altitude
+ * @param sep  Separation distance
+ * @return  The samples
+ */
+static vector<Sample> BuildSamples (
+        const Sweep& sweep,
+        double lat_min,
+        double lat_max,
+        double h,
+        double sep
+)
+{
+    vector<Sample> samples;
+    uint32_t k = 0;
+
+    for (double lat = lat_min; lat < lat_max || (lat_max >= 90.0 && lat <= 90.0); lat += sweep.lat_step) {
+        for (double lon = -180.0; lon < 180.0; lon += sweep.lon_step) {
+            Sample s;
+            s.lat0 = lat;
+            s.lon0 = lon;
+            s.h0 = h;
+            geodesy::geodetic_to_ecef<ref_t>(s.lat0, s.lon0, s.h0, s.x0, s.y0, s.z0);
+
+            /* Second point at the separation distance, with a bearing that changes along the sweep */
+            ref_t bearing = (ref_t)(k++ % 16) * 3.14159265358979323846L / 8.0L;
+            geodesy::enu_to_geodetic<ref_t>(sep * sinl(bearing), sep * cosl(bearing), 0.0L, s.lat0, s.lon0, s.h0,
+                                            s.lat1, s.lon1, s.h1);
+            samples.push_back(s);
+        }
+    }
+
+    return samples;
+}
+
+/**
+ * Run a kernel over a group of samples and write its CSV row
+ */
+static void RunKernel (
+        FILE* out,
+        const Kernel& kernel,
+        const vector<Sample>& samples,
+        double lat_min,
+        double lat_max,
+        double h,
+        double sep
+)
+{
+    vector<double> res(samples.size() * 3);
+    const uint32_t min_evals = 200000;
+    uint32_t reps = (uint32_t)(min_evals / samples.size()) + 1;
+
+    /* Timing */
+    auto t0 = chrono::steady_clock::now();
+    for (uint32_t r = 0; r < reps; r++) {
+        for (size_t i = 0; i < samples.size(); i++) {
+            kernel.run(samples[i], &res[i * 3]);
+        }
+    }
+    auto t1 = chrono::steady_clock::now();
+    double ns = chrono::duration<double, nano>(t1 - t0).count() / ((double)reps * samples.size());
+
+    /* Accuracy */
+    ref_t max_err = 0.0L;
+    ref_t sum_sq = 0.0L;
+    for (size_t i = 0; i < samples.size(); i++) {
+        ref_t err = kernel.error(samples[i], &res[i * 3]);
+        if (err > max_err) {
+            max_err = err;
+        }
+        sum_sq += err * err;
+    }
+
+    fprintf(out, "%s,%.1f,%.1f,%.1f,%.1f,%u,%.6Lg,%.6Lg,%.2f\n", kernel.name, lat_min, lat_max, h, sep,
+            (unsigned)samples.size(), max_err, sqrtl(sum_sq / samples.size()), ns);
+}
+
+int main(int argc, char **argv) {
+
+    Sweep sweep = {1.0, 5.0, 15.0,
+                   {0.0, 1000.0, 10000.0, 400000.0, 20200000.0},
+                   {1.0, 100.0, 1000.0, 10000.0, 100000.0}};
+    const char* path = NULL;
+    FILE* out = stdout;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--quick") == 0) {
+            sweep.lat_step = 7.5;
+            sweep.lon_step = 60.0;
+            sweep.band = 30.0;
+            sweep.altitudes = {0.0, 20200000.0};
+            sweep.separations = {100.0, 100000.0};
+        } else if (strcmp(argv[i], "--output") == 0 && i + 1 < argc) {
+            path = argv[++i];
+        } else {
+            fprintf(stderr, "Usage: %s [--quick] [--output <file.csv>]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    if (path != NULL) {
+        out = fopen(path, "w");
+        if (out == NULL) {
+            fprintf(stderr, "Cannot create %s\n", path);
+            return 1;
+        }
+    }
+
+    fprintf(out, "kernel,lat_min,lat_max,altitude_m,separation_m,points,max_error_m,rms_error_m,ns_per_point\n");
+
+    for (const auto& kernel : kernels) {
+        for (double lat_min = -90.0; lat_min < 90.0; lat_min += sweep.band) {
+            double lat_max = lat_min + sweep.band;
+            for (double h : sweep.altitudes) {
+                if (!kernel.pairwise) {
+                    RunKernel(out, kernel, BuildSamples(sweep, lat_min, lat_max, h, 0.0), lat_min, lat_max, h, 0.0);
+                    continue;
+                }
+                for (double sep : sweep.separations) {
+                    RunKernel(out, kernel, BuildSamples(sweep, lat_min, lat_max, h, sep), lat_min, lat_max, h, sep);
+                }
+            }
+        }
+    }
+
+    if (out != stdout) {
+        fclose(out);
+    }
+    return 0;
+}
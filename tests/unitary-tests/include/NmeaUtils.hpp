@@ -43,10 +43,11 @@ public:
     /**
      * Generate a NMEA sentence of type GGA with the information of the input.
      * The string contains the final '\r', necessary for parsing the message.
-     * @param gga  GGA parameters
+     * @param gga         GGA parameters
+     * @param separation  False to leave the geoidal separation field empty
      * @return  String with the GGA sentence
      */
-    static std::string GenNMEA_GGAsentence(GgaType gga);
+    static std::string GenNMEA_GGAsentence(GgaType gga, bool separation = true);
 
     /**
      * Get the square difference between expected and obtained values
@@ -12,6 +12,9 @@
 #include "position.h"
 #include "navigation.h"
 #include "userif.h"
+#include "occupancy.h"
+#include "target.h"
+#include "targetset.h"
 #include "app.h"
 
 using namespace ::std;
@@ -72,11 +75,14 @@ TEST(App, step_001)
 }
 
 
+/** Geoidal separation reported by the GPS module around the target, the one of the target table */
+static const float target_separation = 49.5f;
+
 GgaType BuildGGA(float lat, float lon, float alt, int fix, int nsat) {
 
     GgaType gga = {.hours=1, .minutes=2, .seconds=3, .milliseconds=4,
             .latitude=lat, .longitude=lon, .nsIndicator='N', .ewIndicator='E',
-            .fix=fix, .satellites=nsat, .hdop=1.0, .altitude=13.0, .geoidal=0.0};
+            .fix=fix, .satellites=nsat, .hdop=1.0, .altitude=13.0, .geoidal=target_separation};
 
     return gga;
 }
@@ -210,3 +216,241 @@ TEST(App, step_006)
     ASSERT_GT(userif_get_gps_status(),0);
     ASSERT_GT(userif_get_target_reached(),0);
 }
+
+
+/**
+ * APP Step. Custom set of fences with per-fence state
+ */
+TEST(App, step_007)
+{
+    geofence_set_st fences;
+    position_st depot = {39.4731325f, -0.3677324f, 13.0f, pos_3d};
+    position_st region = {39.6f, -0.4f, 13.0f, pos_3d};
+    position_st far = {40.4168f, -3.7038f, 650.0f, pos_3d};
+
+    ASSERT_EQ(geofence_set_init(&fences, 0), 0);
+    ASSERT_EQ(geofence_add(&fences, 7, &depot, 100.0f), 0);
+    ASSERT_EQ(geofence_add(&fences, 9, &region, 50000.0f), 0);
+    ASSERT_EQ(geofence_add(&fences, 11, &far, 1000.0f), 0);
+
+    app_init();
+    app_set_geofences(&fences);
+
+    UpdateApp(p0);
+    ASSERT_GT(userif_get_target_reached(),0);
+    ASSERT_TRUE(userif_is_fence_reached(7));
+    ASSERT_TRUE(userif_is_fence_reached(9));
+    ASSERT_FALSE(userif_is_fence_reached(11));
+
+    UpdateApp(out_of_range_pos[0]);
+    ASSERT_GT(userif_get_target_reached(),0);
+    ASSERT_FALSE(userif_is_fence_reached(7));
+    ASSERT_TRUE(userif_is_fence_reached(9));
+
+    UpdateApp(no_fix_pos[0]);
+    ASSERT_EQ(userif_get_target_reached(),0);
+    ASSERT_FALSE(userif_is_fence_reached(9));
+
+    app_set_geofences(NULL);
+    geofence_set_free(&fences);
+
+    UpdateApp(p0);
+    ASSERT_GT(userif_get_target_reached(),0);
+    ASSERT_TRUE(userif_is_fence_reached(0));
+}
+
+
+/**
+ * APP Step. Lazy evaluation of the fences gives the same results
+ */
+TEST(App, step_008)
+{
+    app_init();
+    app_set_lazy_evaluation(1, 0.0f);
+
+    UpdateApp(p0);
+    ASSERT_GT(userif_get_target_reached(),0);
+    UpdateApp(p0);
+    ASSERT_GT(userif_get_target_reached(),0);
+    ASSERT_TRUE(userif_is_fence_reached(0));
+
+    UpdateApp(out_of_range_pos[2]);
+    ASSERT_EQ(userif_get_target_reached(),0);
+
+    UpdateApp(no_fix_pos[0]);
+    ASSERT_EQ(userif_get_gps_status(),0);
+    ASSERT_EQ(userif_get_target_reached(),0);
+
+    for (auto& pos : on_range_pos) {
+        UpdateApp(pos);
+        ASSERT_GT(userif_get_target_reached(),0);
+    }
+    for (auto& pos : out_of_range_pos) {
+        UpdateApp(pos);
+        ASSERT_EQ(userif_get_target_reached(),0);
+    }
+
+    app_set_lazy_evaluation(0, 0.0f);
+}
+
+
+/**
+ * APP Step. Target set replaced between positions
+ */
+TEST(App, step_009)
+{
+    targetset_st t;
+    geofence_set_st fences;
+    position_st depot = {39.4731325f, -0.3677324f, 13.0f, pos_3d};
+    position_st region = {39.6f, -0.4f, 13.0f, pos_3d};
+
+    ASSERT_EQ(targetset_init(&t), 0);
+    app_init();
+    app_set_lazy_evaluation(1, 0.0f);
+    ASSERT_EQ(app_set_target_set(&t), 0);
+
+    /* Nothing published */
+    UpdateApp(p0);
+    ASSERT_GT(userif_get_gps_status(),0);
+    ASSERT_EQ(userif_get_target_reached(),0);
+
+    ASSERT_EQ(geofence_set_init(&fences, 0), 0);
+    ASSERT_EQ(geofence_add(&fences, 7, &depot, 100.0f), 0);
+    ASSERT_EQ(targetset_publish(&t, &fences), 0);
+    UpdateApp(p0);
+    ASSERT_TRUE(userif_is_fence_reached(7));
+    UpdateApp(p0);
+    ASSERT_TRUE(userif_is_fence_reached(7));
+
+    /* The lazy evaluator does not keep the fences of the old snapshot */
+    ASSERT_EQ(geofence_set_init(&fences, 0), 0);
+    ASSERT_EQ(geofence_add(&fences, 9, &region, 50000.0f), 0);
+    ASSERT_EQ(targetset_publish(&t, &fences), 0);
+    UpdateApp(p0);
+    ASSERT_FALSE(userif_is_fence_reached(7));
+    ASSERT_TRUE(userif_is_fence_reached(9));
+    ASSERT_EQ(targetset_reclaim(&t), 0u);
+
+    ASSERT_EQ(app_set_target_set(NULL), 0);
+    app_set_lazy_evaluation(0, 0.0f);
+    targetset_free(&t);
+
+    UpdateApp(p0);
+    ASSERT_TRUE(userif_is_fence_reached(0));
+}
+
+
+/**
+ * APP Step. Occupancy index updated with the transitions of the device
+ */
+TEST(App, step_010)
+{
+    occupancy_st o;
+    geofence_set_st fences;
+    position_st depot = {39.4731325f, -0.3677324f, 13.0f, pos_3d};
+    position_st region = {39.6f, -0.4f, 13.0f, pos_3d};
+
+    ASSERT_EQ(occupancy_init(&o), 0);
+    ASSERT_EQ(geofence_set_init(&fences, 0), 0);
+    ASSERT_EQ(geofence_add(&fences, 7, &depot, 100.0f), 0);
+    ASSERT_EQ(geofence_add(&fences, 9, &region, 50000.0f), 0);
+
+    app_init();
+    app_set_geofences(&fences);
+    UpdateApp(p0);
+
+    /* The device is already inside both fences */
+    ASSERT_EQ(app_set_occupancy(&o, 42), 0);
+    ASSERT_EQ(occupancy_count(&o, 7), 1u);
+    ASSERT_TRUE(occupancy_contains(&o, 9, 42));
+
+    UpdateApp(out_of_range_pos[0]);
+    ASSERT_EQ(occupancy_count(&o, 7), 0u);
+    ASSERT_TRUE(occupancy_contains(&o, 9, 42));
+
+    UpdateApp(no_fix_pos[0]);
+    ASSERT_EQ(occupancy_count(&o, 9), 0u);
+
+    UpdateApp(p0);
+    ASSERT_TRUE(occupancy_contains(&o, 7, 42));
+    ASSERT_EQ(app_set_occupancy(NULL, 0), 0);
+    ASSERT_EQ(occupancy_count(&o, 7), 0u);
+    ASSERT_EQ(occupancy_count(&o, 9), 0u);
+
+    app_set_geofences(NULL);
+    geofence_set_free(&fences);
+    occupancy_free(&o);
+}
+
+
+/**
+ * APP Step. Stationary device memo
+ */
+TEST(App, step_011)
+{
+    geofence_set_st fences;
+    position_st depot = {39.4731325f, -0.3677324f, 13.0f, pos_3d};
+    app_stats_st stats;
+
+    ASSERT_EQ(geofence_set_init(&fences, 0), 0);
+    ASSERT_EQ(geofence_add(&fences, 7, &depot, 100.0f), 0);
+
+    app_init();
+    app_set_geofences(&fences);
+    app_set_stationary_memo(1, 1.0f);
+
+    /* Parked device */
+    for (int i = 0; i < 5; i++) {
+        UpdateApp(p0);
+        ASSERT_TRUE(userif_is_fence_reached(7));
+    }
+    app_get_stats(&stats);
+    ASSERT_EQ(stats.fixes, 5u);
+    ASSERT_EQ(stats.memo_hits, 4u);
+    ASSERT_EQ(stats.memo_misses, 1u);
+
+    /* Moving device, and without fix */
+    UpdateApp(out_of_range_pos[0]);
+    ASSERT_EQ(userif_get_target_reached(), 0);
+    UpdateApp(no_fix_pos[0]);
+    UpdateApp(p0);
+    ASSERT_TRUE(userif_is_fence_reached(7));
+
+    /* An edit of the set is not hidden by the memo */
+    ASSERT_EQ(geofence_remove(&fences, 7), 0);
+    UpdateApp(p0);
+    ASSERT_FALSE(userif_is_fence_reached(7));
+    UpdateApp(p0);
+
+    app_get_stats(&stats);
+    ASSERT_EQ(stats.fixes, 9u);
+    ASSERT_EQ(stats.memo_hits, 5u);
+    ASSERT_EQ(stats.memo_misses, 4u);
+
+    app_set_stationary_memo(0, 0.0f);
+    app_set_geofences(NULL);
+    geofence_set_free(&fences);
+}
+
+
+/**
+ * APP Step. A device on the target reports its geoidal separation, and the target is at the same ellipsoidal height
+ */
+TEST(App, step_012)
+{
+    position_st target = target_get_position();
+    GgaType gga = BuildGGA(target.latitude, target.longitude, target.altitude, 1, 10);
+
+    ASSERT_NE(gga.geoidal, 0.0f);
+    app_init();
+
+    /* On the target, and right above it. The vertical distance is the MSL one */
+    for (float up : {0.0f, 60.0f, 95.0f}) {
+        gga.altitude = target.altitude + up;
+        UpdateApp(gga);
+        ASSERT_GT(userif_get_target_reached(), 0) << up;
+    }
+    gga.altitude = target.altitude + 105.0f;
+    UpdateApp(gga);
+    ASSERT_EQ(userif_get_target_reached(), 0);
+}
@@ -0,0 +1,116 @@
+/**
+ * @file devgrid_tests.cpp
+ *
+ * @author miguel garcia (miguelden@gmail.com)
+ *
+ * @brief
+ *    Tests for Device spatial hash
+ */
+
+#include <algorithm>
+#include <array>
+#include <random>
+#include <vector>
+#include <gtest/gtest.h>
+#include "devgrid.h"
+#include "position.h"
+
+using namespace ::std;
+
+/** Devices within a distance of a position, by brute force */
+static vector<uint32_t> BruteQuery (const vector<array<float, 3>>& pos, const vector<bool>& present,
+                                    float x, float y, float z, float radius, uint32_t skip)
+{
+    vector<uint32_t> r;
+    for (uint32_t i = 0; i < pos.size(); i++) {
+        float dx = x - pos[i][0], dy = y - pos[i][1], dz = z - pos[i][2];
+        if (present[i] && i != skip && dx * dx + dy * dy + dz * dz <= radius * radius) {
+            r.push_back(i);
+        }
+    }
+    return r;
+}
+
+/**
+ * Init
+ */
+TEST(DevGrid, init_001)
+{
+    devgrid_st g;
+
+    ASSERT_LT(devgrid_init(&g, 10, 1.0f), 0);
+    ASSERT_EQ(devgrid_init(&g, 10, 50.0f), 0);
+    ASSERT_EQ(g.count, 0u);
+    ASSERT_LT(devgrid_update(&g, 10, 0.0f, 0.0f, 0.0f), 0);
+    ASSERT_EQ(devgrid_neighbours(&g, 3, 100.0f, NULL, 0), 0u);
+    devgrid_free(&g);
+}
+
+/**
+ * A fleet of devices moving around a city: the queries find the same devices as a brute force search
+ */
+TEST(DevGrid, query_001)
+{
+    const uint32_t devices = 2000;
+    devgrid_st g;
+    mt19937 rng(7);
+    uniform_real_distribution<float> lat(39.40f, 39.50f), lon(-0.42f, -0.32f), step(-3.0f, 3.0f);
+    vector<array<float, 3>> pos(devices);
+    vector<bool> present(devices, false);
+    vector<uint32_t> found(devices);
+
+    ASSERT_EQ(devgrid_init(&g, devices, 100.0f), 0);
+    for (uint32_t i = 0; i < devices; i++) {
+        position_geodetic_to_ecef(lat(rng), lon(rng), 20.0f, &pos[i][0], &pos[i][1], &pos[i][2]);
+        ASSERT_EQ(devgrid_update(&g, i, pos[i][0], pos[i][1], pos[i][2]), 0);
+        present[i] = true;
+    }
+    ASSERT_EQ(g.count, devices);
+
+    for (int round = 0; round < 20; round++) {
+        /* Small moves, and some devices lose their position */
+        for (uint32_t i = 0; i < devices; i++) {
+            if (rng() % 50 == 0) {
+                devgrid_remove(&g, i);
+                present[i] = false;
+                continue;
+            }
+            for (int k = 0; k < 3; k++) {
+                pos[i][k] += step(rng);
+            }
+            ASSERT_EQ(devgrid_update(&g, i, pos[i][0], pos[i][1], pos[i][2]), 0);
+            present[i] = true;
+        }
+        ASSERT_EQ(g.count, (uint32_t)count(present.begin(), present.end(), true));
+
+        for (uint32_t i = 0; i < devices; i += 37) {
+            float radius = (i % 3 == 0) ? 50.0f : 300.0f;
+            vector<uint32_t> expected = BruteQuery(pos, present, pos[i][0], pos[i][1], pos[i][2], radius, i);
+
+            uint32_t n = devgrid_neighbours(&g, i, radius, found.data(), devices);
+            if (!present[i]) {
+                ASSERT_EQ(n, 0u);
+                continue;
+            }
+            ASSERT_EQ(n, expected.size());
+            sort(found.begin(), found.begin() + n);
+            ASSERT_TRUE(equal(expected.begin(), expected.end(), found.begin()));
+        }
+    }
+
+    /* The devices only change their cell when they cross a boundary */
+    ASSERT_LT(g.moves, g.updates / 4);
+
+    /* A radius larger than the city reads every cell */
+    vector<uint32_t> expected = BruteQuery(pos, present, pos[0][0], pos[0][1], pos[0][2], 50000.0f, devices);
+    ASSERT_EQ(devgrid_query(&g, pos[0][0], pos[0][1], pos[0][2], 50000.0f, found.data(), 10), expected.size());
+
+    /* Everyone leaves */
+    for (uint32_t i = 0; i < devices; i++) {
+        devgrid_remove(&g, i);
+    }
+    ASSERT_EQ(g.count, 0u);
+    ASSERT_EQ(g.ncells, 0u);
+    ASSERT_EQ(devgrid_query(&g, pos[0][0], pos[0][1], pos[0][2], 50000.0f, found.data(), devices), 0u);
+    devgrid_free(&g);
+}
@@ -0,0 +1,265 @@
+/**
+ * @file dispatch_tests.cpp
+ *
+ * @author miguel garcia (miguelden@gmail.com)
+ *
+ * @brief
+ *    Tests for Runtime CPU feature dispatch
+ */
+
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <gtest/gtest.h>
+#include "dispatch.h"
+#include "navigation.h"
+
+using namespace ::std;
+
+/** Aligned and padded float array, as the distance matrix sets */
+static float* AlignedArray (uint32_t n)
+{
+    void* p = NULL;
+    size_t sz = ((n + 15) / 16) * 16 * sizeof(float);
+    EXPECT_EQ(posix_memalign(&p, 64, sz), 0);
+    memset(p, 0, sz);
+    return (float*)p;
+}
+
+/**
+ * The supported level is bound at load time, and the scalar level is always available
+ */
+TEST(Dispatch, dispatch_level_001)
+{
+    dispatch_level supported = dispatch_get_supported();
+
+    ASSERT_GE(supported, dispatch_scalar);
+    ASSERT_LT(supported, dispatch_levels);
+    if (getenv(DISPATCH_ENV) == NULL) {
+        ASSERT_EQ(dispatch_get_level(), supported);
+    }
+
+    ASSERT_NE(dispatch_get_variant(dispatch_scalar), nullptr);
+    ASSERT_EQ(dispatch_get_variant(dispatch_levels), nullptr);
+    ASSERT_STREQ(dispatch_level_name(dispatch_scalar), "scalar");
+    ASSERT_STREQ(dispatch_level_name(dispatch_avx512), "avx512");
+}
+
+/**
+ * Binding a level, and rejecting a level that is not supported
+ */
+TEST(Dispatch, dispatch_level_002)
+{
+    dispatch_level bound = dispatch_get_level();
+
+    ASSERT_EQ(dispatch_set_level(dispatch_scalar), 0);
+    ASSERT_EQ(dispatch_get_level(), dispatch_scalar);
+    ASSERT_EQ(dispatch_get_kernels()->level, dispatch_scalar);
+
+    if (dispatch_get_supported() < dispatch_avx512) {
+        ASSERT_LT(dispatch_set_level(dispatch_avx512), 0);
+        ASSERT_EQ(dispatch_get_level(), dispatch_scalar);
+    }
+
+    ASSERT_EQ(dispatch_set_level(bound), 0);
+}
+
+/**
+ * The environment variable forces a lower level, and a higher level is ignored
+ */
+TEST(Dispatch, dispatch_level_003)
+{
+    setenv(DISPATCH_ENV, "scalar", 1);
+    dispatch_init();
+    ASSERT_EQ(dispatch_get_level(), dispatch_scalar);
+
+    setenv(DISPATCH_ENV, "avx512", 1);
+    dispatch_init();
+    ASSERT_EQ(dispatch_get_level(), dispatch_get_supported());
+
+    unsetenv(DISPATCH_ENV);
+    dispatch_init();
+    ASSERT_EQ(dispatch_get_level(), dispatch_get_supported());
+}
+
+/**
+ * Every supported checksum version matches the scalar one, for every length and alignment
+ */
+TEST(Dispatch, dispatch_xor_001)
+{
+    const dispatch_kernels_st* ref = dispatch_get_variant(dispatch_scalar);
+    vector<char> buf(300);
+
+    for (size_t i = 0; i < buf.size(); i++) {
+        buf[i] = (char)(i * 37 + 11);
+    }
+
+    for (int l = dispatch_scalar; l <= dispatch_get_supported(); l++) {
+        const dispatch_kernels_st* k = dispatch_get_variant((dispatch_level)l);
+        for (uint32_t off = 0; off < 5; off++) {
+            for (uint32_t len = 0; len < 260; len++) {
+                ASSERT_EQ(k->nmea_xor(&buf[off], len), ref->nmea_xor(&buf[off], len)) << dispatch_level_name(k->level);
+            }
+        }
+    }
+}
+
+/**
+ * Every supported field scanning version matches the scalar one, including the limit of offsets
+ */
+TEST(Dispatch, dispatch_scan_001)
+{
+    const dispatch_kernels_st* ref = dispatch_get_variant(dispatch_scalar);
+    string s = "$GPGGA,064951.000,2307.1256,N,12016.4438,E,1,8,0.95,39.9,M,17.8,M,,*65"
+               ",,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,";
+
+    for (int l = dispatch_scalar; l <= dispatch_get_supported(); l++) {
+        const dispatch_kernels_st* k = dispatch_get_variant((dispatch_level)l);
+        for (uint32_t len = 0; len <= s.size(); len++) {
+            for (uint32_t max : {0u, 3u, 14u, 200u}) {
+                uint16_t a[200], b[200];
+                uint32_t na = k->nmea_scan(s.data(), len, ',', a, max);
+                uint32_t nb = ref->nmea_scan(s.data(), len, ',', b, max);
+                ASSERT_EQ(na, nb) << dispatch_level_name(k->level) << " len " << len;
+                ASSERT_EQ(memcmp(a, b, na * sizeof(uint16_t)), 0);
+            }
+        }
+    }
+}
+
+/**
+ * Every supported distance row version matches the scalar one
+ */
+TEST(Dispatch, dispatch_row_dist_001)
+{
+    const dispatch_kernels_st* ref = dispatch_get_variant(dispatch_scalar);
+    const uint32_t n = 37;
+    float* x = AlignedArray(n);
+    float* y = AlignedArray(n);
+    float* z = AlignedArray(n);
+    float* a = AlignedArray(n);
+    float* b = AlignedArray(n);
+
+    for (uint32_t j = 0; j < n; j++) {
+        x[j] = 4.9e6f + 1000.0f * j;
+        y[j] = -3.2e4f - 10.0f * j;
+        z[j] = 4.0e6f + 333.0f * j;
+    }
+
+    for (int l = dispatch_scalar; l <= dispatch_get_supported(); l++) {
+        const dispatch_kernels_st* k = dispatch_get_variant((dispatch_level)l);
+        for (uint8_t take_sqrt = 0; take_sqrt < 2; take_sqrt++) {
+            k->row_dist(x, y, z, 4.9e6f, -3.1e4f, 4.0e6f, n, take_sqrt, a);
+            ref->row_dist(x, y, z, 4.9e6f, -3.1e4f, 4.0e6f, n, take_sqrt, b);
+            for (uint32_t j = 0; j < n; j++) {
+                ASSERT_NEAR(a[j], b[j], fabsf(b[j]) * 1e-6f) << dispatch_level_name(k->level);
+            }
+        }
+    }
+
+    free(x); free(y); free(z); free(a); free(b);
+}
+
+/**
+ * Every level counts the same polygon crossings as the scalar level
+ */
+TEST(Dispatch, dispatch_crossings_001)
+{
+    const dispatch_kernels_st* ref = dispatch_get_variant(dispatch_scalar);
+    const uint32_t n = 37;
+    float* x0 = AlignedArray(n);
+    float* y0 = AlignedArray(n);
+    float* x1 = AlignedArray(n);
+    float* y1 = AlignedArray(n);
+
+    /* Star-shaped polygon, the padding edges are degenerate */
+    for (uint32_t j = 0; j < n; j++) {
+        float r0 = (j % 2) ? 500.0f : 1000.0f;
+        float r1 = (j % 2) ? 1000.0f : 500.0f;
+        float a0 = 2.0f * (float)M_PI * j / n;
+        float a1 = 2.0f * (float)M_PI * (j + 1) / n;
+        x0[j] = r0 * cosf(a0);
+        y0[j] = r0 * sinf(a0);
+        x1[j] = r1 * cosf(a1);
+        y1[j] = r1 * sinf(a1);
+    }
+
+    for (int l = dispatch_scalar; l <= dispatch_get_supported(); l++) {
+        const dispatch_kernels_st* k = dispatch_get_variant((dispatch_level)l);
+        uint32_t inside = 0;
+        for (float px = -1100.37f; px < 1100.0f; px += 50.0f) {
+            for (float py = -1100.71f; py < 1100.0f; py += 50.0f) {
+                uint32_t c = k->crossings(x0, y0, x1, y1, n, px, py);
+                ASSERT_EQ(c, ref->crossings(x0, y0, x1, y1, n, px, py)) << dispatch_level_name(k->level);
+                inside += c & 1;
+            }
+        }
+        ASSERT_GT(inside, 0u);
+        ASSERT_EQ(k->crossings(x0, y0, x1, y1, n, 0.1f, 0.1f) & 1, 1u);
+        ASSERT_EQ(k->crossings(x0, y0, x1, y1, n, 2000.0f, 0.1f), 0u);
+    }
+
+    free(x0); free(y0); free(x1); free(y1);
+}
+
+/**
+ * Every level finds the same boxes as the scalar level, bounds included
+ */
+TEST(Dispatch, dispatch_box_mask_001)
+{
+    const dispatch_kernels_st* ref = dispatch_get_variant(dispatch_scalar);
+    float* bounds = AlignedArray(96);
+
+    /* Nested boxes: box k is [-k, k] on every axis, box 15 is empty */
+    for (uint32_t k = 0; k < 16; k++) {
+        for (int a = 0; a < 3; a++) {
+            bounds[a * 16 + k] = (k < 15) ? -(float)k : 1.0f;
+            bounds[48 + a * 16 + k] = (k < 15) ? (float)k : -1.0f;
+        }
+    }
+
+    for (int l = dispatch_scalar; l <= dispatch_get_supported(); l++) {
+        const dispatch_kernels_st* k = dispatch_get_variant((dispatch_level)l);
+        for (float v = -16.0f; v <= 16.0f; v += 0.5f) {
+            ASSERT_EQ(k->box_mask(bounds, v, 0.0f, 0.0f), ref->box_mask(bounds, v, 0.0f, 0.0f));
+            ASSERT_EQ(k->box_mask(bounds, 0.0f, v, -v), ref->box_mask(bounds, 0.0f, v, -v));
+        }
+        ASSERT_EQ(k->box_mask(bounds, 0.0f, 0.0f, 0.0f), 0x7fffu) << dispatch_level_name(k->level);
+        ASSERT_EQ(k->box_mask(bounds, 3.0f, -3.0f, 0.0f), 0x7ff8u) << dispatch_level_name(k->level);
+        ASSERT_EQ(k->box_mask(bounds, 0.0f, 0.0f, 14.5f), 0u) << dispatch_level_name(k->level);
+    }
+
+    free(bounds);
+}
+
+/**
+ * The NMEA parser gives the same position with every supported level
+ */
+TEST(Dispatch, dispatch_nmea_001)
+{
+    const char* nmea = "$GPGGA,064951.000,2307.1256,N,12016.4438,E,1,8,0.95,39.9,M,17.8,M,,*63\r";
+    dispatch_level bound = dispatch_get_level();
+
+    for (int l = dispatch_scalar; l <= dispatch_get_supported(); l++) {
+        uint8_t res = 0;
+        float separation;
+
+        ASSERT_EQ(dispatch_set_level((dispatch_level)l), 0);
+        navigation_reset();
+        for (const char* p = nmea; *p; p++) {
+            res |= navigation_add_nmea_char(*p);
+        }
+
+        position_st llh = navigation_get_llh();
+        ASSERT_EQ(res, 1) << dispatch_level_name((dispatch_level)l);
+        ASSERT_NEAR(llh.latitude, 23.11876f, 1e-4f);
+        ASSERT_NEAR(llh.longitude, 120.27406f, 1e-4f);
+        ASSERT_NEAR(llh.altitude, 39.9f, 1e-4f);
+        ASSERT_GT(navigation_get_geoid_separation(&separation), 0);
+        ASSERT_NEAR(separation, 17.8f, 1e-4f);
+    }
+
+    ASSERT_EQ(dispatch_set_level(bound), 0);
+}
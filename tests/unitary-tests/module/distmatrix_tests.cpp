@@ -0,0 +1,190 @@
+/**
+ * @file distmatrix_tests.cpp
+ *
+ * @author miguel garcia (miguelden@gmail.com)
+ *
+ * @brief
+ *    Tests for Pairwise distance matrix component
+ */
+
+#include <algorithm>
+#include <random>
+#include <vector>
+#include <gtest/gtest.h>
+#include "position.h"
+#include "distmatrix.h"
+
+using namespace ::std;
+
+/**
+ * Random positions around a center
+ * @param n       Number of positions
+ * @param lat     Center latitude
+ * @param lon     Center longitude
+ * @param spread  Max offset in degrees
+ * @param seed    Random seed
+ * @return  The positions
+ */
+static vector<position_st> RandomPositions (uint32_t n, float lat, float lon, float spread, uint32_t seed)
+{
+    mt19937 gen(seed);
+    uniform_real_distribution<float> d(-spread, spread);
+    vector<position_st> res(n);
+
+    for (auto& p : res) {
+        p.latitude = lat + d(gen);
+        p.longitude = lon + d(gen);
+        p.altitude = 10.0f + d(gen) * 100.0f;
+        p.is_valid = pos_3d;
+    }
+    return res;
+}
+
+/**
+ * Distance given by the position component
+ */
+static float RefDistance (const position_st& a, const position_st& b)
+{
+    float enu[3];
+    position_geodetic_to_enu(b.latitude, b.longitude, b.altitude, a.latitude, a.longitude, a.altitude,
+                             &enu[0], &enu[1], &enu[2]);
+    return position_xyz_distance(0.0f, 0.0f, 0.0f, enu[0], enu[1], enu[2]);
+}
+
+/** Pairs received by the stream callback */
+static void CollectPairs (const distmatrix_pair_st* pairs, uint32_t n, void* ctx)
+{
+    auto v = (vector<distmatrix_pair_st>*)ctx;
+    v->insert(v->end(), pairs, pairs + n);
+}
+
+/**
+ * Matrix matches the distances of the position component, for several tiles and threads
+ */
+TEST(DistMatrix, compute_001)
+{
+    auto a = RandomPositions(150, 39.47f, -0.37f, 0.05f, 1);
+    auto b = RandomPositions(2100, 39.47f, -0.37f, 0.05f, 2);
+    distmatrix_set_st sa, sb;
+
+    ASSERT_EQ(distmatrix_set_init(&sa, a.data(), a.size()), 0);
+    ASSERT_EQ(distmatrix_set_init(&sb, b.data(), b.size()), 0);
+
+    vector<float> d1(a.size() * b.size(), -1.0f);
+    vector<float> d4(a.size() * b.size(), -1.0f);
+    ASSERT_EQ(distmatrix_compute(&sa, &sb, d1.data(), 1), 0);
+    ASSERT_EQ(distmatrix_compute(&sa, &sb, d4.data(), 4), 0);
+    ASSERT_TRUE(d1 == d4);
+
+    for (uint32_t i = 0; i < a.size(); i += 7) {
+        for (uint32_t j = 0; j < b.size(); j += 13) {
+            /* float ECEF, ~1 m */
+            ASSERT_NEAR(d1[i * b.size() + j], RefDistance(a[i], b[j]), 2.0f) << "i=" << i << " j=" << j;
+        }
+    }
+
+    distmatrix_set_free(&sa);
+    distmatrix_set_free(&sb);
+}
+
+/**
+ * A NULL set or output fails instead of running the job
+ */
+TEST(DistMatrix, compute_002)
+{
+    auto a = RandomPositions(10, 39.47f, -0.37f, 0.05f, 1);
+    distmatrix_set_st sa;
+    vector<float> d(a.size() * a.size());
+
+    ASSERT_EQ(distmatrix_set_init(&sa, a.data(), a.size()), 0);
+    ASSERT_LT(distmatrix_compute(&sa, &sa, NULL, 1), 0);
+    ASSERT_LT(distmatrix_compute(NULL, &sa, d.data(), 1), 0);
+    ASSERT_LT(distmatrix_compute(&sa, NULL, d.data(), 1), 0);
+    ASSERT_EQ(distmatrix_compute(&sa, &sa, d.data(), 1), 0);
+
+    distmatrix_set_free(&sa);
+}
+
+/**
+ * Stream gives the pairs of the matrix under the threshold
+ */
+TEST(DistMatrix, stream_001)
+{
+    auto a = RandomPositions(300, 39.47f, -0.37f, 0.02f, 3);
+    auto b = RandomPositions(1500, 39.47f, -0.37f, 0.02f, 4);
+    distmatrix_set_st sa, sb;
+    const float max_dist = 500.0f;
+
+    ASSERT_EQ(distmatrix_set_init(&sa, a.data(), a.size()), 0);
+    ASSERT_EQ(distmatrix_set_init(&sb, b.data(), b.size()), 0);
+
+    vector<float> d(a.size() * b.size());
+    ASSERT_EQ(distmatrix_compute(&sa, &sb, d.data(), 2), 0);
+
+    vector<distmatrix_pair_st> pairs;
+    ASSERT_EQ(distmatrix_stream(&sa, &sb, max_dist, CollectPairs, &pairs, 3), 0);
+
+    uint32_t expected = count_if(d.begin(), d.end(), [=](float v) { return v <= max_dist; });
+    ASSERT_GT(expected, 0u);
+    ASSERT_EQ(pairs.size(), expected);
+    for (auto& p : pairs) {
+        ASSERT_NEAR(p.dist, d[p.i * b.size() + p.j], 1e-3f);
+        ASSERT_LE(p.dist, max_dist);
+    }
+
+    distmatrix_set_free(&sa);
+    distmatrix_set_free(&sb);
+}
+
+/**
+ * All pairs of one set: each pair once, with i < j
+ */
+TEST(DistMatrix, stream_002)
+{
+    auto a = RandomPositions(1200, -33.45f, -70.66f, 0.01f, 5);
+    distmatrix_set_st sa;
+    const float max_dist = 300.0f;
+
+    ASSERT_EQ(distmatrix_set_init(&sa, a.data(), a.size()), 0);
+
+    vector<float> d(a.size() * a.size());
+    ASSERT_EQ(distmatrix_compute(&sa, &sa, d.data(), 0), 0);
+
+    uint32_t expected = 0;
+    for (uint32_t i = 0; i < a.size(); i++) {
+        ASSERT_EQ(d[i * a.size() + i], 0.0f);
+        for (uint32_t j = i + 1; j < a.size(); j++) {
+            expected += (d[i * a.size() + j] <= max_dist) ? 1 : 0;
+        }
+    }
+
+    vector<distmatrix_pair_st> pairs;
+    ASSERT_EQ(distmatrix_stream(&sa, &sa, max_dist, CollectPairs, &pairs, 4), 0);
+    ASSERT_EQ(pairs.size(), expected);
+    for (auto& p : pairs) {
+        ASSERT_LT(p.i, p.j);
+    }
+
+    distmatrix_set_free(&sa);
+}
+
+/**
+ * Empty sets and invalid arguments
+ */
+TEST(DistMatrix, stream_003)
+{
+    distmatrix_set_st sa, sb;
+    vector<distmatrix_pair_st> pairs;
+    position_st p = {.latitude = 1.0f, .longitude = 2.0f, .altitude = 3.0f, .is_valid = pos_3d};
+
+    ASSERT_EQ(distmatrix_set_init(&sa, NULL, 0), 0);
+    ASSERT_EQ(distmatrix_set_init(&sb, &p, 1), 0);
+    ASSERT_EQ(distmatrix_stream(&sa, &sb, 10.0f, CollectPairs, &pairs, 2), 0);
+    ASSERT_EQ(distmatrix_stream(&sb, &sb, 10.0f, CollectPairs, &pairs, 2), 0);
+    ASSERT_TRUE(pairs.empty());
+    ASSERT_EQ(distmatrix_stream(&sb, &sb, -1.0f, CollectPairs, &pairs, 2), -1);
+    ASSERT_EQ(distmatrix_stream(&sb, &sb, 1.0f, NULL, &pairs, 2), -1);
+
+    distmatrix_set_free(&sa);
+    distmatrix_set_free(&sb);
+}
@@ -0,0 +1,313 @@
+/**
+ * @file fencefile_tests.cpp
+ *
+ * @author miguel garcia (miguelden@gmail.com)
+ *
+ * @brief
+ *    Tests for Memory-mapped geofence index file
+ */
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+#include <gtest/gtest.h>
+#include "fencefile.h"
+#include "geofence.h"
+#include "position.h"
+
+using namespace ::std;
+
+/** Random circular and polygon fences around Valencia */
+static void RandomSet (geofence_set_st* s, uint32_t ncircles, uint32_t npolygons, mt19937& rng)
+{
+    uniform_real_distribution<float> lat(38.5f, 40.5f);
+    uniform_real_distribution<float> lon(-1.5f, 0.5f);
+    uniform_real_distribution<float> log_radius(log(50.0f), log(20000.0f));
+    uniform_real_distribution<float> size(0.001f, 0.2f);
+
+    ASSERT_EQ(geofence_set_init(s, 0), 0);
+    for (uint32_t i = 0; i < ncircles; i++) {
+        position_st c = {lat(rng), lon(rng), 0.0f, pos_3d};
+        ASSERT_EQ(geofence_add(s, 1000 + i, &c, exp(log_radius(rng))), 0);
+    }
+    for (uint32_t i = 0; i < npolygons; i++) {
+        float clat = lat(rng), clon = lon(rng), d = size(rng);
+        vector<position_st> ring;
+        /* Some polygons with enough vertices to have bands */
+        uint32_t n = (i % 10 == 0) ? 200 : 5;
+        for (uint32_t k = 0; k < n; k++) {
+            float a = 2.0f * (float)M_PI * k / n;
+            float r = d * ((k % 2) ? 0.6f : 1.0f);
+            ring.push_back({clat + r * sinf(a), clon + 1.3f * r * cosf(a), 0.0f, pos_2d});
+        }
+        ASSERT_EQ(geofence_add_polygon(s, 100000 + i, ring.data(), n), 0);
+    }
+}
+
+/** Path of a temporary file */
+static string TempPath (const char* name)
+{
+    return testing::TempDir() + name;
+}
+
+/** Contents of a file */
+static vector<uint8_t> ReadFile (const string& path)
+{
+    vector<uint8_t> data;
+    FILE* f = fopen(path.c_str(), "rb");
+    if (f != NULL) {
+        int c;
+        while ((c = fgetc(f)) != EOF) {
+            data.push_back((uint8_t)c);
+        }
+        fclose(f);
+    }
+    return data;
+}
+
+/** CRC-32 (IEEE 802.3) */
+static uint32_t Crc32 (const uint8_t* data, size_t size)
+{
+    uint32_t crc = 0xFFFFFFFFu;
+    for (size_t i = 0; i < size; i++) {
+        crc ^= data[i];
+        for (int k = 0; k < 8; k++) {
+            crc = (crc & 1) ? 0xEDB88320u ^ (crc >> 1) : crc >> 1;
+        }
+    }
+    return crc ^ 0xFFFFFFFFu;
+}
+
+/** Update the checksums of a file in memory after a change */
+static void FixChecksums (uint8_t* data)
+{
+    fencefile_header_st* h = (fencefile_header_st*)data;
+    for (int i = 0; i < FENCEFILE_SECTIONS; i++) {
+        h->sections[i].checksum = Crc32(data + h->sections[i].offset, h->sections[i].size);
+    }
+    h->checksum = 0;
+    h->checksum = Crc32(data, sizeof(fencefile_header_st));
+}
+
+/**
+ * The mapped file finds the same fences as the set it was written from
+ */
+TEST(FenceFile, evaluate_001)
+{
+    mt19937 rng(40);
+    geofence_set_st s;
+    fencefile_st f;
+    string path = TempPath("fencefile_evaluate_001.idx");
+    uniform_real_distribution<float> lat(38.5f, 40.5f);
+    uniform_real_distribution<float> lon(-1.5f, 0.5f);
+    vector<uint32_t> expected(10000), ids(10000);
+    uint32_t found = 0;
+
+    RandomSet(&s, 5000, 300, rng);
+    ASSERT_EQ(fencefile_write(&s, path.c_str()), 0);
+    ASSERT_EQ(s.index, geofence_index_grid);
+    ASSERT_EQ(fencefile_open(&f, path.c_str(), FENCEFILE_VERIFY), 0);
+    ASSERT_EQ(f.header->ncircles, 5000u);
+    ASSERT_EQ(f.header->npolygons, 300u);
+    ASSERT_EQ(f.rtree.n, 5300u);
+    ASSERT_EQ(f.size % 4, 0u);
+    for (int i = 0; i < FENCEFILE_SECTIONS; i++) {
+        ASSERT_EQ(f.header->sections[i].offset % FENCEFILE_ALIGN, 0u);
+    }
+
+    for (int q = 0; q < 2000; q++) {
+        float x, y, z;
+        position_geodetic_to_ecef(lat(rng), lon(rng), 20.0f, &x, &y, &z);
+
+        uint32_t ne = geofence_evaluate(&s, x, y, z, expected.data(), (uint32_t)expected.size());
+        uint32_t n = fencefile_evaluate(&f, x, y, z, ids.data(), (uint32_t)ids.size());
+        ASSERT_EQ(n, ne);
+        sort(expected.begin(), expected.begin() + ne);
+        sort(ids.begin(), ids.begin() + n);
+        ASSERT_TRUE(equal(expected.begin(), expected.begin() + ne, ids.begin()));
+        ASSERT_EQ(fencefile_evaluate(&f, x, y, z, ids.data(), 0), n);
+        found += n;
+    }
+    ASSERT_GT(found, 500u);
+
+    fencefile_close(&f);
+    ASSERT_EQ(f.data, nullptr);
+    geofence_set_free(&s);
+    remove(path.c_str());
+}
+
+/**
+ * The set is not changed by a write, and its tombstones are left out of the file
+ */
+TEST(FenceFile, write_001)
+{
+    mt19937 rng(42);
+    geofence_set_st s;
+    fencefile_st f;
+    string path = TempPath("fencefile_write_001.idx");
+    uniform_real_distribution<float> lat(38.5f, 40.5f);
+    uniform_real_distribution<float> lon(-1.5f, 0.5f);
+    vector<uint32_t> expected(1000), ids(1000);
+
+    RandomSet(&s, 200, 20, rng);
+    ASSERT_EQ(geofence_build(&s), 0);
+    for (uint32_t i = 0; i < 10; i++) {
+        ASSERT_EQ(geofence_remove(&s, 1000 + 3 * i), 0);
+    }
+    ASSERT_EQ(geofence_remove(&s, 100000), 0);
+    ASSERT_EQ(geofence_remove(&s, 100007), 0);
+    uint32_t version = s.version;
+
+    ASSERT_LT(fencefile_write(&s, NULL), 0);
+    ASSERT_LT(fencefile_write(NULL, path.c_str()), 0);
+    ASSERT_EQ(fencefile_write(&s, path.c_str()), 0);
+    ASSERT_EQ(s.index, geofence_index_grid);
+    ASSERT_EQ(s.version, version);
+    ASSERT_EQ(s.count, 200u);
+    ASSERT_EQ(s.npolygons, 20u);
+
+    ASSERT_EQ(fencefile_open(&f, path.c_str(), FENCEFILE_VERIFY), 0);
+    ASSERT_EQ(f.header->ncircles, 190u);
+    ASSERT_EQ(f.header->npolygons, 18u);
+    ASSERT_EQ(f.rtree.n, 208u);
+    for (int q = 0; q < 500; q++) {
+        float x, y, z;
+        position_geodetic_to_ecef(lat(rng), lon(rng), 20.0f, &x, &y, &z);
+
+        uint32_t ne = geofence_evaluate(&s, x, y, z, expected.data(), (uint32_t)expected.size());
+        uint32_t n = fencefile_evaluate(&f, x, y, z, ids.data(), (uint32_t)ids.size());
+        ASSERT_EQ(n, ne);
+        sort(expected.begin(), expected.begin() + ne);
+        sort(ids.begin(), ids.begin() + n);
+        ASSERT_TRUE(equal(expected.begin(), expected.begin() + ne, ids.begin()));
+    }
+
+    fencefile_close(&f);
+    geofence_set_free(&s);
+    remove(path.c_str());
+}
+
+/**
+ * Empty set, files in memory and missing files
+ */
+TEST(FenceFile, open_001)
+{
+    geofence_set_st s;
+    fencefile_st f;
+    string path = TempPath("fencefile_open_001.idx");
+    uint32_t ids[4];
+    float x, y, z;
+
+    ASSERT_EQ(geofence_set_init(&s, 0), 0);
+    ASSERT_EQ(fencefile_write(&s, path.c_str()), 0);
+    ASSERT_EQ(fencefile_open(&f, path.c_str(), FENCEFILE_VERIFY), 0);
+    position_geodetic_to_ecef(39.47f, -0.37f, 0.0f, &x, &y, &z);
+    ASSERT_EQ(fencefile_evaluate(&f, x, y, z, ids, 4), 0u);
+    fencefile_close(&f);
+
+    /* One fence, from a copy in memory */
+    position_st c = {39.47f, -0.37f, 0.0f, pos_3d};
+    ASSERT_EQ(geofence_add(&s, 5, &c, 100.0f), 0);
+    ASSERT_EQ(fencefile_write(&s, path.c_str()), 0);
+    auto data = ReadFile(path);
+    void* buffer = NULL;
+    ASSERT_EQ(posix_memalign(&buffer, FENCEFILE_ALIGN, data.size()), 0);
+    memcpy(buffer, data.data(), data.size());
+    ASSERT_EQ(fencefile_open_memory(&f, buffer, data.size(), FENCEFILE_VERIFY), 0);
+    ASSERT_EQ(f.mapped, 0);
+    ASSERT_EQ(fencefile_evaluate(&f, x, y, z, ids, 4), 1u);
+    ASSERT_EQ(ids[0], 5u);
+    fencefile_close(&f);
+
+    /* Misaligned contents */
+    ASSERT_LT(fencefile_open_memory(&f, (uint8_t*)buffer + 4, data.size() - 4, 0), 0);
+    free(buffer);
+
+    ASSERT_LT(fencefile_open(&f, TempPath("fencefile_missing.idx").c_str(), 0), 0);
+    ASSERT_LT(fencefile_open(&f, NULL, 0), 0);
+    ASSERT_LT(fencefile_verify(&f), 0);
+
+    geofence_set_free(&s);
+    remove(path.c_str());
+}
+
+/**
+ * Corrupted files are rejected: the header on open, the sections by the verification
+ */
+TEST(FenceFile, verify_001)
+{
+    mt19937 rng(41);
+    geofence_set_st s;
+    fencefile_st f;
+    string path = TempPath("fencefile_verify_001.idx");
+    void* buffer = NULL;
+
+    RandomSet(&s, 500, 30, rng);
+    ASSERT_EQ(fencefile_write(&s, path.c_str()), 0);
+    geofence_set_free(&s);
+
+    auto data = ReadFile(path);
+    ASSERT_EQ(posix_memalign(&buffer, FENCEFILE_ALIGN, data.size()), 0);
+    uint8_t* bytes = (uint8_t*)buffer;
+    auto reset = [&]() { memcpy(buffer, data.data(), data.size()); };
+
+    reset();
+    ASSERT_EQ(fencefile_open_memory(&f, buffer, data.size(), FENCEFILE_VERIFY), 0);
+    const fencefile_header_st h = *f.header;
+
+    /* Truncated */
+    ASSERT_LT(fencefile_open_memory(&f, buffer, data.size() - 64, 0), 0);
+    ASSERT_LT(fencefile_open_memory(&f, buffer, 16, 0), 0);
+
+    /* Magic, version and header checksum */
+    bytes[0] = 'X';
+    ASSERT_LT(fencefile_open_memory(&f, buffer, data.size(), 0), 0);
+    reset();
+    ((fencefile_header_st*)buffer)->version = FENCEFILE_VERSION + 1;
+    ASSERT_LT(fencefile_open_memory(&f, buffer, data.size(), 0), 0);
+    reset();
+    ((fencefile_header_st*)buffer)->ncircles++;
+    ASSERT_LT(fencefile_open_memory(&f, buffer, data.size(), 0), 0);
+
+    /* A byte of every section: the structure is fine, the checksum is not */
+    for (int i = 0; i < FENCEFILE_SECTIONS; i++) {
+        reset();
+        ASSERT_GT(h.sections[i].size, 0u);
+        bytes[h.sections[i].offset + h.sections[i].size / 2] ^= 0x40;
+        ASSERT_EQ(fencefile_open_memory(&f, buffer, data.size(), 0), 0);
+        ASSERT_LT(fencefile_verify(&f), 0);
+        ASSERT_LT(fencefile_open_memory(&f, buffer, data.size(), FENCEFILE_VERIFY), 0);
+    }
+
+    /* Out of bounds references with valid checksums */
+    reset();
+    ASSERT_EQ(fencefile_open_memory(&f, buffer, data.size(), 0), 0);
+    ((fencefile_polygon_st*)f.polygons)[3].edges += 1 << 20;
+    FixChecksums(bytes);
+    ASSERT_EQ(fencefile_open_memory(&f, buffer, data.size(), 0), 0);
+    ASSERT_LT(fencefile_verify(&f), 0);
+
+    reset();
+    ASSERT_EQ(fencefile_open_memory(&f, buffer, data.size(), 0), 0);
+    ((rtree_node_st*)f.rtree.nodes)[f.rtree.nnodes - 1].first = f.rtree.nnodes - 1;
+    FixChecksums(bytes);
+    ASSERT_EQ(fencefile_open_memory(&f, buffer, data.size(), 0), 0);
+    ASSERT_LT(fencefile_verify(&f), 0);
+
+    reset();
+    ASSERT_EQ(fencefile_open_memory(&f, buffer, data.size(), 0), 0);
+    ((uint32_t*)f.rtree.items)[7] = 1000000;
+    FixChecksums(bytes);
+    ASSERT_LT(fencefile_open_memory(&f, buffer, data.size(), FENCEFILE_VERIFY), 0);
+
+    reset();
+    FixChecksums(bytes);
+    ASSERT_EQ(fencefile_open_memory(&f, buffer, data.size(), FENCEFILE_VERIFY), 0);
+
+    free(buffer);
+    remove(path.c_str());
+}
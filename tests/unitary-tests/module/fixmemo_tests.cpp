@@ -0,0 +1,73 @@
+/**
+ * @file fixmemo_tests.cpp
+ *
+ * @author miguel garcia (miguelden@gmail.com)
+ *
+ * @brief
+ *    Tests for Stationary device memo
+ */
+
+#include <gtest/gtest.h>
+#include "fixmemo.h"
+#include "position.h"
+
+using namespace ::std;
+
+/**
+ * Lookup and store
+ */
+TEST(FixMemo, lookup_001)
+{
+    fixmemo_st m;
+    int set1, set2;
+    position_st p = {39.4731325f, -0.3677324f, 63.0f, pos_3d};
+    uint32_t ids[4] = {7, 9, 11, 13};
+    uint32_t out[4];
+    uint32_t n = 0;
+
+    fixmemo_init(&m, 5.0f);
+
+    /* Nothing kept */
+    ASSERT_FALSE(fixmemo_lookup(&m, &set1, 1, &p, out, 4, &n));
+    fixmemo_store(&m, &set1, 1, &p, ids, 3);
+
+    /* Same position */
+    ASSERT_TRUE(fixmemo_lookup(&m, &set1, 1, &p, out, 4, &n));
+    ASSERT_EQ(n, 3u);
+    ASSERT_EQ(out[2], 11u);
+
+    /* Near position, only room for one ID */
+    position_st near = {p.latitude + 0.00001f, p.longitude - 0.00001f, p.altitude + 0.5f, pos_3d};
+    ASSERT_TRUE(fixmemo_lookup(&m, &set1, 1, &near, out, 1, &n));
+    ASSERT_EQ(n, 3u);
+    ASSERT_EQ(out[0], 7u);
+
+    /* Too far, or up */
+    position_st far = {p.latitude + 0.0001f, p.longitude, p.altitude, pos_3d};
+    ASSERT_FALSE(fixmemo_lookup(&m, &set1, 1, &far, out, 4, &n));
+    position_st up = {p.latitude, p.longitude, p.altitude + 6.0f, pos_3d};
+    ASSERT_FALSE(fixmemo_lookup(&m, &set1, 1, &up, out, 4, &n));
+
+    /* Another set, or another version */
+    ASSERT_FALSE(fixmemo_lookup(&m, &set2, 1, &p, out, 4, &n));
+    ASSERT_FALSE(fixmemo_lookup(&m, &set1, 2, &p, out, 4, &n));
+
+    ASSERT_EQ(m.hits, 2u);
+    ASSERT_EQ(m.misses, 5u);
+
+    /* Too many fences are not kept */
+    uint32_t many[FIXMEMO_MAX_IDS + 1] = {0};
+    fixmemo_store(&m, &set1, 1, &p, many, FIXMEMO_MAX_IDS + 1);
+    ASSERT_FALSE(fixmemo_lookup(&m, &set1, 1, &p, out, 4, &n));
+
+    /* Identical positions only */
+    fixmemo_init(&m, 0.0f);
+    fixmemo_store(&m, &set1, 1, &p, ids, 0);
+    ASSERT_TRUE(fixmemo_lookup(&m, &set1, 1, &p, out, 4, &n));
+    ASSERT_EQ(n, 0u);
+    ASSERT_FALSE(fixmemo_lookup(&m, &set1, 1, &near, out, 4, &n));
+    fixmemo_reset(&m);
+    ASSERT_FALSE(fixmemo_lookup(&m, &set1, 1, &p, out, 4, &n));
+    ASSERT_EQ(m.hits, 1u);
+    ASSERT_EQ(m.misses, 2u);
+}
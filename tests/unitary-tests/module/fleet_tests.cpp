@@ -0,0 +1,133 @@
+/**
+ * @file fleet_tests.cpp
+ *
+ * @author miguel garcia (miguelden@gmail.com)
+ *
+ * @brief
+ *    Tests for Fleet engine
+ */
+
+#include <atomic>
+#include <cmath>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include <gtest/gtest.h>
+#include "NmeaUtils.hpp"
+#include "fleet.h"
+#include "geofence.h"
+#include "position.h"
+#include "targetset.h"
+
+using namespace ::std;
+using namespace ::testing;
+
+/** Position of the sentence k of a device. The altitude is the sentence number */
+static GgaType DeviceGGA (uint32_t device, uint32_t k)
+{
+    GgaType gga = {.hours=1, .minutes=2, .seconds=3, .milliseconds=0,
+            .latitude=39.40f + (float)(device % 200) * 0.001f, .longitude=-0.37f, .nsIndicator='N', .ewIndicator='E',
+            .fix=1, .satellites=8, .hdop=1.0, .altitude=(float)k, .geoidal=0.0};
+    return gga;
+}
+
+/** Number of positions reported by the callback */
+static void CountPositions (uint32_t device, const fleet_status_st* status, void* ctx)
+{
+    (void)device;
+    (void)status;
+    (*(atomic<uint32_t>*)ctx)++;
+}
+
+/**
+ * Several threads submit the streams of many devices, in fragments of random size
+ */
+TEST(Fleet, submit_001)
+{
+    const uint32_t devices = 2000;
+    const uint32_t sentences = 6;
+    const uint32_t submitters = 4;
+    fleet_st f;
+    targetset_st t;
+    geofence_set_st fences;
+    position_st center = {39.45f, -0.37f, 0.0f, pos_3d};
+    atomic<uint32_t> positions(0);
+    vector<thread> threads;
+
+    /* The devices below latitude 39.54 are inside the fence */
+    ASSERT_EQ(targetset_init(&t), 0);
+    ASSERT_EQ(geofence_set_init(&fences, 0), 0);
+    ASSERT_EQ(geofence_add(&fences, 5, &center, 10000.0f), 0);
+    ASSERT_EQ(targetset_publish(&t, &fences), 0);
+
+    ASSERT_EQ(fleet_init(&f, 4, &t, CountPositions, &positions), 0);
+    ASSERT_EQ(f.workers, 4u);
+
+    /* Each submitter owns the devices i % submitters, and interleaves them */
+    for (uint32_t w = 0; w < submitters; w++) {
+        threads.emplace_back([&, w]() {
+            mt19937 rng(w);
+            vector<string> streams;
+            vector<size_t> sent;
+
+            for (uint32_t d = w; d < devices; d += submitters) {
+                string s;
+                for (uint32_t k = 0; k < sentences; k++) {
+                    s += NmeaUtils::GenNMEA_GGAsentence(DeviceGGA(d, k));
+                }
+                streams.push_back(s);
+                sent.push_back(0);
+            }
+            for (bool pending = true; pending;) {
+                pending = false;
+                for (size_t i = 0; i < streams.size(); i++) {
+                    size_t n = min<size_t>(rng() % 40 + 1, streams[i].size() - sent[i]);
+                    if (n > 0) {
+                        fleet_submit(&f, (uint32_t)(w + i * submitters), &streams[i][sent[i]], (uint32_t)n);
+                        sent[i] += n;
+                        pending = true;
+                    }
+                }
+            }
+        });
+    }
+    for (auto& th : threads) {
+        th.join();
+    }
+    fleet_flush(&f);
+
+    ASSERT_EQ(fleet_count(&f), devices);
+    ASSERT_EQ(positions.load(), devices * sentences);
+    for (uint32_t d = 0; d < devices; d++) {
+        fleet_status_st status;
+        ASSERT_EQ(fleet_get_status(&f, d, &status), 0);
+        ASSERT_EQ(status.positions, sentences);
+        ASSERT_EQ(status.llh.is_valid, pos_3d);
+
+        /* The last sentence is the last parsed */
+        ASSERT_NEAR(status.llh.altitude, (float)(sentences - 1), 0.01f);
+        ASSERT_NEAR(status.llh.latitude, DeviceGGA(d, 0).latitude, 0.001f);
+
+        float latitude = DeviceGGA(d, 0).latitude;
+        if (fabsf(latitude - 39.54f) > 0.003f) {
+            ASSERT_EQ(status.nfences, (latitude < 39.54f) ? 1u : 0u);
+        }
+    }
+
+    fleet_status_st status;
+    ASSERT_LT(fleet_get_status(&f, devices, &status), 0);
+
+    /* Large submissions are split, and stay in order */
+    string big;
+    for (uint32_t k = 0; big.size() < 3 * FLEET_QUEUE_BYTES; k++) {
+        big += NmeaUtils::GenNMEA_GGAsentence(DeviceGGA(7, k % 1000));
+    }
+    ASSERT_EQ(fleet_submit(&f, 7, big.data(), (uint32_t)big.size()), 0);
+    fleet_flush(&f);
+    ASSERT_EQ(fleet_get_status(&f, 7, &status), 0);
+    ASSERT_GT(status.positions, 1000u);
+
+    fleet_free(&f);
+    targetset_free(&t);
+}
@@ -0,0 +1,205 @@
+/**
+ * @file geodesy_tests.cpp
+ *
+ * @author miguel garcia (miguelden@gmail.com)
+ *
+ * @brief
+ *    Tests for the templated geodesy kernels
+ */
+
+#include <gtest/gtest.h>
+#include "geodesy.hpp"
+#include "position.h"
+
+using namespace ::std;
+
+/**
+ * Derived ellipsoid constants are folded at compile time
+ */
+TEST(Geodesy, test_ellipsoid_constants_001)
+{
+    static_assert(geodesy::ellipsoid<geodesy::wgs84>::a() == 6378137.0, "WGS-84 semimajor axis");
+    static_assert(geodesy::ellipsoid<geodesy::wgs84>::e2() > 0.00669437 &&
+                  geodesy::ellipsoid<geodesy::wgs84>::e2() < 0.00669438, "WGS-84 eccentricity");
+
+    ASSERT_NEAR(geodesy::ellipsoid<geodesy::wgs84>::b(), 6356752.314245, 1e-6);
+    ASSERT_NEAR(geodesy::ellipsoid<geodesy::grs80>::b(), 6356752.314140, 1e-6);
+    ASSERT_NEAR(geodesy::ellipsoid<geodesy::pz90>::b(), 6356751.361796, 1e-6);
+}
+
+/**
+ * Geodetic to ECEF in double precision
+ */
+TEST(Geodesy, test_geodetic_to_ecef_001)
+{
+    double x, y, z;
+    geodesy::geodetic_to_ecef<double>(34.00000048, -117.3335693, 251.702, x, y, z);
+
+    ASSERT_NEAR(x, -2430601.8, 0.1);
+    ASSERT_NEAR(y, -4702442.7, 0.1);
+    ASSERT_NEAR(z, 3546587.4, 0.1);
+}
+
+/**
+ * The float WGS-84 instantiation matches the C implementation
+ */
+TEST(Geodesy, test_geodetic_to_ecef_002)
+{
+    float llh[3] = {34.00000048f, -117.3335693f, 251.702f};
+    float c_xyz[3];
+    float t_xyz[3];
+
+    position_geodetic_to_ecef(llh[0], llh[1], llh[2], &c_xyz[0], &c_xyz[1], &c_xyz[2]);
+    geodesy::geodetic_to_ecef<float>(llh[0], llh[1], llh[2], t_xyz[0], t_xyz[1], t_xyz[2]);
+
+    ASSERT_NEAR(c_xyz[0], t_xyz[0], 1.0f);
+    ASSERT_NEAR(c_xyz[1], t_xyz[1], 1.0f);
+    ASSERT_NEAR(c_xyz[2], t_xyz[2], 1.0f);
+}
+
+/**
+ * Equatorial point lays on the semimajor axis for every ellipsoid
+ */
+TEST(Geodesy, test_geodetic_to_ecef_003)
+{
+    double x, y, z;
+
+    geodesy::geodetic_to_ecef<double, geodesy::wgs84>(0.0, 0.0, 0.0, x, y, z);
+    ASSERT_DOUBLE_EQ(x, 6378137.0);
+    geodesy::geodetic_to_ecef<double, geodesy::pz90>(0.0, 0.0, 0.0, x, y, z);
+    ASSERT_DOUBLE_EQ(x, 6378136.0);
+
+    /* Pole lays on the semiminor axis */
+    geodesy::geodetic_to_ecef<double, geodesy::grs80>(90.0, 0.0, 0.0, x, y, z);
+    ASSERT_NEAR(z, geodesy::ellipsoid<geodesy::grs80>::b(), 1e-6);
+}
+
+/**
+ * ECEF to ENU reads out the rotation matrix entries of the paper
+ */
+TEST(Geodesy, test_ecef_to_enu_001)
+{
+    double llh0[3] = {34.00000048, -117.3335693, 251.702};
+    auto frame = geodesy::enu_frame<double>::from_geodetic(llh0[0], llh0[1], llh0[2]);
+
+    double e, n, u;
+    frame.ecef_to_enu(frame.x0 + 1.0, frame.y0, frame.z0, e, n, u);
+    ASSERT_NEAR(e, 0.88834836, 1e-6);
+    ASSERT_NEAR(n, 0.25676467, 1e-6);
+    ASSERT_NEAR(u, -0.38066927, 1e-6);
+
+    geodesy::ecef_to_enu<double>(frame.x0, frame.y0 + 1.0, frame.z0, llh0[0], llh0[1], llh0[2], e, n, u);
+    ASSERT_NEAR(e, -0.45917011, 1e-6);
+    ASSERT_NEAR(n, 0.49675810, 1e-6);
+    ASSERT_NEAR(u, -0.73647416, 1e-6);
+}
+
+/**
+ * Geodetic to ENU and distance in float, double and long double
+ */
+TEST(Geodesy, test_geodetic_to_enu_001)
+{
+    float ef, nf, uf;
+    double ed, nd, ud;
+    long double el, nl, ul;
+
+    geodesy::geodetic_to_enu<float>(39.47229865871014f, -0.36729115805255386f, 13.0f,
+                                    39.47314319954006f, -0.36773293176583255f, 13.0f, ef, nf, uf);
+    geodesy::geodetic_to_enu<double>(39.47229865871014, -0.36729115805255386, 13.0,
+                                     39.47314319954006, -0.36773293176583255, 13.0, ed, nd, ud);
+    geodesy::geodetic_to_enu<long double>(39.47229865871014L, -0.36729115805255386L, 13.0L,
+                                          39.47314319954006L, -0.36773293176583255L, 13.0L, el, nl, ul);
+
+    ASSERT_NEAR(geodesy::xyz_distance(0.0f, 0.0f, 0.0f, ef, nf, uf), 101.15f, 1.0f);
+    ASSERT_NEAR(geodesy::xyz_distance(0.0, 0.0, 0.0, ed, nd, ud), 101.15, 0.1);
+    ASSERT_NEAR((double)(geodesy::xyz_distance<long double>(0.0L, 0.0L, 0.0L, el, nl, ul)), 101.15, 0.1);
+    ASSERT_NEAR(ed, (double)el, 1e-6);
+    ASSERT_NEAR(nd, (double)nl, 1e-6);
+}
+
+/**
+ * Batch conversion gives the same result as the scalar one
+ */
+TEST(Geodesy, test_geodetic_to_ecef_batch_001)
+{
+    const double lat[4] = {0.0, 45.0, -33.5, 89.9};
+    const double lon[4] = {0.0, 179.0, -70.6, -12.0};
+    const double h[4] = {0.0, 100.0, 520.0, 2800.0};
+    double x[4], y[4], z[4];
+
+    geodesy::geodetic_to_ecef<double>(lat, lon, h, x, y, z, 4);
+
+    for (int i = 0; i < 4; i++) {
+        double xs, ys, zs;
+        geodesy::geodetic_to_ecef<double>(lat[i], lon[i], h[i], xs, ys, zs);
+        ASSERT_DOUBLE_EQ(x[i], xs);
+        ASSERT_DOUBLE_EQ(y[i], ys);
+        ASSERT_DOUBLE_EQ(z[i], zs);
+    }
+}
+
+/**
+ * ECEF to Geodetic in double precision. Round trip over the full globe for every ellipsoid
+ */
+template <typename E>
+static void CheckEcefToGeodeticRoundTrip ()
+{
+    const double heights[] = {-11000.0, -400.0, 0.0, 1500.0, 9000.0, 400000.0, 35786000.0};
+
+    for (double lat = -90.0; lat <= 90.0; lat += 2.5) {
+        for (double lon = -180.0; lon < 180.0; lon += 10.0) {
+            for (auto h : heights) {
+                double x, y, z;
+                double llh[3];
+                geodesy::geodetic_to_ecef<double, E>(lat, lon, h, x, y, z);
+                geodesy::ecef_to_geodetic<double, E>(x, y, z, llh[0], llh[1], llh[2]);
+
+                ASSERT_NEAR(lat, llh[0], 1e-9) << "lat=" << lat << " lon=" << lon << " h=" << h;
+                if (fabs(lat) < 90.0) {
+                    /* -180 and 180 are the same meridian */
+                    ASSERT_NEAR(0.0, remainder(lon - llh[1], 360.0), 1e-9) << "lat=" << lat << " lon=" << lon << " h=" << h;
+                }
+                ASSERT_NEAR(h, llh[2], 1e-4) << "lat=" << lat << " lon=" << lon << " h=" << h;
+            }
+        }
+    }
+}
+
+TEST(Geodesy, test_ecef_to_geodetic_001)
+{
+    CheckEcefToGeodeticRoundTrip<geodesy::wgs84>();
+    CheckEcefToGeodeticRoundTrip<geodesy::grs80>();
+    CheckEcefToGeodeticRoundTrip<geodesy::pz90>();
+}
+
+/**
+ * ENU to Geodetic and batch ECEF to Geodetic
+ */
+TEST(Geodesy, test_enu_to_geodetic_001)
+{
+    const double llh0[3] = {-33.45, -70.66, 520.0};
+    const double enu[4][3] = {{0.0, 0.0, 0.0}, {1000.0, -250.0, 3.0}, {-75000.0, 12000.0, -40.0}, {5.0, 5.0, 5.0}};
+    double x[4], y[4], z[4];
+    double lat[4], lon[4], h[4];
+
+    auto frame = geodesy::enu_frame<double>::from_geodetic(llh0[0], llh0[1], llh0[2]);
+    for (int i = 0; i < 4; i++) {
+        frame.enu_to_ecef(enu[i][0], enu[i][1], enu[i][2], x[i], y[i], z[i]);
+    }
+    geodesy::ecef_to_geodetic<double>(x, y, z, lat, lon, h, 4);
+
+    for (int i = 0; i < 4; i++) {
+        double llh[3];
+        double e, n, u;
+        geodesy::enu_to_geodetic<double>(enu[i][0], enu[i][1], enu[i][2], llh0[0], llh0[1], llh0[2],
+                                         llh[0], llh[1], llh[2]);
+        ASSERT_DOUBLE_EQ(llh[0], lat[i]);
+        ASSERT_DOUBLE_EQ(llh[1], lon[i]);
+        ASSERT_DOUBLE_EQ(llh[2], h[i]);
+
+        geodesy::geodetic_to_enu<double>(llh[0], llh[1], llh[2], llh0[0], llh0[1], llh0[2], e, n, u);
+        ASSERT_NEAR(e, enu[i][0], 1e-6);
+        ASSERT_NEAR(n, enu[i][1], 1e-6);
+        ASSERT_NEAR(u, enu[i][2], 1e-6);
+    }
+}
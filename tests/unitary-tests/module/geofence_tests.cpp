@@ -0,0 +1,496 @@
+/**
+ * @file geofence_tests.cpp
+ *
+ * @author miguel garcia (miguelden@gmail.com)
+ *
+ * @brief
+ *    Tests for Geofence set
+ */
+
+#include <algorithm>
+#include <map>
+#include <cmath>
+#include <random>
+#include <vector>
+#include <gtest/gtest.h>
+#include "geofence.h"
+#include "lazyfence.h"
+#include "position.h"
+#include "target.h"
+
+using namespace ::std;
+
+/** Random fences around Valencia, with radii from 50 m to 50 km */
+static vector<geofence_st> RandomFences (geofence_set_st* s, uint32_t n, mt19937& rng)
+{
+    uniform_real_distribution<float> lat(38.5f, 40.5f);
+    uniform_real_distribution<float> lon(-1.5f, 0.5f);
+    uniform_real_distribution<float> log_radius(log(50.0f), log(50000.0f));
+    vector<geofence_st> fences;
+
+    for (uint32_t i = 0; i < n; i++) {
+        position_st c = {lat(rng), lon(rng), 0.0f, pos_3d};
+        float r = exp(log_radius(rng));
+        EXPECT_EQ(geofence_add(s, 1000 + i, &c, r), 0);
+
+        geofence_st f;
+        f.id = 1000 + i;
+        f.radius_sq = r * r;
+        position_geodetic_to_ecef(c.latitude, c.longitude, c.altitude, &f.ecef[0], &f.ecef[1], &f.ecef[2]);
+        fences.push_back(f);
+    }
+    return fences;
+}
+
+/**
+ * The evaluation finds the same fences as a brute force scan
+ */
+TEST(Geofence, evaluate_001)
+{
+    mt19937 rng(33);
+    geofence_set_st s;
+    uniform_real_distribution<float> lat(38.5f, 40.5f);
+    uniform_real_distribution<float> lon(-1.5f, 0.5f);
+
+    ASSERT_EQ(geofence_set_init(&s, 0), 0);
+    auto fences = RandomFences(&s, 2000, rng);
+    ASSERT_EQ(s.count, 2000u);
+
+    for (int q = 0; q < 500; q++) {
+        float x, y, z;
+        position_geodetic_to_ecef(lat(rng), lon(rng), 0.0f, &x, &y, &z);
+
+        vector<uint32_t> expected;
+        for (auto& f : fences) {
+            float dx = x - f.ecef[0], dy = y - f.ecef[1], dz = z - f.ecef[2];
+            if (dx * dx + dy * dy + dz * dz <= f.radius_sq) {
+                expected.push_back(f.id);
+            }
+        }
+
+        vector<uint32_t> ids(fences.size());
+        uint32_t n = geofence_evaluate(&s, x, y, z, ids.data(), (uint32_t)ids.size());
+        ids.resize(n);
+        sort(ids.begin(), ids.end());
+        sort(expected.begin(), expected.end());
+        ASSERT_EQ(ids, expected);
+    }
+
+    geofence_set_free(&s);
+}
+
+/**
+ * The IDs buffer is not overflowed, and the count includes the fences that do not fit
+ */
+TEST(Geofence, evaluate_002)
+{
+    geofence_set_st s;
+    position_st c = {39.4731325f, -0.3677324f, 8.0f, pos_3d};
+    uint32_t ids[4] = {0, 0, 0, 0xdeadbeef};
+    float x, y, z;
+
+    ASSERT_EQ(geofence_set_init(&s, 2), 0);
+    for (uint32_t i = 0; i < 40; i++) {
+        ASSERT_EQ(geofence_add(&s, i, &c, 10.0f + i), 0);
+    }
+    position_geodetic_to_ecef(c.latitude, c.longitude, c.altitude, &x, &y, &z);
+
+    ASSERT_EQ(geofence_evaluate(&s, x, y, z, ids, 3), 40u);
+    ASSERT_EQ(ids[3], 0xdeadbeef);
+    ASSERT_EQ(geofence_evaluate(&s, x, y, z, NULL, 0), 40u);
+
+    /* Nothing around the antipode */
+    ASSERT_EQ(geofence_evaluate(&s, -x, -y, -z, ids, 3), 0u);
+
+    ASSERT_LT(geofence_add(&s, 99, &c, -1.0f), 0);
+    ASSERT_LT(geofence_add(&s, 99, NULL, 1.0f), 0);
+
+    geofence_set_free(&s);
+}
+
+/**
+ * The targets of the target table are fences with the target index as ID
+ */
+TEST(Geofence, add_targets_001)
+{
+    geofence_set_st s;
+    uint32_t ids[8];
+    const target_entry_st* t = target_get_entry(0);
+
+    ASSERT_EQ(geofence_set_init(&s, 0), 0);
+    ASSERT_EQ(geofence_add_targets(&s), 0);
+    ASSERT_EQ(s.count, target_get_count());
+
+    ASSERT_EQ(geofence_evaluate(&s, t->ecef[0], t->ecef[1], t->ecef[2], ids, 8), 1u);
+    ASSERT_EQ(ids[0], 0u);
+    ASSERT_EQ(geofence_evaluate(&s, t->ecef[0] + t->range * 1.01f, t->ecef[1], t->ecef[2], ids, 8), 0u);
+
+    geofence_set_free(&s);
+}
+
+/**
+ * Grid index with 100k fences, and fences added after an evaluation
+ */
+TEST(Geofence, evaluate_003)
+{
+    mt19937 rng(34);
+    geofence_set_st s;
+    uniform_real_distribution<float> lat(38.5f, 40.5f);
+    uniform_real_distribution<float> lon(-1.5f, 0.5f);
+    vector<uint32_t> ids(100000);
+
+    ASSERT_EQ(geofence_set_init(&s, 100000), 0);
+    auto fences = RandomFences(&s, 50000, rng);
+    ASSERT_EQ(geofence_build(&s), 0);
+    ASSERT_GT(s.grid.levels, 0u);
+
+    /* Fences added after the grid was built are inserted in its cells */
+    auto more = RandomFences(&s, 50000, rng);
+    fences.insert(fences.end(), more.begin(), more.end());
+
+    for (int q = 0; q < 200; q++) {
+        float x, y, z;
+        position_geodetic_to_ecef(lat(rng), lon(rng), 0.0f, &x, &y, &z);
+
+        uint32_t expected = 0;
+        for (auto& f : fences) {
+            float dx = x - f.ecef[0], dy = y - f.ecef[1], dz = z - f.ecef[2];
+            expected += (dx * dx + dy * dy + dz * dz <= f.radius_sq) ? 1 : 0;
+        }
+        ASSERT_EQ(geofence_evaluate(&s, x, y, z, ids.data(), (uint32_t)ids.size()), expected);
+        ASSERT_FALSE(s.dirty);
+    }
+
+    geofence_set_free(&s);
+}
+
+/**
+ * Mixed set of circular and polygon fences, with every index of the circular fences
+ */
+TEST(Geofence, evaluate_004)
+{
+    mt19937 rng(37);
+    geofence_set_st s;
+    uniform_real_distribution<float> lat(38.5f, 40.5f);
+    uniform_real_distribution<float> lon(-1.5f, 0.5f);
+    uniform_real_distribution<float> size(0.001f, 0.3f);
+    vector<polyfence_st> polygons(300);
+    vector<uint32_t> ids(10000);
+
+    ASSERT_EQ(geofence_set_init(&s, 0), 0);
+    auto fences = RandomFences(&s, 3000, rng);
+    for (uint32_t i = 0; i < polygons.size(); i++) {
+        float clat = lat(rng), clon = lon(rng), d = size(rng);
+        const position_st ring[] = {
+            {clat - d, clon - d, 0.0f, pos_2d},
+            {clat - d, clon + d, 0.0f, pos_2d},
+            {clat + d, clon, 0.0f, pos_2d},
+            {clat, clon, 0.0f, pos_2d},
+        };
+        ASSERT_EQ(geofence_add_polygon(&s, 5000 + i, ring, 4), 0);
+        ASSERT_EQ(polyfence_init(&polygons[i], 5000 + i, ring, 4), 0);
+    }
+    ASSERT_EQ(s.npolygons, 300u);
+    ASSERT_LT(geofence_add_polygon(&s, 1, NULL, 0), 0);
+
+    for (int q = 0; q < 300; q++) {
+        float x, y, z;
+        vector<uint32_t> expected;
+        position_geodetic_to_ecef(lat(rng), lon(rng), 50.0f, &x, &y, &z);
+
+        for (auto& f : fences) {
+            float dx = x - f.ecef[0], dy = y - f.ecef[1], dz = z - f.ecef[2];
+            if (dx * dx + dy * dy + dz * dz <= f.radius_sq) {
+                expected.push_back(f.id);
+            }
+        }
+        for (auto& p : polygons) {
+            if (polyfence_contains(&p, x, y, z)) {
+                expected.push_back(p.id);
+            }
+        }
+        sort(expected.begin(), expected.end());
+
+        for (int index = geofence_index_grid; index <= geofence_index_scan; index++) {
+            geofence_set_index(&s, (geofence_index)index);
+            uint32_t n = geofence_evaluate(&s, x, y, z, ids.data(), (uint32_t)ids.size());
+            ASSERT_EQ(n, expected.size());
+            sort(ids.begin(), ids.begin() + n);
+            ASSERT_TRUE(equal(expected.begin(), expected.end(), ids.begin()));
+        }
+    }
+    ASSERT_EQ(s.grid.levels, 0u);
+    ASSERT_EQ(s.rtree.n, 300u);
+    ASSERT_EQ(s.scan.n, 3000u);
+
+    for (auto& p : polygons) {
+        polyfence_free(&p);
+    }
+    geofence_set_free(&s);
+}
+
+/**
+ * Distance to the nearest fence boundary with every index, compared with a brute force search
+ */
+TEST(Geofence, margin_001)
+{
+    mt19937 rng(39);
+    geofence_set_st s;
+    uniform_real_distribution<float> lat(38.5f, 40.5f);
+    uniform_real_distribution<float> lon(-1.5f, 0.5f);
+    vector<polyfence_st> polygons(50);
+    const float limit = 3000.0f;
+
+    ASSERT_EQ(geofence_set_init(&s, 0), 0);
+    auto fences = RandomFences(&s, 2000, rng);
+    for (uint32_t i = 0; i < polygons.size(); i++) {
+        float clat = lat(rng), clon = lon(rng);
+        const position_st ring[] = {
+            {clat - 0.01f, clon - 0.01f, 0.0f, pos_2d},
+            {clat - 0.01f, clon + 0.01f, 0.0f, pos_2d},
+            {clat + 0.01f, clon, 0.0f, pos_2d},
+        };
+        ASSERT_EQ(geofence_add_polygon(&s, 5000 + i, ring, 3), 0);
+        ASSERT_EQ(polyfence_init(&polygons[i], 5000 + i, ring, 3), 0);
+    }
+
+    for (int q = 0; q < 200; q++) {
+        float x, y, z;
+        double expected = limit;
+        position_geodetic_to_ecef(lat(rng), lon(rng), 50.0f, &x, &y, &z);
+
+        for (auto& f : fences) {
+            double d = sqrt(pow((double)x - f.ecef[0], 2) + pow((double)y - f.ecef[1], 2) +
+                            pow((double)z - f.ecef[2], 2));
+            expected = fmin(expected, fabs(d - sqrt((double)f.radius_sq)));
+        }
+        for (auto& p : polygons) {
+            expected = fmin(expected, polyfence_distance(&p, x, y, z));
+        }
+
+        for (int index = geofence_index_grid; index <= geofence_index_scan; index++) {
+            geofence_set_index(&s, (geofence_index)index);
+            float margin = geofence_margin(&s, x, y, z, limit);
+            /* Never above the distance, and exact without the grid */
+            ASSERT_LE(margin, expected + 1.0);
+            ASSERT_GE(margin, 0.0f);
+            if (index != geofence_index_grid) {
+                ASSERT_NEAR(margin, expected, 1.0);
+            }
+        }
+    }
+
+    for (auto& p : polygons) {
+        polyfence_free(&p);
+    }
+    geofence_set_free(&s);
+}
+
+/** Fence of the reference of the edit tests: a circle, or a triangle if the radius is negative */
+struct EditFence {
+    position_st center;
+    float radius;
+};
+
+/** Triangle of a polygon fence of the edit tests */
+static vector<position_st> Triangle (const position_st& c)
+{
+    return {{c.latitude - 0.01f, c.longitude - 0.01f, 0.0f, pos_2d},
+            {c.latitude - 0.01f, c.longitude + 0.01f, 0.0f, pos_2d},
+            {c.latitude + 0.01f, c.longitude, 0.0f, pos_2d}};
+}
+
+/**
+ * Random adds, removes and resizes after the indexes are built, with every index: the evaluation finds the same fences
+ * as a set built from scratch, and the set is only built again once in a while
+ */
+TEST(Geofence, edit_001)
+{
+    uniform_real_distribution<float> lat(38.5f, 40.5f);
+    uniform_real_distribution<float> lon(-1.5f, 0.5f);
+    uniform_real_distribution<float> log_radius(log(50.0f), log(20000.0f));
+    vector<uint32_t> ids(10000), expected(10000);
+
+    for (int index = geofence_index_grid; index <= geofence_index_scan; index++) {
+        mt19937 rng(42 + index);
+        geofence_set_st s;
+        map<uint32_t, EditFence> reference;
+        uint32_t next_id = 0;
+        uint32_t builds = 0;
+
+        auto add = [&](bool polygon) {
+            EditFence e = {{lat(rng), lon(rng), 0.0f, pos_3d}, polygon ? -1.0f : exp(log_radius(rng))};
+            if (polygon) {
+                auto ring = Triangle(e.center);
+                ASSERT_EQ(geofence_add_polygon(&s, next_id, ring.data(), 3), 0);
+            } else {
+                ASSERT_EQ(geofence_add(&s, next_id, &e.center, e.radius), 0);
+            }
+            reference[next_id++] = e;
+        };
+        auto random_id = [&]() {
+            auto it = reference.begin();
+            advance(it, uniform_int_distribution<size_t>(0, reference.size() - 1)(rng));
+            return it->first;
+        };
+
+        ASSERT_EQ(geofence_set_init(&s, 0), 0);
+        geofence_set_index(&s, (geofence_index)index);
+        for (int i = 0; i < 3000; i++) {
+            add(i % 60 == 0);
+        }
+        ASSERT_EQ(geofence_build(&s), 0);
+
+        for (int round = 0; round < 40; round++) {
+            for (int e = 0; e < 50; e++) {
+                int op = uniform_int_distribution<int>(0, 9)(rng);
+                if (op < 3) {
+                    add(op == 0);
+                } else if (op < 6) {
+                    uint32_t id = random_id();
+                    ASSERT_EQ(geofence_remove(&s, id), 0);
+                    reference.erase(id);
+                } else {
+                    uint32_t id = random_id();
+                    float r = exp(log_radius(rng));
+                    if (reference[id].radius < 0.0f) {
+                        ASSERT_LT(geofence_set_radius(&s, id, r), 0);
+                    } else {
+                        ASSERT_EQ(geofence_set_radius(&s, id, r), 0);
+                        reference[id].radius = r;
+                    }
+                }
+                if (s.dirty) {
+                    ASSERT_EQ(geofence_build(&s), 0);
+                    builds++;
+                }
+            }
+
+            /* Set built from scratch */
+            geofence_set_st fresh;
+            ASSERT_EQ(geofence_set_init(&fresh, 0), 0);
+            geofence_set_index(&fresh, (geofence_index)index);
+            for (auto& it : reference) {
+                if (it.second.radius < 0.0f) {
+                    auto ring = Triangle(it.second.center);
+                    ASSERT_EQ(geofence_add_polygon(&fresh, it.first, ring.data(), 3), 0);
+                } else {
+                    ASSERT_EQ(geofence_add(&fresh, it.first, &it.second.center, it.second.radius), 0);
+                }
+            }
+
+            for (int q = 0; q < 50; q++) {
+                float x, y, z;
+                position_geodetic_to_ecef(lat(rng), lon(rng), 20.0f, &x, &y, &z);
+
+                uint32_t ne = geofence_evaluate(&fresh, x, y, z, expected.data(), (uint32_t)expected.size());
+                uint32_t n = geofence_evaluate(&s, x, y, z, ids.data(), (uint32_t)ids.size());
+                ASSERT_FALSE(s.dirty);
+                ASSERT_EQ(n, ne);
+                sort(expected.begin(), expected.begin() + ne);
+                sort(ids.begin(), ids.begin() + n);
+                ASSERT_TRUE(equal(expected.begin(), expected.begin() + ne, ids.begin()));
+                ASSERT_LE(geofence_margin(&s, x, y, z, 2000.0f), geofence_margin(&fresh, x, y, z, 2000.0f) + 1.0f);
+            }
+            geofence_set_free(&fresh);
+        }
+
+        /* 2000 edits over about 3000 fences */
+        ASSERT_GT(builds, 0u);
+        ASSERT_LT(builds, 20u);
+        ASSERT_LT(geofence_remove(&s, next_id + 1), 0);
+        geofence_set_free(&s);
+    }
+}
+
+/**
+ * Batches of edits, and edits seen by a lazy evaluator
+ */
+TEST(Geofence, edit_002)
+{
+    geofence_set_st s;
+    lazyfence_st l;
+    position_st c = {39.4731325f, -0.3677324f, 8.0f, pos_3d};
+    auto ring = Triangle(c);
+    uint32_t ids[8];
+    float x, y, z;
+
+    position_geodetic_to_ecef(c.latitude, c.longitude, c.altitude, &x, &y, &z);
+    ASSERT_EQ(geofence_set_init(&s, 0), 0);
+    ASSERT_EQ(geofence_add(&s, 1, &c, 100.0f), 0);
+    ASSERT_EQ(geofence_build(&s), 0);
+
+    /* A small batch updates the indexes */
+    geofence_edit_st small[] = {
+        {geofence_op_add, 2, c, 200.0f, NULL, 0},
+        {geofence_op_add_polygon, 3, c, 0.0f, ring.data(), 3},
+        {geofence_op_radius, 1, c, 50.0f, NULL, 0},
+        {geofence_op_remove, 2, c, 0.0f, NULL, 0},
+    };
+    ASSERT_EQ(geofence_apply(&s, small, 4), 4u);
+    ASSERT_FALSE(s.dirty);
+    ASSERT_EQ(s.removed, 1u);
+    ASSERT_EQ(geofence_evaluate(&s, x, y, z, ids, 8), 2u);
+    sort(ids, ids + 2);
+    ASSERT_EQ(ids[0], 1u);
+    ASSERT_EQ(ids[1], 3u);
+
+    /* Polygons have no radius, and the batch stops at the first failed edit */
+    geofence_edit_st failed[] = {
+        {geofence_op_radius, 3, c, 10.0f, NULL, 0},
+        {geofence_op_remove, 1, c, 0.0f, NULL, 0},
+    };
+    ASSERT_EQ(geofence_apply(&s, failed, 2), 0u);
+    ASSERT_LT(geofence_set_radius(&s, 1, -1.0f), 0);
+    ASSERT_LT(geofence_remove(&s, 99), 0);
+
+    /* A large batch builds the set once */
+    vector<geofence_edit_st> large;
+    for (uint32_t i = 0; i < 500; i++) {
+        large.push_back({geofence_op_add, 100 + i, c, 10.0f + i, NULL, 0});
+    }
+    ASSERT_EQ(geofence_apply(&s, large.data(), (uint32_t)large.size()), 500u);
+    ASSERT_TRUE(s.dirty);
+    ASSERT_EQ(geofence_evaluate(&s, x, y, z, ids, 8), 502u);
+    ASSERT_FALSE(s.dirty);
+    ASSERT_EQ(s.removed, 0u);
+    ASSERT_EQ(s.count, 501u);
+
+    /* The lazy evaluator finds the removed fence */
+    lazyfence_init(&l, 0.0f);
+    ASSERT_EQ(lazyfence_evaluate(&l, &s, &c, 0.0, ids, 8), 502u);
+    ASSERT_EQ(lazyfence_evaluate(&l, &s, &c, 1.0, ids, 8), 502u);
+    ASSERT_EQ(l.evaluations, 1u);
+    ASSERT_EQ(geofence_remove(&s, 3), 0);
+    ASSERT_EQ(lazyfence_evaluate(&l, &s, &c, 2.0, ids, 8), 501u);
+    ASSERT_EQ(l.evaluations, 2u);
+
+    geofence_set_free(&s);
+}
+
+/**
+ * A fence as wide as the cells of a level is registered in 8 cells at most, with the padding of its box
+ */
+TEST(Geofence, grid_cells_001)
+{
+    mt19937 rng(11);
+    uniform_real_distribution<float> lat(38.5f, 40.5f);
+    uniform_real_distribution<float> lon(-1.5f, 0.5f);
+    const uint32_t fences = 2000;
+    geofence_set_st s;
+    uint32_t items = 0;
+
+    ASSERT_EQ(geofence_set_init(&s, fences), 0);
+    for (uint32_t i = 0; i < fences; i++) {
+        position_st c = {lat(rng), lon(rng), 0.0f, pos_3d};
+        ASSERT_EQ(geofence_add(&s, i, &c, GEOFENCE_GRID_MIN_CELL * (float)(1 << (i % 4)) / 2.0f), 0);
+    }
+    ASSERT_EQ(geofence_build(&s), 0);
+
+    for (uint32_t c = 0; c <= s.grid.mask; c++) {
+        items += (s.grid.cells[c].key != 0) ? s.grid.cells[c].count : 0;
+    }
+    ASSERT_LE(items, 8 * fences);
+
+    geofence_set_free(&s);
+}
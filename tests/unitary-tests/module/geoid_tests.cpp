@@ -0,0 +1,270 @@
+/**
+ * @file geoid_tests.cpp
+ *
+ * @author miguel garcia (miguelden@gmail.com)
+ *
+ * @brief
+ *    Tests for Geoid component
+ */
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <unistd.h>
+#include <gtest/gtest.h>
+#include "NmeaUtils.hpp"
+#include "geoid.h"
+#include "app.h"
+#include "fleet.h"
+#include "userif.h"
+
+using namespace ::std;
+using namespace ::testing;
+
+/**
+ * Build a grid file in memory. The undulation of each sample is lat + lon / 10, so the bilinear interpolation is exact
+ * inside the grid.
+ * @param lat0  Latitude of the first row
+ * @param lon0  Longitude of the first column
+ * @param d     Grid spacing in degrees
+ * @param rows  Number of rows
+ * @param cols  Number of columns
+ * @return  Grid file contents as 16-bit words
+ */
+static vector<int16_t> BuildGrid (
+        float lat0,
+        float lon0,
+        float d,
+        uint32_t rows,
+        uint32_t cols
+)
+{
+    vector<int16_t> data(GEOID_GRID_HEADER_SZ / 2 + rows * cols, 0);
+    uint8_t* p = (uint8_t*)data.data();
+    uint32_t version = GEOID_GRID_VERSION;
+    uint32_t header_sz = GEOID_GRID_HEADER_SZ;
+    float scale = 0.01f;
+    float offset = 0.0f;
+
+    memcpy(&p[0], GEOID_GRID_MAGIC, 8);
+    memcpy(&p[8], &version, 4);
+    memcpy(&p[12], &header_sz, 4);
+    memcpy(&p[16], &lat0, 4);
+    memcpy(&p[20], &lon0, 4);
+    memcpy(&p[24], &d, 4);
+    memcpy(&p[28], &d, 4);
+    memcpy(&p[32], &rows, 4);
+    memcpy(&p[36], &cols, 4);
+    memcpy(&p[40], &scale, 4);
+    memcpy(&p[44], &offset, 4);
+
+    int16_t* samples = &data[GEOID_GRID_HEADER_SZ / 2];
+    for (uint32_t r = 0; r < rows; r++) {
+        for (uint32_t c = 0; c < cols; c++) {
+            float n = (lat0 + r * d) + (lon0 + c * d) / 10.0f;
+            samples[r * cols + c] = (int16_t)lroundf(n / scale);
+        }
+    }
+
+    return data;
+}
+
+/**
+ * Bilinear interpolation inside the grid
+ */
+TEST(Geoid, get_undulation_001)
+{
+    auto data = BuildGrid(30.0f, -10.0f, 0.25f, 81, 161);
+    geoid_st g;
+
+    ASSERT_EQ(geoid_init(&g, data.data(), data.size() * 2), 0);
+    ASSERT_EQ(g.wrap_cols, 0u);
+
+    ASSERT_NEAR(geoid_get_undulation(&g, NULL, 30.0f, -10.0f), 29.0f, 0.01f);
+    ASSERT_NEAR(geoid_get_undulation(&g, NULL, 39.4731325f, -0.3677324f), 39.4731325f - 0.03677324f, 0.01f);
+    ASSERT_NEAR(geoid_get_undulation(&g, NULL, 50.0f, 30.0f), 53.0f, 0.01f);
+
+    /* Out of the grid is clamped to the border */
+    ASSERT_NEAR(geoid_get_undulation(&g, NULL, 60.0f, 40.0f), 53.0f, 0.01f);
+    ASSERT_NEAR(geoid_get_undulation(&g, NULL, 0.0f, -20.0f), 29.0f, 0.01f);
+}
+
+/**
+ * Consecutive fixes in the same cell are served by the device cache
+ */
+TEST(Geoid, get_undulation_cache_001)
+{
+    auto data = BuildGrid(30.0f, -10.0f, 0.25f, 81, 161);
+    geoid_st g;
+    geoid_cache_st c;
+
+    ASSERT_EQ(geoid_init(&g, data.data(), data.size() * 2), 0);
+    geoid_cache_reset(&c);
+
+    for (int i = 0; i < 10; i++) {
+        float lat = 39.4731325f + i * 0.0001f;
+        float lon = -0.3677324f + i * 0.0001f;
+        ASSERT_EQ(geoid_get_undulation(&g, &c, lat, lon), geoid_get_undulation(&g, NULL, lat, lon));
+    }
+    ASSERT_EQ(c.misses, 1u);
+    ASSERT_EQ(c.hits, 9u);
+
+    /* Next cell */
+    ASSERT_NEAR(geoid_get_undulation(&g, &c, 39.8f, -0.3677324f), 39.8f - 0.03677324f, 0.01f);
+    ASSERT_EQ(c.misses, 2u);
+}
+
+/**
+ * Global grids wrap around the antimeridian
+ */
+TEST(Geoid, get_undulation_wrap_001)
+{
+    auto data = BuildGrid(-90.0f, -180.0f, 1.0f, 181, 360);
+    geoid_st g;
+
+    ASSERT_EQ(geoid_init(&g, data.data(), data.size() * 2), 0);
+    ASSERT_EQ(g.wrap_cols, 360u);
+
+    /* Between the last column (179) and the first one (-180) */
+    float east = 10.0f + 179.0f / 10.0f;
+    float west = 10.0f - 180.0f / 10.0f;
+    ASSERT_NEAR(geoid_get_undulation(&g, NULL, 10.0f, 179.5f), (east + west) / 2.0f, 0.01f);
+    ASSERT_NEAR(geoid_get_undulation(&g, NULL, 10.0f, 181.0f), geoid_get_undulation(&g, NULL, 10.0f, -179.0f), 0.01f);
+    ASSERT_NEAR(geoid_get_undulation(&g, NULL, 10.0f, -540.0f), west, 0.01f);
+}
+
+/**
+ * Invalid grids are rejected
+ */
+TEST(Geoid, init_001)
+{
+    auto data = BuildGrid(30.0f, -10.0f, 0.25f, 8, 8);
+    geoid_st g;
+
+    ASSERT_EQ(geoid_init(&g, data.data(), 10), -1);
+    ASSERT_EQ(geoid_init(&g, data.data(), data.size() * 2 - 2), -1);
+    ASSERT_EQ(geoid_init(&g, NULL, 0), -1);
+
+    auto bad_magic = data;
+    ((uint8_t*)bad_magic.data())[0] = 'X';
+    ASSERT_EQ(geoid_init(&g, bad_magic.data(), bad_magic.size() * 2), -1);
+
+    auto bad_version = data;
+    ((uint8_t*)bad_version.data())[8] = 2;
+    ASSERT_EQ(geoid_init(&g, bad_version.data(), bad_version.size() * 2), -1);
+}
+
+/**
+ * Grid file mapped in memory
+ */
+TEST(Geoid, open_001)
+{
+    auto data = BuildGrid(30.0f, -10.0f, 0.25f, 81, 161);
+    char path[] = "/tmp/geoid_tests_XXXXXX";
+    int fd = mkstemp(path);
+    ASSERT_GE(fd, 0);
+    ASSERT_EQ(write(fd, data.data(), data.size() * 2), (ssize_t)(data.size() * 2));
+    close(fd);
+
+    geoid_st g;
+    ASSERT_EQ(geoid_open(&g, path), 0);
+    ASSERT_TRUE(g.map != NULL);
+    ASSERT_NEAR(geoid_get_undulation(&g, NULL, 50.0f, 30.0f), 53.0f, 0.01f);
+    geoid_close(&g);
+    unlink(path);
+
+    ASSERT_EQ(geoid_open(&g, "/nonexistent/geoid.bin"), -1);
+}
+
+/**
+ * The geoidal separation moves the device along the vertical. The target is at 57.5 m of ellipsoidal height (8 m MSL
+ * plus 49.5 m of separation), and a device at -80 m MSL is on range only when its separation is applied.
+ */
+TEST(Geoid, app_step_001)
+{
+    /* Grid with undulation ~ 39.47 around the target */
+    auto data = BuildGrid(30.0f, -10.0f, 0.25f, 81, 161);
+    geoid_st g;
+    ASSERT_EQ(geoid_init(&g, data.data(), data.size() * 2), 0);
+
+    GgaType gga = {.hours=1, .minutes=2, .seconds=3, .milliseconds=4,
+            .latitude=39.4731325f, .longitude=-0.3677324f, .nsIndicator='N', .ewIndicator='E',
+            .fix=1, .satellites=10, .hdop=1.0, .altitude=-80.0, .geoidal=0.0};
+    string nmea = NmeaUtils::GenNMEA_GGAsentence(gga, false);
+
+    app_init();
+    for (auto ch : nmea) {
+        app_step(ch);
+    }
+    ASSERT_EQ(userif_get_target_reached(), 0);
+
+    app_set_geoid(&g);
+    for (auto ch : nmea) {
+        app_step(ch);
+    }
+    ASSERT_GT(userif_get_target_reached(), 0);
+
+    /* The separation reported by the GPS module has priority over the grid, even if it is zero */
+    nmea = NmeaUtils::GenNMEA_GGAsentence(gga);
+    for (auto ch : nmea) {
+        app_step(ch);
+    }
+    ASSERT_EQ(userif_get_target_reached(), 0);
+
+    gga.geoidal = -30.0f;
+    nmea = NmeaUtils::GenNMEA_GGAsentence(gga);
+    for (auto ch : nmea) {
+        app_step(ch);
+    }
+    ASSERT_EQ(userif_get_target_reached(), 0);
+
+    app_set_geoid(NULL);
+}
+
+/**
+ * The fleet engine takes the separation from the grid only for the devices that do not report it, and keeps the MSL
+ * altitude without a grid
+ */
+TEST(Geoid, fleet_001)
+{
+    auto data = BuildGrid(30.0f, -10.0f, 0.25f, 81, 161);
+    const float undulation = 39.4731325f - 0.03677324f;
+    geoid_st g;
+    fleet_st f;
+    fleet_st plain;
+    fleet_status_st status;
+
+    ASSERT_EQ(geoid_init(&g, data.data(), data.size() * 2), 0);
+    ASSERT_EQ(fleet_init(&f, 2, NULL, NULL, NULL), 0);
+    ASSERT_EQ(fleet_init(&plain, 1, NULL, NULL, NULL), 0);
+    fleet_set_geoid(&f, &g);
+
+    GgaType gga = {.hours=1, .minutes=2, .seconds=3, .milliseconds=4,
+            .latitude=39.4731325f, .longitude=-0.3677324f, .nsIndicator='N', .ewIndicator='E',
+            .fix=1, .satellites=10, .hdop=1.0, .altitude=10.0, .geoidal=0.0};
+    string missing = NmeaUtils::GenNMEA_GGAsentence(gga, false);
+    string zero = NmeaUtils::GenNMEA_GGAsentence(gga);
+    gga.geoidal = 50.0f;
+    string reported = NmeaUtils::GenNMEA_GGAsentence(gga);
+
+    ASSERT_EQ(fleet_submit(&f, 1, missing.data(), missing.size()), 0);
+    ASSERT_EQ(fleet_submit(&f, 2, zero.data(), zero.size()), 0);
+    ASSERT_EQ(fleet_submit(&f, 3, reported.data(), reported.size()), 0);
+    ASSERT_EQ(fleet_submit(&plain, 1, missing.data(), missing.size()), 0);
+    fleet_flush(&f);
+    fleet_flush(&plain);
+
+    ASSERT_EQ(fleet_get_status(&f, 1, &status), 0);
+    ASSERT_NEAR(status.llh.altitude, 10.0f + undulation, 0.01f);
+    ASSERT_EQ(fleet_get_status(&f, 2, &status), 0);
+    ASSERT_NEAR(status.llh.altitude, 10.0f, 0.01f);
+    ASSERT_EQ(fleet_get_status(&f, 3, &status), 0);
+    ASSERT_NEAR(status.llh.altitude, 60.0f, 0.01f);
+    ASSERT_EQ(fleet_get_status(&plain, 1, &status), 0);
+    ASSERT_NEAR(status.llh.altitude, 10.0f, 0.01f);
+
+    fleet_free(&f);
+    fleet_free(&plain);
+}
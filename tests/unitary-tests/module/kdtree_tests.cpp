@@ -0,0 +1,180 @@
+/**
+ * @file kdtree_tests.cpp
+ *
+ * @author miguel garcia (miguelden@gmail.com)
+ *
+ * @brief
+ *    Tests for ECEF k-d tree
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+#include <gtest/gtest.h>
+#include "kdtree.h"
+#include "position.h"
+#include "target.h"
+
+using namespace ::std;
+
+/** Random positions around the world, with some duplicates */
+static vector<position_st> RandomPositions (uint32_t n, mt19937& rng)
+{
+    uniform_real_distribution<float> lat(-89.0f, 89.0f);
+    uniform_real_distribution<float> lon(-180.0f, 180.0f);
+    uniform_real_distribution<float> alt(0.0f, 2000.0f);
+    vector<position_st> points;
+
+    for (uint32_t i = 0; i < n; i++) {
+        if (i % 17 == 16) {
+            points.push_back(points[i / 2]);
+        } else {
+            points.push_back({lat(rng), lon(rng), alt(rng), pos_3d});
+        }
+    }
+    return points;
+}
+
+/** ECEF distances from a position to every point, sorted */
+static vector<float> BruteForce (const vector<position_st>& points, const float q[3])
+{
+    vector<float> d;
+    for (auto& p : points) {
+        float x, y, z;
+        position_geodetic_to_ecef(p.latitude, p.longitude, p.altitude, &x, &y, &z);
+        d.push_back(sqrtf((x - q[0]) * (x - q[0]) + (y - q[1]) * (y - q[1]) + (z - q[2]) * (z - q[2])));
+    }
+    sort(d.begin(), d.end());
+    return d;
+}
+
+/**
+ * k nearest targets, compared with a brute force search
+ */
+TEST(KdTree, knn_001)
+{
+    mt19937 rng(35);
+    kdtree_st t;
+    auto points = RandomPositions(5000, rng);
+    kdtree_result_st out[16];
+
+    ASSERT_EQ(kdtree_build(&t, points.data(), (uint32_t)points.size(), 4), 0);
+    ASSERT_EQ(t.n, 5000u);
+
+    for (int i = 0; i < 200; i++) {
+        float q[3];
+        position_st p = RandomPositions(1, rng)[0];
+        position_geodetic_to_ecef(p.latitude, p.longitude, p.altitude, &q[0], &q[1], &q[2]);
+
+        auto expected = BruteForce(points, q);
+        ASSERT_EQ(kdtree_knn(&t, q[0], q[1], q[2], 16, out), 16u);
+        for (int j = 0; j < 16; j++) {
+            ASSERT_NEAR(out[j].dist, expected[j], 1.0f);
+            if (j > 0) {
+                ASSERT_LE(out[j - 1].dist, out[j].dist);
+            }
+        }
+    }
+
+    /* More neighbours than targets */
+    vector<kdtree_result_st> all(6000);
+    ASSERT_EQ(kdtree_knn(&t, 0.0f, 0.0f, 0.0f, 6000, all.data()), 5000u);
+    ASSERT_EQ(kdtree_knn(&t, 0.0f, 0.0f, 0.0f, 0, all.data()), 0u);
+
+    kdtree_free(&t);
+}
+
+/**
+ * Radius search, compared with a brute force search
+ */
+TEST(KdTree, radius_001)
+{
+    mt19937 rng(36);
+    kdtree_st t;
+    auto points = RandomPositions(5000, rng);
+    vector<kdtree_result_st> out(5000);
+
+    ASSERT_EQ(kdtree_build(&t, points.data(), (uint32_t)points.size(), 1), 0);
+
+    for (int i = 0; i < 200; i++) {
+        float q[3];
+        position_geodetic_to_ecef(points[i].latitude, points[i].longitude, points[i].altitude, &q[0], &q[1], &q[2]);
+
+        auto expected = BruteForce(points, q);
+        float radius = 300000.0f;
+        uint32_t n_expected = (uint32_t)(upper_bound(expected.begin(), expected.end(), radius) - expected.begin());
+
+        uint32_t n = kdtree_radius(&t, q[0], q[1], q[2], radius, out.data(), (uint32_t)out.size());
+        ASSERT_NEAR((double)n, (double)n_expected, 1.0);
+        ASSERT_GE(n, 1u);
+        for (uint32_t j = 0; j < n; j++) {
+            ASSERT_LE(out[j].dist, radius);
+        }
+        ASSERT_EQ(kdtree_radius(&t, q[0], q[1], q[2], radius, out.data(), 0), n);
+    }
+
+    kdtree_free(&t);
+}
+
+/**
+ * The parallel build gives the same tree as the serial one, and the batch queries the same results
+ */
+TEST(KdTree, batch_001)
+{
+    mt19937 rng(37);
+    kdtree_st t1, t4;
+    auto points = RandomPositions(20000, rng);
+    const uint32_t nq = 1000, k = 5;
+    vector<float> queries;
+    vector<kdtree_result_st> out(nq * k);
+    vector<uint32_t> counts(nq);
+
+    ASSERT_EQ(kdtree_build(&t1, points.data(), (uint32_t)points.size(), 1), 0);
+    ASSERT_EQ(kdtree_build(&t4, points.data(), (uint32_t)points.size(), 4), 0);
+    for (uint32_t i = 0; i < t1.n; i++) {
+        ASSERT_EQ(t1.nodes[i].id, t4.nodes[i].id);
+        ASSERT_EQ(t1.axes[i], t4.axes[i]);
+    }
+
+    for (auto& p : RandomPositions(nq, rng)) {
+        float q[3];
+        position_geodetic_to_ecef(p.latitude, p.longitude, p.altitude, &q[0], &q[1], &q[2]);
+        queries.insert(queries.end(), q, q + 3);
+    }
+
+    ASSERT_EQ(kdtree_knn_batch(&t4, queries.data(), nq, k, out.data(), counts.data(), 3), 0);
+    for (uint32_t i = 0; i < nq; i++) {
+        kdtree_result_st single[k];
+        ASSERT_EQ(counts[i], k);
+        ASSERT_EQ(kdtree_knn(&t1, queries[i * 3], queries[i * 3 + 1], queries[i * 3 + 2], k, single), k);
+        for (uint32_t j = 0; j < k; j++) {
+            ASSERT_EQ(out[i * k + j].dist, single[j].dist);
+        }
+    }
+
+    kdtree_free(&t1);
+    kdtree_free(&t4);
+}
+
+/**
+ * Tree of the target table, and an empty tree
+ */
+TEST(KdTree, build_targets_001)
+{
+    kdtree_st t;
+    kdtree_result_st out[1];
+    const target_entry_st* e = target_get_entry(0);
+
+    ASSERT_EQ(kdtree_build_targets(&t, 0), 0);
+    ASSERT_EQ(t.n, target_get_count());
+    ASSERT_EQ(kdtree_knn(&t, e->ecef[0] + 30.0f, e->ecef[1], e->ecef[2], 1, out), 1u);
+    ASSERT_EQ(out[0].id, 0u);
+    ASSERT_NEAR(out[0].dist, 30.0f, 0.5f);
+    kdtree_free(&t);
+
+    ASSERT_EQ(kdtree_build(&t, NULL, 0, 0), 0);
+    ASSERT_EQ(kdtree_knn(&t, 0.0f, 0.0f, 0.0f, 1, out), 0u);
+    ASSERT_EQ(kdtree_radius(&t, 0.0f, 0.0f, 0.0f, 1e7f, out, 1), 0u);
+    kdtree_free(&t);
+}
@@ -0,0 +1,192 @@
+/**
+ * @file lazyfence_tests.cpp
+ *
+ * @author miguel garcia (miguelden@gmail.com)
+ *
+ * @brief
+ *    Tests for Lazy geofence evaluation
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+#include <gtest/gtest.h>
+#include "geofence.h"
+#include "lazyfence.h"
+#include "position.h"
+
+using namespace ::std;
+
+/**
+ * The displacement bound is never below the ECEF distance
+ */
+TEST(LazyFence, displacement_001)
+{
+    mt19937 rng(39);
+    uniform_real_distribution<float> lat(-89.0f, 89.0f);
+    uniform_real_distribution<float> lon(-180.0f, 180.0f);
+    uniform_real_distribution<float> delta(-0.05f, 0.05f);
+    uniform_real_distribution<float> height(-100.0f, 10000.0f);
+    lazyfence_st l;
+
+    lazyfence_init(&l, 0.0f);
+    ASSERT_LT(l.margin, 0.0f);
+
+    for (int i = 0; i < 10000; i++) {
+        position_st a = {lat(rng), lon(rng), height(rng), pos_3d};
+        position_st b = {a.latitude + delta(rng), a.longitude + delta(rng), a.altitude + delta(rng) * 1000.0f, pos_3d};
+        double pa[3], pb[3];
+        float x, y, z;
+
+        if (b.longitude > 180.0f) {
+            b.longitude -= 360.0f;
+        }
+        position_geodetic_to_ecef(a.latitude, a.longitude, a.altitude, &x, &y, &z);
+        pa[0] = x, pa[1] = y, pa[2] = z;
+        position_geodetic_to_ecef(b.latitude, b.longitude, b.altitude, &x, &y, &z);
+        pb[0] = x, pb[1] = y, pb[2] = z;
+
+        l.anchor = a;
+        l.cos_lat = cosf(a.latitude * (float)M_PI / 180.0f);
+        double d = sqrt(pow(pa[0] - pb[0], 2) + pow(pa[1] - pb[1], 2) + pow(pa[2] - pb[2], 2));
+        /* The float ECEF positions are rounded to about 0.5 m */
+        ASSERT_GE(lazyfence_displacement(&l, &b) + 2.0, d);
+    }
+}
+
+/**
+ * A device driving through a set of fences gets the same fences as the full evaluation of every position, and most
+ * positions are not evaluated
+ */
+TEST(LazyFence, evaluate_001)
+{
+    mt19937 rng(40);
+    uniform_real_distribution<float> lat(39.40f, 39.50f);
+    uniform_real_distribution<float> lon(-0.45f, -0.30f);
+    uniform_real_distribution<float> radius(100.0f, 1500.0f);
+    uniform_real_distribution<float> turn(-0.3f, 0.3f);
+    geofence_set_st s;
+    lazyfence_st l;
+    position_st p = {39.45f, -0.375f, 30.0f, pos_3d};
+    float heading = 0.0f;
+    uint32_t inside = 0;
+
+    ASSERT_EQ(geofence_set_init(&s, 0), 0);
+    for (uint32_t i = 0; i < 40; i++) {
+        position_st c = {lat(rng), lon(rng), 0.0f, pos_3d};
+        ASSERT_EQ(geofence_add(&s, i, &c, radius(rng)), 0);
+    }
+    const position_st ring[] = {
+        {39.44f, -0.39f, 0.0f, pos_2d},
+        {39.44f, -0.36f, 0.0f, pos_2d},
+        {39.46f, -0.37f, 0.0f, pos_2d},
+    };
+    ASSERT_EQ(geofence_add_polygon(&s, 100, ring, 3), 0);
+
+    for (int index = geofence_index_grid; index <= geofence_index_scan; index++) {
+        geofence_set_index(&s, (geofence_index)index);
+        lazyfence_init(&l, 0.0f);
+
+        /* 15 m/s, one position per second */
+        for (int t = 0; t < 3000; t++) {
+            uint32_t expected[64], ids[64];
+            float x, y, z;
+
+            heading += turn(rng);
+            p.latitude += 15.0f * cosf(heading) / 111000.0f;
+            p.longitude += 15.0f * sinf(heading) / 86000.0f;
+            if (p.latitude < 39.40f || p.latitude > 39.50f || p.longitude < -0.45f || p.longitude > -0.30f) {
+                heading += (float)M_PI;
+            }
+
+            position_geodetic_to_ecef(p.latitude, p.longitude, p.altitude, &x, &y, &z);
+            uint32_t ne = geofence_evaluate(&s, x, y, z, expected, 64);
+            uint32_t n = lazyfence_evaluate(&l, &s, &p, t, ids, 64);
+            ASSERT_EQ(n, ne);
+            sort(expected, expected + ne);
+            sort(ids, ids + n);
+            ASSERT_TRUE(equal(expected, expected + ne, ids));
+            inside += n;
+        }
+        ASSERT_EQ(l.evaluations + l.skipped, 3000u);
+        ASSERT_GT(l.skipped, l.evaluations);
+    }
+    ASSERT_GT(inside, 0u);
+
+    /* Fences changed: the evaluator must be reset */
+    lazyfence_reset(&l);
+    {
+        uint32_t ids[64];
+        uint32_t evaluations = l.evaluations;
+        lazyfence_evaluate(&l, &s, &p, 0.0, ids, 64);
+        ASSERT_EQ(l.evaluations, evaluations + 1);
+    }
+
+    geofence_set_free(&s);
+}
+
+/**
+ * The max speed skips the positions that cannot reach the nearest boundary in time, including outliers
+ */
+TEST(LazyFence, evaluate_002)
+{
+    geofence_set_st s;
+    lazyfence_st l;
+    const position_st center = {39.45f, -0.375f, 0.0f, pos_3d};
+    position_st p = center;
+    uint32_t ids[4];
+
+    ASSERT_EQ(geofence_set_init(&s, 0), 0);
+    ASSERT_EQ(geofence_add(&s, 9, &center, 1000.0f), 0);
+    lazyfence_init(&l, 20.0f);
+
+    ASSERT_EQ(lazyfence_evaluate(&l, &s, &p, 100.0, ids, 4), 1u);
+    ASSERT_EQ(ids[0], 9u);
+    ASSERT_NEAR(l.margin, 1000.0f - LAZYFENCE_PAD, 2.0f);
+    ASSERT_EQ(l.evaluations, 1u);
+
+    /* A jump out of the fence one second later is not plausible */
+    p.latitude += 0.02f;
+    ASSERT_EQ(lazyfence_evaluate(&l, &s, &p, 101.0, ids, 4), 1u);
+    ASSERT_EQ(l.skipped, 1u);
+
+    /* After 60 s the device could have left */
+    ASSERT_EQ(lazyfence_evaluate(&l, &s, &p, 160.0, ids, 4), 0u);
+    ASSERT_EQ(l.evaluations, 2u);
+
+    /* A time in the past only uses the displacement */
+    ASSERT_EQ(lazyfence_evaluate(&l, &s, &center, 50.0, ids, 4), 1u);
+    ASSERT_EQ(l.evaluations, 3u);
+
+    geofence_set_free(&s);
+}
+
+/**
+ * Another set with the same version is evaluated, without a reset
+ */
+TEST(LazyFence, evaluate_003)
+{
+    geofence_set_st a;
+    geofence_set_st b;
+    lazyfence_st l;
+    const position_st center = {39.45f, -0.375f, 0.0f, pos_3d};
+    const position_st far = {39.55f, -0.375f, 0.0f, pos_3d};
+    uint32_t ids[4];
+
+    ASSERT_EQ(geofence_set_init(&a, 0), 0);
+    ASSERT_EQ(geofence_set_init(&b, 0), 0);
+    ASSERT_EQ(geofence_add(&a, 1, &center, 1000.0f), 0);
+    ASSERT_EQ(geofence_add(&b, 2, &far, 1000.0f), 0);
+    ASSERT_EQ(a.version, b.version);
+    lazyfence_init(&l, 0.0f);
+
+    ASSERT_EQ(lazyfence_evaluate(&l, &a, &center, 0.0, ids, 4), 1u);
+    ASSERT_EQ(ids[0], 1u);
+    ASSERT_EQ(lazyfence_evaluate(&l, &b, &center, 1.0, ids, 4), 0u);
+    ASSERT_EQ(l.evaluations, 2u);
+    ASSERT_EQ(l.skipped, 0u);
+
+    geofence_set_free(&a);
+    geofence_set_free(&b);
+}
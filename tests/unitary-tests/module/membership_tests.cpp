@@ -0,0 +1,153 @@
+/**
+ * @file membership_tests.cpp
+ *
+ * @author miguel garcia (miguelden@gmail.com)
+ *
+ * @brief
+ *    Tests for Device fence membership
+ */
+
+#include <random>
+#include <set>
+#include <vector>
+#include <gtest/gtest.h>
+#include "membership.h"
+#include "position.h"
+#include "rangeset.h"
+
+using namespace ::std;
+
+/** Events received by the callback */
+typedef struct {
+    vector<membership_event_st> events;
+    uint32_t batches;
+} Received;
+
+/** Callback that stores the events */
+static void StoreEvents (const membership_event_st* events, uint32_t n, void* ctx)
+{
+    Received* r = (Received*)ctx;
+    r->events.insert(r->events.end(), events, events + n);
+    r->batches++;
+    ASSERT_LE(n, (uint32_t)MEMBERSHIP_BATCH);
+}
+
+/**
+ * Init and single bits
+ */
+TEST(Membership, update_001)
+{
+    membership_st m;
+    Received r = {};
+    uint64_t mask[2] = {0, 0};
+
+    ASSERT_LT(membership_init(&m, 4, 100, NULL, NULL), 0);
+    ASSERT_EQ(membership_init(&m, 4, 100, StoreEvents, &r), 0);
+    ASSERT_EQ(m.words, 2u);
+
+    /* Enter fences 3 and 70, and a bit out of the fences is ignored */
+    mask[0] = 1ULL << 3;
+    mask[1] = (1ULL << 6) | (1ULL << 50);
+    ASSERT_EQ(membership_update(&m, 2, mask), 2u);
+    ASSERT_EQ(r.batches, 0u);
+    membership_flush(&m);
+    ASSERT_EQ(r.batches, 1u);
+    ASSERT_EQ(r.events.size(), 2u);
+    ASSERT_EQ(r.events[0].fence, 3u);
+    ASSERT_EQ(r.events[0].type, membership_enter);
+    ASSERT_EQ(r.events[1].fence, 70u);
+    ASSERT_EQ(r.events[1].device, 2u);
+    ASSERT_TRUE(membership_contains(&m, 2, 70));
+    ASSERT_FALSE(membership_contains(&m, 2, 114));
+    ASSERT_FALSE(membership_contains(&m, 1, 3));
+    ASSERT_EQ(membership_count(&m, 2), 2u);
+
+    /* Same mask, no events */
+    ASSERT_EQ(membership_update(&m, 2, mask), 0u);
+
+    /* Leave fence 3 */
+    mask[0] = 0;
+    ASSERT_EQ(membership_update(&m, 2, mask), 1u);
+    membership_flush(&m);
+    ASSERT_EQ(r.events.back().fence, 3u);
+    ASSERT_EQ(r.events.back().type, membership_exit);
+
+    /* Fewer fences: fence 70 is dropped without events */
+    ASSERT_EQ(membership_resize(&m, 64), 0);
+    ASSERT_EQ(m.words, 1u);
+    ASSERT_EQ(membership_count(&m, 2), 0u);
+    mask[0] = 1ULL << 63;
+    ASSERT_EQ(membership_update(&m, 2, mask), 1u);
+    ASSERT_EQ(membership_resize(&m, 200), 0);
+    ASSERT_TRUE(membership_contains(&m, 2, 63));
+    ASSERT_EQ(membership_clear(&m, 2), 1u);
+    ASSERT_EQ(m.events, 5u);
+    membership_free(&m);
+}
+
+/**
+ * A fleet moving through a set of targets: the events are the difference between consecutive evaluations
+ */
+TEST(Membership, fleet_001)
+{
+    const uint32_t devices = 1000;
+    const uint32_t targets = 300;
+    membership_st m;
+    rangeset_st s;
+    Received r = {};
+    mt19937 rng(11);
+    uniform_real_distribution<float> lat(39.40f, 39.50f), lon(-0.42f, -0.32f), range(200.0f, 2000.0f);
+    vector<float> ecef(targets * 3), ranges(targets);
+    vector<position_st> pos(devices);
+    vector<set<uint32_t>> inside(devices);
+    vector<uint64_t> mask(RANGESET_WORDS(targets));
+
+    for (uint32_t t = 0; t < targets; t++) {
+        position_geodetic_to_ecef(lat(rng), lon(rng), 0.0f, &ecef[t * 3], &ecef[t * 3 + 1], &ecef[t * 3 + 2]);
+        ranges[t] = range(rng);
+    }
+    ASSERT_EQ(rangeset_build(&s, NULL, ecef.data(), ranges.data(), targets), 0);
+    ASSERT_EQ(membership_init(&m, devices, targets, StoreEvents, &r), 0);
+    for (uint32_t i = 0; i < devices; i++) {
+        pos[i] = {lat(rng), lon(rng), 0.0f, pos_3d};
+    }
+
+    for (int round = 0; round < 10; round++) {
+        size_t first = r.events.size();
+        vector<set<uint32_t>> previous = inside;
+
+        for (uint32_t i = 0; i < devices; i++) {
+            float x, y, z;
+            pos[i].latitude += (float)(rng() % 200) * 1e-5f - 1e-3f;
+            pos[i].longitude += (float)(rng() % 200) * 1e-5f - 1e-3f;
+            position_geodetic_to_ecef(pos[i].latitude, pos[i].longitude, 0.0f, &x, &y, &z);
+            rangeset_evaluate(&s, x, y, z, mask.data());
+            membership_update(&m, i, mask.data());
+
+            inside[i].clear();
+            for (uint32_t t = 0; t < targets; t++) {
+                if ((mask[t / 64] >> (t % 64)) & 1) {
+                    inside[i].insert(t);
+                }
+            }
+            ASSERT_EQ(membership_count(&m, i), inside[i].size());
+        }
+        membership_flush(&m);
+
+        /* Replay the events over the previous state */
+        for (size_t k = first; k < r.events.size(); k++) {
+            const membership_event_st& e = r.events[k];
+            if (e.type == membership_enter) {
+                ASSERT_TRUE(previous[e.device].insert(e.fence).second);
+            } else {
+                ASSERT_EQ(previous[e.device].erase(e.fence), 1u);
+            }
+        }
+        ASSERT_TRUE(previous == inside);
+    }
+    ASSERT_EQ(m.events, r.events.size());
+    ASSERT_GT(r.batches, 1u);
+
+    rangeset_free(&s);
+    membership_free(&m);
+}
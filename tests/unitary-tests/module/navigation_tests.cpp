@@ -271,3 +271,101 @@ TEST(Navigation, test_nmea_gga_007)
     GTEST_SUCCEED();
 }
 
+
+/**
+ * Read NMEA GGA geoidal separation
+ */
+TEST(Navigation, test_nmea_gga_008)
+{
+    navigation_reset();
+    GgaType gga1 = {.hours=1, .minutes=2, .seconds=3, .milliseconds=4,
+            .latitude=39.47314319954006f, .longitude=-0.36773293176583255f, .nsIndicator='N', .ewIndicator='E',
+            .fix=1, .satellites=12, .hdop=1.0, .altitude=13.0, .geoidal=49.5};
+    float separation;
+
+    CompareNMEAwithGGA(gga1, gga1);
+    ASSERT_GT(navigation_get_geoid_separation(&separation), 0);
+    ASSERT_NEAR(separation, 49.5f, 0.01f);
+
+    gga1.fix = 0;
+    CompareNMEAwithGGA(gga1, gga1);
+    ASSERT_EQ(navigation_get_geoid_separation(&separation), 0);
+    ASSERT_EQ(separation, 0.0f);
+}
+
+/**
+ * A zero geoidal separation is reported, an empty separation field is not
+ */
+TEST(Navigation, test_nmea_gga_009)
+{
+    GgaType gga1 = {.hours=1, .minutes=2, .seconds=3, .milliseconds=4,
+            .latitude=39.47314319954006f, .longitude=-0.36773293176583255f, .nsIndicator='N', .ewIndicator='E',
+            .fix=1, .satellites=12, .hdop=1.0, .altitude=13.0, .geoidal=0.0};
+    float separation = 1.0f;
+    uint8_t res = 0;
+
+    navigation_reset();
+    for (auto ch : NmeaUtils::GenNMEA_GGAsentence(gga1)) {
+        res |= navigation_add_nmea_char(ch);
+    }
+    ASSERT_EQ(res, 1);
+    ASSERT_GT(navigation_get_geoid_separation(&separation), 0);
+    ASSERT_EQ(separation, 0.0f);
+
+    res = 0;
+    separation = 1.0f;
+    for (auto ch : NmeaUtils::GenNMEA_GGAsentence(gga1, false)) {
+        res |= navigation_add_nmea_char(ch);
+    }
+    ASSERT_EQ(res, 1);
+    ASSERT_NEAR(navigation_get_llh().altitude, 13.0f, 0.01f);
+    ASSERT_EQ(navigation_get_geoid_separation(&separation), 0);
+    ASSERT_EQ(separation, 0.0f);
+}
+
+/**
+ * Two parser contexts fed at the same time
+ */
+TEST(Navigation, test_nmea_ctx_001)
+{
+    navigation_st nav1, nav2;
+    GgaType gga1 = {.hours=1, .minutes=2, .seconds=3, .milliseconds=4,
+            .latitude=39.47314319954006f, .longitude=-0.36773293176583255f, .nsIndicator='N', .ewIndicator='E',
+            .fix=1, .satellites=12, .hdop=1.0, .altitude=13.0, .geoidal=49.5};
+    GgaType gga2 = {.hours=5, .minutes=6, .seconds=7, .milliseconds=0,
+            .latitude=-10.5f, .longitude=20.25f, .nsIndicator='N', .ewIndicator='E',
+            .fix=1, .satellites=3, .hdop=1.0, .altitude=120.0, .geoidal=0.0};
+    string s1 = NmeaUtils::GenNMEA_GGAsentence(gga1);
+    string s2 = NmeaUtils::GenNMEA_GGAsentence(gga2);
+    uint32_t n1 = 0, n2 = 0;
+
+    navigation_reset();
+    navigation_init(&nav1);
+    navigation_init(&nav2);
+    for (size_t i = 0; i < s1.length() || i < s2.length(); i++) {
+        if (i < s1.length()) {
+            n1 += navigation_ctx_add_nmea_char(&nav1, s1[i]);
+        }
+        if (i < s2.length()) {
+            n2 += navigation_ctx_add_nmea_char(&nav2, s2[i]);
+        }
+    }
+    ASSERT_EQ(n1, 1u);
+    ASSERT_EQ(n2, 1u);
+
+    position_st p1 = navigation_ctx_get_llh(&nav1);
+    position_st p2 = navigation_ctx_get_llh(&nav2);
+    ASSERT_NEAR(p1.latitude, gga1.latitude, 0.001f);
+    ASSERT_EQ(p1.is_valid, pos_3d);
+    float separation;
+    ASSERT_GT(navigation_ctx_get_geoid_separation(&nav1, &separation), 0);
+    ASSERT_NEAR(separation, 49.5f, 0.01f);
+    ASSERT_NEAR(p2.latitude, -10.5f, 0.001f);
+    ASSERT_NEAR(p2.longitude, 20.25f, 0.001f);
+    ASSERT_NEAR(p2.altitude, 120.0f, 0.01f);
+    ASSERT_EQ(p2.is_valid, pos_2d);
+    ASSERT_NEAR(navigation_ctx_get_time(&nav2), 5 * 3600.0 + 6 * 60.0 + 7, 0.01);
+
+    /* The global context is not changed */
+    ASSERT_EQ(navigation_get_time(), 0.0);
+}
@@ -0,0 +1,127 @@
+/**
+ * @file occupancy_tests.cpp
+ *
+ * @author miguel garcia (miguelden@gmail.com)
+ *
+ * @brief
+ *    Tests for Fence occupancy index
+ */
+
+#include <algorithm>
+#include <random>
+#include <set>
+#include <vector>
+#include <gtest/gtest.h>
+#include "occupancy.h"
+
+using namespace ::std;
+
+/**
+ * Enter, exit and queries of a fence
+ */
+TEST(Occupancy, enter_001)
+{
+    occupancy_st o;
+    uint32_t devices[4];
+
+    ASSERT_EQ(occupancy_init(&o), 0);
+    ASSERT_EQ(occupancy_count(&o, 7), 0u);
+    ASSERT_EQ(occupancy_members(&o, 7, devices, 4), 0u);
+    ASSERT_FALSE(occupancy_contains(&o, 7, 1));
+
+    for (uint32_t d = 0; d < 100; d++) {
+        ASSERT_EQ(occupancy_enter(&o, 7, d * 1000), 0);
+    }
+    /* Entering twice does not count twice */
+    ASSERT_EQ(occupancy_enter(&o, 7, 5000), 0);
+    ASSERT_EQ(occupancy_count(&o, 7), 100u);
+    ASSERT_TRUE(occupancy_contains(&o, 7, 42000));
+    ASSERT_FALSE(occupancy_contains(&o, 7, 42001));
+    ASSERT_FALSE(occupancy_contains(&o, 8, 42000));
+    ASSERT_EQ(occupancy_members(&o, 7, devices, 4), 100u);
+    ASSERT_EQ(devices[0] % 1000, 0u);
+
+    ASSERT_EQ(occupancy_exit(&o, 7, 42000), 0);
+    ASSERT_LT(occupancy_exit(&o, 7, 42000), 0);
+    ASSERT_LT(occupancy_exit(&o, 8, 1000), 0);
+    ASSERT_FALSE(occupancy_contains(&o, 7, 42000));
+    ASSERT_EQ(occupancy_count(&o, 7), 99u);
+    ASSERT_LT(occupancy_enter(&o, 7, OCCUPANCY_EMPTY), 0);
+
+    occupancy_clear(&o, 7);
+    ASSERT_EQ(occupancy_count(&o, 7), 0u);
+    ASSERT_FALSE(occupancy_contains(&o, 7, 1000));
+    ASSERT_EQ(occupancy_enter(&o, 7, 3), 0);
+    ASSERT_EQ(occupancy_count(&o, 7), 1u);
+
+    occupancy_free(&o);
+}
+
+/**
+ * Random moves of many devices between many fences: the index has the devices of a reference, and the tables shrink
+ * back when the devices leave
+ */
+TEST(Occupancy, update_001)
+{
+    const uint32_t ndevices = 50000;
+    const uint32_t nfences = 2000;
+    mt19937 rng(43);
+    uniform_int_distribution<uint32_t> fence(0, nfences - 1);
+    uniform_int_distribution<uint32_t> count(0, 3);
+    occupancy_st o;
+    vector<vector<uint32_t>> state(ndevices);
+    vector<set<uint32_t>> reference(nfences);
+
+    ASSERT_EQ(occupancy_init(&o), 0);
+
+    for (int step = 0; step < 4; step++) {
+        for (uint32_t d = 0; d < ndevices; d++) {
+            /* Keep some fences, and enter a few others */
+            vector<uint32_t> current;
+            for (uint32_t f : state[d]) {
+                if (rng() % 2) {
+                    current.push_back(f);
+                }
+            }
+            for (uint32_t k = count(rng); k > 0; k--) {
+                uint32_t f = fence(rng) * 1009;
+                if (find(current.begin(), current.end(), f) == current.end()) {
+                    current.push_back(f);
+                }
+            }
+
+            ASSERT_EQ(occupancy_update(&o, d, state[d].data(), (uint32_t)state[d].size(), current.data(),
+                                       (uint32_t)current.size()), 0);
+            for (uint32_t f : state[d]) {
+                reference[f / 1009].erase(d);
+            }
+            for (uint32_t f : current) {
+                reference[f / 1009].insert(d);
+            }
+            state[d] = current;
+        }
+
+        for (uint32_t f = 0; f < nfences; f++) {
+            vector<uint32_t> members(reference[f].size() + 1);
+            ASSERT_EQ(occupancy_count(&o, f * 1009), reference[f].size());
+            ASSERT_EQ(occupancy_members(&o, f * 1009, members.data(), (uint32_t)members.size()),
+                      reference[f].size());
+            members.resize(reference[f].size());
+            sort(members.begin(), members.end());
+            ASSERT_TRUE(equal(members.begin(), members.end(), reference[f].begin()));
+        }
+        ASSERT_TRUE(state[7].empty() || occupancy_contains(&o, state[7][0], 7));
+    }
+
+    /* Every device leaves */
+    for (uint32_t d = 0; d < ndevices; d++) {
+        ASSERT_EQ(occupancy_update(&o, d, state[d].data(), (uint32_t)state[d].size(), NULL, 0), 0);
+    }
+    for (uint32_t i = 0; i < o.nfences; i++) {
+        ASSERT_EQ(o.fences[i].count, 0u);
+        ASSERT_EQ(o.fences[i].devices, nullptr);
+    }
+    ASSERT_LE(o.nfences, nfences);
+
+    occupancy_free(&o);
+}
@@ -0,0 +1,70 @@
+/**
+ * @file parallel_tests.cpp
+ *
+ * @author miguel garcia (miguelden@gmail.com)
+ *
+ * @brief
+ *    Tests for Parallel task runner
+ */
+
+#include <atomic>
+#include <vector>
+#include <gtest/gtest.h>
+#include "parallel.h"
+
+using namespace ::std;
+
+/** Context of the test tasks */
+struct TaskCtx {
+    vector<atomic<uint32_t>> runs;
+    atomic<uint32_t> max_worker;
+    uint32_t workers;
+
+    explicit TaskCtx(uint32_t tasks) : runs(tasks), max_worker(0), workers(0) {}
+};
+
+static void CountTask (uint32_t task, uint32_t worker, void* ctx)
+{
+    auto c = (TaskCtx*)ctx;
+    c->runs[task]++;
+    uint32_t m = c->max_worker;
+    while (worker > m && !c->max_worker.compare_exchange_weak(m, worker)) {
+    }
+}
+
+/**
+ * Every task runs exactly once, with worker indexes lower than the number of workers
+ */
+TEST(Parallel, parallel_for_001)
+{
+    const uint32_t threads[] = {0, 1, 2, 7, 64};
+
+    for (auto t : threads) {
+        TaskCtx ctx(1000);
+        int workers = parallel_for(1000, t, CountTask, &ctx);
+
+        ASSERT_GE(workers, 1);
+        if (t != 0) {
+            ASSERT_LE(workers, (int)t);
+        }
+        ASSERT_LT(ctx.max_worker.load(), (uint32_t)workers);
+        for (auto& r : ctx.runs) {
+            ASSERT_EQ(r.load(), 1u);
+        }
+    }
+}
+
+/**
+ * No tasks and fewer tasks than threads
+ */
+TEST(Parallel, parallel_for_002)
+{
+    TaskCtx ctx(3);
+
+    ASSERT_EQ(parallel_for(0, 4, CountTask, &ctx), 1);
+    ASSERT_EQ(parallel_for(3, 16, CountTask, &ctx), 3);
+    for (auto& r : ctx.runs) {
+        ASSERT_EQ(r.load(), 1u);
+    }
+    ASSERT_GE(parallel_default_threads(), 1u);
+}
@@ -0,0 +1,226 @@
+/**
+ * @file polyfence_tests.cpp
+ *
+ * @author miguel garcia (miguelden@gmail.com)
+ *
+ * @brief
+ *    Tests for Polygon geofences
+ */
+
+#include <cmath>
+#include <random>
+#include <vector>
+#include <gtest/gtest.h>
+#include "polyfence.h"
+#include "position.h"
+
+using namespace ::std;
+
+/** ECEF of a geodetic position */
+static void Ecef (float lat, float lon, float h, float q[3])
+{
+    position_geodetic_to_ecef(lat, lon, h, &q[0], &q[1], &q[2]);
+}
+
+/** Distance from a point to a segment in the plane */
+static double SegmentDistance (double px, double py, double ax, double ay, double bx, double by)
+{
+    double dx = bx - ax, dy = by - ay;
+    double t = ((px - ax) * dx + (py - ay) * dy) / (dx * dx + dy * dy);
+    t = t < 0.0 ? 0.0 : (t > 1.0 ? 1.0 : t);
+    return hypot(px - (ax + t * dx), py - (ay + t * dy));
+}
+
+/**
+ * Square fence, inside and outside positions
+ */
+TEST(PolyFence, contains_001)
+{
+    polyfence_st p;
+    float q[3];
+    const position_st square[] = {
+        {40.40f, -3.71f, 0.0f, pos_2d},
+        {40.40f, -3.69f, 0.0f, pos_2d},
+        {40.42f, -3.69f, 0.0f, pos_2d},
+        {40.42f, -3.71f, 0.0f, pos_2d},
+        {40.40f, -3.71f, 0.0f, pos_2d},
+    };
+
+    ASSERT_EQ(polyfence_init(&p, 7, square, 5), 0);
+    ASSERT_EQ(p.id, 7u);
+    ASSERT_EQ(p.nvertices, 4u);
+    ASSERT_EQ(p.nbands, 1u);
+
+    Ecef(40.41f, -3.70f, 650.0f, q);
+    ASSERT_GT(polyfence_contains(&p, q[0], q[1], q[2]), 0);
+    Ecef(40.4005f, -3.7095f, 0.0f, q);
+    ASSERT_GT(polyfence_contains(&p, q[0], q[1], q[2]), 0);
+    Ecef(40.43f, -3.70f, 0.0f, q);
+    ASSERT_EQ(polyfence_contains(&p, q[0], q[1], q[2]), 0);
+    Ecef(40.41f, -3.68f, 0.0f, q);
+    ASSERT_EQ(polyfence_contains(&p, q[0], q[1], q[2]), 0);
+
+    /* The antipode projects inside the bounding box, but it is far below the plane */
+    Ecef(-40.41f, 176.30f, 0.0f, q);
+    ASSERT_EQ(polyfence_contains(&p, q[0], q[1], q[2]), 0);
+    polyfence_free(&p);
+    ASSERT_EQ(polyfence_contains(&p, q[0], q[1], q[2]), 0);
+
+    /* Degenerate rings */
+    ASSERT_LT(polyfence_init(&p, 1, square, 2), 0);
+    ASSERT_LT(polyfence_init(&p, 1, NULL, 4), 0);
+    const position_st closed[] = {square[0], square[1], square[0]};
+    ASSERT_LT(polyfence_init(&p, 1, closed, 3), 0);
+}
+
+/**
+ * Triangle across the antimeridian
+ */
+TEST(PolyFence, contains_002)
+{
+    polyfence_st p;
+    float q[3];
+    const position_st triangle[] = {
+        {-17.0f, 179.9f, 0.0f, pos_2d},
+        {-17.0f, -179.9f, 0.0f, pos_2d},
+        {-16.8f, 180.0f, 0.0f, pos_2d},
+    };
+
+    ASSERT_EQ(polyfence_init(&p, 1, triangle, 3), 0);
+    Ecef(-16.95f, 179.99f, 0.0f, q);
+    ASSERT_GT(polyfence_contains(&p, q[0], q[1], q[2]), 0);
+    Ecef(-16.95f, -179.99f, 0.0f, q);
+    ASSERT_GT(polyfence_contains(&p, q[0], q[1], q[2]), 0);
+    Ecef(-16.95f, 0.0f, 0.0f, q);
+    ASSERT_EQ(polyfence_contains(&p, q[0], q[1], q[2]), 0);
+    Ecef(-17.05f, 180.0f, 0.0f, q);
+    ASSERT_EQ(polyfence_contains(&p, q[0], q[1], q[2]), 0);
+    polyfence_free(&p);
+}
+
+/**
+ * Large star-shaped fence with bands, compared with a plain crossing number test of the projected vertices
+ */
+TEST(PolyFence, contains_003)
+{
+    mt19937 rng(36);
+    uniform_real_distribution<float> radius(0.02f, 0.2f);
+    const uint32_t n = 4000;
+    vector<position_st> ring;
+    vector<double> ex(n), ey(n);
+    polyfence_st p;
+    uint32_t inside = 0, tested = 0;
+
+    for (uint32_t i = 0; i < n; i++) {
+        double a = 2.0 * M_PI * i / n;
+        float r = radius(rng);
+        ring.push_back({(float)(52.0 + r * sin(a)), (float)(13.0 + 1.6 * r * cos(a)), 0.0f, pos_2d});
+    }
+    ASSERT_EQ(polyfence_init(&p, 2, ring.data(), n), 0);
+    ASSERT_GT(p.nbands, 1u);
+
+    for (uint32_t i = 0; i < n; i++) {
+        float q[3], e, no;
+        Ecef(ring[i].latitude, ring[i].longitude, 0.0f, q);
+        polyfence_project(&p, q[0], q[1], q[2], &e, &no);
+        ex[i] = e;
+        ey[i] = no;
+    }
+
+    uniform_real_distribution<float> lat(51.75f, 52.25f);
+    uniform_real_distribution<float> lon(12.6f, 13.4f);
+    for (int t = 0; t < 3000; t++) {
+        float q[3], e, no;
+        double near = 1e9;
+        uint8_t expected = 0;
+
+        Ecef(lat(rng), lon(rng), 100.0f, q);
+        polyfence_project(&p, q[0], q[1], q[2], &e, &no);
+        for (uint32_t i = 0, j = n - 1; i < n; j = i++) {
+            near = fmin(near, SegmentDistance(e, no, ex[j], ey[j], ex[i], ey[i]));
+            if (((ey[i] > no) != (ey[j] > no)) && (e < (ex[j] - ex[i]) * (no - ey[i]) / (ey[j] - ey[i]) + ex[i])) {
+                expected ^= 1;
+            }
+        }
+        if (near < 0.5) {
+            continue;
+        }
+        ASSERT_EQ(polyfence_contains(&p, q[0], q[1], q[2]) != 0, expected != 0);
+        inside += expected;
+        tested++;
+    }
+    ASSERT_GT(inside, 100u);
+    ASSERT_GT(tested, 2900u);
+    polyfence_free(&p);
+}
+
+/**
+ * Distance to the boundary of a large fence, compared with the distance to the projected polygon extruded between the
+ * vertical bounds
+ */
+TEST(PolyFence, distance_001)
+{
+    mt19937 rng(39);
+    uniform_real_distribution<float> radius(0.02f, 0.2f);
+    const uint32_t n = 500;
+    vector<position_st> ring;
+    vector<double> ex(n), ey(n);
+    polyfence_st p;
+
+    for (uint32_t i = 0; i < n; i++) {
+        double a = 2.0 * M_PI * i / n;
+        float r = radius(rng);
+        ring.push_back({(float)(52.0 + r * sin(a)), (float)(13.0 + 1.6 * r * cos(a)), 0.0f, pos_2d});
+    }
+    /* A horizontal edge, which is not in the bands */
+    ring[1].latitude = ring[0].latitude;
+    ASSERT_EQ(polyfence_init(&p, 2, ring.data(), n), 0);
+
+    for (uint32_t i = 0; i < n; i++) {
+        float q[3], e, no;
+        Ecef(ring[i].latitude, ring[i].longitude, 0.0f, q);
+        polyfence_project(&p, q[0], q[1], q[2], &e, &no);
+        ex[i] = e;
+        ey[i] = no;
+    }
+
+    uniform_real_distribution<float> lat(51.75f, 52.25f);
+    uniform_real_distribution<float> lon(12.6f, 13.4f);
+    uniform_real_distribution<float> height(-500.0f, 3000.0f);
+    for (int t = 0; t < 1000; t++) {
+        float q[3], e, no, up;
+        double near = 1e9, expected, dv;
+        uint8_t inside = 0;
+
+        Ecef(lat(rng), lon(rng), height(rng), q);
+        up = polyfence_project(&p, q[0], q[1], q[2], &e, &no);
+        for (uint32_t i = 0, j = n - 1; i < n; j = i++) {
+            near = fmin(near, SegmentDistance(e, no, ex[j], ey[j], ex[i], ey[i]));
+            if (((ey[i] > no) != (ey[j] > no)) && (e < (ex[j] - ex[i]) * (no - ey[i]) / (ey[j] - ey[i]) + ex[i])) {
+                inside ^= 1;
+            }
+        }
+        if (near < 0.5) {
+            continue;
+        }
+        dv = fmax(fmax(p.min_up - up, up - p.max_up), 0.0);
+        if (!inside) {
+            expected = sqrt(near * near + dv * dv);
+        } else if (dv > 0.0) {
+            expected = dv;
+        } else {
+            expected = fmin(near, fmin(up - p.min_up, p.max_up - up));
+        }
+        ASSERT_NEAR(polyfence_distance(&p, q[0], q[1], q[2]), expected, 0.01 + expected * 1e-5);
+    }
+
+    /* On the horizontal edge */
+    {
+        float q[3];
+        Ecef(ring[0].latitude, (ring[0].longitude + ring[1].longitude) * 0.5f, 0.0f, q);
+        ASSERT_LT(polyfence_distance(&p, q[0], q[1], q[2]), 10.0f);
+    }
+
+    polyfence_free(&p);
+    ASSERT_EQ(polyfence_distance(&p, 0.0f, 0.0f, 0.0f), 0.0f);
+}
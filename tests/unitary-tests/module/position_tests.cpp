@@ -8,6 +8,7 @@
  */
 
 #include <iostream>
+#include <cmath>
 #include <gtest/gtest.h>
 #include "position.h"
 
@@ -262,3 +263,123 @@ TEST(Position, test_geodetic_to_enu_002)
 
     ASSERT_LE(sq_error(exp_dist, dist), 1.0f);
 }
+
+/**
+ * ECEF to Geodetic. Reference point of the paper
+ */
+TEST(Position, test_ecef_to_geodetic_001)
+{
+    float llh[3];
+    position_ecef_to_geodetic(-2430601.8f, -4702442.7f, 3546587.4f, &llh[0], &llh[1], &llh[2]);
+
+    ASSERT_NEAR(34.00000048f, llh[0], 2e-5f);
+    ASSERT_NEAR(-117.3335693f, llh[1], 2e-5f);
+    ASSERT_LE(sq_error(251.702f, llh[2]), max_sq_error);
+}
+
+/**
+ * ECEF to Geodetic. Round trip over the full globe, including poles and high altitudes
+ */
+TEST(Position, test_ecef_to_geodetic_002)
+{
+    const float heights[] = {-400.0f, 0.0f, 1500.0f, 9000.0f, 35786000.0f};
+
+    for (float lat = -90.0f; lat <= 90.0f; lat += 7.5f) {
+        for (float lon = -180.0f; lon < 180.0f; lon += 15.0f) {
+            for (auto h : heights) {
+                float xyz[3];
+                float llh[3];
+                position_geodetic_to_ecef(lat, lon, h, &xyz[0], &xyz[1], &xyz[2]);
+                position_ecef_to_geodetic(xyz[0], xyz[1], xyz[2], &llh[0], &llh[1], &llh[2]);
+
+                /* float ECEF has ~0.5 m resolution, ~5e-6 degrees */
+                ASSERT_NEAR(lat, llh[0], 2e-5f) << "lat=" << lat << " lon=" << lon << " h=" << h;
+                if (fabsf(lat) < 90.0f) {
+                    /* -180 and 180 are the same meridian */
+                    ASSERT_NEAR(0.0f, remainderf(lon - llh[1], 360.0f), 2e-5f) << "lat=" << lat << " lon=" << lon << " h=" << h;
+                }
+                ASSERT_NEAR(h, llh[2], 2.0f + fabsf(h) * 1e-6f) << "lat=" << lat << " lon=" << lon << " h=" << h;
+            }
+        }
+    }
+}
+
+/**
+ * ECEF to Geodetic. The array version gives the same result as the scalar one
+ */
+TEST(Position, test_ecef_to_geodetic_array_001)
+{
+    const float lat[3] = {39.4731325f, -45.0f, 89.5f};
+    const float lon[3] = {-0.3677324f, 170.0f, -60.0f};
+    const float h[3] = {8.0f, 120.0f, 3000.0f};
+    float x[3], y[3], z[3];
+    float llh[3][3];
+
+    for (int i = 0; i < 3; i++) {
+        position_geodetic_to_ecef(lat[i], lon[i], h[i], &x[i], &y[i], &z[i]);
+    }
+    position_ecef_to_geodetic_array(x, y, z, llh[0], llh[1], llh[2], 3);
+
+    for (int i = 0; i < 3; i++) {
+        float s[3];
+        position_ecef_to_geodetic(x[i], y[i], z[i], &s[0], &s[1], &s[2]);
+        ASSERT_EQ(s[0], llh[0][i]);
+        ASSERT_EQ(s[1], llh[1][i]);
+        ASSERT_EQ(s[2], llh[2][i]);
+    }
+}
+
+/**
+ * ENU to Geodetic. Inverse of Geodetic to ENU
+ */
+TEST(Position, test_enu_to_geodetic_001)
+{
+    float llh0[3] = {39.47314319954006f, -0.36773293176583255f, 13.0f};
+    float llh1[3] = {39.47229865871014f, -0.36729115805255386f, 13.0f};
+
+    float enu[3];
+    float llh[3];
+    position_geodetic_to_enu(llh1[0], llh1[1], llh1[2], llh0[0], llh0[1], llh0[2], &enu[0], &enu[1], &enu[2]);
+    position_enu_to_geodetic(enu[0], enu[1], enu[2], llh0[0], llh0[1], llh0[2], &llh[0], &llh[1], &llh[2]);
+
+    ASSERT_NEAR(llh1[0], llh[0], 2e-5f);
+    ASSERT_NEAR(llh1[1], llh[1], 2e-5f);
+    ASSERT_NEAR(llh1[2], llh[2], 2.0f);
+}
+
+/**
+ * Displacement bound. Not shorter than the ECEF distance, at any latitude and across the antimeridian
+ */
+TEST(Position, test_displacement_bound_001)
+{
+    const position_st refs[] = {
+        {39.4731f, -0.3677f, 13.0f, pos_3d},
+        {0.0f, 179.999f, 0.0f, pos_3d},
+        {-78.5f, 45.0f, 2500.0f, pos_3d},
+        {89.9f, 10.0f, 100.0f, pos_3d},
+    };
+    const float deltas[][3] = {
+        {0.0f, 0.0f, 0.0f}, {0.001f, 0.0f, 0.0f}, {0.0f, 0.002f, 5.0f}, {-0.003f, -0.004f, -20.0f},
+        {0.0005f, 0.003f, 1.0f},
+    };
+
+    for (const position_st& ref : refs) {
+        float cos_lat = position_cos_latitude(ref.latitude);
+        float x0, y0, z0;
+
+        position_geodetic_to_ecef(ref.latitude, ref.longitude, ref.altitude, &x0, &y0, &z0);
+        for (const auto& d : deltas) {
+            position_st llh = {ref.latitude + d[0], ref.longitude + d[1], ref.altitude + d[2], pos_3d};
+            float x1, y1, z1;
+
+            if (llh.longitude > 180.0f) {
+                llh.longitude -= 360.0f;
+            }
+            position_geodetic_to_ecef(llh.latitude, llh.longitude, llh.altitude, &x1, &y1, &z1);
+            /* Float rounding of the ECEF coordinates */
+            ASSERT_GE(position_displacement_bound(&ref, cos_lat, &llh) + 2.0f,
+                    position_xyz_distance(x0, y0, z0, x1, y1, z1));
+        }
+        ASSERT_EQ(position_displacement_bound(&ref, cos_lat, &ref), 0.0f);
+    }
+}
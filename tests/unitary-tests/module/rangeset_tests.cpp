@@ -0,0 +1,129 @@
+/**
+ * @file rangeset_tests.cpp
+ *
+ * @author miguel garcia (miguelden@gmail.com)
+ *
+ * @brief
+ *    Tests for Brute-force target set
+ */
+
+#include <cmath>
+#include <random>
+#include <vector>
+#include <gtest/gtest.h>
+#include "dispatch.h"
+#include "position.h"
+#include "rangeset.h"
+#include "target.h"
+
+using namespace ::std;
+
+/**
+ * Bitmask of every dispatch level, compared with the distances in double precision
+ */
+TEST(RangeSet, evaluate_001)
+{
+    mt19937 rng(38);
+    uniform_real_distribution<float> lat(39.0f, 40.0f);
+    uniform_real_distribution<float> lon(-1.0f, 0.0f);
+    uniform_real_distribution<float> range(100.0f, 20000.0f);
+    const uint32_t n = 1000;
+    vector<float> ecef(n * 3), ranges(n);
+    vector<uint32_t> ids(n);
+    rangeset_st s;
+    uint64_t mask[RANGESET_WORDS(n)];
+
+    for (uint32_t i = 0; i < n; i++) {
+        position_geodetic_to_ecef(lat(rng), lon(rng), 0.0f, &ecef[i * 3], &ecef[i * 3 + 1], &ecef[i * 3 + 2]);
+        ranges[i] = range(rng);
+        ids[i] = 100 + i;
+    }
+    ASSERT_EQ(rangeset_build(&s, ids.data(), ecef.data(), ranges.data(), n), 0);
+    ASSERT_EQ(s.n, n);
+    ASSERT_LT(s.range_sq[n], 0.0f);
+
+    for (int q = 0; q < 100; q++) {
+        float p[3];
+        vector<uint32_t> expected;
+        vector<uint32_t> found(n);
+        position_geodetic_to_ecef(lat(rng), lon(rng), 0.0f, &p[0], &p[1], &p[2]);
+
+        vector<uint8_t> in(n);
+        vector<uint8_t> edge(n);
+        for (uint32_t i = 0; i < n; i++) {
+            double d = sqrt(pow((double)ecef[i * 3] - p[0], 2) + pow((double)ecef[i * 3 + 1] - p[1], 2) +
+                            pow((double)ecef[i * 3 + 2] - p[2], 2));
+            in[i] = d <= ranges[i];
+            /* The float rounding of the kernels is about 1 m at ECEF magnitudes */
+            edge[i] = fabs(d - ranges[i]) < 2.0;
+        }
+
+        for (int l = dispatch_scalar; l <= dispatch_get_supported(); l++) {
+            const dispatch_kernels_st* k = dispatch_get_variant((dispatch_level)l);
+            uint32_t count = k->range_mask(s.x, s.y, s.z, s.range_sq, n, p[0], p[1], p[2], mask);
+            uint32_t bits = 0;
+            for (uint32_t i = 0; i < n; i++) {
+                uint8_t bit = (mask[i / 64] >> (i % 64)) & 1;
+                if (!edge[i]) {
+                    ASSERT_EQ(bit, in[i]) << dispatch_level_name(k->level);
+                }
+                bits += bit;
+            }
+            ASSERT_EQ(count, bits);
+            ASSERT_EQ(mask[RANGESET_WORDS(n) - 1] >> (n % 64), 0u);
+        }
+
+        /* The IDs are in target order */
+        uint32_t nfound = rangeset_find(&s, p[0], p[1], p[2], found.data(), n);
+        ASSERT_EQ(nfound, rangeset_evaluate(&s, p[0], p[1], p[2], mask));
+        for (uint32_t j = 0; j < nfound; j++) {
+            ASSERT_TRUE((mask[(found[j] - 100) / 64] >> ((found[j] - 100) % 64)) & 1);
+            if (j > 0) {
+                ASSERT_LT(found[j - 1], found[j]);
+            }
+        }
+        ASSERT_EQ(rangeset_find(&s, p[0], p[1], p[2], found.data(), 0), nfound);
+    }
+
+    rangeset_free(&s);
+}
+
+/**
+ * Set of the target table, several blocks, and an empty set
+ */
+TEST(RangeSet, find_001)
+{
+    rangeset_st s;
+    uint32_t ids[4];
+    const target_entry_st* e = target_get_entry(0);
+
+    ASSERT_EQ(rangeset_build_targets(&s), 0);
+    ASSERT_EQ(s.n, target_get_count());
+    ASSERT_GE(rangeset_find(&s, e->ecef[0], e->ecef[1], e->ecef[2], ids, 4), 1u);
+    ASSERT_EQ(ids[0], 0u);
+    rangeset_free(&s);
+
+    /* Same center for every target, only the last ones in range of a far position */
+    const uint32_t n = 3000;
+    vector<float> ecef(n * 3), ranges(n);
+    for (uint32_t i = 0; i < n; i++) {
+        ecef[i * 3] = 6378137.0f;
+        ecef[i * 3 + 1] = 0.0f;
+        ecef[i * 3 + 2] = 0.0f;
+        ranges[i] = (float)i;
+    }
+    ASSERT_EQ(rangeset_build(&s, NULL, ecef.data(), ranges.data(), n), 0);
+    ASSERT_EQ(rangeset_find(&s, 6378137.0f, 2990.5f, 0.0f, ids, 4), 9u);
+    ASSERT_EQ(ids[0], 2991u);
+    ASSERT_EQ(ids[3], 2994u);
+    rangeset_free(&s);
+
+    ASSERT_EQ(rangeset_build(&s, NULL, NULL, NULL, 0), 0);
+    ASSERT_EQ(rangeset_find(&s, 0.0f, 0.0f, 0.0f, ids, 4), 0u);
+    ASSERT_EQ(rangeset_evaluate(&s, 0.0f, 0.0f, 0.0f, NULL), 0u);
+    for (int l = dispatch_scalar; l <= dispatch_get_supported(); l++) {
+        const dispatch_kernels_st* k = dispatch_get_variant((dispatch_level)l);
+        ASSERT_EQ(k->range_mask(s.x, s.y, s.z, s.range_sq, 0, 0.0f, 0.0f, 0.0f, NULL), 0u);
+    }
+    rangeset_free(&s);
+}
@@ -0,0 +1,126 @@
+/**
+ * @file registry_tests.cpp
+ *
+ * @author miguel garcia (miguelden@gmail.com)
+ *
+ * @brief
+ *    Tests for Device registry
+ */
+
+#include <atomic>
+#include <random>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include <gtest/gtest.h>
+#include "registry.h"
+
+using namespace ::std;
+
+/**
+ * Random inserts and removes, checked against a map
+ */
+TEST(Registry, insert_001)
+{
+    registry_st r;
+    unordered_map<uint64_t, uint32_t> expected;
+    vector<uint64_t> keys;
+    mt19937_64 rng(3);
+
+    ASSERT_EQ(registry_init(&r, 0), 0);
+    ASSERT_EQ(registry_find(&r, 0), REGISTRY_NONE);
+    ASSERT_EQ(registry_remove(&r, 0), REGISTRY_NONE);
+
+    /* Key zero is a valid key */
+    ASSERT_EQ(registry_insert(&r, 0), 0u);
+    ASSERT_EQ(registry_insert(&r, 0), 0u);
+    ASSERT_EQ(registry_find(&r, 0), 0u);
+    expected[0] = 0;
+    keys.push_back(0);
+
+    for (int i = 0; i < 200000; i++) {
+        if (rng() % 4 == 0 && !keys.empty()) {
+            size_t k = rng() % keys.size();
+            uint64_t key = keys[k];
+            ASSERT_EQ(registry_remove(&r, key), expected[key]);
+            expected.erase(key);
+            keys[k] = keys.back();
+            keys.pop_back();
+        } else {
+            uint64_t key = rng() % 1000000;
+            uint32_t index = registry_insert(&r, key);
+            ASSERT_NE(index, REGISTRY_NONE);
+            if (expected.count(key) > 0) {
+                ASSERT_EQ(index, expected[key]);
+            } else {
+                expected[key] = index;
+                keys.push_back(key);
+            }
+        }
+        if (i % 997 == 0) {
+            for (auto& e : expected) {
+                ASSERT_EQ(registry_find(&r, e.first), e.second);
+            }
+            ASSERT_EQ(registry_find(&r, 2000000 + i), REGISTRY_NONE);
+        }
+    }
+    ASSERT_EQ(r.count, expected.size());
+
+    /* The indexes are dense: a removed index is given to the next key */
+    vector<bool> used(r.indexes, false);
+    for (auto& e : expected) {
+        ASSERT_LT(e.second, r.indexes);
+        ASSERT_FALSE(used[e.second]);
+        used[e.second] = true;
+    }
+    ASSERT_EQ(r.indexes, expected.size() + r.nreuse);
+
+    ASSERT_GT(registry_reclaim(&r), 0u);
+    registry_free(&r);
+}
+
+/**
+ * Lookups from several threads while a writer inserts and the table grows
+ */
+TEST(Registry, concurrent_001)
+{
+    const uint32_t keys = 300000;
+    registry_st r;
+    atomic<uint32_t> inserted(0);
+    atomic<bool> done(false);
+    atomic<uint32_t> errors(0);
+    vector<thread> readers;
+
+    ASSERT_EQ(registry_init(&r, 16), 0);
+
+    for (int t = 0; t < 3; t++) {
+        readers.emplace_back([&, t]() {
+            mt19937 rng(t);
+            while (!done.load()) {
+                uint32_t n = inserted.load();
+                if (n == 0) {
+                    continue;
+                }
+                uint32_t i = rng() % n;
+                if (registry_find(&r, (uint64_t)i * 0x9E3779B97F4A7C15ULL) != i) {
+                    errors++;
+                }
+                if (registry_find(&r, (uint64_t)(keys + i) * 0x9E3779B97F4A7C15ULL) != REGISTRY_NONE) {
+                    errors++;
+                }
+            }
+        });
+    }
+
+    for (uint32_t i = 0; i < keys; i++) {
+        ASSERT_EQ(registry_insert(&r, (uint64_t)i * 0x9E3779B97F4A7C15ULL), i);
+        inserted = i + 1;
+    }
+    done = true;
+    for (auto& th : readers) {
+        th.join();
+    }
+    ASSERT_EQ(errors.load(), 0u);
+    ASSERT_EQ(r.count, keys);
+    registry_free(&r);
+}
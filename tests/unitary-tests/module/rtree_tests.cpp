@@ -0,0 +1,174 @@
+/**
+ * @file rtree_tests.cpp
+ *
+ * @author miguel garcia (miguelden@gmail.com)
+ *
+ * @brief
+ *    Tests for Bulk-loaded R-tree of bounding boxes
+ */
+
+#include <algorithm>
+#include <random>
+#include <vector>
+#include <gtest/gtest.h>
+#include "rtree.h"
+
+using namespace ::std;
+
+/** Random boxes in a cube of 10000 km, with sizes from 1 m to 100 km */
+static vector<rtree_box_st> RandomBoxes (uint32_t n, mt19937& rng)
+{
+    uniform_real_distribution<float> pos(-5.0e6f, 5.0e6f);
+    uniform_real_distribution<float> log_size(0.0f, 5.0f);
+    vector<rtree_box_st> boxes;
+
+    for (uint32_t i = 0; i < n; i++) {
+        rtree_box_st b;
+        for (int a = 0; a < 3; a++) {
+            b.min[a] = pos(rng);
+            b.max[a] = b.min[a] + powf(10.0f, log_size(rng));
+        }
+        boxes.push_back(b);
+    }
+    return boxes;
+}
+
+/** IDs of the boxes that contain a point, sorted */
+static vector<uint32_t> BruteForce (const vector<rtree_box_st>& boxes, const float q[3])
+{
+    vector<uint32_t> ids;
+    for (uint32_t i = 0; i < boxes.size(); i++) {
+        const rtree_box_st& b = boxes[i];
+        if (q[0] >= b.min[0] && q[0] <= b.max[0] && q[1] >= b.min[1] && q[1] <= b.max[1] &&
+            q[2] >= b.min[2] && q[2] <= b.max[2]) {
+            ids.push_back(i);
+        }
+    }
+    return ids;
+}
+
+/**
+ * Point queries, compared with a brute force search
+ */
+TEST(RTree, query_001)
+{
+    mt19937 rng(37);
+    rtree_st t;
+    auto boxes = RandomBoxes(50000, rng);
+    vector<uint32_t> ids(1000);
+    uint32_t found = 0;
+
+    ASSERT_EQ(rtree_build(&t, boxes.data(), (uint32_t)boxes.size(), 0), 0);
+    ASSERT_EQ(t.n, 50000u);
+    ASSERT_EQ(t.nleaves, 3125u);
+    ASSERT_EQ(t.depth, 4u);
+    ASSERT_EQ((uintptr_t)t.nodes % 64, 0u);
+
+    for (int i = 0; i < 500; i++) {
+        float q[3];
+        /* Half of the queries inside a box */
+        const rtree_box_st& b = boxes[i * 97];
+        for (int a = 0; a < 3; a++) {
+            q[a] = (i % 2) ? (b.min[a] + b.max[a]) * 0.5f : b.min[a] - 1.0f;
+        }
+
+        auto expected = BruteForce(boxes, q);
+        uint32_t n = rtree_query(&t, q[0], q[1], q[2], ids.data(), (uint32_t)ids.size());
+        ASSERT_EQ(n, expected.size());
+        sort(ids.begin(), ids.begin() + n);
+        ASSERT_TRUE(equal(expected.begin(), expected.end(), ids.begin()));
+        ASSERT_EQ(rtree_query(&t, q[0], q[1], q[2], ids.data(), 0), n);
+        found += n;
+    }
+    ASSERT_GE(found, 250u);
+
+    rtree_free(&t);
+}
+
+/**
+ * The parallel build gives the same tree as the serial one
+ */
+TEST(RTree, build_001)
+{
+    mt19937 rng(38);
+    rtree_st t1, t4;
+    auto boxes = RandomBoxes(30000, rng);
+
+    ASSERT_EQ(rtree_build(&t1, boxes.data(), (uint32_t)boxes.size(), 1), 0);
+    ASSERT_EQ(rtree_build(&t4, boxes.data(), (uint32_t)boxes.size(), 4), 0);
+    ASSERT_EQ(t1.nnodes, t4.nnodes);
+    for (uint32_t i = 0; i < t1.n; i++) {
+        ASSERT_EQ(t1.items[i], t4.items[i]);
+    }
+    for (uint32_t i = 0; i < t1.nnodes; i++) {
+        ASSERT_EQ(t1.nodes[i].first, t4.nodes[i].first);
+        ASSERT_EQ(t1.nodes[i].count, t4.nodes[i].count);
+    }
+
+    rtree_free(&t1);
+    rtree_free(&t4);
+}
+
+/**
+ * Trees of one box and of no boxes
+ */
+TEST(RTree, build_002)
+{
+    rtree_st t;
+    uint32_t ids[1];
+    const rtree_box_st box = {{0.0f, 0.0f, 0.0f}, {1.0f, 1.0f, 1.0f}};
+
+    ASSERT_EQ(rtree_build(&t, &box, 1, 1), 0);
+    ASSERT_EQ(t.nnodes, 1u);
+    ASSERT_EQ(rtree_query(&t, 0.5f, 0.5f, 1.0f, ids, 1), 1u);
+    ASSERT_EQ(ids[0], 0u);
+    ASSERT_EQ(rtree_query(&t, 0.5f, 0.5f, 1.1f, ids, 1), 0u);
+    rtree_free(&t);
+
+    ASSERT_EQ(rtree_build(&t, NULL, 0, 1), 0);
+    ASSERT_EQ(rtree_query(&t, 0.0f, 0.0f, 0.0f, ids, 1), 0u);
+    ASSERT_LT(rtree_build(&t, NULL, 5, 1), 0);
+}
+
+/**
+ * Box queries, compared with a brute force search
+ */
+TEST(RTree, visit_box_001)
+{
+    mt19937 rng(39);
+    rtree_st t;
+    auto boxes = RandomBoxes(20000, rng);
+    auto queries = RandomBoxes(200, rng);
+    uint32_t found = 0;
+
+    ASSERT_EQ(rtree_build(&t, boxes.data(), (uint32_t)boxes.size(), 0), 0);
+
+    for (auto& q : queries) {
+        /* Queries of about 500 km */
+        for (int a = 0; a < 3; a++) {
+            q.min[a] -= 2.5e5f;
+            q.max[a] += 2.5e5f;
+        }
+
+        vector<uint32_t> expected, ids;
+        for (uint32_t i = 0; i < boxes.size(); i++) {
+            const rtree_box_st& b = boxes[i];
+            if (b.min[0] <= q.max[0] && b.max[0] >= q.min[0] && b.min[1] <= q.max[1] && b.max[1] >= q.min[1] &&
+                b.min[2] <= q.max[2] && b.max[2] >= q.min[2]) {
+                expected.push_back(i);
+            }
+        }
+
+        uint32_t n = rtree_visit_box(&t, &q, [](uint32_t id, void* ctx) {
+            ((vector<uint32_t>*)ctx)->push_back(id);
+        }, &ids);
+        ASSERT_EQ(n, expected.size());
+        sort(ids.begin(), ids.end());
+        ASSERT_TRUE(equal(expected.begin(), expected.end(), ids.begin(), ids.end()));
+        found += n;
+    }
+    ASSERT_GT(found, 0u);
+
+    rtree_free(&t);
+    ASSERT_EQ(rtree_visit_box(&t, &queries[0], NULL, NULL), 0u);
+}
@@ -36,3 +36,75 @@ TEST(Target, get_range_001)
 
     ASSERT_EQ(targetRange, 100.0f);
 }
+
+/**
+ * Target table
+ */
+TEST(Target, get_entry_001)
+{
+    ASSERT_GE(target_get_count(), 1u);
+    ASSERT_TRUE(target_get_entry(target_get_count()) == NULL);
+
+    auto t = target_get_entry(0);
+    ASSERT_TRUE(t != NULL);
+    ASSERT_EQ(t->llh.latitude, target_get_position().latitude);
+    ASSERT_EQ(t->llh.longitude, target_get_position().longitude);
+    ASSERT_EQ(t->range, 100.0f);
+    ASSERT_EQ(t->range_sq, 10000.0f);
+    ASSERT_EQ(t->separation, 49.5f);
+}
+
+/**
+ * The precomputed ECEF origin matches the runtime conversion at the ellipsoidal height of the target
+ */
+TEST(Target, get_entry_002)
+{
+    auto t = target_get_entry(0);
+    float xyz[3];
+
+    position_geodetic_to_ecef(t->llh.latitude, t->llh.longitude, t->llh.altitude + t->separation,
+                              &xyz[0], &xyz[1], &xyz[2]);
+
+    ASSERT_NEAR(t->ecef[0], xyz[0], 1.0f);
+    ASSERT_NEAR(t->ecef[1], xyz[1], 1.0f);
+    ASSERT_NEAR(t->ecef[2], xyz[2], 1.0f);
+}
+
+/**
+ * The precomputed rotation matches the runtime ECEF to ENU conversion
+ */
+TEST(Target, ecef_to_enu_001)
+{
+    auto t = target_get_entry(0);
+    float offsets[4][3] = {{1.0f, 0.0f, 0.0f}, {0.0f, 1.0f, 0.0f}, {0.0f, 0.0f, 1.0f}, {35.0f, -80.0f, 12.0f}};
+
+    for (auto& o : offsets) {
+        float x = t->ecef[0] + o[0];
+        float y = t->ecef[1] + o[1];
+        float z = t->ecef[2] + o[2];
+        float enu[3];
+        float exp_enu[3];
+
+        target_ecef_to_enu(t, x, y, z, &enu[0], &enu[1], &enu[2]);
+        position_ecef_to_enu(x, y, z, t->llh.latitude, t->llh.longitude, t->llh.altitude + t->separation,
+                             &exp_enu[0], &exp_enu[1], &exp_enu[2]);
+
+        /* Both origins are rounded to float ECEF, ~0.5 m */
+        ASSERT_NEAR(exp_enu[0], enu[0], 1.0f);
+        ASSERT_NEAR(exp_enu[1], enu[1], 1.0f);
+        ASSERT_NEAR(exp_enu[2], enu[2], 1.0f);
+    }
+}
+
+/**
+ * On range check against the squared range
+ */
+TEST(Target, is_on_range_001)
+{
+    auto t = target_get_entry(0);
+
+    ASSERT_GT(target_is_on_range(t, t->ecef[0], t->ecef[1], t->ecef[2]), 0);
+    ASSERT_GT(target_is_on_range(t, t->ecef[0] + 60.0f, t->ecef[1] - 60.0f, t->ecef[2]), 0);
+    ASSERT_EQ(target_is_on_range(t, t->ecef[0] + 80.0f, t->ecef[1] - 80.0f, t->ecef[2]), 0);
+    ASSERT_EQ(target_is_on_range(t, t->ecef[0], t->ecef[1], t->ecef[2] + 101.0f), 0);
+}
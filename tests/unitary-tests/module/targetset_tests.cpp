@@ -0,0 +1,184 @@
+/**
+ * @file targetset_tests.cpp
+ *
+ * @author miguel garcia (miguelden@gmail.com)
+ *
+ * @brief
+ *    Tests for Hot-swappable target set
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <gtest/gtest.h>
+#include "geofence.h"
+#include "position.h"
+#include "target.h"
+#include "targetset.h"
+
+using namespace ::std;
+
+/** Position of the queries */
+static const position_st center = {39.4731325f, -0.3677324f, 50.0f, pos_3d};
+
+/** Set of fences that contain the center, with the IDs version * 100 + k */
+static void VersionSet (geofence_set_st* s, uint32_t version)
+{
+    ASSERT_EQ(geofence_set_init(s, 0), 0);
+    geofence_set_index(s, (geofence_index)(version % 3));
+    for (uint32_t k = 0; k <= version % 7; k++) {
+        ASSERT_EQ(geofence_add(s, version * 100 + k, &center, 100.0f + 10.0f * k), 0);
+    }
+    /* And one that does not */
+    position_st far = {center.latitude + 1.0f, center.longitude, 0.0f, pos_3d};
+    ASSERT_EQ(geofence_add(s, 99, &far, 100.0f), 0);
+}
+
+/**
+ * Publish, evaluate and reclaim the snapshots
+ */
+TEST(TargetSet, publish_001)
+{
+    targetset_st t;
+    geofence_set_st s;
+    uint32_t ids[16];
+    uint64_t version;
+    float x, y, z;
+
+    position_geodetic_to_ecef(center.latitude, center.longitude, center.altitude, &x, &y, &z);
+    ASSERT_EQ(targetset_init(&t), 0);
+    int r = targetset_reader_register(&t);
+    ASSERT_GE(r, 0);
+
+    /* Nothing published */
+    ASSERT_EQ(targetset_evaluate(&t, r, x, y, z, ids, 16, &version), 0u);
+    ASSERT_EQ(version, 0u);
+
+    VersionSet(&s, 1);
+    ASSERT_EQ(targetset_publish(&t, &s), 0);
+    ASSERT_EQ(s.fences, nullptr);
+    ASSERT_EQ(targetset_evaluate(&t, r, x, y, z, ids, 16, &version), 2u);
+    ASSERT_EQ(version, 1u);
+    sort(ids, ids + 2);
+    ASSERT_EQ(ids[0], 100u);
+    ASSERT_EQ(ids[1], 101u);
+    ASSERT_EQ(targetset_reclaim(&t), 0u);
+
+    /* A read section keeps the snapshot it started with */
+    targetset_snapshot_st* old = targetset_read_begin(&t, r);
+    ASSERT_EQ(old->version, 1u);
+    VersionSet(&s, 2);
+    ASSERT_EQ(targetset_publish(&t, &s), 0);
+    ASSERT_EQ(targetset_reclaim(&t), 1u);
+    ASSERT_EQ(geofence_evaluate(&old->fences, x, y, z, ids, 16), 2u);
+    targetset_read_end(&t, r);
+    ASSERT_EQ(targetset_reclaim(&t), 0u);
+
+    ASSERT_EQ(targetset_evaluate(&t, r, x, y, z, ids, 16, NULL), 3u);
+
+    /* Sections started after the swap do not keep the old snapshot */
+    int r2 = targetset_reader_register(&t);
+    ASSERT_GE(r2, 0);
+    ASSERT_NE(r2, r);
+    targetset_snapshot_st* s1 = targetset_read_begin(&t, r);
+    VersionSet(&s, 3);
+    ASSERT_EQ(targetset_publish(&t, &s), 0);
+    targetset_snapshot_st* s2 = targetset_read_begin(&t, r2);
+    ASSERT_EQ(s1->version, 2u);
+    ASSERT_EQ(s2->version, 3u);
+    VersionSet(&s, 4);
+    ASSERT_EQ(targetset_publish(&t, &s), 0);
+    targetset_read_end(&t, r);
+    ASSERT_EQ(targetset_reclaim(&t), 1u);
+    targetset_read_end(&t, r2);
+    ASSERT_EQ(targetset_reclaim(&t), 0u);
+
+    /* Target table */
+    ASSERT_EQ(targetset_publish_targets(&t), 0);
+    ASSERT_EQ(t.current->fences.count, target_get_count());
+    ASSERT_EQ(t.current->version, 5u);
+
+    targetset_reader_unregister(&t, r);
+    targetset_reader_unregister(&t, r2);
+    targetset_free(&t);
+}
+
+/**
+ * All the reader slots
+ */
+TEST(TargetSet, reader_001)
+{
+    targetset_st t;
+
+    ASSERT_EQ(targetset_init(&t), 0);
+    for (int i = 0; i < TARGETSET_MAX_READERS; i++) {
+        ASSERT_EQ(targetset_reader_register(&t), i);
+    }
+    ASSERT_LT(targetset_reader_register(&t), 0);
+    targetset_reader_unregister(&t, 5);
+    ASSERT_EQ(targetset_reader_register(&t), 5);
+    targetset_free(&t);
+}
+
+/**
+ * Readers evaluate while a writer publishes new snapshots: every evaluation sees a whole snapshot, and the replaced
+ * snapshots are released
+ */
+TEST(TargetSet, concurrent_001)
+{
+    const uint32_t versions = 300;
+    targetset_st t;
+    atomic<bool> done(false);
+    atomic<uint32_t> errors(0);
+    vector<thread> readers;
+    float x, y, z;
+
+    position_geodetic_to_ecef(center.latitude, center.longitude, center.altitude, &x, &y, &z);
+    ASSERT_EQ(targetset_init(&t), 0);
+
+    for (int i = 0; i < 3; i++) {
+        readers.emplace_back([&]() {
+            int r = targetset_reader_register(&t);
+            uint64_t last = 0;
+            uint32_t ids[16];
+
+            while (!done.load()) {
+                uint64_t version;
+                uint32_t n = targetset_evaluate(&t, r, x, y, z, ids, 16, &version);
+
+                /* The versions never go back, and the fences are the ones of the version */
+                if (version < last || (version != 0 && n != version % 7 + 1)) {
+                    errors++;
+                }
+                for (uint32_t k = 0; k < n && k < 16; k++) {
+                    if (ids[k] / 100 != version) {
+                        errors++;
+                    }
+                }
+                last = version;
+                this_thread::yield();
+            }
+            targetset_reader_unregister(&t, r);
+        });
+    }
+
+    for (uint32_t v = 1; v <= versions; v++) {
+        geofence_set_st s;
+        VersionSet(&s, v);
+        ASSERT_EQ(targetset_publish(&t, &s), 0);
+        if (v % 16 == 0) {
+            this_thread::yield();
+        }
+    }
+    done = true;
+    for (auto& th : readers) {
+        th.join();
+    }
+
+    ASSERT_EQ(errors.load(), 0u);
+    ASSERT_EQ(targetset_reclaim(&t), 0u);
+    ASSERT_EQ(t.retired, nullptr);
+    ASSERT_EQ(t.current->version, versions);
+    targetset_free(&t);
+}
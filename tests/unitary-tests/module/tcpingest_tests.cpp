@@ -0,0 +1,299 @@
+/**
+ * @file tcpingest_tests.cpp
+ *
+ * @author miguel garcia (miguelden@gmail.com)
+ *
+ * @brief
+ *    Tests for TCP ingestion server
+ */
+
+#include <chrono>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <gtest/gtest.h>
+#include "NmeaUtils.hpp"
+#include "fleet.h"
+#include "tcpingest.h"
+
+using namespace ::std;
+using namespace ::testing;
+
+/** Position of the sentence k of a device. The altitude is the sentence number */
+static GgaType DeviceGGA (uint32_t device, uint32_t k)
+{
+    GgaType gga = {.hours=1, .minutes=2, .seconds=3, .milliseconds=0,
+            .latitude=39.40f + (float)(device % 200) * 0.001f, .longitude=-0.37f, .nsIndicator='N', .ewIndicator='E',
+            .fix=1, .satellites=8, .hdop=1.0, .altitude=(float)k, .geoidal=0.0};
+    return gga;
+}
+
+/** Connect a synthetic client to the server over loopback */
+static int Connect (uint16_t port)
+{
+    struct sockaddr_in addr = {};
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (fd >= 0 && connect(fd, (struct sockaddr*)&addr, sizeof(addr)) != 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+/** Wait until the server has closed a number of connections */
+static bool WaitClosed (tcpingest_st* t, uint64_t closed)
+{
+    tcpingest_stats_st stats;
+
+    for (int i = 0; i < 1000; i++) {
+        tcpingest_get_stats(t, &stats);
+        if (stats.closed >= closed) {
+            return true;
+        }
+        this_thread::sleep_for(chrono::milliseconds(5));
+    }
+    return false;
+}
+
+/** Device ID of a connection from its peer port */
+static uint32_t PeerPort (const struct sockaddr* peer, socklen_t peer_len, void* ctx)
+{
+    (void)peer_len;
+    (void)ctx;
+    return ntohs(((const struct sockaddr_in*)peer)->sin_port);
+}
+
+/**
+ * Many clients send their streams in fragments of random size, and close their connections
+ */
+TEST(TcpIngest, stream_001)
+{
+    const uint32_t clients = 200;
+    const uint32_t sentences = 20;
+    fleet_st f;
+    tcpingest_st t;
+    tcpingest_stats_st stats;
+    vector<int> fds;
+    vector<string> streams;
+    vector<size_t> sent;
+    mt19937 rng(1);
+    uint64_t bytes = 0;
+
+    ASSERT_EQ(fleet_init(&f, 2, NULL, NULL, NULL), 0);
+    ASSERT_EQ(tcpingest_init(&t, &f, 0, 3, 0, NULL, NULL), 0);
+    ASSERT_GT(tcpingest_port(&t), 0);
+
+    for (uint32_t c = 0; c < clients; c++) {
+        int fd = Connect(tcpingest_port(&t));
+        ASSERT_GE(fd, 0);
+        fds.push_back(fd);
+        streams.push_back("");
+        sent.push_back(0);
+    }
+
+    /* The device IDs are given in the order of acceptance, the streams are the same for all the devices */
+    for (uint32_t k = 0; k < sentences; k++) {
+        streams[0] += NmeaUtils::GenNMEA_GGAsentence(DeviceGGA(0, k));
+    }
+    for (uint32_t c = 0; c < clients; c++) {
+        streams[c] = streams[0];
+        bytes += streams[c].size();
+    }
+
+    for (bool pending = true; pending;) {
+        pending = false;
+        for (uint32_t c = 0; c < clients; c++) {
+            size_t n = min<size_t>(rng() % 60 + 1, streams[c].size() - sent[c]);
+            if (n > 0) {
+                ASSERT_EQ(write(fds[c], &streams[c][sent[c]], n), (ssize_t)n);
+                sent[c] += n;
+                pending = true;
+            }
+        }
+    }
+
+    /* Half of the clients only shut down their side */
+    for (uint32_t c = 0; c < clients; c++) {
+        if (c % 2 == 0) {
+            close(fds[c]);
+        } else {
+            shutdown(fds[c], SHUT_WR);
+        }
+    }
+    ASSERT_TRUE(WaitClosed(&t, clients));
+    fleet_flush(&f);
+
+    tcpingest_get_stats(&t, &stats);
+    ASSERT_EQ(stats.accepted, clients);
+    ASSERT_EQ(stats.closed, clients);
+    ASSERT_EQ(stats.timeouts, 0u);
+    ASSERT_EQ(stats.bytes, bytes);
+
+    ASSERT_EQ(fleet_count(&f), clients);
+    for (uint32_t d = 1; d <= clients; d++) {
+        fleet_status_st status;
+        ASSERT_EQ(fleet_get_status(&f, d, &status), 0);
+        ASSERT_EQ(status.positions, sentences);
+        ASSERT_NEAR(status.llh.altitude, (float)(sentences - 1), 0.01f);
+    }
+
+    /* The server closed the half-closed connections */
+    for (uint32_t c = 1; c < clients; c += 2) {
+        char b;
+        ASSERT_EQ(read(fds[c], &b, 1), 0);
+        close(fds[c]);
+    }
+
+    tcpingest_free(&t);
+    fleet_free(&f);
+}
+
+/**
+ * Silent peers are closed by the idle timeout, the device IDs are given by the callback
+ */
+TEST(TcpIngest, idle_001)
+{
+    fleet_st f;
+    tcpingest_st t;
+    tcpingest_stats_st stats;
+    struct sockaddr_in local;
+    socklen_t local_len = sizeof(local);
+    string sentence = NmeaUtils::GenNMEA_GGAsentence(DeviceGGA(0, 1));
+    char b;
+
+    ASSERT_EQ(fleet_init(&f, 1, NULL, NULL, NULL), 0);
+    ASSERT_EQ(tcpingest_init(&t, &f, 0, 1, 1000, PeerPort, NULL), 0);
+
+    /* An active peer sends a sentence every 20 ms, far below the idle timeout, a silent one sends nothing */
+    int active = Connect(tcpingest_port(&t));
+    int silent = Connect(tcpingest_port(&t));
+    ASSERT_GE(active, 0);
+    ASSERT_GE(silent, 0);
+    ASSERT_EQ(getsockname(active, (struct sockaddr*)&local, &local_len), 0);
+
+    for (int i = 0; i < 60; i++) {
+        ASSERT_EQ(write(active, sentence.data(), sentence.size()), (ssize_t)sentence.size());
+        this_thread::sleep_for(chrono::milliseconds(20));
+    }
+
+    /* The silent peer is closed, the active one is not */
+    struct pollfd pfd = {silent, POLLIN, 0};
+    ASSERT_EQ(poll(&pfd, 1, 2000), 1);
+    ASSERT_EQ(read(silent, &b, 1), 0);
+    pfd.fd = active;
+    ASSERT_EQ(poll(&pfd, 1, 0), 0);
+
+    /* Then the active peer stops sending too */
+    ASSERT_EQ(poll(&pfd, 1, 3000), 1);
+    ASSERT_EQ(read(active, &b, 1), 0);
+    ASSERT_TRUE(WaitClosed(&t, 2));
+    tcpingest_get_stats(&t, &stats);
+    ASSERT_EQ(stats.closed, 2u);
+    ASSERT_EQ(stats.timeouts, 2u);
+    fleet_flush(&f);
+
+    fleet_status_st status;
+    ASSERT_EQ(fleet_count(&f), 1u);
+    ASSERT_EQ(fleet_get_status(&f, ntohs(local.sin_port), &status), 0);
+    ASSERT_EQ(status.positions, 60u);
+
+    close(active);
+    close(silent);
+    tcpingest_free(&t);
+    fleet_free(&f);
+}
+
+/**
+ * Out of descriptors: the connections over the limit are refused, and the loop does not spin on the listening socket
+ */
+TEST(TcpIngest, refuse_001)
+{
+    const uint32_t clients = 10;
+    const uint32_t room = 3;
+    fleet_st f;
+    tcpingest_st t;
+    tcpingest_stats_st stats;
+    struct rlimit limit;
+    struct rlimit low;
+    struct rusage before;
+    struct rusage after;
+    vector<int> fds;
+
+    ASSERT_EQ(fleet_init(&f, 1, NULL, NULL, NULL), 0);
+    ASSERT_EQ(tcpingest_init(&t, &f, 0, 1, 0, NULL, NULL), 0);
+
+    /* The client sockets are created first, then the server has room for a few connections only */
+    for (uint32_t c = 0; c < clients; c++) {
+        int fd = socket(AF_INET, SOCK_STREAM, 0);
+        ASSERT_GE(fd, 0);
+        fds.push_back(fd);
+    }
+    int lowest = dup(0);
+    ASSERT_GE(lowest, 0);
+    close(lowest);
+    ASSERT_EQ(getrlimit(RLIMIT_NOFILE, &limit), 0);
+    low = limit;
+    low.rlim_cur = (rlim_t)(lowest + room);
+    ASSERT_EQ(setrlimit(RLIMIT_NOFILE, &low), 0);
+
+    struct sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(tcpingest_port(&t));
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    for (uint32_t c = 0; c < clients; c++) {
+        ASSERT_EQ(connect(fds[c], (struct sockaddr*)&addr, sizeof(addr)), 0);
+    }
+
+    for (int i = 0; i < 1000; i++) {
+        tcpingest_get_stats(&t, &stats);
+        if (stats.accepted + stats.refused >= clients) {
+            break;
+        }
+        this_thread::sleep_for(chrono::milliseconds(5));
+    }
+
+    /* The loop sleeps while the descriptors are used up */
+    ASSERT_EQ(getrusage(RUSAGE_SELF, &before), 0);
+    this_thread::sleep_for(chrono::milliseconds(200));
+    ASSERT_EQ(getrusage(RUSAGE_SELF, &after), 0);
+    ASSERT_EQ(setrlimit(RLIMIT_NOFILE, &limit), 0);
+
+    long cpu_us = (after.ru_utime.tv_sec - before.ru_utime.tv_sec) * 1000000L +
+            (after.ru_utime.tv_usec - before.ru_utime.tv_usec) +
+            (after.ru_stime.tv_sec - before.ru_stime.tv_sec) * 1000000L +
+            (after.ru_stime.tv_usec - before.ru_stime.tv_usec);
+    ASSERT_LT(cpu_us, 50000L);
+
+    tcpingest_get_stats(&t, &stats);
+    ASSERT_EQ(stats.accepted, room);
+    ASSERT_EQ(stats.refused, clients - room);
+
+    /* The refused clients see the connection closed */
+    uint32_t closed = 0;
+    for (uint32_t c = 0; c < clients; c++) {
+        struct timeval tv = {0, 100000};
+        char b;
+
+        setsockopt(fds[c], SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+        ssize_t n = read(fds[c], &b, 1);
+        if (n == 0 || (n < 0 && errno == ECONNRESET)) {
+            closed++;
+        }
+        close(fds[c]);
+    }
+    ASSERT_EQ(closed, clients - room);
+
+    tcpingest_free(&t);
+    fleet_free(&f);
+}
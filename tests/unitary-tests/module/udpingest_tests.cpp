@@ -0,0 +1,216 @@
+/**
+ * @file udpingest_tests.cpp
+ *
+ * @author miguel garcia (miguelden@gmail.com)
+ *
+ * @brief
+ *    Tests for UDP ingestion listener
+ */
+
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <gtest/gtest.h>
+#include "NmeaUtils.hpp"
+#include "fleet.h"
+#include "udpingest.h"
+
+using namespace ::std;
+using namespace ::testing;
+
+/** Position of the sentence k of a device. The altitude is the sentence number */
+static GgaType DeviceGGA (uint32_t device, uint32_t k)
+{
+    GgaType gga = {.hours=1, .minutes=2, .seconds=3, .milliseconds=0,
+            .latitude=39.40f + (float)(device % 200) * 0.001f, .longitude=-0.37f, .nsIndicator='N', .ewIndicator='E',
+            .fix=1, .satellites=8, .hdop=1.0, .altitude=(float)k, .geoidal=0.0};
+    return gga;
+}
+
+/** Device ID of a source from its port */
+static uint32_t SourcePort (const struct sockaddr* source, socklen_t source_len, void* ctx)
+{
+    (void)source_len;
+    (void)ctx;
+    return ntohs(((const struct sockaddr_in*)source)->sin_port);
+}
+
+/** Packet generator: a set of loopback sources that send datagrams to a port */
+class PacketGenerator
+{
+public:
+    PacketGenerator (uint32_t sources, uint16_t port)
+    {
+        struct sockaddr_in local = {};
+
+        dest_.sin_family = AF_INET;
+        dest_.sin_port = htons(port);
+        dest_.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        local.sin_family = AF_INET;
+        local.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+        for (uint32_t i = 0; i < sources; i++) {
+            struct sockaddr_in addr;
+            socklen_t addr_len = sizeof(addr);
+            int fd = socket(AF_INET, SOCK_DGRAM, 0);
+
+            bind(fd, (struct sockaddr*)&local, sizeof(local));
+            getsockname(fd, (struct sockaddr*)&addr, &addr_len);
+            fds_.push_back(fd);
+            ports_.push_back(ntohs(addr.sin_port));
+        }
+    }
+
+    ~PacketGenerator ()
+    {
+        for (int fd : fds_) {
+            close(fd);
+        }
+    }
+
+    /** Send the datagrams of a source at once */
+    bool Send (uint32_t source, const vector<string>& datagrams)
+    {
+        vector<struct mmsghdr> msgs(datagrams.size());
+        vector<struct iovec> iov(datagrams.size());
+
+        for (size_t i = 0; i < datagrams.size(); i++) {
+            iov[i].iov_base = (void*)datagrams[i].data();
+            iov[i].iov_len = datagrams[i].size();
+            msgs[i] = {};
+            msgs[i].msg_hdr.msg_iov = &iov[i];
+            msgs[i].msg_hdr.msg_iovlen = 1;
+            msgs[i].msg_hdr.msg_name = &dest_;
+            msgs[i].msg_hdr.msg_namelen = sizeof(dest_);
+        }
+        return sendmmsg(fds_[source], msgs.data(), (unsigned int)msgs.size(), 0) == (int)msgs.size();
+    }
+
+    uint16_t Port (uint32_t source) const
+    {
+        return ports_[source];
+    }
+
+private:
+    struct sockaddr_in dest_ = {};
+    vector<int> fds_;
+    vector<uint16_t> ports_;
+};
+
+/** Wait until the listener has received a number of datagrams */
+static bool WaitDatagrams (udpingest_st* u, uint64_t datagrams)
+{
+    udpingest_stats_st stats;
+
+    for (int i = 0; i < 2000; i++) {
+        udpingest_get_stats(u, &stats);
+        if (stats.datagrams >= datagrams) {
+            return true;
+        }
+        this_thread::sleep_for(chrono::milliseconds(1));
+    }
+    return false;
+}
+
+/**
+ * Many sources send one sentence per datagram, and each one is a device
+ */
+TEST(UdpIngest, batch_001)
+{
+    const uint32_t sources = 100;
+    const uint32_t rounds = 40;
+    const uint32_t burst = 5;
+    fleet_st f;
+    udpingest_st u;
+    udpingest_stats_st stats;
+
+    ASSERT_EQ(fleet_init(&f, 2, NULL, NULL, NULL), 0);
+    ASSERT_EQ(udpingest_init(&u, &f, 0, 4, SourcePort, NULL), 0);
+    ASSERT_EQ(u.nworkers, 4u);
+    ASSERT_GT(udpingest_port(&u), 0);
+
+    PacketGenerator gen(sources, udpingest_port(&u));
+
+    /* Each round is received before the next one, so no datagram is dropped by a full socket */
+    for (uint32_t r = 0; r < rounds; r++) {
+        for (uint32_t s = 0; s < sources; s++) {
+            vector<string> datagrams;
+            for (uint32_t k = 0; k < burst; k++) {
+                datagrams.push_back(NmeaUtils::GenNMEA_GGAsentence(DeviceGGA(s, r * burst + k)));
+            }
+            ASSERT_TRUE(gen.Send(s, datagrams));
+        }
+        ASSERT_TRUE(WaitDatagrams(&u, (uint64_t)(r + 1) * sources * burst));
+    }
+    fleet_flush(&f);
+
+    udpingest_get_stats(&u, &stats);
+    ASSERT_EQ(stats.datagrams, (uint64_t)sources * rounds * burst);
+    ASSERT_EQ(stats.sources, sources);
+    ASSERT_EQ(stats.truncated, 0u);
+    ASSERT_LE(stats.batches, stats.datagrams);
+
+    ASSERT_EQ(fleet_count(&f), sources);
+    for (uint32_t s = 0; s < sources; s++) {
+        fleet_status_st status;
+        ASSERT_EQ(fleet_get_status(&f, gen.Port(s), &status), 0);
+        ASSERT_EQ(status.positions, rounds * burst);
+        ASSERT_NEAR(status.llh.altitude, (float)(rounds * burst - 1), 0.01f);
+        ASSERT_NEAR(status.llh.latitude, DeviceGGA(s, 0).latitude, 0.001f);
+    }
+
+    udpingest_free(&u);
+    fleet_free(&f);
+}
+
+/**
+ * Sentences split across datagrams, several sentences per datagram, and datagrams too large
+ */
+TEST(UdpIngest, split_001)
+{
+    fleet_st f;
+    udpingest_st u;
+    udpingest_stats_st stats;
+    string stream;
+
+    ASSERT_EQ(fleet_init(&f, 1, NULL, NULL, NULL), 0);
+    ASSERT_EQ(udpingest_init(&u, &f, 0, 2, NULL, NULL), 0);
+
+    PacketGenerator gen(2, udpingest_port(&u));
+
+    for (uint32_t k = 0; k < 10; k++) {
+        stream += NmeaUtils::GenNMEA_GGAsentence(DeviceGGA(0, k));
+    }
+
+    /* Source 0: the stream in datagrams of 7 bytes. Source 1: the whole stream in one datagram, and a large one */
+    vector<string> small;
+    for (size_t pos = 0; pos < stream.size(); pos += 7) {
+        small.push_back(stream.substr(pos, 7));
+    }
+    ASSERT_TRUE(gen.Send(0, small));
+    ASSERT_TRUE(gen.Send(1, {stream, string(UDPINGEST_DGRAM_BYTES + 1, '$')}));
+    ASSERT_TRUE(WaitDatagrams(&u, small.size() + 2));
+    fleet_flush(&f);
+
+    udpingest_get_stats(&u, &stats);
+    ASSERT_EQ(stats.sources, 2u);
+    ASSERT_EQ(stats.truncated, 1u);
+    ASSERT_EQ(stats.bytes, 2 * stream.size());
+
+    /* Sequential device IDs */
+    ASSERT_EQ(fleet_count(&f), 2u);
+    for (uint32_t d = 1; d <= 2; d++) {
+        fleet_status_st status;
+        ASSERT_EQ(fleet_get_status(&f, d, &status), 0);
+        ASSERT_EQ(status.positions, 10u);
+        ASSERT_NEAR(status.llh.altitude, 9.0f, 0.01f);
+    }
+
+    udpingest_free(&u);
+    fleet_free(&f);
+}
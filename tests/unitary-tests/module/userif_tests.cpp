@@ -38,3 +38,31 @@ TEST(UserIf, test_set_gps_status_001)
         ASSERT_EQ(userif_get_gps_status(),v);
     }
 }
+
+/**
+ * Update the reached fences
+ */
+TEST(UserIf, test_set_fences_reached_001)
+{
+    uint32_t ids[] = {4, 8, 15, 16, 23, 42};
+    uint32_t out[USERIF_MAX_FENCES + 8];
+    uint32_t many[USERIF_MAX_FENCES + 8];
+
+    userif_set_fences_reached(ids, 6);
+    ASSERT_EQ(userif_get_fences_reached(out, 3), 6u);
+    ASSERT_EQ(out[0], 4u);
+    ASSERT_EQ(out[2], 15u);
+    ASSERT_TRUE(userif_is_fence_reached(42));
+    ASSERT_FALSE(userif_is_fence_reached(5));
+
+    for (uint32_t i = 0; i < USERIF_MAX_FENCES + 8; i++) {
+        many[i] = i;
+    }
+    userif_set_fences_reached(many, USERIF_MAX_FENCES + 8);
+    ASSERT_EQ(userif_get_fences_reached(out, USERIF_MAX_FENCES + 8), (uint32_t)USERIF_MAX_FENCES);
+    ASSERT_FALSE(userif_is_fence_reached(USERIF_MAX_FENCES));
+
+    userif_set_fences_reached(NULL, 0);
+    ASSERT_EQ(userif_get_fences_reached(out, 3), 0u);
+    ASSERT_FALSE(userif_is_fence_reached(4));
+}
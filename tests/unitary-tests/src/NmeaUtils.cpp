@@ -79,11 +79,13 @@ vector<string> NmeaUtils::ReadNMEAfile (
 /**
  * Generate a NMEA sentence of type GGA with the information of the input.
  * The string contains the final '\r', necessary for parsing the message.
- * @param gga  GGA parameters
+ * @param gga         GGA parameters
+ * @param separation  False to leave the geoidal separation field empty
  * @return  String with the GGA sentence
  */
 string NmeaUtils::GenNMEA_GGAsentence (
-        GgaType gga
+        GgaType gga,
+        bool separation
 )
 {
     char hhmmssss[10];
@@ -105,10 +107,15 @@ string NmeaUtils::GenNMEA_GGAsentence (
     char lng_format[10];
     snprintf(lng_format, 10, "%03d%02d.%03d", (int)lng_deg, (int)lng_min, (int)lng_sec);
 
+    char geoidal[16] = "";
+    if (separation) {
+        snprintf(geoidal, 16, "%.1f", gga.geoidal);
+    }
+
     char str[255];
-    auto n = snprintf(str, 255, "GPGGA,%s,%s,%c,%s,%c,%d,%02d,%.1f,%.1f,M,%.1f,M,,",
+    auto n = snprintf(str, 255, "GPGGA,%s,%s,%c,%s,%c,%d,%02d,%.1f,%.1f,M,%s,M,,",
             hhmmssss, lat_format, lat_pole_prime, lng_format, lng_pole_prime,
-            gga.fix, gga.satellites, gga.hdop, gga.altitude, gga.geoidal);
+            gga.fix, gga.satellites, gga.hdop, gga.altitude, geoidal);
 
     int crc = 0;
     for (int i=0; i<n; i++) {